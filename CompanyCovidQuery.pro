@@ -1,35 +1,95 @@
-QT       += core gui sql charts
+QT       += core gui sql charts network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++17
 
+# The exporter and the online backup use the SQLite C API on connections of the QSQLITE driver.
+# Qt must be built with -system-sqlite so both use this library, which getSqliteHandle() checks at run time.
+LIBS += -lsqlite3
+
+# The online backup compresses its copies with zlib.
+LIBS += -lz
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    src/forms/alertsdialog.cpp \
+    src/forms/compliancedialog.cpp \
     src/forms/employeedialog.cpp \
     src/forms/surveydialog.cpp \
+    src/forms/teamdialog.cpp \
+    src/objects/auditlog.cpp \
+    src/objects/durabilityprofile.cpp \
+    src/objects/complianceengine.cpp \
     src/objects/employeetablemodel.cpp \
+    src/objects/ingestionserver.cpp \
+    src/objects/profilebenchmark.cpp \
+    src/objects/queryplaninspector.cpp \
+    src/objects/questionset.cpp \
+    src/objects/retentionjob.cpp \
     src/objects/survey.cpp \
+    src/objects/surveydaemon.cpp \
     src/objects/surveydatabase.cpp \
+    src/objects/surveybackup.cpp \
+    src/objects/surveyexporter.cpp \
+    src/objects/surveyimporter.cpp \
+    src/objects/surveypagecache.cpp \
+    src/objects/surveypageloader.cpp \
+    src/objects/temperaturechart.cpp \
+    src/objects/temperatureseries.cpp \
+    src/objects/temperaturesketch.cpp \
+    src/objects/teammatrixmodel.cpp \
+    src/objects/temperaturetrend.cpp \
+    src/objects/tracer.cpp \
+    src/objects/workdaycalendar.cpp \
     src/main.cpp \
     src/forms/mainwindow.cpp \
     src/objects/surveytablemodel.cpp
 
 HEADERS += \
+    src/forms/alertsdialog.h \
+    src/forms/compliancedialog.h \
     src/forms/employeedialog.h \
     src/forms/surveydialog.h \
+    src/forms/teamdialog.h \
+    src/objects/auditlog.h \
+    src/objects/durabilityprofile.h \
+    src/objects/complianceengine.h \
     src/objects/employeetablemodel.h \
+    src/objects/ingestionserver.h \
+    src/objects/profilebenchmark.h \
+    src/objects/queryplaninspector.h \
+    src/objects/questionset.h \
+    src/objects/retentionjob.h \
     src/objects/survey.h \
+    src/objects/surveydaemon.h \
     src/objects/surveydatabase.h \
+    src/objects/spscqueue.h \
+    src/objects/sqlitehandle.h \
+    src/objects/surveybackup.h \
+    src/objects/surveyexporter.h \
+    src/objects/surveyimporter.h \
+    src/objects/surveypagecache.h \
+    src/objects/surveypageloader.h \
+    src/objects/temperaturechart.h \
+    src/objects/temperatureseries.h \
+    src/objects/temperaturesketch.h \
+    src/objects/teammatrixmodel.h \
+    src/objects/temperaturetrend.h \
+    src/objects/tracer.h \
+    src/objects/workdaycalendar.h \
     src/forms/mainwindow.h \
     src/objects/surveytablemodel.h
 
 FORMS += \
+    src/forms/alertsdialog.ui \
+    src/forms/compliancedialog.ui \
     src/forms/employeedialog.ui \
     src/forms/surveydialog.ui \
+    src/forms/teamdialog.ui \
     src/forms/mainwindow.ui
 
 TRANSLATIONS += \
@@ -0,0 +1,37 @@
+#include "alertsdialog.h"
+#include "ui_alertsdialog.h"
+
+/*!
+ * \brief The constructor for the AlertsDialog.
+ * \param alerts = The alerts to list, in the order they should appear
+ * \param parent = The QWidget to which this dialog is bound to
+ */
+AlertsDialog::AlertsDialog(const QList<TemperatureAlert> &alerts, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::AlertsDialog)
+{
+    ui->setupUi(this);
+
+    ui->tableAlerts->setColumnCount(AlertTableColumns::AlertZScore + 1);
+    ui->tableAlerts->setHorizontalHeaderLabels({tr("Survey Date"), tr("Employee"), tr("Temperature (°C)"),
+                                                tr("Baseline (°C)"), tr("Deviation")});
+    ui->tableAlerts->setRowCount(alerts.size());
+
+    for (int row = 0; row < alerts.size(); ++row) {
+        const TemperatureAlert &alert(alerts[row]);
+
+        ui->tableAlerts->setItem(row, AlertTableColumns::AlertDate, new QTableWidgetItem(alert.surveyDate.toString("dd/MM/yyyy")));
+        ui->tableAlerts->setItem(row, AlertTableColumns::AlertEmployee, new QTableWidgetItem(alert.name));
+        ui->tableAlerts->setItem(row, AlertTableColumns::AlertTemperature, new QTableWidgetItem(QString::number(alert.temperature, 'f', 1)));
+        ui->tableAlerts->setItem(row, AlertTableColumns::AlertBaseline, new QTableWidgetItem(QString::number(alert.baseline, 'f', 1)));
+        ui->tableAlerts->setItem(row, AlertTableColumns::AlertZScore, new QTableWidgetItem(QString::number(alert.zScore, 'f', 1) + " σ"));
+    }
+}
+
+/*!
+ * \brief The destructor for the AlertsDialog.
+ */
+AlertsDialog::~AlertsDialog()
+{
+    delete ui;
+}
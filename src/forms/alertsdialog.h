@@ -0,0 +1,39 @@
+#ifndef ALERTSDIALOG_H
+#define ALERTSDIALOG_H
+
+#include "../objects/temperaturetrend.h"
+
+#include <QDialog>
+
+namespace Ui {
+class AlertsDialog;
+}
+
+/*!
+ * \brief Enum for the column headers found in the alerts table.
+ * \note The order in which they appear here is also their order in the table.
+ */
+enum AlertTableColumns {
+    AlertDate,          ///< 0
+    AlertEmployee,      ///< 1
+    AlertTemperature,   ///< 2
+    AlertBaseline,      ///< 3
+    AlertZScore         ///< 4
+};
+
+/*!
+ * \brief The window where the company-wide temperature alerts are listed.
+ */
+class AlertsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit AlertsDialog(const QList<TemperatureAlert> &alerts, QWidget *parent = nullptr);
+    ~AlertsDialog();
+
+private:
+    Ui::AlertsDialog *ui;   ///< The reference to the UI of the AlertsDialog.
+};
+
+#endif // ALERTSDIALOG_H
@@ -0,0 +1,152 @@
+#include "compliancedialog.h"
+#include "ui_compliancedialog.h"
+
+#include "../objects/surveydatabase.h"
+
+#include <QCheckBox>
+#include <QInputDialog>
+#include <QLocale>
+#include <QMessageBox>
+#include <algorithm>
+
+/*!
+ * \brief The constructor for the ComplianceDialog.
+ * \param db = The database the surveys are read from
+ * \param parent = The QWidget to which this dialog is bound to
+ * \note The range starts as the last 90 days, a quarter.
+ */
+ComplianceDialog::ComplianceDialog(SurveyDatabase *db, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::ComplianceDialog),
+    surveyDb(db),
+    calendar(WorkdayCalendar::load())
+{
+    ui->setupUi(this);
+
+    ui->tableCompliance->setColumnCount(ComplianceTableColumns::ComplianceMissedDates + 1);
+    ui->tableCompliance->setHorizontalHeaderLabels({tr("Employee"), tr("Workdays"), tr("Missed"), tr("Missed Dates")});
+
+    ui->dateTo->setDate(QDate::currentDate());
+    ui->dateFrom->setDate(QDate::currentDate().addDays(-89));
+
+    setupWeekdays();
+
+    connect(ui->dateFrom, &QDateEdit::dateChanged, this, &ComplianceDialog::refresh);
+    connect(ui->dateTo, &QDateEdit::dateChanged, this, &ComplianceDialog::refresh);
+    connect(ui->checkMissedOnly, &QCheckBox::toggled, this, &ComplianceDialog::refresh);
+    connect(surveyDb, &SurveyDatabase::databaseChanged, this, &ComplianceDialog::refresh);
+
+    refresh();
+}
+
+/*!
+ * \brief The destructor for the ComplianceDialog.
+ */
+ComplianceDialog::~ComplianceDialog()
+{
+    delete ui;
+}
+
+/*!
+ * \brief Recomputes the compliance of every employee and shows it in the table.
+ */
+void ComplianceDialog::refresh()
+{
+    QDate from(ui->dateFrom->date());
+    QDate to(ui->dateTo->date());
+    const QList<ComplianceRecord> records(surveyDb->getCompliance(from, to, calendar, ui->checkMissedOnly->isChecked()));
+
+    ui->tableCompliance->setSortingEnabled(false);
+    ui->tableCompliance->setRowCount(records.size());
+
+    int compliant(0);
+
+    for (int row = 0; row < records.size(); ++row) {
+        const ComplianceRecord &record(records[row]);
+        QStringList dates;
+
+        for (const QDate &date : record.missedDates)
+            dates.append(date.toString("dd/MM/yyyy"));
+
+        QTableWidgetItem *requiredItem(new QTableWidgetItem());
+        QTableWidgetItem *missedItem(new QTableWidgetItem());
+
+        // Numbers, so the columns sort numerically.
+        requiredItem->setData(Qt::DisplayRole, record.requiredDays);
+        missedItem->setData(Qt::DisplayRole, record.missedDays);
+
+        ui->tableCompliance->setItem(row, ComplianceTableColumns::ComplianceEmployee, new QTableWidgetItem(record.name));
+        ui->tableCompliance->setItem(row, ComplianceTableColumns::ComplianceRequired, requiredItem);
+        ui->tableCompliance->setItem(row, ComplianceTableColumns::ComplianceMissed, missedItem);
+        ui->tableCompliance->setItem(row, ComplianceTableColumns::ComplianceMissedDates, new QTableWidgetItem(dates.join(", ")));
+
+        if (record.missedDays == 0)
+            ++compliant;
+    }
+
+    ui->tableCompliance->setSortingEnabled(true);
+
+    ui->labelSummary->setText(records.isEmpty() ? tr("No employees to report.")
+                                                : QString::number(compliant) + " " + tr("of") + " " +
+                                                  QString::number(records.size()) + " " + tr("employees submitted a survey on every workday."));
+}
+
+/*!
+ * \brief Lets the user edit the holidays, one date per line.
+ */
+void ComplianceDialog::on_btnHolidays_clicked()
+{
+    QList<QDate> holidays(calendar.getHolidays().values());
+    QStringList lines;
+
+    std::sort(holidays.begin(), holidays.end());
+
+    for (const QDate &holiday : holidays)
+        lines.append(holiday.toString(Qt::ISODate));
+
+    bool ok;
+    QString text(QInputDialog::getMultiLineText(this, tr("Holidays"), tr("One date (yyyy-mm-dd) per line:"),
+                                                lines.join('\n'), &ok));
+
+    if (!ok)
+        return;
+
+    QSet<QDate> dates;
+    QStringList invalid;
+    const QStringList entries(text.split('\n', Qt::SkipEmptyParts));
+
+    for (const QString &entry : entries) {
+        QDate date(QDate::fromString(entry.trimmed(), Qt::ISODate));
+
+        if (date.isValid())
+            dates.insert(date);
+        else if (!entry.trimmed().isEmpty())
+            invalid.append(entry.trimmed());
+    }
+
+    if (!invalid.isEmpty())
+        QMessageBox::warning(this, tr("Holidays"), tr("These lines are not valid dates and were ignored:") + "\n" + invalid.join('\n'));
+
+    calendar.setHolidays(dates);
+    calendar.save();
+    refresh();
+}
+
+/*!
+ * \brief Creates a check box for every weekday, checked if it is a working day.
+ */
+void ComplianceDialog::setupWeekdays()
+{
+    for (int day = 1; day <= 7; ++day) {
+        QCheckBox *check(new QCheckBox(QLocale().dayName(day, QLocale::ShortFormat), this));
+
+        check->setChecked(calendar.isWorkingWeekday(day));
+        ui->layoutWeekdays->insertWidget(day - 1, check);
+
+        connect(check, &QCheckBox::toggled, this, [this, day](const bool &checked) {
+            calendar.setWorkingWeekday(day, checked);
+            calendar.save();
+            refresh();
+        });
+    }
+}
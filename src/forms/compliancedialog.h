@@ -0,0 +1,52 @@
+#ifndef COMPLIANCEDIALOG_H
+#define COMPLIANCEDIALOG_H
+
+#include "../objects/workdaycalendar.h"
+
+#include <QDialog>
+
+namespace Ui {
+class ComplianceDialog;
+}
+
+class SurveyDatabase;
+
+/*!
+ * \brief Enum for the column headers found in the compliance table.
+ * \note The order in which they appear here is also their order in the table.
+ */
+enum ComplianceTableColumns {
+    ComplianceEmployee,     ///< 0
+    ComplianceRequired,     ///< 1
+    ComplianceMissed,       ///< 2
+    ComplianceMissedDates   ///< 3
+};
+
+/*!
+ * \brief The window where the workdays on which employees did not submit a survey are listed.
+ *
+ * The report is recomputed whenever the range or the calendar changes, and whenever the database changes.
+ */
+class ComplianceDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ComplianceDialog(SurveyDatabase *db, QWidget *parent = nullptr);
+    ~ComplianceDialog();
+
+public slots:
+    void refresh();
+
+private slots:
+    void on_btnHolidays_clicked();
+
+private:
+    Ui::ComplianceDialog *ui;       ///< The reference to the UI of the ComplianceDialog.
+    SurveyDatabase *surveyDb;       ///< The database the surveys are read from.
+    WorkdayCalendar calendar;       ///< The days on which a survey is required.
+
+    void setupWeekdays();
+};
+
+#endif // COMPLIANCEDIALOG_H
@@ -6,24 +6,33 @@
 #include <QAction>
 #include <QMenu>
 #include <QMessageBox>
+#include <QInputDialog>
+#include <QSortFilterProxyModel>
 
 /*!
  * \brief The constructor for the EmployeeDialog.
- * \param empModel = The model used to display the employees in a list
+ * \param empModel = The model used to display the employees in a table
  * \param parent = The QWidget to which this dialog is bound to
  */
-EmployeeDialog::EmployeeDialog(QSqlQueryModel *empModel, QWidget *parent) :
+EmployeeDialog::EmployeeDialog(EmployeeTableModel *empModel, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::EmployeeDialog),
-    contextMenu(new QMenu(this))
+    contextMenu(new QMenu(this)),
+    sortModel(new QSortFilterProxyModel(this))
 {
     ui->setupUi(this);
 
-    // Setup the listEmployees list.
-    ui->listEmployees->setModel(empModel);
-    ui->listEmployees->setModelColumn(EmployeeTableColumns::Name);
+    // Sort on the unformatted values, in a proxy so the order of the shared model (and the employee combobox) stays the same.
+    sortModel->setSourceModel(empModel);
+    sortModel->setSortRole(Qt::EditRole);
+    sortModel->setSortCaseSensitivity(Qt::CaseInsensitive);
 
-    // Setup the context menu for listEmployees.
+    // Setup the tableEmployees table.
+    ui->tableEmployees->setModel(sortModel);
+    ui->tableEmployees->setColumnHidden(EmployeeTableColumns::ID, true);
+    ui->tableEmployees->sortByColumn(EmployeeTableColumns::Name, Qt::AscendingOrder);
+
+    // Setup the context menu for tableEmployees.
     setupEmployeeListContextMenu();
 }
 
@@ -52,13 +61,12 @@ void EmployeeDialog::on_btnAdd_clicked()
 }
 
 /*!
- * \brief Deletes the selected employee.
- * \note This function only calls removeSelectedEmployee().
+ * \brief Deletes all selected employees.
  */
 void EmployeeDialog::on_btnDelete_clicked()
 {
-    if (ui->listEmployees->currentIndex().row() > -1)
-        emit removeEmployee(getCurrentEmployeeId());
+    if (ui->tableEmployees->selectionModel()->hasSelection())
+        emit removeEmployees(getSelectedEmployeeIds());
     else
         QMessageBox::information(this, "No entry selected", "Please select an entry from the list first.");
 }
@@ -69,9 +77,9 @@ void EmployeeDialog::on_btnDelete_clicked()
  */
 int EmployeeDialog::getCurrentEmployeeId() const
 {
-    int row(ui->listEmployees->currentIndex().row());
-    QModelIndex index(ui->listEmployees->model()->index(row, EmployeeTableColumns::ID));
-    QVariant id(ui->listEmployees->model()->data(index));
+    int row(ui->tableEmployees->currentIndex().row());
+    QModelIndex index(ui->tableEmployees->model()->index(row, EmployeeTableColumns::ID));
+    QVariant id(ui->tableEmployees->model()->data(index));
 
     return id.toInt();
 }
@@ -82,21 +90,36 @@ int EmployeeDialog::getCurrentEmployeeId() const
  */
 QString EmployeeDialog::getCurrentEmployeeName() const
 {
-    int row(ui->listEmployees->currentIndex().row());
-    QModelIndex index(ui->listEmployees->model()->index(row, EmployeeTableColumns::Name));
-    QVariant name(ui->listEmployees->model()->data(index));
+    int row(ui->tableEmployees->currentIndex().row());
+    QModelIndex index(ui->tableEmployees->model()->index(row, EmployeeTableColumns::Name));
+    QVariant name(ui->tableEmployees->model()->data(index));
 
     return name.toString();
 }
 
 /*!
- * \brief Opens a context menu only if an item in the list is right clicked.
+ * \brief Retrieves the IDs of all employees currently selected.
+ * \return A list with the employees' IDs.
+ */
+QList<int> EmployeeDialog::getSelectedEmployeeIds() const
+{
+    QList<int> ids;
+    const QModelIndexList selected(ui->tableEmployees->selectionModel()->selectedRows(EmployeeTableColumns::ID));
+
+    for (const QModelIndex &index : selected)
+        ids.append(index.data().toInt());
+
+    return ids;
+}
+
+/*!
+ * \brief Opens a context menu only if an item in the table is right clicked.
  * \param pos = The position of the mouse cursor when right clicked
  */
 void EmployeeDialog::contextMenuRequested(const QPoint &pos)
 {
-    if (ui->listEmployees->indexAt(pos).row() > -1)
-        contextMenu->popup(ui->listEmployees->viewport()->mapToGlobal(pos));
+    if (ui->tableEmployees->indexAt(pos).row() > -1)
+        contextMenu->popup(ui->tableEmployees->viewport()->mapToGlobal(pos));
 }
 
 /*!
@@ -104,19 +127,56 @@ void EmployeeDialog::contextMenuRequested(const QPoint &pos)
  */
 void EmployeeDialog::on_btnEdit_clicked()
 {
-    if (ui->listEmployees->currentIndex().row() > -1)
+    if (ui->tableEmployees->currentIndex().row() > -1)
         emit editEmployee(getCurrentEmployeeId(), getCurrentEmployeeName());
     else
         QMessageBox::information(this, "No entry selected", "Please select an entry from the list first.");
 }
 
 /*!
- * \brief Create the context menu for the employee list.
+ * \brief Asks which of the selected employees to keep and prompts a command to merge the others into it.
+ */
+void EmployeeDialog::on_btnMerge_clicked()
+{
+    const QModelIndexList selected(ui->tableEmployees->selectionModel()->selectedRows(EmployeeTableColumns::Name));
+
+    if (selected.size() < 2) {
+        QMessageBox::information(this, tr("Merge Employees"), tr("Please select at least two entries from the list first."));
+        return;
+    }
+
+    QList<int> ids(getSelectedEmployeeIds());
+    QStringList labels;
+
+    for (int i = 0; i < selected.size(); ++i)
+        labels.append(selected[i].data().toString() + " (ID " + QString::number(ids[i]) + ")");
+
+    bool ok;
+    QString keepLabel(QInputDialog::getItem(this, tr("Merge Employees"),
+                                            tr("Keep this employee and move the others' surveys to it:"),
+                                            labels, 0, false, &ok));
+
+    if (ok) {
+        int keepId(ids.takeAt(labels.indexOf(keepLabel)));
+        emit mergeEmployees(keepId, ids);
+    }
+}
+
+/*!
+ * \brief Prompts a command to rename employees from a mapping file.
+ */
+void EmployeeDialog::on_btnRenameFromFile_clicked()
+{
+    emit renameEmployeesFromFile();
+}
+
+/*!
+ * \brief Create the context menu for the employee table.
  */
 void EmployeeDialog::setupEmployeeListContextMenu()
 {
-    // Use listEmployees' actions as context menu items.
-    ui->listEmployees->setContextMenuPolicy(Qt::CustomContextMenu);
+    // Use tableEmployees' actions as context menu items.
+    ui->tableEmployees->setContextMenuPolicy(Qt::CustomContextMenu);
 
     QAction* editAction(new QAction("Edit", this));
     connect(editAction, &QAction::triggered, [this]() {
@@ -125,12 +185,12 @@ void EmployeeDialog::setupEmployeeListContextMenu()
 
     QAction* deleteAction(new QAction("Delete", this));
     connect(deleteAction, &QAction::triggered, [this]() {
-        emit removeEmployee(getCurrentEmployeeId());
+        emit removeEmployees(getSelectedEmployeeIds());
     });
 
     contextMenu->addAction(editAction);
     contextMenu->addAction(deleteAction);
 
-    connect(ui->listEmployees, &QWidget::customContextMenuRequested, this, &EmployeeDialog::contextMenuRequested);
+    connect(ui->tableEmployees, &QWidget::customContextMenuRequested, this, &EmployeeDialog::contextMenuRequested);
 }
 
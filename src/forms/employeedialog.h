@@ -2,13 +2,14 @@
 #define EMPLOYEEDIALOG_H
 
 #include <QDialog>
-#include <QSqlQueryModel>
 
 namespace Ui {
 class EmployeeDialog;
 }
 
 class QMenu;
+class QSortFilterProxyModel;
+class EmployeeTableModel;
 
 /*!
  * \brief The window where employee data is displayed, added, edited and removed.
@@ -18,7 +19,7 @@ class EmployeeDialog : public QDialog
     Q_OBJECT
 
 public:
-    explicit EmployeeDialog(QSqlQueryModel *empModel, QWidget *parent = nullptr);
+    explicit EmployeeDialog(EmployeeTableModel *empModel, QWidget *parent = nullptr);
     ~EmployeeDialog();
 
 private slots:
@@ -26,19 +27,25 @@ private slots:
     void on_btnAdd_clicked();
     void on_btnDelete_clicked();
     void on_btnEdit_clicked();
+    void on_btnMerge_clicked();
+    void on_btnRenameFromFile_clicked();
 
 signals:
     void addEmployee();
-    void removeEmployee(const int &empId);
+    void removeEmployees(const QList<int> &empIds);
     void editEmployee(const int &empId, const QString &currentName);
+    void mergeEmployees(const int &keepId, const QList<int> &duplicateIds);
+    void renameEmployeesFromFile();
 
 private:
     Ui::EmployeeDialog *ui;
     QMenu *contextMenu;
+    QSortFilterProxyModel *sortModel;
 
     void setupEmployeeListContextMenu();
     int getCurrentEmployeeId() const;
     QString getCurrentEmployeeName() const;
+    QList<int> getSelectedEmployeeIds() const;
     void contextMenuRequested(const QPoint &pos);
 };
 
@@ -1,309 +1,1282 @@
-#include "mainwindow.h"
-#include "ui_mainwindow.h"
-#include "surveydialog.h"
-#include "employeedialog.h"
-
-#include <QSqlTableModel>
-#include <QMessageBox>
-#include <QSqlRecord>
-#include <QMenu>
-
-/*!
- * \brief The constructor for the MainWindow.
- * \param parent = The QWidget to which this window is bound to.
- */
-MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent)
-    , ui(new Ui::MainWindow),
-      surveyDb(),
-      contextMenu(new QMenu(this))
-{
-    // Initialize the UI.
-    ui->setupUi(this);
-
-    // Update the survey table when a new employee is selected.
-    connect(ui->comboEmployee, &QComboBox::currentIndexChanged, this, &MainWindow::updateSurveyTableModel);
-
-    // Connect the new employee and employee list action buttons.
-    connect(ui->actionNewEmployee, &QAction::triggered, this, &MainWindow::addEmployee);
-    connect(ui->actionEmployeeList, &QAction::triggered, this, &MainWindow::openEmployeeDialog);
-
-    // Setup the database.
-    if (!surveyDb.createDatabase())
-        QApplication::quit();
-
-    // Set the model for the employee combobox.
-    ui->comboEmployee->setModel(surveyDb.getEmployeeModel());
-    ui->comboEmployee->setModelColumn(EmployeeTableColumns::Name);
-
-    // Set the model for the survey table.
-    ui->tableSurveys->setModel(surveyDb.getSurveyModel());
-
-    setupSurveyTableContextMenu();
-}
-
-/*!
- * \brief The destructor for the MainWindow.
- */
-MainWindow::~MainWindow()
-{
-    delete ui;
-}
-
-/*!
- * \brief Retrieves a list of all employees and assign it to the Employee ComboBox in the UI.
- * \note After updating the Employee ComboBox it will implicitly update the survey table. This happens ONLY if you have connected the combobox's signal with this class' updateSurveyTableModel slot.
- */
-void MainWindow::updateEmployeeComboBox()
-{
-    surveyDb.updateEmployeeTableModel();
-}
-
-/*!
- * \brief Updates the survey table model with the current selected employee in the Employee ComboBox.
- */
-void MainWindow::updateSurveyTableModel()
-{
-    surveyDb.setCurrentEmployeeId(getCurrentEmployeeId());
-    surveyDb.updateSurveyTableModel();
-}
-
-/*!
- * \brief Asks user for an employee name and adds it to the database.
- */
-void MainWindow::addEmployee()
-{
-    bool ok;
-    QString empName(QInputDialog::getText(this, tr("New Employee"),
-                                            tr("Employee's name:"), QLineEdit::Normal,
-                                            "", &ok));
-
-    if (ok && !empName.isEmpty()) {
-        if (surveyDb.addEmployee(empName)) {
-            updateEmployeeComboBox();
-            QMessageBox::information(this, tr("Success"), tr("The new employee has been successfully added."));
-        } else
-            QMessageBox::critical(this, tr("Error"), tr("An unexpected error has ocurred when adding the new employee."));
-    }
-}
-
-/*!
- * \brief Deletes the given employee from the database.
- * \param empId = The employee's ID
- * \note This does generate a confirmation message before deletion.
- */
-void MainWindow::removeEmployee(const int &empId)
-{
-
-    QMessageBox::StandardButton buttonPressed(QMessageBox::question(this,
-                                                                    "Delete Employee",
-                                                                    "Are you sure you wish to delete this employee?\nCaution: This will delete all their surveys as well."));
-
-    if (buttonPressed == QMessageBox::StandardButton::Yes) {
-        if (surveyDb.removeEmployee(empId)) {
-            updateEmployeeComboBox();
-            updateSurveyTableModel();
-        } else
-            QMessageBox::critical(this, tr("Error"), tr("An unexpected error has ocurred while removing the employee."));
-    }
-}
-
-/*!
- * \brief Displays an existing employee's name and allows the user to edit it.
- * \param empId = The employee's ID
- * \param currentName = The name of the employee before the change
- */
-void MainWindow::editEmployee(const int &empId, const QString &currentName)
-{
-    bool ok;
-    QString newName(QInputDialog::getText(this, tr("Editing employee:") + " " + currentName,
-                                            tr("Employee's name:"), QLineEdit::Normal,
-                                            currentName, &ok));
-
-    if (ok && !newName.isEmpty()) {
-        if (surveyDb.editEmployee(empId, newName)) {
-            updateEmployeeComboBox();
-            QMessageBox::information(this, tr("Success"), currentName + " " + tr("has been successfully renamed to") + " " + newName + ".");
-        } else
-            QMessageBox::critical(this, tr("Error"), tr("An unexpected error ocurred while changing") + " " + currentName + tr("'s name."));
-    }
-}
-
-/*!
- * \brief Opens the survey dialog
- * \param surveyDate = The date and ID of the survey to be edited
- * This will also assign the current selected employee's ID as the ID to which the new survey will belong to.
- * \note If a surveyDate is provided, that survey will be edited instead.
- * \note The default value for surveyDate is a null QDate (which is invalid).
- */
-void MainWindow::openSurveyDialog(const Survey &editSurvey)
-{
-    SurveyDialog *surveyDialog(new SurveyDialog(getCurrentEmployeeId(), this, editSurvey));
-
-    // If a new survey is to be added...
-    if (!editSurvey.isValid())
-        connect(surveyDialog, &SurveyDialog::sendNewSurvey, this, &MainWindow::addSurvey);
-    else
-        connect(surveyDialog, &SurveyDialog::updateSurvey, this, &MainWindow::editSurvey);
-
-    surveyDialog->setAttribute(Qt::WA_DeleteOnClose);
-    surveyDialog->open();
-}
-
-/*!
- * \brief Opens the employee dialog
- */
-void MainWindow::openEmployeeDialog()
-{
-    EmployeeDialog *employeeDialog(new EmployeeDialog(surveyDb.getEmployeeModel()));
-
-    connect(employeeDialog, &EmployeeDialog::addEmployee, this, &MainWindow::addEmployee);
-    connect(employeeDialog, &EmployeeDialog::removeEmployee, this, &MainWindow::removeEmployee);
-    connect(employeeDialog, &EmployeeDialog::editEmployee, this, &MainWindow::editEmployee);
-
-    employeeDialog->setAttribute(Qt::WA_DeleteOnClose);
-    employeeDialog->open();
-}
-
-/*!
- * \brief Adds the new data as a new survey in the database.
- * \param newSurvey = The new survey to be added
- * \note This will automatically update the survey table if successful.
- */
-void MainWindow::addSurvey(const Survey &newSurvey)
-{
-    if (surveyDb.addSurvey(newSurvey)) {
-        updateSurveyTableModel();
-        QMessageBox::information(this, tr("Success"), tr("The new survey has been successfully added."));
-    } else
-        QMessageBox::critical(this, tr("Error"), tr("An unexpected error has ocurred while adding the new survey."));
-}
-
-/*!
- * \brief Removes the survey that contains the given date and employee ID.
- * \param date = The survey date
- * \param empId = The employee's ID
- * \note This does not generate a confirmation message. It only generates an error message if the action failed.
- */
-void MainWindow::removeSurvey(const QDate &date, const int &empId)
-{
-    if (surveyDb.removeSurvey(date, empId))
-        updateSurveyTableModel();
-    else
-        QMessageBox::critical(this, tr("Error"), tr("An unexpected error has ocurred while removing the survey."));
-}
-
-/*!
- * \brief Edits an existing survey in the database.
- * \param survey = The survey data to be updated into the database
- * \note This will automatically update the survey table if successful.
- */
-void MainWindow::editSurvey(const Survey &survey)
-{
-    if (surveyDb.editSurvey(survey)) {
-        updateSurveyTableModel();
-        QMessageBox::information(this, tr("Success"), tr("The survey has been successfully updated."));
-    } else
-        QMessageBox::critical(this, tr("Error"), tr("An unexpected error has ocurred while updating the survey."));
-}
-
-/*!
- * \brief The function executed when clicking the Add Survey button.
- * This function will call the openSurveyDialog() function.
- */
-void MainWindow::on_btnAddSurvey_clicked()
-{
-    openSurveyDialog();
-}
-
-/*!
- * \brief Create the context menu for the survey table.
- */
-void MainWindow::setupSurveyTableContextMenu()
-{
-    // Use tableSurveys' actions as context menu items.
-    ui->tableSurveys->setContextMenuPolicy(Qt::CustomContextMenu);
-
-    QAction* editAction(new QAction("Edit", this));
-    connect(editAction, &QAction::triggered, [this]() {
-        openSurveyDialog(getCurrentSurvey());
-    });
-
-    QAction* deleteAction(new QAction("Delete", this));
-    connect(deleteAction, &QAction::triggered, [this]() {
-        if (QMessageBox::question(this, "Delete survey?",
-                                  "Are you sure you wish to delete this survey?") == QMessageBox::Yes)
-        {
-            removeSurvey(getCurrentSurveyDate(), getCurrentEmployeeId());
-        }
-    });
-
-    contextMenu->addAction(editAction);
-    contextMenu->addAction(deleteAction);
-
-    connect(ui->tableSurveys, &QWidget::customContextMenuRequested, this, &MainWindow::contextMenuRequested);
-}
-
-/*!
- * \brief Retrieves the ID of the employee currently selected in the employee combobox.
- * \return An integer with the employee's ID
- */
-int MainWindow::getCurrentEmployeeId() const
-{
-    int row(ui->comboEmployee->currentIndex());
-    QModelIndex index(ui->comboEmployee->model()->index(row, EmployeeTableColumns::ID));
-    QVariant id(ui->comboEmployee->model()->data(index));
-
-    return id.toInt();
-}
-
-/*!
- * \brief Retrieves the currently selected survey from the table.
- * \return A Survey object with the survey values.
- */
-Survey MainWindow::getCurrentSurvey()
-{
-    QModelIndexList indexList(ui->tableSurveys->selectionModel()->selectedRows());
-
-    // Retrieve the first row in the list.
-    // Only one selected row should be allowed.
-    QModelIndex index(indexList[0]);
-
-    // Retrieve the record of the row in the survey model.
-    QSqlRecord surveyRecord(surveyDb.getSurveyModel()->record(index.row()));
-
-    // Retrieve all values of the survey from the table.
-    Survey currentSurvey(QDate::fromString(surveyRecord.value(SurveyTableColumns::Date).toString(), "dd/MM/yyyy"),
-                         getCurrentEmployeeId(),
-                         (surveyRecord.value(SurveyTableColumns::Question1).toString() == "Yes") ? true : false,
-                         (surveyRecord.value(SurveyTableColumns::Question2).toString() == "Yes") ? true : false,
-                         (surveyRecord.value(SurveyTableColumns::Question3).toString() == "Yes") ? true : false,
-                         surveyRecord.value(SurveyTableColumns::Temperature).toDouble());
-
-    return currentSurvey;
-}
-
-/*!
- * \brief Retrieves the currently selected survey's date from the table.
- * \return A QDate with the survey date.
- */
-QDate MainWindow::getCurrentSurveyDate()
-{
-    QModelIndexList indexList(ui->tableSurveys->selectionModel()->selectedRows());
-
-    // Retrieve the first row in the list.
-    // Only one selected row should be allowed.
-    QModelIndex index(indexList[0]);
-
-    // Retrieve the record of the row in the survey model.
-    QSqlRecord surveyRecord(surveyDb.getSurveyModel()->record(index.row()));
-
-    return QDate::fromString(surveyRecord.value(SurveyTableColumns::Date).toString(), "dd/MM/yyyy");
-}
-
-void MainWindow::contextMenuRequested(const QPoint &pos)
-{
-    if (ui->tableSurveys->indexAt(pos).row() > -1)
-        contextMenu->popup(ui->tableSurveys->viewport()->mapToGlobal(pos));
-}
-
+#include "mainwindow.h"
+#include "ui_mainwindow.h"
+#include "surveydialog.h"
+#include "employeedialog.h"
+#include "alertsdialog.h"
+#include "compliancedialog.h"
+#include "teamdialog.h"
+#include "../objects/surveyexporter.h"
+#include "../objects/temperaturechart.h"
+#include "../objects/tracer.h"
+
+#include <QSqlTableModel>
+#include <QMessageBox>
+#include <QMenu>
+#include <QFileDialog>
+#include <QTextStream>
+#include <QFile>
+#include <QPushButton>
+#include <QLabel>
+#include <QLocale>
+#include <QSettings>
+#include <QProgressBar>
+#include <QTimer>
+#include <QThread>
+
+#include <memory>
+
+namespace {
+const int WriteRetryInterval(250);  ///< The time (in milliseconds) before a write that found the database locked is tried again.
+const int MaxWriteAttempts(20);     ///< The amount of times a write is tried before the user is told the database is in use.
+}
+
+/*!
+ * \brief The constructor for the MainWindow.
+ * \param parent = The QWidget to which this window is bound to.
+ * \param profile = The durability profile the database is opened with
+ */
+MainWindow::MainWindow(QWidget *parent, const DurabilityProfile &profile)
+    : QMainWindow(parent)
+    , ui(new Ui::MainWindow),
+      surveyDb(),
+      retentionJob(&surveyDb),
+      ingestionServer(&surveyDb),
+      surveyImporter(),
+      contextMenu(new QMenu(this)),
+      modelInfoLabel(new QLabel(this)),
+      temperatureChart(nullptr),
+      prefetchPages(QSettings().value("cache/prefetch", true).toBool()),
+      loadProgress(new QProgressBar(this)),
+      loadTimer(),
+      exportThread(nullptr)
+{
+    // Initialize the UI.
+    ui->setupUi(this);
+    ui->statusbar->addPermanentWidget(loadProgress);
+    ui->statusbar->addPermanentWidget(modelInfoLabel);
+    loadProgress->setMaximumWidth(160);
+    loadProgress->hide();
+    temperatureChart = new TemperatureChart(ui->chartSurvey, this);
+
+    // Update the survey table when a new employee is selected.
+    connect(ui->comboEmployee, &QComboBox::currentIndexChanged, this, &MainWindow::updateSurveyTableModel);
+
+    // Connect the new employee and employee list action buttons.
+    connect(ui->actionNewEmployee, &QAction::triggered, this, &MainWindow::addEmployee);
+    connect(ui->actionEmployeeList, &QAction::triggered, this, &MainWindow::openEmployeeDialog);
+    connect(ui->actionSelectPartition, &QAction::triggered, this, &MainWindow::selectPartition);
+    connect(ui->actionMoveEmployee, &QAction::triggered, this, &MainWindow::moveEmployee);
+    connect(ui->actionTemperatureAlerts, &QAction::triggered, this, &MainWindow::openAlertsDialog);
+    connect(ui->actionMissedSurveys, &QAction::triggered, this, &MainWindow::openComplianceDialog);
+    connect(ui->actionTeamComparison, &QAction::triggered, this, &MainWindow::openTeamDialog);
+    connect(ui->actionCompanyChart, &QAction::toggled, this, &MainWindow::updateChart);
+    connect(ui->actionTemperaturePercentiles, &QAction::triggered, this, &MainWindow::showTemperaturePercentiles);
+    connect(ui->actionQueryPlanReport, &QAction::triggered, this, &MainWindow::showQueryPlanReport);
+    connect(ui->actionAddQuestion, &QAction::triggered, this, &MainWindow::addQuestion);
+    connect(ui->actionRetireQuestion, &QAction::triggered, this, &MainWindow::retireQuestion);
+    connect(ui->actionDatabaseStatistics, &QAction::triggered, this, &MainWindow::showDatabaseStatistics);
+    connect(ui->actionDurabilityProfile, &QAction::triggered, this, &MainWindow::selectDurabilityProfile);
+
+    // Record a trace from the user action to the repaint of the survey table.
+    ui->actionRecordTrace->setChecked(Tracer::isEnabled());
+    ui->tableSurveys->viewport()->installEventFilter(this);
+    connect(ui->actionRecordTrace, &QAction::toggled, this, [](const bool &checked) { Tracer::setEnabled(checked); });
+    connect(ui->actionSaveTrace, &QAction::triggered, this, &MainWindow::saveTrace);
+
+    // Show the changes made by other workstations sharing the database file.
+    connect(&surveyDb, &SurveyDatabase::databaseChanged, this, &MainWindow::refreshFromDatabase);
+
+    // Follow the surveys of the selected employee as they are loaded in the background.
+    connect(&surveyDb, &SurveyDatabase::surveyLoadProgress, this, &MainWindow::showSurveyLoadProgress);
+    connect(&surveyDb, &SurveyDatabase::surveysLoaded, this, &MainWindow::surveysLoaded);
+
+    // Connect the export action.
+    connect(ui->actionExportSurveys, &QAction::triggered, this, &MainWindow::exportSurveys);
+
+    // Connect the import action and show the progress of a running import.
+    connect(ui->actionImportSurveys, &QAction::triggered, this, &MainWindow::importSurveys);
+    connect(&surveyImporter, &SurveyImporter::progress, this, &MainWindow::importProgress);
+    connect(&surveyImporter, &SurveyImporter::finished, this, &MainWindow::importFinished);
+
+    // Connect the retention job and its menu action.
+    connect(ui->actionPurgeSurveys, &QAction::triggered, this, &MainWindow::purgeOldSurveys);
+    connect(&retentionJob, &RetentionJob::finished, this, &MainWindow::retentionFinished);
+    connect(&retentionJob, &RetentionJob::compacted, this, &MainWindow::compactionFinished);
+    connect(&retentionJob, &RetentionJob::progress, this, [this](const int &rowsPurged) {
+        ui->statusbar->showMessage(tr("Purging old surveys...") + " " + QString::number(rowsPurged));
+    });
+
+    // Back up the database while it is in use, on request and on the schedule in the settings.
+    connect(ui->actionBackUpNow, &QAction::triggered, this, &MainWindow::backUpNow);
+    connect(surveyDb.getBackup(), &SurveyBackup::finished, this, &MainWindow::backupFinished);
+    connect(surveyDb.getBackup(), &SurveyBackup::progress, this, [this](const int &pagesCopied, const int &pagesTotal) {
+        ui->statusbar->showMessage(tr("Backing up the database...") + " " +
+                                   QString::number(pagesTotal > 0 ? 100 * pagesCopied / pagesTotal : 0) + "%");
+    });
+
+    // Show surveys submitted by tablets as soon as they are written.
+    connect(&ingestionServer, &IngestionServer::surveysIngested, this, [this](const int &count) {
+        updateSurveyTableModel();
+        ui->statusbar->showMessage(QString::number(count) + " " + tr("surveys received from tablets."), 5000);
+    });
+    connect(&ingestionServer, &IngestionServer::surveysDropped, this, [this](const int &count) {
+        ui->statusbar->showMessage(QString::number(count) + " " + tr("surveys from tablets could not be saved."), 10000);
+    });
+
+    // Setup the database.
+    surveyDb.setDurabilityProfile(profile);
+    surveyDb.setPageCacheSize(QSettings().value("cache/surveyPagesMiB", 16).toLongLong() * 1024 * 1024);
+
+    // Only show the site and department that were shown last.
+    Partition partition;
+    partition.siteId = QSettings().value("partition/site", -1).toInt();
+    partition.deptId = QSettings().value("partition/department", -1).toInt();
+    surveyDb.setPartition(partition);
+
+    if (!surveyDb.createDatabase())
+        QApplication::quit();
+
+    BackupSettings backupSettings;
+    QSettings settings;
+
+    backupSettings.directory = settings.value("backup/directory").toString();
+    backupSettings.generations = settings.value("backup/generations", 7).toInt();
+    backupSettings.compress = settings.value("backup/compress", true).toBool();
+    backupSettings.stepBudgetMs = settings.value("backup/stepBudgetMs", 5).toInt();
+    backupSettings.intervalMinutes = settings.value("backup/intervalMinutes", 24 * 60).toInt();
+    surveyDb.getBackup()->setSettings(backupSettings);
+    showPartition();
+
+    // Set the model for the employee combobox.
+    ui->comboEmployee->setModel(surveyDb.getEmployeeModel());
+    ui->comboEmployee->setModelColumn(EmployeeTableColumns::Name);
+
+    // Set the model for the survey table.
+    ui->tableSurveys->setModel(surveyDb.getSurveyModel());
+
+    setupSurveyTableContextMenu();
+}
+
+/*!
+ * \brief The destructor for the MainWindow.
+ */
+MainWindow::~MainWindow()
+{
+    // A running export cannot be interrupted, its thread is waited for.
+    if (exportThread != nullptr) {
+        exportThread->wait();
+        delete exportThread;
+    }
+
+    delete ui;
+}
+
+/*!
+ * \brief Starts accepting surveys from entry tablets.
+ * \param port = The TCP port to listen on
+ * \param address = The address to listen on
+ * \param token = The token tablets must send with every request (an empty token allows all tablets)
+ * \return A boolean value that states whether the server is listening or not.
+ */
+bool MainWindow::startIngestionServer(const quint16 &port, const QHostAddress &address, const QString &token)
+{
+    ingestionServer.setAccessToken(token);
+
+    if (ingestionServer.start(port, address)) {
+        ui->statusbar->showMessage(tr("Accepting surveys from tablets on port") + " " + QString::number(ingestionServer.getPort()));
+        return true;
+    }
+
+    QMessageBox::warning(this, tr("Tablet Server"), tr("Could not start accepting surveys from tablets on port") + " " + QString::number(port) + ".\n" +
+                         ingestionServer.getLastError());
+    return false;
+}
+
+/*!
+ * \brief Retrieves a list of all employees and assign it to the Employee ComboBox in the UI.
+ * \note After updating the Employee ComboBox it will implicitly update the survey table. This happens ONLY if you have connected the combobox's signal with this class' updateSurveyTableModel slot.
+ */
+void MainWindow::updateEmployeeComboBox()
+{
+    surveyDb.updateEmployeeTableModel();
+}
+
+/*!
+ * \brief Reloads the employees and surveys after another workstation changed the database.
+ * \note The selected employee stays selected, unless it was removed.
+ */
+void MainWindow::refreshFromDatabase()
+{
+    int empId(getCurrentEmployeeId());
+    EmployeeTableModel *employeeModel(surveyDb.getEmployeeModel());
+
+    // Do not reload the surveys for every intermediate selection while the employees are reloaded.
+    ui->comboEmployee->blockSignals(true);
+    updateEmployeeComboBox();
+
+    for (int row = 0; row < employeeModel->rowCount(); ++row) {
+        if (employeeModel->getEmployeeId(row) == empId) {
+            ui->comboEmployee->setCurrentIndex(row);
+            break;
+        }
+    }
+
+    ui->comboEmployee->blockSignals(false);
+    updateSurveyTableModel();
+}
+
+/*!
+ * \brief Updates the survey table model with the current selected employee in the Employee ComboBox.
+ * \note The surveys are loaded in the background and the table fills as they arrive. Selecting another employee cancels the load.
+ */
+void MainWindow::updateSurveyTableModel()
+{
+    surveyDb.setCurrentEmployeeId(getCurrentEmployeeId());
+
+    loadTimer.start();
+    surveyDb.updateSurveyTableModelAsync();
+}
+
+/*!
+ * \brief Shows the progress of a survey load once it takes long enough to be noticed.
+ * \param loaded = The amount of surveys loaded so far
+ * \param total = The amount of surveys expected
+ */
+void MainWindow::showSurveyLoadProgress(const int &loaded, const int &total)
+{
+    static const qint64 ShowProgressAfter(300);
+
+    if (loadProgress->isHidden() && loadTimer.elapsed() < ShowProgressAfter)
+        return;
+
+    loadProgress->setRange(0, total);
+    loadProgress->setValue(loaded);
+    loadProgress->show();
+}
+
+/*!
+ * \brief Updates everything that depends on the surveys of the selected employee once they are loaded.
+ */
+void MainWindow::surveysLoaded()
+{
+    TraceSpan span("MainWindow::surveysLoaded");
+
+    loadProgress->hide();
+
+    SurveyTableModel *surveyModel(surveyDb.getSurveyModel());
+    modelInfoLabel->setText(QString::number(surveyModel->rowCount()) + " " + tr("surveys") + " ("
+                            + QLocale().formattedDataSize(surveyModel->getMemoryFootprint()) + ")");
+
+    updateChart();
+
+    // Read ahead once the selected employee is shown, so flipping to a neighbour is a cache hit.
+    if (prefetchPages)
+        prefetchNeighbourPages();
+}
+
+/*!
+ * \brief Loads the temperatures of the current employee, or of the whole company, into the chart.
+ * \note Only the downsampled points for the visible range are drawn, so even years of surveys redraw quickly.
+ */
+void MainWindow::updateChart()
+{
+    bool company(ui->actionCompanyChart->isChecked());
+    int empId(company ? -1 : getCurrentEmployeeId());
+
+    if (!company && empId < 0) {
+        temperatureChart->setSeries(TemperatureSeries(), QString());
+        return;
+    }
+
+    TemperatureSeries series;
+
+    if (company) {
+        if (!surveyDb.loadTemperatureSeries(series))
+            return;
+    } else {
+        // The employee's surveys are already loaded, so the chart does not read them again.
+        const SurveyPage &page(surveyDb.getSurveyModel()->getPage());
+
+        series.reserve(static_cast<int>(page.dates.size()));
+
+        for (size_t i = 0; i < page.dates.size(); ++i)
+            series.append(page.dates[i], page.temperatures[i]);
+
+        series.buildLevels();
+    }
+
+    temperatureChart->setSeries(std::move(series), company ? tr("All employees") : ui->comboEmployee->currentText());
+}
+
+/*!
+ * \brief Asks user for an employee name and adds it to the database.
+ */
+void MainWindow::addEmployee()
+{
+    bool ok;
+    QString empName(QInputDialog::getText(this, tr("New Employee"),
+                                            tr("Employee's name:"), QLineEdit::Normal,
+                                            "", &ok));
+
+    if (ok && !empName.isEmpty()) {
+        runWrite([this, empName]() { return surveyDb.addEmployee(empName); },
+                 [this]() {
+                     updateEmployeeComboBox();
+                     QMessageBox::information(this, tr("Success"), tr("The new employee has been successfully added."));
+                 },
+                 tr("An unexpected error has ocurred when adding the new employee."));
+    }
+}
+
+/*!
+ * \brief Lets the user pick the site and department whose employees, reports and charts are shown.
+ */
+void MainWindow::selectPartition()
+{
+    const QMap<int, QString> sites(surveyDb.getSites());
+    const QMap<int, QString> departments(surveyDb.getDepartments());
+    Partition partition(surveyDb.getPartition());
+
+    bool ok;
+    QString site(pickPartitionName(tr("Show Site"), tr("Show the employees of this site:"),
+                                   sites, tr("All sites"), partition.siteId, false, ok));
+
+    if (!ok)
+        return;
+
+    QString department(pickPartitionName(tr("Show Department"), tr("Show the employees of this department:"),
+                                         departments, tr("All departments"), partition.deptId, false, ok));
+
+    if (!ok)
+        return;
+
+    partition.siteId = sites.key(site, -1);
+    partition.deptId = departments.key(department, -1);
+
+    QSettings settings;
+    settings.setValue("partition/site", partition.siteId);
+    settings.setValue("partition/department", partition.deptId);
+
+    surveyDb.setPartition(partition);
+    showPartition();
+    refreshFromDatabase();
+    updateChart();
+}
+
+/*!
+ * \brief Lets the user move the current employee to another site and department, which are added if they are new.
+ */
+void MainWindow::moveEmployee()
+{
+    int empId(getCurrentEmployeeId());
+
+    if (empId < 0)
+        return;
+
+    Partition partition(surveyDb.getPartition());
+    QString name(ui->comboEmployee->currentText());
+
+    bool ok;
+    QString site(pickPartitionName(tr("Move Employee"), tr("Site of") + " " + name + " " + tr("(type a name to add a site):"),
+                                   surveyDb.getSites(), tr("No site"), partition.siteId, true, ok));
+
+    if (!ok)
+        return;
+
+    QString department(pickPartitionName(tr("Move Employee"), tr("Department of") + " " + name + " " + tr("(type a name to add a department):"),
+                                         surveyDb.getDepartments(), tr("No department"), partition.deptId, true, ok));
+
+    if (!ok)
+        return;
+
+    int siteId(site.isEmpty() || site == tr("No site") ? -1 : surveyDb.addSite(site));
+    int deptId(department.isEmpty() || department == tr("No department") ? -1 : surveyDb.addDepartment(department));
+
+    if ((siteId < 0 && site != tr("No site") && !site.isEmpty()) ||
+            (deptId < 0 && department != tr("No department") && !department.isEmpty())) {
+        showDatabaseError(tr("An unexpected error has ocurred while adding the site or department."));
+        return;
+    }
+
+    // The employee is no longer listed if it moved out of the site or department that is shown.
+    runWrite([this, empId, siteId, deptId]() { return surveyDb.setEmployeePartition({empId}, siteId, deptId); },
+             [this]() { refreshFromDatabase(); },
+             tr("An unexpected error has ocurred while moving the employee."));
+}
+
+/*!
+ * \brief Deletes the given employees from the database.
+ * \param empIds = The employees' IDs
+ * \note This does generate a single confirmation message before deletion, no matter how many employees are deleted.
+ */
+void MainWindow::removeEmployees(const QList<int> &empIds)
+{
+    if (empIds.isEmpty())
+        return;
+
+    QString question(empIds.size() == 1 ? tr("Are you sure you wish to delete this employee?")
+                                        : tr("Are you sure you wish to delete these") + " " + QString::number(empIds.size()) + " " + tr("employees?"));
+
+    QMessageBox::StandardButton buttonPressed(QMessageBox::question(this,
+                                                                    tr("Delete Employee"),
+                                                                    question + "\n" + tr("Caution: This will delete all their surveys as well.")));
+
+    if (buttonPressed == QMessageBox::StandardButton::Yes) {
+        runWrite([this, empIds]() { return surveyDb.removeEmployees(empIds); },
+                 [this]() {
+                     updateEmployeeComboBox();
+                     updateSurveyTableModel();
+                 },
+                 tr("An unexpected error has ocurred while removing the employee."));
+    }
+}
+
+/*!
+ * \brief Merges duplicate employees into one employee.
+ * \param keepId = The ID of the employee that is kept
+ * \param duplicateIds = The IDs of the employees merged into keepId
+ * \note This does generate a confirmation message before merging.
+ */
+void MainWindow::mergeEmployees(const int &keepId, const QList<int> &duplicateIds)
+{
+    QMessageBox::StandardButton buttonPressed(QMessageBox::question(this,
+                                                                    tr("Merge Employees"),
+                                                                    tr("Are you sure you wish to merge") + " " + QString::number(duplicateIds.size()) + " " +
+                                                                    tr("employees into the selected employee?") + "\n" +
+                                                                    tr("Caution: Where both have a survey on the same date, only the kept employee's survey remains.")));
+
+    if (buttonPressed == QMessageBox::StandardButton::Yes) {
+        runWrite([this, keepId, duplicateIds]() { return surveyDb.mergeEmployees(keepId, duplicateIds); },
+                 [this]() {
+                     updateEmployeeComboBox();
+                     updateSurveyTableModel();
+                 },
+                 tr("An unexpected error has ocurred while merging the employees."));
+    }
+}
+
+/*!
+ * \brief Asks for a mapping file and renames all employees listed in it.
+ *
+ * Every line of the file holds an employee's current name and their new name, separated by a comma or a tab.
+ * Empty lines are skipped. All renames are applied in a single transaction.
+ */
+void MainWindow::renameEmployeesFromFile()
+{
+    QString fileName(QFileDialog::getOpenFileName(this, tr("Rename Employees"), "",
+                                                  tr("Mapping files (*.csv *.txt *.tsv);;All files (*)")));
+
+    if (fileName.isEmpty())
+        return;
+
+    QFile mappingFile(fileName);
+
+    if (!mappingFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QMessageBox::critical(this, tr("Error"), tr("The mapping file could not be opened."));
+        return;
+    }
+
+    QList<QPair<QString, QString>> renames;
+    QTextStream mappingStream(&mappingFile);
+
+    while (!mappingStream.atEnd()) {
+        QString line(mappingStream.readLine().trimmed());
+        int separator(line.indexOf('\t'));
+
+        if (separator < 0)
+            separator = line.indexOf(',');
+
+        if (separator > 0)
+            renames.append(qMakePair(line.left(separator).trimmed(), line.mid(separator + 1).trimmed()));
+    }
+
+    std::shared_ptr<int> renamed(std::make_shared<int>(-1));
+
+    runWrite([this, renames, renamed]() { return (*renamed = surveyDb.renameEmployees(renames)) >= 0; },
+             [this, renames, renamed]() {
+                 updateEmployeeComboBox();
+                 QMessageBox::information(this, tr("Success"), QString::number(*renamed) + " " + tr("of") + " " +
+                                          QString::number(renames.size()) + " " + tr("employees have been renamed."));
+             },
+             tr("An unexpected error has ocurred while renaming the employees."));
+}
+
+/*!
+ * \brief Displays an existing employee's name and allows the user to edit it.
+ * \param empId = The employee's ID
+ * \param currentName = The name of the employee before the change
+ */
+void MainWindow::editEmployee(const int &empId, const QString &currentName)
+{
+    bool ok;
+    QString newName(QInputDialog::getText(this, tr("Editing employee:") + " " + currentName,
+                                            tr("Employee's name:"), QLineEdit::Normal,
+                                            currentName, &ok));
+
+    if (ok && !newName.isEmpty()) {
+        runWrite([this, empId, newName]() { return surveyDb.editEmployee(empId, newName); },
+                 [this, currentName, newName]() {
+                     updateEmployeeComboBox();
+                     QMessageBox::information(this, tr("Success"), currentName + " " + tr("has been successfully renamed to") + " " + newName + ".");
+                 },
+                 tr("An unexpected error ocurred while changing") + " " + currentName + tr("'s name."));
+    }
+}
+
+/*!
+ * \brief Opens the survey dialog
+ * \param surveyDate = The date and ID of the survey to be edited
+ * This will also assign the current selected employee's ID as the ID to which the new survey will belong to.
+ * \note If a surveyDate is provided, that survey will be edited instead.
+ * \note The default value for surveyDate is a null QDate (which is invalid).
+ */
+void MainWindow::openSurveyDialog(const Survey &editSurvey)
+{
+    SurveyDialog *surveyDialog(new SurveyDialog(getCurrentEmployeeId(), surveyDb.getQuestionSet(), this, editSurvey));
+
+    // If a new survey is to be added...
+    if (!editSurvey.isValid())
+        connect(surveyDialog, &SurveyDialog::sendNewSurvey, this, &MainWindow::addSurvey);
+    else
+        connect(surveyDialog, &SurveyDialog::updateSurvey, this, &MainWindow::editSurvey);
+
+    surveyDialog->setAttribute(Qt::WA_DeleteOnClose);
+    surveyDialog->open();
+}
+
+/*!
+ * \brief Opens the employee dialog
+ */
+void MainWindow::openEmployeeDialog()
+{
+    // Reload the employees, so the survey counts and last surveys in the summary are current.
+    refreshFromDatabase();
+
+    EmployeeDialog *employeeDialog(new EmployeeDialog(surveyDb.getEmployeeModel()));
+
+    connect(employeeDialog, &EmployeeDialog::addEmployee, this, &MainWindow::addEmployee);
+    connect(employeeDialog, &EmployeeDialog::removeEmployees, this, &MainWindow::removeEmployees);
+    connect(employeeDialog, &EmployeeDialog::mergeEmployees, this, &MainWindow::mergeEmployees);
+    connect(employeeDialog, &EmployeeDialog::renameEmployeesFromFile, this, &MainWindow::renameEmployeesFromFile);
+    connect(employeeDialog, &EmployeeDialog::editEmployee, this, &MainWindow::editEmployee);
+
+    employeeDialog->setAttribute(Qt::WA_DeleteOnClose);
+    employeeDialog->open();
+}
+
+/*!
+ * \brief Opens the list of company-wide temperature alerts of the last 30 days.
+ */
+void MainWindow::openAlertsDialog()
+{
+    AlertsDialog *alertsDialog(new AlertsDialog(surveyDb.getTemperatureAlerts(QDate::currentDate().addDays(-30)), this));
+
+    alertsDialog->setAttribute(Qt::WA_DeleteOnClose);
+    alertsDialog->open();
+}
+
+/*!
+ * \brief Opens the list of workdays on which employees did not submit a survey.
+ */
+void MainWindow::openComplianceDialog()
+{
+    ComplianceDialog *complianceDialog(new ComplianceDialog(&surveyDb, this));
+
+    complianceDialog->setAttribute(Qt::WA_DeleteOnClose);
+    complianceDialog->open();
+}
+
+/*!
+ * \brief Opens the side by side comparison of the daily surveys of a team.
+ */
+void MainWindow::openTeamDialog()
+{
+    TeamDialog *teamDialog(new TeamDialog(&surveyDb, this));
+
+    teamDialog->setAttribute(Qt::WA_DeleteOnClose);
+    teamDialog->open();
+}
+
+/*!
+ * \brief Adds the new data as a new survey in the database.
+ * \param newSurvey = The new survey to be added
+ * \note This will automatically update the survey table if successful.
+ */
+void MainWindow::addSurvey(const Survey &newSurvey)
+{
+    TraceSpan span("MainWindow::addSurvey");
+
+    // The confirmation is shown from the event loop, so the trace ends with the repaint instead of the message box.
+    runWrite([this, newSurvey]() { return surveyDb.addSurvey(newSurvey); },
+             [this]() {
+                 updateSurveyTableModel();
+                 QTimer::singleShot(0, this, [this]() {
+                     QMessageBox::information(this, tr("Success"), tr("The new survey has been successfully added."));
+                 });
+             },
+             tr("An unexpected error has ocurred while adding the new survey."));
+}
+
+/*!
+ * \brief Removes the survey that contains the given date and employee ID.
+ * \param date = The survey date
+ * \param empId = The employee's ID
+ * \note This does not generate a confirmation message. It only generates an error message if the action failed.
+ */
+void MainWindow::removeSurvey(const QDate &date, const int &empId)
+{
+    runWrite([this, date, empId]() { return surveyDb.removeSurvey(date, empId); },
+             [this]() { updateSurveyTableModel(); },
+             tr("An unexpected error has ocurred while removing the survey."));
+}
+
+/*!
+ * \brief Edits an existing survey in the database.
+ * \param survey = The survey data to be updated into the database
+ * \note This will automatically update the survey table if successful.
+ */
+void MainWindow::editSurvey(const Survey &survey)
+{
+    runWrite([this, survey]() { return surveyDb.editSurvey(survey); },
+             [this]() {
+                 updateSurveyTableModel();
+                 QMessageBox::information(this, tr("Success"), tr("The survey has been successfully updated."));
+             },
+             tr("An unexpected error has ocurred while updating the survey."));
+}
+
+/*!
+ * \brief Asks the user for a file and exports all surveys to it in the background.
+ * \note The format is chosen by the selected file type: CSV, JSON lines or the columnar binary format.
+ */
+void MainWindow::exportSurveys()
+{
+    if (exportThread != nullptr) {
+        QMessageBox::information(this, tr("Busy"), tr("The surveys are already being exported."));
+        return;
+    }
+
+    const QString csvFilter(tr("CSV files (*.csv)"));
+    const QString jsonFilter(tr("JSON lines (*.jsonl)"));
+    const QString columnarFilter(tr("Columnar binary (*.ccqc)"));
+
+    QString selectedFilter(csvFilter);
+    QString fileName(QFileDialog::getSaveFileName(this, tr("Export Surveys"), "",
+                                                  csvFilter + ";;" + jsonFilter + ";;" + columnarFilter,
+                                                  &selectedFilter));
+
+    if (fileName.isEmpty())
+        return;
+
+    ExportFormat format(ExportFormat::Csv);
+
+    if (selectedFilter == jsonFilter)
+        format = ExportFormat::JsonLines;
+    else if (selectedFilter == columnarFilter)
+        format = ExportFormat::Columnar;
+
+    QString location(surveyDb.getDatabaseLocation());
+
+    // The exporter reads the database on a connection of its own, so the window keeps handling user input.
+    exportThread = QThread::create([this, location, fileName, format]() {
+        SurveyExporter exporter(location);
+        bool exported(exporter.exportSurveys(fileName, format));
+        qint64 rows(exporter.getRowsExported());
+        QString error(exporter.getLastError());
+
+        QMetaObject::invokeMethod(this, [this, exported, rows, error]() {
+            exportThread->wait();
+            delete exportThread;
+            exportThread = nullptr;
+
+            ui->actionExportSurveys->setEnabled(true);
+            ui->statusbar->clearMessage();
+
+            if (exported)
+                QMessageBox::information(this, tr("Success"), QString::number(rows) + " " + tr("surveys have been exported."));
+            else
+                QMessageBox::critical(this, tr("Error"), tr("An unexpected error has ocurred while exporting the surveys:") + "\n" + error);
+        }, Qt::QueuedConnection);
+    });
+
+    ui->actionExportSurveys->setEnabled(false);
+    ui->statusbar->showMessage(tr("Exporting surveys..."));
+    exportThread->start(QThread::LowPriority);
+}
+
+/*!
+ * \brief Asks the user for survey files exported by other sites and imports them in the background.
+ * \note The employees are matched by name, employees that do not exist yet are added.
+ */
+void MainWindow::importSurveys()
+{
+    if (surveyImporter.isRunning()) {
+        QMessageBox::information(this, tr("Busy"), tr("Surveys are already being imported."));
+        return;
+    }
+
+    const QStringList fileNames(QFileDialog::getOpenFileNames(this, tr("Import Surveys"), "",
+                                                              tr("Survey exports (*.csv *.jsonl)")));
+
+    if (fileNames.isEmpty())
+        return;
+
+    if (surveyImporter.start(fileNames, surveyDb.getDatabaseLocation(), surveyDb.getDurabilityProfile()))
+        ui->actionImportSurveys->setEnabled(false);
+}
+
+/*!
+ * \brief Shows the progress of a running import in the status bar.
+ * \param progress = The current progress of the import
+ */
+void MainWindow::importProgress(const ImportProgress &progress)
+{
+    double rate(progress.elapsedSec > 0 ? (progress.recordsWritten + progress.recordsSkipped) / progress.elapsedSec : 0);
+
+    ui->statusbar->showMessage(tr("Importing surveys...") + " " +
+                               QString::number(progress.filesDone) + "/" + QString::number(progress.filesTotal) + " " + tr("files,") + " " +
+                               QString::number(progress.recordsParsed) + " " + tr("parsed,") + " " +
+                               QString::number(progress.recordsWritten) + " " + tr("written") +
+                               " (" + QString::number(rate, 'f', 0) + "/s), " +
+                               QString::number(progress.recordsQueued) + " " + tr("queued"));
+}
+
+/*!
+ * \brief Shows the results of an import and the surveys it added.
+ * \param progress = The final progress of the import
+ */
+void MainWindow::importFinished(const ImportProgress &progress)
+{
+    ui->actionImportSurveys->setEnabled(true);
+    ui->statusbar->clearMessage();
+    refreshFromDatabase();
+
+    if (progress.errors.isEmpty())
+        QMessageBox::information(this, tr("Import Complete"), SurveyImporter::formatReport(progress));
+    else
+        QMessageBox::warning(this, tr("Import Incomplete"), SurveyImporter::formatReport(progress));
+}
+
+/*!
+ * \brief Shows the query plan of every statement the database has run and offers to create the suggested indexes.
+ */
+void MainWindow::showQueryPlanReport()
+{
+    QList<QueryPlan> plans(surveyDb.inspectQueryPlans());
+    QStringList suggestions;
+    int issues(0);
+
+    for (const QueryPlan &plan : plans) {
+        if (plan.hasIssues())
+            ++issues;
+
+        if (!plan.suggestedIndex.isEmpty() && !suggestions.contains(plan.suggestedIndex))
+            suggestions.append(plan.suggestedIndex);
+    }
+
+    QMessageBox reportBox(this);
+    reportBox.setWindowTitle(tr("Query Plan Report"));
+    reportBox.setText(QString::number(plans.size()) + " " + tr("statements inspected,") + " " +
+                      QString::number(issues) + " " + tr("with full table scans or temporary sorts."));
+    reportBox.setDetailedText(QueryPlanInspector::formatReport(plans));
+    reportBox.addButton(QMessageBox::Close);
+
+    QPushButton *createButton(nullptr);
+
+    if (!suggestions.isEmpty())
+        createButton = reportBox.addButton(tr("Create Suggested Indexes"), QMessageBox::ActionRole);
+
+    reportBox.exec();
+
+    if (createButton != nullptr && reportBox.clickedButton() == createButton) {
+        int created(0);
+
+        for (const QString &suggestion : suggestions) {
+            if (surveyDb.createIndex(suggestion))
+                ++created;
+        }
+
+        QMessageBox::information(this, tr("Query Plan Report"), QString::number(created) + " " + tr("of") + " " +
+                                 QString::number(suggestions.size()) + " " + tr("suggested indexes have been created."));
+    }
+}
+
+/*!
+ * \brief Asks the user for a new question and adds it to the survey.
+ * \note The question is asked in every new survey. Older surveys show "No" for it.
+ */
+void MainWindow::addQuestion()
+{
+    if (surveyDb.getQuestionSet().getFreeBit() < 0) {
+        QMessageBox::warning(this, tr("Add Question"), tr("The survey already has the maximum of") + " " +
+                             QString::number(QuestionSet::MaxQuestions) + " " + tr("questions."));
+        return;
+    }
+
+    bool ok;
+    QString text(QInputDialog::getMultiLineText(this, tr("Add Question"), tr("Question:"), "", &ok));
+
+    if (ok && !text.trimmed().isEmpty()) {
+        runWrite([this, text]() { return surveyDb.addQuestion(text); },
+                 [this]() { updateSurveyTableModel(); },
+                 tr("An unexpected error has ocurred when adding the question."));
+    }
+}
+
+/*!
+ * \brief Asks the user which question should no longer be asked and retires it.
+ * \note The answers already given to the question are kept.
+ */
+void MainWindow::retireQuestion()
+{
+    const QList<Question> questions(surveyDb.getQuestionSet().getActiveQuestions());
+    QStringList items;
+
+    for (const Question &question : questions)
+        items.append(QString::number(question.bit + 1) + ". " + QuestionSet::getPlainText(question.text).left(80));
+
+    if (items.isEmpty())
+        return;
+
+    bool ok;
+    QString item(QInputDialog::getItem(this, tr("Retire Question"), tr("Question to stop asking:"), items, 0, false, &ok));
+
+    if (ok) {
+        int bit(questions[items.indexOf(item)].bit);
+
+        runWrite([this, bit]() { return surveyDb.setQuestionActive(bit, false); },
+                 [this]() { updateSurveyTableModel(); },
+                 tr("An unexpected error has ocurred when retiring the question."));
+    }
+}
+
+/*!
+ * \brief Shows how long this workstation waited for other workstations sharing the database file.
+ */
+void MainWindow::showDatabaseStatistics()
+{
+    ContentionStats stats(surveyDb.getContentionStats());
+    PageCacheStats cacheStats(surveyDb.getPageCacheStats());
+    double averageWaitMs(stats.writeTransactions + stats.failedWrites > 0
+                         ? stats.totalLockWaitMs / (stats.writeTransactions + stats.failedWrites) : 0);
+
+    QMessageBox::information(this, tr("Database Statistics"),
+                             tr("Durability profile:") + " " + surveyDb.getDurabilityProfile().name + "\n" +
+                             tr("Journal mode:") + " " + surveyDb.getJournalMode() + "\n" +
+                             tr("Write transactions:") + " " + QString::number(stats.writeTransactions) + "\n" +
+                             tr("Retries while locked:") + " " + QString::number(stats.busyRetries) + "\n" +
+                             tr("Failed while locked:") + " " + QString::number(stats.failedWrites) + "\n" +
+                             tr("Average lock wait:") + " " + QString::number(averageWaitMs, 'f', 1) + " ms\n" +
+                             tr("Longest lock wait:") + " " + QString::number(stats.maxLockWaitMs, 'f', 1) + " ms\n" +
+                             tr("Survey page cache:") + " " + QString::number(cacheStats.pages) + " " + tr("employees") + ", " +
+                             QLocale().formattedDataSize(cacheStats.bytes) + " / " + QLocale().formattedDataSize(cacheStats.maxBytes) + "\n" +
+                             tr("Cache hit rate:") + " " + QString::number(cacheStats.getHitRate() * 100, 'f', 1) + "% (" +
+                             QString::number(cacheStats.hits) + " " + tr("hits") + ", " +
+                             QString::number(cacheStats.misses) + " " + tr("misses") + ", " +
+                             QString::number(cacheStats.prefetches) + " " + tr("prefetched") + ")");
+}
+
+/*!
+ * \brief Asks the user for a file name and writes the recorded trace to it in the Chrome trace format.
+ * \note The file can be opened in chrome://tracing or ui.perfetto.dev.
+ */
+void MainWindow::saveTrace()
+{
+    if (Tracer::getEventCount() == 0) {
+        QMessageBox::information(this, tr("Save Trace"), tr("No trace has been recorded. Enable Tools > Record Trace first."));
+        return;
+    }
+
+    QString fileName(QFileDialog::getSaveFileName(this, tr("Save Trace"), "ccq-trace.json", tr("Trace files (*.json)")));
+
+    if (fileName.isEmpty())
+        return;
+
+    if (Tracer::writeChromeTrace(fileName))
+        ui->statusbar->showMessage(QString::number(Tracer::getEventCount()) + " " + tr("trace events saved."), 5000);
+    else
+        QMessageBox::critical(this, tr("Error"), tr("The trace could not be written to") + " " + fileName);
+}
+
+/*!
+ * \brief Marks every repaint of the survey table in the trace, as the end of a user action.
+ * \param watched = The object the event is sent to
+ * \param event = The event
+ * \return A boolean value that is always false, the event is never filtered out.
+ */
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Paint && watched == ui->tableSurveys->viewport())
+        Tracer::instant("tableSurveys paint");
+
+    return QMainWindow::eventFilter(watched, event);
+}
+
+/*!
+ * \brief Shows the company-wide median, 95th and 99th percentile temperature of today, the last week and the last month.
+ */
+void MainWindow::showTemperaturePercentiles()
+{
+    const QDate today(QDate::currentDate());
+    const QList<QPair<QString, int>> periods({{tr("Today"), 1}, {tr("Last 7 days"), 7}, {tr("Last 30 days"), 30}});
+    QString text;
+
+    for (const QPair<QString, int> &period : periods) {
+        TemperatureSketch sketch(surveyDb.getTemperatureSketch(today.addDays(1 - period.second), today));
+
+        text += period.first + ": ";
+
+        if (sketch.getCount() == 0) {
+            text += tr("no readings") + "\n";
+            continue;
+        }
+
+        text += tr("median") + " " + QString::number(sketch.getPercentile(50), 'f', 1) + " °C, " +
+                tr("95th") + " " + QString::number(sketch.getPercentile(95), 'f', 1) + " °C, " +
+                tr("99th") + " " + QString::number(sketch.getPercentile(99), 'f', 1) + " °C (" +
+                QString::number(sketch.getCount()) + " " + tr("readings") + ")\n";
+    }
+
+    text += "\n" + tr("Percentiles are accurate to %1 °C between %2 °C and %3 °C.")
+            .arg(TemperatureSketch::MaxError, 0, 'f', 2)
+            .arg(TemperatureSketch::MinTemperature, 0, 'f', 1)
+            .arg(TemperatureSketch::MaxTemperature, 0, 'f', 1);
+
+    QMessageBox::information(this, tr("Temperature Percentiles"), text);
+}
+
+/*!
+ * \brief Asks the user which durability profile the database should be opened with from the next start on.
+ * \note The choice is stored in the settings. The --profile command line option overrides it.
+ */
+void MainWindow::selectDurabilityProfile()
+{
+    const QStringList names(DurabilityProfile::getNames());
+    QSettings settings;
+
+    bool ok;
+    QString name(QInputDialog::getItem(this, tr("Durability Profile"),
+                                       tr("Open the database with this profile from the next start on:"),
+                                       names, names.indexOf(surveyDb.getDurabilityProfile().name), false, &ok));
+
+    if (!ok)
+        return;
+
+    settings.setValue("database/profile", name);
+    ui->statusbar->showMessage(tr("The durability profile is used after a restart."), 5000);
+}
+
+/*!
+ * \brief Shows the site and department whose employees are shown in the window title.
+ */
+void MainWindow::showPartition()
+{
+    Partition partition(surveyDb.getPartition());
+    QStringList names;
+
+    if (partition.siteId >= 0)
+        names.append(surveyDb.getSites().value(partition.siteId));
+
+    if (partition.deptId >= 0)
+        names.append(surveyDb.getDepartments().value(partition.deptId));
+
+    setWindowTitle(names.isEmpty() ? tr("CCQ - Company Covid Query") : tr("CCQ - Company Covid Query") + " - " + names.join(" / "));
+}
+
+/*!
+ * \brief Lets the user pick a site or department by name.
+ * \param title = The title of the input dialog
+ * \param label = The text shown above the names
+ * \param names = The name of every site or department by ID
+ * \param noneItem = The first item, which stands for no site or department (or all of them)
+ * \param current = The ID of the site or department that is picked at first, or -1 for noneItem
+ * \param editable = Can the user type a name that is not in the list?
+ * \param ok = Receives whether the user picked a name or cancelled
+ * \return The picked name, or noneItem.
+ */
+QString MainWindow::pickPartitionName(const QString &title, const QString &label, const QMap<int, QString> &names,
+                                      const QString &noneItem, const int &current, const bool &editable, bool &ok)
+{
+    QStringList items(names.values());
+
+    items.sort(Qt::CaseInsensitive);
+    items.prepend(noneItem);
+
+    int index(names.contains(current) ? static_cast<int>(items.indexOf(names.value(current))) : 0);
+
+    return QInputDialog::getItem(this, title, label, items, index, editable, &ok).simplified();
+}
+
+/*!
+ * \brief Shows an error message for a failed database operation, with the reason if the database reported one.
+ * \param message = The description of the operation that failed
+ */
+void MainWindow::showDatabaseError(const QString &message)
+{
+    QString reason(surveyDb.getLastError());
+
+    QMessageBox::critical(this, tr("Error"), reason.isEmpty() ? message : message + "\n\n" + reason);
+}
+
+/*!
+ * \brief Writes to the database, and tries again from the event loop while another workstation holds the write lock.
+ * \param write = Writes to surveyDb and returns whether it succeeded
+ * \param done = Is called once the write succeeded, which may be after this function returned
+ * \param errorMessage = The description of the write, shown if it failed for another reason or kept finding the lock taken
+ * \param attempt = The number of this attempt, starting at 1
+ * \note The main thread only waits briefly for the lock, so the window stays responsive while it waits between attempts.
+ */
+void MainWindow::runWrite(const std::function<bool ()> &write, const std::function<void ()> &done, const QString &errorMessage,
+                          const int &attempt)
+{
+    if (write()) {
+        if (attempt > 1)
+            ui->statusbar->clearMessage();
+
+        done();
+        return;
+    }
+
+    if (surveyDb.isLockBusy() && attempt < MaxWriteAttempts) {
+        ui->statusbar->showMessage(tr("Waiting for another workstation to finish writing..."));
+        QTimer::singleShot(WriteRetryInterval, this, [this, write, done, errorMessage, attempt]() {
+            runWrite(write, done, errorMessage, attempt + 1);
+        });
+        return;
+    }
+
+    if (attempt > 1)
+        ui->statusbar->clearMessage();
+
+    showDatabaseError(errorMessage);
+}
+
+/*!
+ * \brief Asks the user how many days surveys should be kept and starts purging all older surveys.
+ * \note The surveys are purged in small batches in the background, so the application stays usable.
+ */
+void MainWindow::purgeOldSurveys()
+{
+    if (retentionJob.isRunning()) {
+        QMessageBox::information(this, tr("Busy"), tr("Old surveys are already being purged."));
+        return;
+    }
+
+    if (retentionJob.isCompacting()) {
+        QMessageBox::information(this, tr("Busy"), tr("The database is being compacted."));
+        return;
+    }
+
+    bool ok;
+    int retentionDays(QInputDialog::getInt(this, tr("Purge Old Surveys"),
+                                           tr("Delete all surveys older than this amount of days:"),
+                                           90, 0, 36500, 1, &ok));
+
+    if (ok) {
+        if (QMessageBox::question(this, tr("Purge Old Surveys"),
+                                  tr("Are you sure you wish to delete all surveys older than") + " " +
+                                  QString::number(retentionDays) + " " + tr("days?")) == QMessageBox::Yes) {
+            if (retentionJob.start(retentionDays))
+                ui->actionPurgeSurveys->setEnabled(false);
+            else
+                showDatabaseError(tr("An unexpected error has ocurred while starting the purge."));
+        }
+    }
+}
+
+/*!
+ * \brief Starts a backup of the database in the background.
+ */
+void MainWindow::backUpNow()
+{
+    if (surveyDb.getBackup()->isRunning()) {
+        QMessageBox::information(this, tr("Busy"), tr("The database is already being backed up."));
+        return;
+    }
+
+    if (surveyDb.getBackup()->start())
+        ui->actionBackUpNow->setEnabled(false);
+    else
+        showDatabaseError(tr("An unexpected error has ocurred while preparing the backup."));
+}
+
+/*!
+ * \brief Reports the result of a backup in the status bar.
+ * \param report = The results of the backup
+ * \note A failed backup is also reported with a message box, as the database is then not backed up.
+ */
+void MainWindow::backupFinished(const BackupReport &report)
+{
+    ui->actionBackUpNow->setEnabled(true);
+
+    if (!report.error.isEmpty()) {
+        ui->statusbar->clearMessage();
+        QMessageBox::warning(this, tr("Backup Failed"), tr("The database could not be backed up.") + "\n" + report.error);
+        return;
+    }
+
+    ui->statusbar->showMessage(tr("Database backed up to") + " " + report.fileName + " (" +
+                               QLocale().formattedDataSize(report.bytes) + ", " + tr("longest step") + " " +
+                               QString::number(report.maxStepMs, 'f', 1) + " ms)", 10000);
+}
+
+/*!
+ * \brief Displays the results of the retention job and updates the survey table.
+ * \param report = The totals reported by the retention job
+ * \note If the database does not use incremental auto vacuum, the user is offered to compact it once. That rebuild locks
+ * the database until it is done, so it only runs when the user confirms it. It runs in the background, so the window
+ * stays responsive in the meantime.
+ */
+void MainWindow::retentionFinished(const RetentionReport &report)
+{
+    ui->actionPurgeSurveys->setEnabled(true);
+    ui->statusbar->clearMessage();
+    updateSurveyTableModel();
+
+    QString summary(tr("Surveys purged:") + " " + QString::number(report.rowsPurged) + "\n" +
+                    tr("Space reclaimed:") + " " + QString::number(report.bytesReclaimed / 1024.0, 'f', 1) + " KiB\n" +
+                    tr("Longest database lock:") + " " + QString::number(report.maxLockHoldMs, 'f', 1) + " ms");
+
+    if (!report.vacuumSkipped) {
+        QMessageBox::information(this, tr("Purge Complete"), summary);
+        return;
+    }
+
+    if (QMessageBox::question(this, tr("Purge Complete"),
+                              summary + "\n\n" +
+                              tr("The space of the purged surveys was kept for new surveys, as this database has to be compacted "
+                                 "once before it can be released. Compacting can take a while and the database cannot be used "
+                                 "until it is done.") + "\n\n" + tr("Do you wish to compact the database now?")) != QMessageBox::Yes)
+        return;
+
+    if (retentionJob.compact()) {
+        ui->actionPurgeSurveys->setEnabled(false);
+        ui->statusbar->showMessage(tr("Compacting the database..."));
+    } else
+        showDatabaseError(tr("An unexpected error has ocurred while compacting the database."));
+}
+
+/*!
+ * \brief Reports the result of compacting the database.
+ * \param success = Was the database compacted?
+ * \param error = Why the database could not be compacted, or empty if it was
+ */
+void MainWindow::compactionFinished(const bool &success, const QString &error)
+{
+    ui->actionPurgeSurveys->setEnabled(true);
+    ui->statusbar->clearMessage();
+
+    if (success) {
+        ui->statusbar->showMessage(tr("Database compacted."), 10000);
+        return;
+    }
+
+    QString message(tr("An unexpected error has ocurred while compacting the database."));
+
+    QMessageBox::critical(this, tr("Error"), error.isEmpty() ? message : message + "\n\n" + error);
+}
+
+/*!
+ * \brief The function executed when clicking the Add Survey button.
+ * This function will call the openSurveyDialog() function.
+ */
+void MainWindow::on_btnAddSurvey_clicked()
+{
+    openSurveyDialog();
+}
+
+/*!
+ * \brief Create the context menu for the survey table.
+ */
+void MainWindow::setupSurveyTableContextMenu()
+{
+    // Use tableSurveys' actions as context menu items.
+    ui->tableSurveys->setContextMenuPolicy(Qt::CustomContextMenu);
+
+    QAction* editAction(new QAction("Edit", this));
+    connect(editAction, &QAction::triggered, [this]() {
+        openSurveyDialog(getCurrentSurvey());
+    });
+
+    QAction* deleteAction(new QAction("Delete", this));
+    connect(deleteAction, &QAction::triggered, [this]() {
+        if (QMessageBox::question(this, "Delete survey?",
+                                  "Are you sure you wish to delete this survey?") == QMessageBox::Yes)
+        {
+            removeSurvey(getCurrentSurveyDate(), getCurrentEmployeeId());
+        }
+    });
+
+    contextMenu->addAction(editAction);
+    contextMenu->addAction(deleteAction);
+
+    connect(ui->tableSurveys, &QWidget::customContextMenuRequested, this, &MainWindow::contextMenuRequested);
+}
+
+/*!
+ * \brief Reads the surveys of the employees before and after the selected one in the Employee ComboBox into the page cache.
+ */
+void MainWindow::prefetchNeighbourPages()
+{
+    QAbstractItemModel *employees(ui->comboEmployee->model());
+    int row(ui->comboEmployee->currentIndex());
+    QList<int> empIds;
+
+    for (int neighbour : {row - 1, row + 1}) {
+        if (neighbour >= 0 && neighbour < employees->rowCount())
+            empIds.append(employees->data(employees->index(neighbour, EmployeeTableColumns::ID), Qt::EditRole).toInt());
+    }
+
+    surveyDb.prefetchSurveyPages(empIds);
+}
+
+/*!
+ * \brief Retrieves the ID of the employee currently selected in the employee combobox.
+ * \return An integer with the employee's ID
+ */
+int MainWindow::getCurrentEmployeeId() const
+{
+    int row(ui->comboEmployee->currentIndex());
+    QModelIndex index(ui->comboEmployee->model()->index(row, EmployeeTableColumns::ID));
+    QVariant id(ui->comboEmployee->model()->data(index));
+
+    return id.toInt();
+}
+
+/*!
+ * \brief Retrieves the currently selected survey from the table.
+ * \return A Survey object with the survey values.
+ */
+Survey MainWindow::getCurrentSurvey()
+{
+    QModelIndexList indexList(ui->tableSurveys->selectionModel()->selectedRows());
+
+    // Retrieve the first row in the list.
+    // Only one selected row should be allowed.
+    QModelIndex index(indexList[0]);
+
+    // Retrieve all values of the survey from the survey model.
+    return surveyDb.getSurveyModel()->getSurvey(index.row(), getCurrentEmployeeId());
+}
+
+/*!
+ * \brief Retrieves the currently selected survey's date from the table.
+ * \return A QDate with the survey date.
+ */
+QDate MainWindow::getCurrentSurveyDate()
+{
+    QModelIndexList indexList(ui->tableSurveys->selectionModel()->selectedRows());
+
+    // Retrieve the first row in the list.
+    // Only one selected row should be allowed.
+    QModelIndex index(indexList[0]);
+
+    return surveyDb.getSurveyModel()->getSurveyDate(index.row());
+}
+
+void MainWindow::contextMenuRequested(const QPoint &pos)
+{
+    if (ui->tableSurveys->indexAt(pos).row() > -1)
+        contextMenu->popup(ui->tableSurveys->viewport()->mapToGlobal(pos));
+}
+
@@ -3,14 +3,24 @@
 
 #include "../objects/surveydatabase.h"
 #include "../objects/survey.h"
+#include "../objects/retentionjob.h"
+#include "../objects/ingestionserver.h"
+#include "../objects/surveyimporter.h"
 
 #include <QMainWindow>
+#include <QElapsedTimer>
+
+#include <functional>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
 class QMenu;
+class QLabel;
+class QProgressBar;
+class QThread;
+class TemperatureChart;
 
 /*!
  * \brief The main window to be used in the application.
@@ -20,22 +30,53 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    MainWindow(QWidget *parent = nullptr, const DurabilityProfile &profile = DurabilityProfile::balanced());
     ~MainWindow();
 
+    bool startIngestionServer(const quint16 &port, const QHostAddress &address, const QString &token);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 public slots:
     void updateEmployeeComboBox();
     void updateSurveyTableModel();
+    void showSurveyLoadProgress(const int &loaded, const int &total);
+    void surveysLoaded();
     void addEmployee();
-    void removeEmployee(const int &empId);
+    void removeEmployees(const QList<int> &empIds);
+    void mergeEmployees(const int &keepId, const QList<int> &duplicateIds);
+    void renameEmployeesFromFile();
     void editEmployee(const int &empId, const QString &currentName);
     void openSurveyDialog(const Survey &newSurvey = Survey());
     void openEmployeeDialog();
+    void selectPartition();
+    void moveEmployee();
+    void openAlertsDialog();
+    void openComplianceDialog();
+    void openTeamDialog();
+    void updateChart();
     void addSurvey(const Survey &newSurvey);
     void removeSurvey(const QDate &date,
                       const int &empId);
     void editSurvey(const Survey &survey);
-
+    void exportSurveys();
+    void importSurveys();
+    void importProgress(const ImportProgress &progress);
+    void importFinished(const ImportProgress &progress);
+    void showQueryPlanReport();
+    void addQuestion();
+    void retireQuestion();
+    void showDatabaseStatistics();
+    void showTemperaturePercentiles();
+    void selectDurabilityProfile();
+    void saveTrace();
+    void refreshFromDatabase();
+    void purgeOldSurveys();
+    void retentionFinished(const RetentionReport &report);
+    void compactionFinished(const bool &success, const QString &error);
+    void backUpNow();
+    void backupFinished(const BackupReport &report);
 
 private slots:
     void on_btnAddSurvey_clicked();
@@ -43,12 +84,28 @@ private slots:
 private:
     Ui::MainWindow *ui;         ///< The reference to the UI of the MainWindow.
     SurveyDatabase surveyDb;    ///< The database variable that stores the survey data.
+    RetentionJob retentionJob;  ///< The job that purges expired surveys from surveyDb.
+    IngestionServer ingestionServer; ///< The optional server through which entry tablets submit surveys.
+    SurveyImporter surveyImporter;  ///< Imports the survey files of other sites in the background.
     QMenu *contextMenu;
+    QLabel *modelInfoLabel;     ///< Shows the amount of surveys loaded and the memory used by the survey model.
+    TemperatureChart *temperatureChart; ///< Draws the downsampled temperatures of the employee or the whole company.
+    bool prefetchPages;         ///< Should the surveys of the employees next to the selected one be read ahead of time?
+    QProgressBar *loadProgress; ///< Shows the progress of a long survey load.
+    QElapsedTimer loadTimer;    ///< Measures the time since the survey load started.
+    QThread *exportThread;      ///< The thread of the running export, or nullptr if none is running.
 
     void setupSurveyTableContextMenu();
+    void prefetchNeighbourPages();
     int getCurrentEmployeeId() const;
     Survey getCurrentSurvey();
     QDate getCurrentSurveyDate();
     void contextMenuRequested(const QPoint &pos);
+    void showDatabaseError(const QString &message);
+    void runWrite(const std::function<bool ()> &write, const std::function<void ()> &done, const QString &errorMessage,
+                  const int &attempt = 1);
+    void showPartition();
+    QString pickPartitionName(const QString &title, const QString &label, const QMap<int, QString> &names,
+                              const QString &noneItem, const int &current, const bool &editable, bool &ok);
 };
 #endif // MAINWINDOW_H
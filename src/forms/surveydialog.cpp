@@ -1,32 +1,35 @@
 #include "surveydialog.h"
 #include "ui_surveydialog.h"
+#include "../objects/tracer.h"
 
 #include <QPushButton>
 #include <QButtonGroup>
 #include <QMessageBox>
+#include <QRadioButton>
+#include <QLabel>
+#include <QFrame>
+#include <QHBoxLayout>
 
 /*!
  * \brief The constructor for the SurveyDialog.
+ * \param emp = The ID of the employee to which the survey belongs
+ * \param questions = The questions of the survey, only the active ones are asked
  * \param parent = The QWidget to which this dialog is bound to.
+ * \param editSurvey = The survey to edit, or an invalid survey to add a new one
  */
-SurveyDialog::SurveyDialog(const int& emp, QWidget *parent, const Survey &editSurvey) :
+SurveyDialog::SurveyDialog(const int& emp, const QuestionSet &questions, QWidget *parent, const Survey &editSurvey) :
     QDialog(parent),
     ui(new Ui::SurveyDialog),
     empId(emp),
-    rbgroupQOne(new QButtonGroup(this)),
-    rbgroupQTwo(new QButtonGroup(this)),
-    rbgroupQThree(new QButtonGroup(this)),
+    answerGroups(),
+    questionBits(),
+    retiredAnswers(editSurvey.getAnswers() & ~questions.getActiveMask()),
     editMode(false)
 {
     ui->setupUi(this);
 
-    // Add all the "Yes" and "No" radio buttons to their respective button groups.
-    rbgroupQOne->addButton(ui->rbQOneYes);
-    rbgroupQOne->addButton(ui->rbQOneNo);
-    rbgroupQTwo->addButton(ui->rbQTwoYes);
-    rbgroupQTwo->addButton(ui->rbQTwoNo);
-    rbgroupQThree->addButton(ui->rbQThreeYes);
-    rbgroupQThree->addButton(ui->rbQThreeNo);
+    // Add a row with "Yes" and "No" radio buttons for every question.
+    setupQuestions(questions);
 
     // If a survey is about to be edited instead...
     if (editSurvey.isValid())
@@ -49,11 +52,12 @@ SurveyDialog::~SurveyDialog()
  */
 void SurveyDialog::questionAnswered()
 {
-    if (rbgroupQOne->checkedButton() != nullptr &&
-            rbgroupQTwo->checkedButton() != nullptr &&
-            rbgroupQThree->checkedButton() != nullptr) {
-        ui->buttonBox->button(QDialogButtonBox::Ok)->setDisabled(false);
+    for (const QButtonGroup *group : answerGroups) {
+        if (group->checkedButton() == nullptr)
+            return;
     }
+
+    ui->buttonBox->button(QDialogButtonBox::Ok)->setDisabled(false);
 }
 
 /*!
@@ -80,15 +84,64 @@ void SurveyDialog::answerChanged()
         ui->buttonBox->button(QDialogButtonBox::Ok)->setDisabled(false);
 }
 
+/*!
+ * \brief Adds a row with the text and the "Yes" and "No" radio buttons of every active question.
+ * \param questions = The questions of the survey
+ */
+void SurveyDialog::setupQuestions(const QuestionSet &questions)
+{
+    const QList<Question> activeQuestions(questions.getActiveQuestions());
+
+    for (int i = 0; i < activeQuestions.size(); ++i) {
+        const Question &question(activeQuestions[i]);
+
+        if (i > 0) {
+            QFrame *line(new QFrame(ui->widgetQuestions));
+            line->setFrameShape(QFrame::HLine);
+            line->setFrameShadow(QFrame::Sunken);
+            ui->layoutQuestions->addWidget(line);
+        }
+
+        // Questions are numbered by their bit, the same as in the survey table.
+        QLabel *lblQuestion(new QLabel("<p><span style=\" font-size:12pt; font-weight:600; text-decoration: underline;\">" +
+                                       tr("Question") + " " + QString::number(question.bit + 1) + "</span></p>" +
+                                       question.text, ui->widgetQuestions));
+        lblQuestion->setTextFormat(Qt::RichText);
+        lblQuestion->setWordWrap(true);
+
+        QFrame *separator(new QFrame(ui->widgetQuestions));
+        separator->setFrameShape(QFrame::VLine);
+        separator->setFrameShadow(QFrame::Sunken);
+
+        QRadioButton *rbYes(new QRadioButton(tr("Yes"), ui->widgetQuestions));
+        QRadioButton *rbNo(new QRadioButton(tr("No"), ui->widgetQuestions));
+        QButtonGroup *group(new QButtonGroup(this));
+
+        group->addButton(rbYes, 1);
+        group->addButton(rbNo, 0);
+
+        QHBoxLayout *row(new QHBoxLayout());
+        row->addWidget(lblQuestion, 1);
+        row->addWidget(separator);
+        row->addWidget(rbYes);
+        row->addWidget(rbNo);
+        ui->layoutQuestions->addLayout(row);
+
+        answerGroups.append(group);
+        questionBits.append(question.bit);
+    }
+
+    ui->layoutQuestions->addStretch();
+}
+
 /*!
  * \brief Setup all UI elements for adding a new survey.
  */
 void SurveyDialog::setupAddMode()
 {
     // Connect the "toggled" signals of all button groups with the questionAnswered() function.
-    connect(rbgroupQOne.get(), &QButtonGroup::buttonToggled, this, &SurveyDialog::questionAnswered);
-    connect(rbgroupQTwo.get(), &QButtonGroup::buttonToggled, this, &SurveyDialog::questionAnswered);
-    connect(rbgroupQThree.get(), &QButtonGroup::buttonToggled, this, &SurveyDialog::questionAnswered);
+    for (QButtonGroup *group : answerGroups)
+        connect(group, &QButtonGroup::buttonToggled, this, &SurveyDialog::questionAnswered);
 
     // Set the default date to today and give the date edit a calendar popup.
     ui->cbTodayDate->setCheckState(Qt::CheckState::Checked);
@@ -97,6 +150,9 @@ void SurveyDialog::setupAddMode()
     // Set the "OK" button text to "Add" and disable it.
     ui->buttonBox->button(QDialogButtonBox::Ok)->setText("Add");
     ui->buttonBox->button(QDialogButtonBox::Ok)->setDisabled(true);
+
+    // Enables the button right away if there are no questions to answer.
+    questionAnswered();
 }
 
 /*!
@@ -113,9 +169,8 @@ void SurveyDialog::setupEditMode(const Survey &editSurvey)
     ui->deSurveyDate->setDisabled(true);
 
     // Set all answers to "No" by default.
-    ui->rbQOneNo->setChecked(true);
-    ui->rbQTwoNo->setChecked(true);
-    ui->rbQThreeNo->setChecked(true);
+    for (QButtonGroup *group : answerGroups)
+        group->button(0)->setChecked(true);
 
     // Set the "OK" button text to "Add" and disable it.
     ui->buttonBox->button(QDialogButtonBox::Ok)->setText("Apply Changes");
@@ -123,15 +178,15 @@ void SurveyDialog::setupEditMode(const Survey &editSurvey)
 
     // Assign the answers of the survey to the UI.
     // NOTE: All answers MUST be set to "No" beforehand for this to work.
-    ui->rbQOneYes->setChecked(editSurvey.getQuestionOne());
-    ui->rbQTwoYes->setChecked(editSurvey.getQuestionTwo());
-    ui->rbQThreeYes->setChecked(editSurvey.getQuestionThree());
+    for (int i = 0; i < answerGroups.size(); ++i)
+        answerGroups[i]->button(1)->setChecked(editSurvey.getAnswer(questionBits[i]));
+
     ui->dspinTemp->setValue(editSurvey.getTemperature());
 
     // Connect the "toggled" and "valueChanged" signals of questions with the answerChanged() function.
-    connect(rbgroupQOne.get(), &QButtonGroup::buttonToggled, this, &SurveyDialog::answerChanged);
-    connect(rbgroupQTwo.get(), &QButtonGroup::buttonToggled, this, &SurveyDialog::answerChanged);
-    connect(rbgroupQThree.get(), &QButtonGroup::buttonToggled, this, &SurveyDialog::answerChanged);
+    for (QButtonGroup *group : answerGroups)
+        connect(group, &QButtonGroup::buttonToggled, this, &SurveyDialog::answerChanged);
+
     connect(ui->dspinTemp, &QDoubleSpinBox::valueChanged, this, &SurveyDialog::answerChanged);
 
     this->setWindowTitle(tr("Editing survey"));
@@ -144,12 +199,15 @@ void SurveyDialog::setupEditMode(const Survey &editSurvey)
  */
 void SurveyDialog::on_buttonBox_accepted()
 {
+    Tracer::instant("SurveyDialog::accepted");
+
     Survey survey(ui->deSurveyDate->date(),
-                     empId,
-                     rbgroupQOne->checkedButton()->text() == "Yes",
-                     rbgroupQTwo->checkedButton()->text() == "Yes",
-                     rbgroupQThree->checkedButton()->text() == "Yes",
-                     ui->dspinTemp->value());
+                  empId,
+                  retiredAnswers,
+                  ui->dspinTemp->value());
+
+    for (int i = 0; i < answerGroups.size(); ++i)
+        survey.setAnswer(questionBits[i], answerGroups[i]->checkedId() == 1);
 
     if (editMode)
         emit updateSurvey(survey);
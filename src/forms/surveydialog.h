@@ -2,10 +2,13 @@
 #define SURVEYDIALOG_H
 
 #include "../objects/survey.h"
+#include "../objects/questionset.h"
 
 #include <QDialog>
 #include <QAbstractButton>
 
+class QButtonGroup;
+
 namespace Ui {
 class SurveyDialog;
 }
@@ -18,7 +21,7 @@ class SurveyDialog : public QDialog
     Q_OBJECT
 
 public:
-    explicit SurveyDialog(const int& emp, QWidget *parent = nullptr, const Survey &editSurvey = Survey());
+    explicit SurveyDialog(const int& emp, const QuestionSet &questions, QWidget *parent = nullptr, const Survey &editSurvey = Survey());
     ~SurveyDialog();
 
 signals:
@@ -35,11 +38,12 @@ private slots:
 private:
     Ui::SurveyDialog *ui;   ///< The reference to the UI of the SurveyDialog.
     int empId; ///< The ID of the employee to which this survey belongs.
-    QSharedPointer<QButtonGroup> rbgroupQOne;   ///< The button group for the question 1 radio buttons.
-    QSharedPointer<QButtonGroup> rbgroupQTwo;   ///< The button group for the question 2 radio buttons.
-    QSharedPointer<QButtonGroup> rbgroupQThree; ///< The button group for the question 3 radio buttons.
+    QList<QButtonGroup *> answerGroups;     ///< The button group of the "Yes" (ID 1) and "No" (ID 0) radio buttons of every question.
+    QList<int> questionBits;    ///< The bit of the question of every button group.
+    quint32 retiredAnswers;     ///< The answers of the edited survey to questions that are no longer asked, which are kept as is.
     bool editMode;  ///< Is the dialog in edit mode?
 
+    void setupQuestions(const QuestionSet &questions);
     void setupAddMode();
     void setupEditMode(const Survey &editSurvey);
 };
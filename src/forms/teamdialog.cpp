@@ -0,0 +1,124 @@
+#include "teamdialog.h"
+#include "ui_teamdialog.h"
+
+#include "../objects/surveydatabase.h"
+
+#include <QHeaderView>
+#include <QSettings>
+#include <QSignalBlocker>
+#include <QVariantList>
+
+/*!
+ * \brief The constructor for the TeamDialog.
+ * \param db = The database the surveys are read from
+ * \param parent = The QWidget to which this dialog is bound to
+ * \note The range starts as the last 30 days.
+ */
+TeamDialog::TeamDialog(SurveyDatabase *db, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::TeamDialog),
+    surveyDb(db),
+    matrixModel(this),
+    team()
+{
+    ui->setupUi(this);
+
+    const QVariantList members(QSettings().value("team/employees").toList());
+
+    for (const QVariant &member : members)
+        team.insert(member.toInt());
+
+    ui->dateTo->setDate(QDate::currentDate());
+    ui->dateFrom->setDate(QDate::currentDate().addDays(-29));
+
+    // Fixed section sizes, so the view never measures the cells of hundreds of columns to lay them out.
+    ui->tableTeam->setModel(&matrixModel);
+    ui->tableTeam->horizontalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    ui->tableTeam->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+
+    // Also loads the surveys of the team.
+    loadEmployees();
+
+    connect(ui->listEmployees, &QListWidget::itemChanged, this, &TeamDialog::memberToggled);
+    connect(ui->dateFrom, &QDateEdit::dateChanged, this, &TeamDialog::refresh);
+    connect(ui->dateTo, &QDateEdit::dateChanged, this, &TeamDialog::refresh);
+    connect(surveyDb, &SurveyDatabase::databaseChanged, this, &TeamDialog::loadEmployees);
+}
+
+/*!
+ * \brief The destructor for the TeamDialog.
+ */
+TeamDialog::~TeamDialog()
+{
+    delete ui;
+}
+
+/*!
+ * \brief Reloads the surveys of the team and shows them in the table.
+ */
+void TeamDialog::refresh()
+{
+    TeamMatrix matrix;
+
+    matrixModel.setQuestionSet(surveyDb->getQuestionSet());
+
+    if (!surveyDb->loadTeamMatrix(matrix, team.values(), ui->dateFrom->date(), ui->dateTo->date()))
+        matrix.reset(QDate(), QDate());
+
+    matrixModel.load(matrix);
+
+    ui->labelSummary->setText(team.isEmpty() ? tr("Check the employees to compare.")
+                                             : QString::number(matrix.empIds.size()) + " " + tr("employees over") + " " +
+                                               QString::number(matrix.days) + " " + tr("days."));
+}
+
+/*!
+ * \brief Lists every employee, with the members of the team checked.
+ * \note Employees that were removed are dropped from the team.
+ */
+void TeamDialog::loadEmployees()
+{
+    EmployeeTableModel *employees(surveyDb->getEmployeeModel());
+    QSet<int> existing;
+
+    QSignalBlocker blocker(ui->listEmployees);
+    ui->listEmployees->clear();
+
+    for (int row = 0; row < employees->rowCount(); ++row) {
+        int empId(employees->getEmployeeId(row));
+        QListWidgetItem *item(new QListWidgetItem(employees->getName(row), ui->listEmployees));
+
+        item->setData(Qt::UserRole, empId);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(team.contains(empId) ? Qt::Checked : Qt::Unchecked);
+        existing.insert(empId);
+    }
+
+    team.intersect(existing);
+    ui->listEmployees->sortItems();
+
+    refresh();
+}
+
+/*!
+ * \brief Adds an employee to the team or removes it, and remembers the team.
+ * \param item = The item of the employee that was checked or unchecked
+ */
+void TeamDialog::memberToggled(QListWidgetItem *item)
+{
+    int empId(item->data(Qt::UserRole).toInt());
+
+    if (item->checkState() == Qt::Checked)
+        team.insert(empId);
+    else
+        team.remove(empId);
+
+    QVariantList members;
+
+    for (const int &member : std::as_const(team))
+        members.append(member);
+
+    QSettings().setValue("team/employees", members);
+
+    refresh();
+}
@@ -0,0 +1,44 @@
+#ifndef TEAMDIALOG_H
+#define TEAMDIALOG_H
+
+#include "../objects/teammatrixmodel.h"
+
+#include <QDialog>
+#include <QSet>
+
+namespace Ui {
+class TeamDialog;
+}
+
+class QListWidgetItem;
+class SurveyDatabase;
+
+/*!
+ * \brief The window where the daily surveys of a team are compared side by side, one column per employee.
+ *
+ * The team is picked from the list of employees and remembered between sessions. The whole team is read with a
+ * single query whenever the team or the range changes, and whenever the database changes.
+ */
+class TeamDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit TeamDialog(SurveyDatabase *db, QWidget *parent = nullptr);
+    ~TeamDialog();
+
+public slots:
+    void refresh();
+
+private slots:
+    void loadEmployees();
+    void memberToggled(QListWidgetItem *item);
+
+private:
+    Ui::TeamDialog *ui;         ///< The reference to the UI of the TeamDialog.
+    SurveyDatabase *surveyDb;   ///< The database the surveys are read from.
+    TeamMatrixModel matrixModel;///< The surveys of the team, one row per day and one column per employee.
+    QSet<int> team;             ///< The IDs of the employees in the team.
+};
+
+#endif // TEAMDIALOG_H
@@ -1,8 +1,18 @@
 #include "forms/mainwindow.h"
+#include "objects/profilebenchmark.h"
+#include "objects/tracer.h"
+#include "objects/surveydaemon.h"
+#include "objects/auditlog.h"
 
 #include <QApplication>
 #include <QLocale>
 #include <QTranslator>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QScopedPointer>
+#include <QDateTime>
 
 /*!
  * \brief Start the application.
@@ -12,7 +22,17 @@
  */
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
+    // The daemon runs on machines without a display, so it must not create a GUI application.
+    bool daemonMode(false);
+
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--daemon") == 0 || qstrncmp(argv[i], "--daemon=", 9) == 0)
+            daemonMode = true;
+    }
+
+    QScopedPointer<QCoreApplication> a(daemonMode ? new QCoreApplication(argc, argv) : new QApplication(argc, argv));
+    QApplication::setOrganizationName("CCQ");
+    QApplication::setApplicationName("CompanyCovidQuery");
 
     QTranslator translator;
     const QStringList uiLanguages = QLocale::system().uiLanguages();
@@ -20,12 +40,180 @@ int main(int argc, char *argv[])
     for (const QString &locale : uiLanguages) {
         const QString baseName = "CompanyCovidQuery_" + QLocale(locale).name();
         if (translator.load(":/i18n/" + baseName)) {
-            a.installTranslator(&translator);
+            a->installTranslator(&translator);
             break;
         }
     }
 
-    MainWindow w;
+    QCommandLineParser parser;
+    parser.setApplicationDescription("CCQ - Company Covid Query");
+    parser.addHelpOption();
+
+    QCommandLineOption ingestPortOption("ingest-port", "Accept surveys from entry tablets on <port>.", "port");
+    QCommandLineOption ingestAddressOption("ingest-address", "Accept tablets on <address> (default: localhost only, other addresses require --ingest-token).", "address");
+    QCommandLineOption ingestTokenOption("ingest-token", "Require tablets to send <token> in the X-CCQ-Token header.", "token");
+    parser.addOption(ingestPortOption);
+    parser.addOption(ingestAddressOption);
+    parser.addOption(ingestTokenOption);
+
+    QCommandLineOption checkPlansOption("check-query-plans", "Print the query plan report and exit with 1 if any statement unexpectedly scans a full table or sorts in a temporary B-tree.");
+    parser.addOption(checkPlansOption);
+
+    QCommandLineOption profileOption("profile", "Open the database with durability profile <name>: " +
+                                     DurabilityProfile::getNames().join(", ") + " (default: the saved setting, or balanced).", "name");
+    QCommandLineOption benchmarkOption("benchmark-profiles", "Measure the throughput and latency of every durability profile in <dir> and exit.", "dir");
+    parser.addOption(profileOption);
+    parser.addOption(benchmarkOption);
+
+    QCommandLineOption daemonOption("daemon", "Run without a window and answer clearance queries from local clients on socket <name>.", "name");
+    QCommandLineOption databaseOption("database", "Open the database file <file> in daemon mode (default: survey.data next to the application).", "file");
+    QCommandLineOption threadsOption("threads", "Serve the daemon's clients with <count> threads (default: one less than the amount of cores).", "count");
+    parser.addOption(daemonOption);
+    parser.addOption(databaseOption);
+    parser.addOption(threadsOption);
+
+    QCommandLineOption auditLogOption("audit-log", "Verify the audit log <file>, print its records as CSV and exit with 1 if it was changed.", "file");
+    QCommandLineOption employeeOption("employee", "Only print the audit records of employee <id>.", "id");
+    QCommandLineOption fromOption("from", "Only print the audit records of surveys on or after <date> (yyyy-MM-dd).", "date");
+    QCommandLineOption toOption("to", "Only print the audit records of surveys on or before <date> (yyyy-MM-dd).", "date");
+    parser.addOption(auditLogOption);
+    parser.addOption(employeeOption);
+    parser.addOption(fromOption);
+    parser.addOption(toOption);
+
+    QCommandLineOption traceOption("trace", "Record a trace from the start, which can be saved with Tools > Save Trace...");
+    parser.addOption(traceOption);
+    parser.process(*a);
+
+    if (parser.isSet(benchmarkOption)) {
+        QTemporaryDir tempDir(parser.value(benchmarkOption) + "/ccq-benchmark-XXXXXX");
+
+        if (!tempDir.isValid())
+            return 2;
+
+        ProfileBenchmark benchmark;
+        QList<ProfileResult> results;
+        const QStringList names(DurabilityProfile::getNames());
+
+        for (const QString &name : names)
+            results.append(benchmark.run(DurabilityProfile::fromName(name), tempDir.path()));
+
+        QTextStream(stdout) << ProfileBenchmark::formatReport(results);
+
+        for (const ProfileResult &result : results) {
+            if (!result.error.isEmpty())
+                return 1;
+        }
+
+        return 0;
+    }
+
+    if (parser.isSet(auditLogOption)) {
+        AuditLogReader reader(parser.value(auditLogOption));
+        AuditFilter filter;
+        QTextStream out(stdout);
+
+        filter.empId = parser.isSet(employeeOption) ? parser.value(employeeOption).toInt() : -1;
+        filter.from = QDate::fromString(parser.value(fromOption), Qt::ISODate);
+        filter.to = QDate::fromString(parser.value(toOption), Qt::ISODate);
+
+        out << "changed_at,action,emp_id,survey_date,old_answers,old_temperature,new_answers,new_temperature" << Qt::endl;
+
+        bool valid(reader.read(filter, [&out](const AuditRecord &record) {
+            out << QDateTime::fromMSecsSinceEpoch(record.timestamp).toString(Qt::ISODate) << ","
+                << (record.action == AuditRecord::Remove ? "remove" : "edit") << ","
+                << record.empId << ","
+                << QDateTime::fromSecsSinceEpoch(record.surveyDate).date().toString(Qt::ISODate) << ","
+                << record.oldAnswers << "," << record.oldTemperature << ","
+                << record.newAnswers << "," << record.newTemperature << "\n";
+        }));
+
+        out.flush();
+
+        if (!valid) {
+            QTextStream(stderr) << "Audit log error: " << reader.getError() << Qt::endl;
+            return 1;
+        }
+
+        return 0;
+    }
+
+    // The command line option overrides the profile saved in the settings.
+    QString profileName(QSettings().value("database/profile", "balanced").toString());
+
+    if (parser.isSet(profileOption))
+        profileName = parser.value(profileOption);
+
+    bool profileOk;
+    DurabilityProfile profile(DurabilityProfile::fromName(profileName, &profileOk));
+
+    if (!profileOk) {
+        QTextStream(stderr) << "Unknown durability profile: " << profileName << Qt::endl;
+        return 2;
+    }
+
+    if (parser.isSet(checkPlansOption)) {
+        // The plans are checked against a new database with the current schema, the user's database is never touched.
+        QTemporaryDir planDir;
+        const QString planLocation(planDir.filePath("plans.data"));
+
+        if (!planDir.isValid())
+            return 2;
+
+        {
+            SurveyDatabase creator;
+
+            if (!creator.createDatabase(planLocation))
+                return 2;
+        }
+
+        // Only the statements used on an existing file are explained, not the ones that created it.
+        SurveyDatabase surveyDb;
+        surveyDb.setDurabilityProfile(profile);
+
+        if (!surveyDb.createDatabase(planLocation))
+            return 2;
+
+        // Run the read paths, so their statements are inspected as well.
+        surveyDb.getTemperatureAlerts(QDate::currentDate());
+        surveyDb.getCompliance(QDate::currentDate().addDays(-89), QDate::currentDate(), WorkdayCalendar());
+
+        QList<QueryPlan> plans(surveyDb.inspectQueryPlans());
+        QTextStream(stdout) << QueryPlanInspector::formatReport(plans);
+
+        for (const QueryPlan &plan : plans) {
+            if (plan.hasIssues() || !plan.error.isEmpty())
+                return 1;
+        }
+
+        return 0;
+    }
+
+    if (daemonMode) {
+        SurveyDaemon daemon;
+        QString dbLocation(parser.isSet(databaseOption) ? parser.value(databaseOption)
+                                                        : QCoreApplication::applicationDirPath() + "/survey.data");
+
+        if (!daemon.start(parser.value(daemonOption), dbLocation, profile, parser.value(threadsOption).toInt()))
+            return 2;
+
+        QTextStream(stdout) << "Listening on " << daemon.getServerName() << Qt::endl;
+        return a->exec();
+    }
+
+    Tracer::setEnabled(parser.isSet(traceOption));
+
+    MainWindow w(nullptr, profile);
     w.show();
-    return a.exec();
+
+    if (parser.isSet(ingestPortOption)) {
+        QHostAddress address(QHostAddress::LocalHost);
+
+        if (parser.isSet(ingestAddressOption))
+            address = QHostAddress(parser.value(ingestAddressOption));
+
+        w.startIngestionServer(parser.value(ingestPortOption).toUShort(), address, parser.value(ingestTokenOption));
+    }
+
+    return a->exec();
 }
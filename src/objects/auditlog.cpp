@@ -0,0 +1,585 @@
+#include "auditlog.h"
+
+#include <QThread>
+#include <QFile>
+#include <QLockFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QtDebug>
+
+#include <limits>
+
+namespace {
+const char FileMagic[] = "CCQAUDIT";    ///< The first bytes of every audit log.
+const int FileMagicSize(8);             ///< The size of FileMagic without its terminator.
+const quint32 FileVersion(1);           ///< The version of the file format.
+const int FileHeaderSize(FileMagicSize + 4); ///< The size of the magic and the version.
+const quint32 BlockMagic(0x43434142);   ///< The first field of every block ("CCAB").
+const int BlockFieldsSize(3 * 4 + 2 * 4 + 2 * 8); ///< The size of the fixed block fields before the hash.
+const int HashSize(32);                 ///< The size of a SHA-256 hash.
+const int RecordSize(8 + 1 + 4 + 8 + 4 + 4 + 4 + 4); ///< The size of a single uncompressed record.
+const int LockTimeout(5000);            ///< The time (in milliseconds) a writer waits for another workstation to finish its block.
+
+/*!
+ * \brief The fixed fields of a block in the log.
+ */
+struct BlockHeader
+{
+    quint32 records = 0;    ///< The amount of records in the block.
+    quint32 size = 0;       ///< The size of the compressed payload.
+    qint32 minEmpId = 0;    ///< The lowest employee ID in the block.
+    qint32 maxEmpId = 0;    ///< The highest employee ID in the block.
+    qint64 minDate = 0;     ///< The earliest survey date in the block.
+    qint64 maxDate = 0;     ///< The latest survey date in the block.
+    QByteArray hash;        ///< The hash of the previous block's hash, the fields above and the payload.
+};
+
+/*!
+ * \brief Serializes the fixed fields of a block, without its hash.
+ * \param header = The block header
+ * \return The serialized fields, BlockFieldsSize bytes long.
+ */
+QByteArray serializeFields(const BlockHeader &header)
+{
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+
+    out << BlockMagic << header.records << header.size << header.minEmpId << header.maxEmpId
+        << header.minDate << header.maxDate;
+
+    return bytes;
+}
+
+/*!
+ * \brief Reads the fixed fields and the hash of the block at the current position.
+ * \param device = The log file
+ * \param header = Receives the block header
+ * \return A boolean value that is false if there is no complete, valid block header.
+ */
+bool readBlockHeader(QIODevice &device, BlockHeader &header)
+{
+    QDataStream in(&device);
+    quint32 magic(0);
+
+    in >> magic >> header.records >> header.size >> header.minEmpId >> header.maxEmpId
+       >> header.minDate >> header.maxDate;
+    header.hash = device.read(HashSize);
+
+    return in.status() == QDataStream::Ok && magic == BlockMagic && header.hash.size() == HashSize;
+}
+
+/*!
+ * \brief Calculates the hash that chains a block to the block before it.
+ * \param previous = The hash of the previous block, or HashSize zero bytes for the first block
+ * \param fields = The serialized fixed fields of the block
+ * \param payload = The compressed payload of the block
+ * \return The SHA-256 hash.
+ */
+QByteArray chainHash(const QByteArray &previous, const QByteArray &fields, const QByteArray &payload)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+
+    hash.addData(previous);
+    hash.addData(fields);
+    hash.addData(payload);
+
+    return hash.result();
+}
+
+/*!
+ * \brief Compresses records into a block payload, column by column.
+ * \param records = The records
+ * \return The compressed payload.
+ */
+QByteArray encodeRecords(const QList<AuditRecord> &records)
+{
+    QByteArray raw;
+    raw.reserve(records.size() * RecordSize);
+
+    QDataStream out(&raw, QIODevice::WriteOnly);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    // Neighbouring values in a column are alike, which is what the compression feeds on.
+    for (const AuditRecord &record : records)
+        out << record.timestamp;
+    for (const AuditRecord &record : records)
+        out << static_cast<quint8>(record.action);
+    for (const AuditRecord &record : records)
+        out << record.empId;
+    for (const AuditRecord &record : records)
+        out << record.surveyDate;
+    for (const AuditRecord &record : records)
+        out << record.oldAnswers;
+    for (const AuditRecord &record : records)
+        out << record.oldTemperature;
+    for (const AuditRecord &record : records)
+        out << record.newAnswers;
+    for (const AuditRecord &record : records)
+        out << record.newTemperature;
+
+    return qCompress(raw);
+}
+
+/*!
+ * \brief Decompresses the records of a block payload.
+ * \param payload = The compressed payload
+ * \param count = The amount of records in the block
+ * \param records = Receives the records
+ * \return A boolean value that is false if the payload is damaged.
+ */
+bool decodeRecords(const QByteArray &payload, const quint32 &count, QList<AuditRecord> &records)
+{
+    const QByteArray raw(qUncompress(payload));
+
+    if (raw.size() != static_cast<qint64>(count) * RecordSize)
+        return false;
+
+    records.resize(count);
+
+    QDataStream in(raw);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    for (AuditRecord &record : records)
+        in >> record.timestamp;
+    for (AuditRecord &record : records) {
+        quint8 action;
+        in >> action;
+        record.action = static_cast<AuditRecord::Action>(action);
+    }
+    for (AuditRecord &record : records)
+        in >> record.empId;
+    for (AuditRecord &record : records)
+        in >> record.surveyDate;
+    for (AuditRecord &record : records)
+        in >> record.oldAnswers;
+    for (AuditRecord &record : records)
+        in >> record.oldTemperature;
+    for (AuditRecord &record : records)
+        in >> record.newAnswers;
+    for (AuditRecord &record : records)
+        in >> record.newTemperature;
+
+    return in.status() == QDataStream::Ok;
+}
+
+/*!
+ * \brief Converts the first day of a filter to unix time.
+ * \param from = The first survey date, or an invalid date for no lower bound
+ * \return The start of the day as unix time.
+ */
+qint64 firstSecond(const QDate &from)
+{
+    return from.isValid() ? from.startOfDay().toSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+}
+
+/*!
+ * \brief Converts the last day of a filter to unix time.
+ * \param to = The last survey date, or an invalid date for no upper bound
+ * \return The end of the day as unix time.
+ */
+qint64 lastSecond(const QDate &to)
+{
+    return to.isValid() ? to.endOfDay().toSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+}
+}
+
+/*!
+ * \brief Determines if a record matches the filter.
+ * \param record = The record
+ * \return A boolean value that states whether the record matches.
+ */
+bool AuditFilter::matches(const AuditRecord &record) const
+{
+    return (empId < 0 || record.empId == empId) &&
+            record.surveyDate >= firstSecond(from) && record.surveyDate <= lastSecond(to);
+}
+
+/*!
+ * \brief Determines if a block could contain records that match the filter.
+ * \param minEmpId = The lowest employee ID in the block
+ * \param maxEmpId = The highest employee ID in the block
+ * \param minDate = The earliest survey date (unix time) in the block
+ * \param maxDate = The latest survey date (unix time) in the block
+ * \return A boolean value that is false if none of the block's records can match.
+ */
+bool AuditFilter::mayMatch(const qint32 &minEmpId, const qint32 &maxEmpId, const qint64 &minDate, const qint64 &maxDate) const
+{
+    return (empId < 0 || (empId >= minEmpId && empId <= maxEmpId)) &&
+            maxDate >= firstSecond(from) && minDate <= lastSecond(to);
+}
+
+/*!
+ * \brief The constructor for the AuditLog.
+ * \param parent = The QObject to which this object is bound to
+ * \note Nothing is written until a location is set.
+ */
+AuditLog::AuditLog(QObject *parent) :
+    QObject(parent),
+    location(),
+    pending(),
+    flushTimer(this),
+    writer(nullptr),
+    writerContext(nullptr),
+    writtenPath(),
+    writtenSize(0),
+    lastHash(),
+    unwritten()
+{
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(FlushInterval);
+
+    connect(&flushTimer, &QTimer::timeout, this, &AuditLog::flush);
+}
+
+/*!
+ * \brief The destructor for the AuditLog.
+ * \note The pending records are written and the writer thread is waited for.
+ */
+AuditLog::~AuditLog()
+{
+    flush();
+
+    if (writer != nullptr) {
+        // Quitting through the writer's own queue lets it write every block that was posted before.
+        QThread *thread(writer);
+        QMetaObject::invokeMethod(writerContext, [thread]() { thread->quit(); }, Qt::QueuedConnection);
+
+        writer->wait();
+        delete writer;
+    }
+}
+
+/*!
+ * \brief Assigns the file the records are appended to.
+ * \param path = The full path to the log file
+ * \note Records buffered for the previous file are written to it first.
+ */
+void AuditLog::setLocation(const QString &path)
+{
+    flush();
+    location = path;
+}
+
+/*!
+ * \brief Retrieves the file the records are appended to.
+ * \return The full path to the log file, or an empty string if none was set.
+ */
+QString AuditLog::getLocation() const
+{
+    return location;
+}
+
+/*!
+ * \brief Buffers a record. It is written within FlushInterval, or at once when BlockRecords records are waiting.
+ * \param record = The record
+ */
+void AuditLog::append(const AuditRecord &record)
+{
+    // Without a file (an in-memory database) there is nowhere to keep the records.
+    if (location.isEmpty())
+        return;
+
+    pending.append(record);
+
+    if (pending.size() >= BlockRecords)
+        flush();
+    else if (!flushTimer.isActive())
+        flushTimer.start();
+}
+
+/*!
+ * \brief Hands the buffered records to the writer thread as a single block.
+ */
+void AuditLog::flush()
+{
+    flushTimer.stop();
+
+    if (pending.isEmpty() || location.isEmpty())
+        return;
+
+    if (writer == nullptr) {
+        writer = new QThread();
+        writerContext = new QObject();
+
+        writerContext->moveToThread(writer);
+        connect(writer, &QThread::finished, writerContext, &QObject::deleteLater);
+        writer->start();
+    }
+
+    QList<AuditRecord> block;
+    block.swap(pending);
+
+    QString path(location);
+    QMetaObject::invokeMethod(writerContext, [this, path, block]() { writeBlock(path, block); }, Qt::QueuedConnection);
+}
+
+/*!
+ * \brief Writes a block on the writer thread, together with any records that failed to write before.
+ * \param path = The full path to the log file
+ * \param records = The records of the block
+ */
+void AuditLog::writeBlock(const QString &path, const QList<AuditRecord> &records)
+{
+    QList<AuditRecord> block(unwritten + records);
+
+    if (appendBlock(path, block))
+        unwritten.clear();
+    else
+        unwritten = block;
+}
+
+/*!
+ * \brief Appends a block to the log file, chained to the last block in it.
+ * \param path = The full path to the log file
+ * \param records = The records of the block
+ * \return A boolean value stating whether the block was written or not.
+ * \note Runs on the writer thread.
+ */
+bool AuditLog::appendBlock(const QString &path, const QList<AuditRecord> &records)
+{
+    QLockFile lock(path + ".lock");
+
+    if (!lock.tryLock(LockTimeout)) {
+        qDebug() << "(Audit) Error locking the log: " << lock.error() << Qt::endl;
+        return false;
+    }
+
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadWrite)) {
+        qDebug() << "(Audit) Error opening the log: " << file.errorString() << Qt::endl;
+        return false;
+    }
+
+    if (path != writtenPath || file.size() < writtenSize) {
+        writtenPath = path;
+        writtenSize = 0;
+        lastHash = QByteArray(HashSize, '\0');
+    }
+
+    if (file.size() < FileHeaderSize) {
+        QDataStream out(&file);
+
+        file.resize(0);
+        out.writeRawData(FileMagic, FileMagicSize);
+        out << FileVersion;
+        writtenSize = FileHeaderSize;
+    } else if (writtenSize == 0) {
+        QDataStream in(&file);
+        QByteArray magic(file.read(FileMagicSize));
+        quint32 version(0);
+
+        in >> version;
+
+        if (magic != QByteArray(FileMagic, FileMagicSize) || version != FileVersion) {
+            qDebug() << "(Audit) Error opening the log: " << path << " is not an audit log." << Qt::endl;
+            return false;
+        }
+
+        writtenSize = FileHeaderSize;
+    }
+
+    // Other workstations may have appended blocks since this writer last wrote, the new block chains to the last one.
+    while (writtenSize < file.size()) {
+        BlockHeader header;
+        file.seek(writtenSize);
+
+        if (!readBlockHeader(file, header)) {
+            qDebug() << "(Audit) Error reading the log: damaged block at offset " << writtenSize << Qt::endl;
+            return false;
+        }
+
+        qint64 blockEnd(writtenSize + BlockFieldsSize + HashSize + header.size);
+
+        // A block that was cut off by a crash was never complete, so it is dropped.
+        if (blockEnd > file.size()) {
+            qDebug() << "(Audit) Dropping incomplete block at offset " << writtenSize << Qt::endl;
+            file.resize(writtenSize);
+            break;
+        }
+
+        lastHash = header.hash;
+        writtenSize = blockEnd;
+    }
+
+    BlockHeader header;
+    QByteArray payload(encodeRecords(records));
+
+    header.records = records.size();
+    header.size = payload.size();
+    header.minEmpId = std::numeric_limits<qint32>::max();
+    header.maxEmpId = std::numeric_limits<qint32>::min();
+    header.minDate = std::numeric_limits<qint64>::max();
+    header.maxDate = std::numeric_limits<qint64>::min();
+
+    for (const AuditRecord &record : records) {
+        header.minEmpId = qMin(header.minEmpId, record.empId);
+        header.maxEmpId = qMax(header.maxEmpId, record.empId);
+        header.minDate = qMin(header.minDate, record.surveyDate);
+        header.maxDate = qMax(header.maxDate, record.surveyDate);
+    }
+
+    QByteArray fields(serializeFields(header));
+    header.hash = chainHash(lastHash, fields, payload);
+
+    // The block is written in one go, so a reader never sees a block without its payload unless the machine crashed.
+    QByteArray block(fields + header.hash + payload);
+
+    if (!file.seek(writtenSize) || file.write(block) != block.size() || !file.flush()) {
+        qDebug() << "(Audit) Error writing the log: " << file.errorString() << Qt::endl;
+        file.resize(writtenSize);
+        return false;
+    }
+
+    writtenSize += block.size();
+    lastHash = header.hash;
+
+    return true;
+}
+
+/*!
+ * \brief The constructor for the AuditLogReader.
+ * \param path = The full path to the log file
+ */
+AuditLogReader::AuditLogReader(const QString &path) :
+    location(path),
+    error(),
+    blocks(0),
+    skippedBlocks(0),
+    records(0)
+{
+}
+
+/*!
+ * \brief Streams the records that match a filter, in the order they were written.
+ * \param filter = Selects the records
+ * \param visit = Called for every record that matches, or nullptr to only verify the log
+ * \param verifyChain = Should the hash of every block be checked?
+ * \return A boolean value that is false if the log could not be read, or (when verifying) was changed.
+ * \note Blocks that cannot match the filter are not decompressed, and are skipped unread if the chain is not verified.
+ */
+bool AuditLogReader::read(const AuditFilter &filter, const std::function<void (const AuditRecord &)> &visit, const bool &verifyChain)
+{
+    error.clear();
+    blocks = 0;
+    skippedBlocks = 0;
+    records = 0;
+
+    QFile file(location);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+
+    QDataStream in(&file);
+    QByteArray magic(file.read(FileMagicSize));
+    quint32 version(0);
+
+    in >> version;
+
+    if (magic != QByteArray(FileMagic, FileMagicSize) || version != FileVersion) {
+        error = "The file is not an audit log.";
+        return false;
+    }
+
+    QByteArray previous(HashSize, '\0');
+    QList<AuditRecord> decoded;
+
+    while (!file.atEnd()) {
+        qint64 offset(file.pos());
+        BlockHeader header;
+
+        if (!readBlockHeader(file, header)) {
+            error = QString("The block at offset %1 is damaged.").arg(offset);
+            return false;
+        }
+
+        bool wanted(visit && filter.mayMatch(header.minEmpId, header.maxEmpId, header.minDate, header.maxDate));
+        QByteArray payload;
+
+        if (wanted || verifyChain)
+            payload = file.read(header.size);
+        else if (file.seek(file.pos() + header.size) && file.pos() <= file.size())
+            payload.resize(header.size);
+
+        if (payload.size() != static_cast<qint64>(header.size)) {
+            error = QString("The block at offset %1 is incomplete.").arg(offset);
+            return false;
+        }
+
+        if (verifyChain && chainHash(previous, serializeFields(header), payload) != header.hash) {
+            error = QString("Block %1 (at offset %2) was changed, or a block before it was removed.").arg(blocks + 1).arg(offset);
+            return false;
+        }
+
+        previous = header.hash;
+        ++blocks;
+
+        if (!wanted) {
+            ++skippedBlocks;
+            continue;
+        }
+
+        if (!decodeRecords(payload, header.records, decoded)) {
+            error = QString("The records of block %1 (at offset %2) are damaged.").arg(blocks).arg(offset);
+            return false;
+        }
+
+        for (const AuditRecord &record : decoded) {
+            if (filter.matches(record)) {
+                ++records;
+                visit(record);
+            }
+        }
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Checks the hash chain of the whole log.
+ * \return A boolean value that is false if the log could not be read or was changed. See getError().
+ * \note Removing blocks from the end of the log can not be detected from the log alone.
+ */
+bool AuditLogReader::verify()
+{
+    return read(AuditFilter(), nullptr, true);
+}
+
+/*!
+ * \brief Retrieves why the last read failed.
+ * \return A description of the error, or an empty string if the last read succeeded.
+ */
+QString AuditLogReader::getError() const
+{
+    return error;
+}
+
+/*!
+ * \brief Retrieves the amount of blocks the last read went through.
+ * \return An integer with the amount of blocks.
+ */
+int AuditLogReader::getBlocks() const
+{
+    return blocks;
+}
+
+/*!
+ * \brief Retrieves the amount of blocks the last read did not decompress, because they could not match the filter.
+ * \return An integer with the amount of blocks.
+ */
+int AuditLogReader::getSkippedBlocks() const
+{
+    return skippedBlocks;
+}
+
+/*!
+ * \brief Retrieves the amount of records that matched the filter in the last read.
+ * \return The amount of records.
+ */
+qint64 AuditLogReader::getRecords() const
+{
+    return records;
+}
@@ -0,0 +1,121 @@
+#ifndef AUDITLOG_H
+#define AUDITLOG_H
+
+#include <QObject>
+#include <QList>
+#include <QDate>
+#include <QTimer>
+#include <QByteArray>
+
+#include <functional>
+
+class QThread;
+
+/*!
+ * \brief A single change to a survey, as recorded in the audit log.
+ */
+struct AuditRecord
+{
+    enum Action : quint8 {
+        Edit = 1,   ///< The answers or the temperature of the survey were changed.
+        Remove = 2  ///< The survey was removed.
+    };
+
+    qint64 timestamp = 0;       ///< When the change was committed, in milliseconds since the epoch.
+    Action action = Edit;       ///< What happened to the survey.
+    qint32 empId = -1;          ///< The ID of the employee.
+    qint64 surveyDate = 0;      ///< The survey date as unix time.
+    quint32 oldAnswers = 0;     ///< The answers before the change.
+    float oldTemperature = 0;   ///< The temperature before the change.
+    quint32 newAnswers = 0;     ///< The answers after the change, 0 for a removal.
+    float newTemperature = 0;   ///< The temperature after the change, 0 for a removal.
+};
+
+/*!
+ * \brief Selects the audit records of an employee and/or a range of survey dates.
+ */
+struct AuditFilter
+{
+    int empId = -1;     ///< The ID of the employee, or -1 for every employee.
+    QDate from;         ///< The first survey date, or an invalid date for no lower bound.
+    QDate to;           ///< The last survey date, or an invalid date for no upper bound.
+
+    bool matches(const AuditRecord &record) const;
+    bool mayMatch(const qint32 &minEmpId, const qint32 &maxEmpId, const qint64 &minDate, const qint64 &maxDate) const;
+};
+
+/*!
+ * \brief An append-only, block-compressed log of every survey edit and removal, stored next to the database.
+ *
+ * Records are buffered and written in blocks by a background thread, so an edit never waits for the disk.
+ * Every block is compressed and carries the range of employees and survey dates it covers, so a reader can skip
+ * the blocks that cannot match its filter without decompressing them. Every block also carries a SHA-256 hash
+ * over its contents and the hash of the block before it, so a changed, removed or reordered block is detected.
+ *
+ * The file is written with QDataStream (big endian):
+ *
+ *     header:  "CCQAUDIT" version(quint32)
+ *     block:   BlockMagic(quint32) records(quint32) size(quint32) minEmpId(qint32) maxEmpId(qint32)
+ *              minDate(qint64) maxDate(qint64) hash(32 bytes) payload(size bytes)
+ *
+ * The payload is compressed with qCompress() and stores the records column by column, which compresses far
+ * better than whole records. Several workstations may share the log: every block is appended under a lock file,
+ * chained to whichever block was appended last.
+ */
+class AuditLog : public QObject
+{
+    Q_OBJECT
+public:
+    static const int BlockRecords = 512;    ///< The amount of buffered records that triggers an immediate write.
+    static const int FlushInterval = 2000;  ///< The maximum time (in milliseconds) a record is buffered before it is written.
+
+    explicit AuditLog(QObject *parent = nullptr);
+    ~AuditLog();
+
+    void setLocation(const QString &path);
+    QString getLocation() const;
+    void append(const AuditRecord &record);
+    void flush();
+
+private:
+    QString location;           ///< The full path to the log file.
+    QList<AuditRecord> pending; ///< The records that have not been handed to the writer yet.
+    QTimer flushTimer;          ///< Writes the pending records once they have waited FlushInterval.
+    QThread *writer;            ///< Writes the blocks, started by the first flush.
+    QObject *writerContext;     ///< An object living in the writer thread, which the blocks are posted to.
+
+    // Only used on the writer thread.
+    QString writtenPath;        ///< The log file writtenSize and lastHash belong to.
+    qint64 writtenSize;         ///< The size of the log file after the last block this writer read or wrote.
+    QByteArray lastHash;        ///< The hash of the last block in the log file.
+    QList<AuditRecord> unwritten; ///< The records of blocks that failed to write, retried with the next block.
+
+    void writeBlock(const QString &path, const QList<AuditRecord> &records);
+    bool appendBlock(const QString &path, const QList<AuditRecord> &records);
+};
+
+/*!
+ * \brief Streams the records of an audit log, optionally verifying its hash chain.
+ */
+class AuditLogReader
+{
+public:
+    explicit AuditLogReader(const QString &path);
+
+    bool read(const AuditFilter &filter, const std::function<void (const AuditRecord &)> &visit, const bool &verifyChain = true);
+    bool verify();
+
+    QString getError() const;
+    int getBlocks() const;
+    int getSkippedBlocks() const;
+    qint64 getRecords() const;
+
+private:
+    QString location;   ///< The full path to the log file.
+    QString error;      ///< Why the last read failed, or empty if it did not.
+    int blocks;         ///< The amount of blocks in the log, as far as the last read got.
+    int skippedBlocks;  ///< The amount of blocks the last read did not decompress because they could not match the filter.
+    qint64 records;     ///< The amount of records that matched the filter in the last read.
+};
+
+#endif // AUDITLOG_H
@@ -0,0 +1,130 @@
+#include "complianceengine.h"
+
+#include <QDateTime>
+#include <QtAlgorithms>
+
+namespace {
+const int SecondsPerDay(24 * 60 * 60);
+}
+
+/*!
+ * \brief The constructor for the ComplianceEngine.
+ * \param from = The first date of the range
+ * \param to = The last date of the range
+ * \param calendar = The calendar with the days on which a survey is required
+ */
+ComplianceEngine::ComplianceEngine(const QDate &from, const QDate &to, const WorkdayCalendar &calendar) :
+    firstDate(from),
+    firstNoon(QDateTime(from, QTime(12, 0)).toSecsSinceEpoch()),
+    dayCount(from.isValid() && to.isValid() ? qMax(0, static_cast<int>(from.daysTo(to)) + 1) : 0),
+    words((dayCount + 63) / 64),
+    required(static_cast<size_t>(words), 0),
+    presence(),
+    slotByEmpId(),
+    empIds(),
+    names()
+{
+    for (int day = 0; day < dayCount; ++day) {
+        if (calendar.isWorkday(firstDate.addDays(day)))
+            required[static_cast<size_t>(day / 64)] |= quint64(1) << (day % 64);
+    }
+}
+
+/*!
+ * \brief Adds an employee whose compliance should be reported.
+ * \param empId = The ID of the employee
+ * \param name = The name of the employee
+ */
+void ComplianceEngine::addEmployee(const int &empId, const QString &name)
+{
+    if (slotByEmpId.contains(empId))
+        return;
+
+    slotByEmpId.insert(empId, empIds.size());
+    empIds.append(empId);
+    names.append(name);
+    presence.resize(presence.size() + static_cast<size_t>(words), 0);
+}
+
+/*!
+ * \brief Marks the day of a survey as present for an employee.
+ * \param empId = The ID of the employee
+ * \param surveyDate = The survey date as unix time (at 12:00)
+ * \note Surveys of employees that were not added and surveys outside the range are ignored.
+ */
+void ComplianceEngine::markPresent(const int &empId, const qint64 &surveyDate)
+{
+    auto slot(slotByEmpId.constFind(empId));
+
+    if (slot == slotByEmpId.constEnd())
+        return;
+
+    // Rounded, so a day that is an hour shorter or longer because of daylight saving time still counts as one.
+    qint64 day(qRound64(static_cast<double>(surveyDate - firstNoon) / SecondsPerDay));
+
+    if (day < 0 || day >= dayCount)
+        return;
+
+    presence[static_cast<size_t>(slot.value()) * static_cast<size_t>(words) + static_cast<size_t>(day / 64)] |= quint64(1) << (day % 64);
+}
+
+/*!
+ * \brief Retrieves the amount of days in the range.
+ * \return An integer with the amount of days.
+ */
+int ComplianceEngine::getDayCount() const
+{
+    return dayCount;
+}
+
+/*!
+ * \brief Retrieves the amount of workdays in the range.
+ * \return An integer with the amount of days on which a survey is required.
+ */
+int ComplianceEngine::getRequiredDayCount() const
+{
+    int count(0);
+
+    for (const quint64 &word : required)
+        count += qPopulationCount(word);
+
+    return count;
+}
+
+/*!
+ * \brief Compares the presence of every employee with the required days.
+ * \param missedOnly = Should only employees that missed at least one day be returned?
+ * \return The ComplianceRecords, in the order the employees were added.
+ */
+QList<ComplianceRecord> ComplianceEngine::getRecords(const bool &missedOnly) const
+{
+    QList<ComplianceRecord> records;
+    int requiredDays(getRequiredDayCount());
+
+    for (int slot = 0; slot < empIds.size(); ++slot) {
+        const quint64 *present(presence.data() + static_cast<size_t>(slot) * static_cast<size_t>(words));
+        ComplianceRecord record;
+
+        record.empId = empIds[slot];
+        record.name = names[slot];
+        record.requiredDays = requiredDays;
+
+        for (int word = 0; word < words; ++word) {
+            quint64 missed(required[static_cast<size_t>(word)] & ~present[word]);
+
+            record.missedDays += qPopulationCount(missed);
+
+            while (missed != 0) {
+                int bit(qCountTrailingZeroBits(missed));
+
+                record.missedDates.append(firstDate.addDays(word * 64 + bit));
+                missed &= missed - 1;
+            }
+        }
+
+        if (!missedOnly || record.missedDays > 0)
+            records.append(record);
+    }
+
+    return records;
+}
@@ -0,0 +1,54 @@
+#ifndef COMPLIANCEENGINE_H
+#define COMPLIANCEENGINE_H
+
+#include "workdaycalendar.h"
+
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <vector>
+
+/*!
+ * \brief The survey compliance of a single employee over a date range.
+ */
+struct ComplianceRecord
+{
+    int empId = -1;             ///< The ID of the employee.
+    QString name;               ///< The name of the employee.
+    int requiredDays = 0;       ///< The amount of workdays in the range.
+    int missedDays = 0;         ///< The amount of workdays without a survey.
+    QList<QDate> missedDates;   ///< The workdays without a survey, oldest first.
+};
+
+/*!
+ * \brief Finds the workdays on which employees did not submit a survey, using one bitmap per employee.
+ *
+ * Every day in the range is a bit. The workdays of the calendar form the required bitmap and every survey
+ * sets a bit in the bitmap of its employee. The missed days are the required bits that are not present,
+ * 64 days at a time, so a quarter takes two words per employee.
+ */
+class ComplianceEngine
+{
+public:
+    ComplianceEngine(const QDate &from, const QDate &to, const WorkdayCalendar &calendar);
+
+    void addEmployee(const int &empId, const QString &name);
+    void markPresent(const int &empId, const qint64 &surveyDate);
+
+    int getDayCount() const;
+    int getRequiredDayCount() const;
+    QList<ComplianceRecord> getRecords(const bool &missedOnly = false) const;
+
+private:
+    QDate firstDate;                ///< The first date of the range.
+    qint64 firstNoon;               ///< The first date of the range at 12:00, as unix time.
+    int dayCount;                   ///< The amount of days in the range.
+    int words;                      ///< The amount of 64-bit words in every bitmap.
+    std::vector<quint64> required;  ///< The bitmap of the workdays in the range.
+    std::vector<quint64> presence;  ///< The bitmaps of the days with a survey, one after another for every employee.
+    QHash<int, int> slotByEmpId;    ///< The index of the bitmap of every employee ID.
+    QList<int> empIds;              ///< The employee IDs, in the order they were added.
+    QStringList names;              ///< The employee names, in the order they were added.
+};
+
+#endif // COMPLIANCEENGINE_H
@@ -0,0 +1,80 @@
+#include "durabilityprofile.h"
+
+/*!
+ * \brief The profile for entry kiosks, where speed matters more than the last few surveys.
+ * \return The "kiosk" DurabilityProfile.
+ */
+DurabilityProfile DurabilityProfile::kiosk()
+{
+    DurabilityProfile profile;
+    profile.name = "kiosk";
+    profile.journalMode = "wal";
+    profile.synchronous = "OFF";
+    profile.cacheSizeKiB = 32 * 1024;
+    profile.mmapSize = 256 * 1024 * 1024;
+    profile.tempStoreMemory = true;
+    return profile;
+}
+
+/*!
+ * \brief The default profile for desk workstations.
+ * \return The "balanced" DurabilityProfile.
+ */
+DurabilityProfile DurabilityProfile::balanced()
+{
+    DurabilityProfile profile;
+    profile.name = "balanced";
+    profile.journalMode = "wal";
+    profile.synchronous = "NORMAL";
+    profile.cacheSizeKiB = 8 * 1024;
+    profile.mmapSize = 64 * 1024 * 1024;
+    profile.tempStoreMemory = true;
+    return profile;
+}
+
+/*!
+ * \brief The profile for the server that keeps the records, where no committed survey may ever be lost.
+ * \return The "archive" DurabilityProfile.
+ */
+DurabilityProfile DurabilityProfile::archive()
+{
+    DurabilityProfile profile;
+    profile.name = "archive";
+    profile.journalMode = "delete";
+    profile.synchronous = "EXTRA";
+    profile.cacheSizeKiB = 2 * 1024;
+    profile.mmapSize = 0;
+    profile.tempStoreMemory = false;
+    return profile;
+}
+
+/*!
+ * \brief Retrieves the names of all profiles.
+ * \return A QStringList with the names, from the fastest to the safest profile.
+ */
+QStringList DurabilityProfile::getNames()
+{
+    return {"kiosk", "balanced", "archive"};
+}
+
+/*!
+ * \brief Retrieves a profile by its name.
+ * \param name = The name of the profile (case insensitive)
+ * \param ok = Is set to false if there is no profile with the name
+ * \return The DurabilityProfile with the name, or the balanced profile if there is none.
+ */
+DurabilityProfile DurabilityProfile::fromName(const QString &name, bool *ok)
+{
+    QString key(name.trimmed().toLower());
+
+    if (ok != nullptr)
+        *ok = getNames().contains(key);
+
+    if (key == "kiosk")
+        return kiosk();
+
+    if (key == "archive")
+        return archive();
+
+    return balanced();
+}
@@ -0,0 +1,33 @@
+#ifndef DURABILITYPROFILE_H
+#define DURABILITYPROFILE_H
+
+#include <QString>
+#include <QStringList>
+
+/*!
+ * \brief A named set of SQLite settings that trades durability for speed, applied when the database is opened.
+ *
+ * - kiosk: WAL without syncing. The fastest, but the last commits (or, on a power loss, the file) can be lost.
+ * - balanced: WAL that syncs at checkpoints. A power loss can lose the last commits, but never corrupts the file.
+ * - archive: Rollback journal that syncs every commit and its directory, without memory mapping. The safest and slowest.
+ *
+ * Files on a network share always use the rollback journal, whatever the profile asks for (see SurveyDatabase).
+ */
+struct DurabilityProfile
+{
+    QString name;               ///< The name the profile is selected by.
+    QString journalMode;        ///< PRAGMA journal_mode.
+    QString synchronous;        ///< PRAGMA synchronous.
+    int cacheSizeKiB = 2000;    ///< The page cache size in KiB (PRAGMA cache_size with a negative value).
+    qint64 mmapSize = 0;        ///< PRAGMA mmap_size in bytes, 0 disables memory mapping.
+    bool tempStoreMemory = false; ///< Should temporary tables and indexes be kept in memory (PRAGMA temp_store)?
+
+    static DurabilityProfile kiosk();
+    static DurabilityProfile balanced();
+    static DurabilityProfile archive();
+
+    static QStringList getNames();
+    static DurabilityProfile fromName(const QString &name, bool *ok = nullptr);
+};
+
+#endif // DURABILITYPROFILE_H
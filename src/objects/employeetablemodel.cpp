@@ -1,9 +1,192 @@
 #include "employeetablemodel.h"
 
+#include <QSqlQuery>
+#include <QDateTime>
+#include <QtMath>
+#include <limits>
+
 /*!
  * \brief The constructor for the table model.
  * \param parent = The QObject to which this object is bound to
  */
-EmployeeTableModel::EmployeeTableModel(QObject *parent) : QSqlQueryModel(parent)
+EmployeeTableModel::EmployeeTableModel(QObject *parent) :
+    QAbstractTableModel(parent),
+    ids(),
+    nameOffsets(1, 0),
+    nameData(),
+    surveyCounts(),
+    lastDates(),
+    lastTemperatures()
+{
+}
+
+/*!
+ * \brief Retrieves the amount of employees in the model.
+ * \param parent = The parent index (the model is a flat table)
+ * \return An integer with the amount of rows.
+ */
+int EmployeeTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(ids.size());
+}
+
+/*!
+ * \brief Retrieves the amount of columns in the model.
+ * \param parent = The parent index (the model is a flat table)
+ * \return An integer with the amount of columns.
+ */
+int EmployeeTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : EmployeeTableColumns::LastTemperature + 1;
+}
+
+/*!
+ * \brief This function is used by the views to retrieve and display individual items.
+ * \param index = The current item index to be queried
+ * \param role = The Qt::DisplayRole of the item index
+ * \return A QVariant with the value of the item index to be displayed.
+ */
+QVariant EmployeeTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount() || (role != Qt::DisplayRole && role != Qt::EditRole))
+        return QVariant();
+
+    size_t row(static_cast<size_t>(index.row()));
+
+    switch (index.column()) {
+    case EmployeeTableColumns::ID: return getEmployeeId(index.row());
+    case EmployeeTableColumns::Name: return getName(index.row());
+    case EmployeeTableColumns::SurveyCount: return surveyCounts[row];
+    case EmployeeTableColumns::LastSeen:
+        if (lastDates[row] == 0)
+            return role == Qt::DisplayRole ? QVariant(tr("Never")) : QVariant(QDate());
+
+        return role == Qt::DisplayRole ? QVariant(getLastSeen(index.row()).toString("dd/MM/yyyy"))
+                                       : QVariant(getLastSeen(index.row()));
+    case EmployeeTableColumns::LastTemperature:
+        if (qIsNaN(lastTemperatures[row]))
+            return role == Qt::DisplayRole ? QVariant(QString()) : QVariant();
+
+        return role == Qt::DisplayRole ? QVariant(QString::number(lastTemperatures[row], 'f', 1))
+                                       : QVariant(lastTemperatures[row]);
+    default: return QVariant();
+    }
+}
+
+/*!
+ * \brief Retrieves the column headers of the table.
+ * \param section = The column (or row) number
+ * \param orientation = The orientation of the header
+ * \param role = The Qt::DisplayRole of the header
+ * \return A QVariant with the header text.
+ */
+QVariant EmployeeTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    switch (section) {
+    case EmployeeTableColumns::ID: return tr("ID");
+    case EmployeeTableColumns::Name: return tr("Name");
+    case EmployeeTableColumns::SurveyCount: return tr("Surveys");
+    case EmployeeTableColumns::LastSeen: return tr("Last Seen");
+    case EmployeeTableColumns::LastTemperature: return tr("Last Temperature (°C)");
+    default: return QVariant();
+    }
+}
+
+/*!
+ * \brief Replaces the employees in the model with the rows of an executed query.
+ * \param query = The executed query with the columns emp_id, name, survey_count, last_date and last_temperature
+ * \note The query should be forward-only, the rows are copied into the model and not kept by the query.
+ */
+void EmployeeTableModel::load(QSqlQuery &query)
+{
+    beginResetModel();
+
+    ids.clear();
+    nameOffsets.assign(1, 0);
+    nameData.clear();
+    surveyCounts.clear();
+    lastDates.clear();
+    lastTemperatures.clear();
+
+    while (query.next()) {
+        ids.push_back(query.value(0).toInt());
+        nameData.append(query.value(1).toString().toUtf8());
+        nameOffsets.push_back(static_cast<quint32>(nameData.size()));
+        surveyCounts.push_back(query.value(2).toInt());
+        lastDates.push_back(static_cast<qint32>(query.value(3).toLongLong()));
+        lastTemperatures.push_back(query.value(4).isNull() ? std::numeric_limits<float>::quiet_NaN()
+                                                           : query.value(4).toFloat());
+    }
+
+    ids.shrink_to_fit();
+    nameOffsets.shrink_to_fit();
+    nameData.squeeze();
+    surveyCounts.shrink_to_fit();
+    lastDates.shrink_to_fit();
+    lastTemperatures.shrink_to_fit();
+
+    endResetModel();
+}
+
+/*!
+ * \brief Retrieves the ID of the employee in a row.
+ * \param row = The row in the table
+ * \return An integer with the employee ID.
+ */
+int EmployeeTableModel::getEmployeeId(const int &row) const
+{
+    return ids[static_cast<size_t>(row)];
+}
+
+/*!
+ * \brief Retrieves the name of the employee in a row.
+ * \param row = The row in the table
+ * \return A QString with the name.
+ */
+QString EmployeeTableModel::getName(const int &row) const
+{
+    quint32 begin(nameOffsets[static_cast<size_t>(row)]);
+    quint32 end(nameOffsets[static_cast<size_t>(row) + 1]);
+
+    return QString::fromUtf8(nameData.constData() + begin, static_cast<qsizetype>(end - begin));
+}
+
+/*!
+ * \brief Retrieves the amount of surveys of the employee in a row.
+ * \param row = The row in the table
+ * \return An integer with the amount of surveys.
+ */
+int EmployeeTableModel::getSurveyCount(const int &row) const
+{
+    return surveyCounts[static_cast<size_t>(row)];
+}
+
+/*!
+ * \brief Retrieves the date of the last survey of the employee in a row.
+ * \param row = The row in the table
+ * \return The QDate of the last survey, or an invalid QDate if the employee has no surveys.
+ */
+QDate EmployeeTableModel::getLastSeen(const int &row) const
+{
+    qint32 lastDate(lastDates[static_cast<size_t>(row)]);
+
+    return lastDate == 0 ? QDate() : QDateTime::fromSecsSinceEpoch(lastDate).date();
+}
+
+/*!
+ * \brief Retrieves the amount of memory used by the model.
+ * \return The size in bytes of the model and its columns.
+ */
+qint64 EmployeeTableModel::getMemoryFootprint() const
 {
+    return static_cast<qint64>(sizeof(*this) +
+                               ids.capacity() * sizeof(qint32) +
+                               nameOffsets.capacity() * sizeof(quint32) +
+                               nameData.capacity() +
+                               surveyCounts.capacity() * sizeof(qint32) +
+                               lastDates.capacity() * sizeof(qint32) +
+                               lastTemperatures.capacity() * sizeof(float));
 }
@@ -1,24 +1,58 @@
 #ifndef EMPLOYEETABLEMODEL_H
 #define EMPLOYEETABLEMODEL_H
 
-#include <QSqlQueryModel>
+#include <QAbstractTableModel>
+#include <QDate>
+#include <vector>
+
+class QSqlQuery;
 
 /*!
  * \brief Enum for the column headers found in the employee table.
  * \note The order in which they appear here is also their order in the table.
  */
 enum EmployeeTableColumns {
-    ID,     ///< 0
-    Name    ///< 1
+    ID,             ///< 0
+    Name,           ///< 1
+    SurveyCount,    ///< 2
+    LastSeen,       ///< 3
+    LastTemperature ///< 4
 };
 
 /*!
  * \brief The model for displaying the employees in the SurveyDatabase in a table.
+ *
+ * The IDs are stored in a packed column and the names as UTF-8 in a single buffer, instead of one record of
+ * QVariants per row. The survey count, last survey date and last temperature come from the EmployeeSummary table.
+ *
+ * The display role formats the values, the edit role returns them unformatted so that views can sort on them.
  */
-class EmployeeTableModel : public QSqlQueryModel
+class EmployeeTableModel : public QAbstractTableModel
 {
+    Q_OBJECT
 public:
     explicit EmployeeTableModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &item, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void load(QSqlQuery &query);
+
+    int getEmployeeId(const int &row) const;
+    QString getName(const int &row) const;
+    int getSurveyCount(const int &row) const;
+    QDate getLastSeen(const int &row) const;
+    qint64 getMemoryFootprint() const;
+
+private:
+    std::vector<qint32> ids;            ///< The employee IDs.
+    std::vector<quint32> nameOffsets;   ///< The offset of every name in nameData, followed by the end of the last name.
+    QByteArray nameData;                ///< The UTF-8 encoded names, one after another.
+    std::vector<qint32> surveyCounts;   ///< The amount of surveys of every employee.
+    std::vector<qint32> lastDates;      ///< The date (unix time) of the last survey, or 0 if there is none.
+    std::vector<float> lastTemperatures;///< The temperature of the last survey, or NaN if there is none.
 };
 
 #endif // EMPLOYEETABLEMODEL_H
@@ -0,0 +1,448 @@
+#include "ingestionserver.h"
+#include "surveydatabase.h"
+#include "questionset.h"
+
+#include <QTcpSocket>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QtDebug>
+
+namespace {
+const int MaxClients(512);              ///< The maximum amount of connected clients.
+const int MaxHeaderSize(8 * 1024);      ///< The maximum size of the headers of a request.
+const qint64 MaxBodySize(1024 * 1024);  ///< The maximum size of the body of a request.
+const int BatchSize(500);               ///< The amount of pending surveys that triggers an immediate write.
+const int FlushInterval(200);           ///< The maximum time (in milliseconds) a survey waits before it is written.
+const int MaxPending(20000);            ///< The amount of pending surveys at which new requests are refused.
+const double MinTemperature(30.0);      ///< The lowest temperature (in degrees Celsius) a tablet may submit.
+const double MaxTemperature(45.0);      ///< The highest temperature (in degrees Celsius) a tablet may submit.
+}
+
+/*!
+ * \brief The constructor for the IngestionServer.
+ * \param db = The database the received surveys are added to
+ * \param parent = The QObject to which this object is bound to
+ */
+IngestionServer::IngestionServer(SurveyDatabase *db, QObject *parent) :
+    QObject(parent),
+    surveyDb(db),
+    server(this),
+    clients(),
+    pending(),
+    flushTimer(this),
+    accessToken(),
+    lastError()
+{
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(FlushInterval);
+
+    connect(&flushTimer, &QTimer::timeout, this, &IngestionServer::flushPending);
+    connect(&server, &QTcpServer::newConnection, this, &IngestionServer::acceptConnections);
+}
+
+/*!
+ * \brief The destructor for the IngestionServer.
+ * \note Any surveys still waiting to be written are written before the server is destroyed.
+ */
+IngestionServer::~IngestionServer()
+{
+    stop();
+}
+
+/*!
+ * \brief Starts listening for tablets.
+ * \param port = The TCP port to listen on
+ * \param address = The address to listen on
+ * \return A boolean value that states whether the server is listening or not.
+ * \note The server refuses to listen on an address other than a loopback address unless an access token is set.
+ */
+bool IngestionServer::start(const quint16 &port, const QHostAddress &address)
+{
+    if (server.isListening())
+        return true;
+
+    lastError.clear();
+
+    if (accessToken.isEmpty() && !address.isLoopback()) {
+        lastError = tr("An access token is required to accept tablets on") + " " + address.toString() + ".";
+        qDebug() << "(Ingest) Error starting server: " << lastError << Qt::endl;
+        return false;
+    }
+
+    if (!server.listen(address, port)) {
+        lastError = server.errorString();
+        qDebug() << "(Ingest) Error starting server: " << lastError << Qt::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Stops listening, disconnects all clients and writes all pending surveys.
+ */
+void IngestionServer::stop()
+{
+    server.close();
+
+    const QList<QTcpSocket *> sockets(clients.keys());
+
+    for (QTcpSocket *socket : sockets) {
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+
+    clients.clear();
+    flushTimer.stop();
+    flushPending();
+}
+
+/*!
+ * \brief Determines if the server is listening for tablets.
+ * \return A boolean value that states whether the server is listening.
+ */
+bool IngestionServer::isListening() const
+{
+    return server.isListening();
+}
+
+/*!
+ * \brief Retrieves the port the server is listening on.
+ * \return The port, or 0 if the server is not listening.
+ */
+quint16 IngestionServer::getPort() const
+{
+    return server.serverPort();
+}
+
+/*!
+ * \brief Retrieves the reason the server could not start.
+ * \return A QString with the error, or an empty string if the server started.
+ */
+QString IngestionServer::getLastError() const
+{
+    return lastError;
+}
+
+/*!
+ * \brief Assigns the token clients must send in the X-CCQ-Token header.
+ * \param token = The access token (an empty token allows all clients)
+ */
+void IngestionServer::setAccessToken(const QString &token)
+{
+    accessToken = token.toUtf8();
+}
+
+/*!
+ * \brief Accepts all waiting connections and stops accepting new ones once the client limit is reached.
+ */
+void IngestionServer::acceptConnections()
+{
+    while (server.hasPendingConnections()) {
+        QTcpSocket *socket(server.nextPendingConnection());
+
+        clients.insert(socket, ClientState());
+
+        connect(socket, &QTcpSocket::readyRead, this, &IngestionServer::readClient);
+        // Queued, so a client is never removed while one of its requests is being handled.
+        connect(socket, &QTcpSocket::disconnected, this, &IngestionServer::clientDisconnected, Qt::QueuedConnection);
+    }
+
+    if (clients.size() >= MaxClients)
+        server.pauseAccepting();
+}
+
+/*!
+ * \brief Reads the data sent by a client and handles every complete request in it.
+ */
+void IngestionServer::readClient()
+{
+    QTcpSocket *socket(qobject_cast<QTcpSocket *>(sender()));
+
+    if (socket == nullptr || !clients.contains(socket))
+        return;
+
+    ClientState &state(clients[socket]);
+    state.buffer.append(socket->readAll());
+
+    while (handleRequest(socket, state)) {}
+}
+
+/*!
+ * \brief Forgets a client after it disconnected and resumes accepting connections if there is room again.
+ */
+void IngestionServer::clientDisconnected()
+{
+    QTcpSocket *socket(qobject_cast<QTcpSocket *>(sender()));
+
+    if (socket == nullptr)
+        return;
+
+    clients.remove(socket);
+    socket->deleteLater();
+
+    if (clients.size() < MaxClients)
+        server.resumeAccepting();
+}
+
+/*!
+ * \brief Writes all pending surveys to the database in a single transaction.
+ * \note If the database is locked the surveys stay pending and are tried again with the next batch.
+ * \note If a survey cannot be written, the batch is written one survey at a time instead, and the surveys that still
+ * fail are dropped and reported with surveysDropped(), so that a single bad survey never blocks the others.
+ */
+void IngestionServer::flushPending()
+{
+    if (pending.isEmpty())
+        return;
+
+    int added(surveyDb->addSurveys(pending));
+
+    // A lock (or open) failure is reported through getLastError() and is worth waiting for.
+    if (added < 0 && !surveyDb->getLastError().isEmpty()) {
+        qDebug() << "(Ingest) Error writing" << pending.size() << "surveys, retrying later." << Qt::endl;
+        flushTimer.start();
+        return;
+    }
+
+    int dropped(0);
+
+    if (added < 0) {
+        added = 0;
+
+        while (!pending.isEmpty()) {
+            int written(surveyDb->addSurveys({pending.first()}));
+
+            if (written < 0 && !surveyDb->getLastError().isEmpty()) {
+                flushTimer.start();
+                break;
+            }
+
+            if (written < 0) {
+                qDebug() << "(Ingest) Dropping survey of employee" << pending.first().getEmployeeId() << "on"
+                         << pending.first().getSurveyDate() << "as it cannot be written." << Qt::endl;
+                ++dropped;
+            } else
+                added += written;
+
+            pending.removeFirst();
+        }
+    } else
+        pending.clear();
+
+    if (added > 0)
+        emit surveysIngested(added);
+
+    if (dropped > 0)
+        emit surveysDropped(dropped);
+}
+
+/*!
+ * \brief Handles the next request in the client's buffer if it has been received completely.
+ * \param socket = The client's socket
+ * \param state = The client's parse state
+ * \return A boolean value that is true if a request was handled and another one may follow in the buffer.
+ */
+bool IngestionServer::handleRequest(QTcpSocket *socket, ClientState &state)
+{
+    if (state.contentLength < 0) {
+        int headerEnd(state.buffer.indexOf("\r\n\r\n"));
+
+        if (headerEnd < 0) {
+            if (state.buffer.size() > MaxHeaderSize) {
+                state.keepAlive = false;
+                sendResponse(socket, state, 431, "Request Header Fields Too Large", "{\"error\":\"headers too large\"}");
+            }
+
+            return false;
+        }
+
+        state.headerLength = headerEnd + 4;
+
+        if (!parseHeaders(state)) {
+            state.keepAlive = false;
+            sendResponse(socket, state, 400, "Bad Request", "{\"error\":\"malformed request\"}");
+            return false;
+        }
+
+        if (state.contentLength > MaxBodySize) {
+            state.keepAlive = false;
+            sendResponse(socket, state, 413, "Payload Too Large", "{\"error\":\"body too large\"}");
+            return false;
+        }
+    }
+
+    if (state.buffer.size() < state.headerLength + state.contentLength)
+        return false;
+
+    QByteArray body(state.buffer.mid(state.headerLength, static_cast<int>(state.contentLength)));
+    state.buffer.remove(0, state.headerLength + static_cast<int>(state.contentLength));
+
+    if (!accessToken.isEmpty() && state.token != accessToken)
+        sendResponse(socket, state, 401, "Unauthorized", "{\"error\":\"invalid token\"}");
+    else if (state.method == "GET" && state.path == "/health")
+        sendResponse(socket, state, 200, "OK", "{\"pending\":" + QByteArray::number(pending.size()) + "}");
+    else if (state.method == "POST" && state.path == "/surveys") {
+        if (pending.size() >= MaxPending) {
+            sendResponse(socket, state, 503, "Service Unavailable", "{\"error\":\"busy\"}", "Retry-After: 1\r\n");
+        } else {
+            int accepted(0);
+            int rejected(0);
+
+            queueSurveys(body, accepted, rejected);
+
+            QByteArray result("{\"accepted\":" + QByteArray::number(accepted) +
+                              ",\"rejected\":" + QByteArray::number(rejected) + "}");
+
+            if (accepted == 0 && rejected > 0)
+                sendResponse(socket, state, 422, "Unprocessable Entity", result);
+            else
+                sendResponse(socket, state, 202, "Accepted", result);
+        }
+    } else
+        sendResponse(socket, state, 404, "Not Found", "{\"error\":\"unknown resource\"}");
+
+    bool keepAlive(state.keepAlive);
+
+    // Reset the state for the next request on this connection.
+    state.contentLength = -1;
+    state.headerLength = 0;
+    state.method.clear();
+    state.path.clear();
+    state.token.clear();
+
+    return keepAlive && !state.buffer.isEmpty();
+}
+
+/*!
+ * \brief Parses the request line and the headers of the current request.
+ * \param state = The client's parse state, with headerLength already set
+ * \return A boolean value that states whether the headers are valid.
+ */
+bool IngestionServer::parseHeaders(ClientState &state)
+{
+    const QList<QByteArray> lines(state.buffer.left(state.headerLength - 4).split('\n'));
+    const QList<QByteArray> requestLine(lines.first().trimmed().split(' '));
+
+    if (requestLine.size() != 3)
+        return false;
+
+    state.method = requestLine[0];
+    state.path = requestLine[1];
+    state.keepAlive = (requestLine[2] == "HTTP/1.1");
+    state.contentLength = 0;
+    state.token.clear();
+
+    for (int i = 1; i < lines.size(); ++i) {
+        int colon(lines[i].indexOf(':'));
+
+        if (colon < 0)
+            continue;
+
+        QByteArray name(lines[i].left(colon).trimmed().toLower());
+        QByteArray value(lines[i].mid(colon + 1).trimmed());
+
+        if (name == "content-length") {
+            bool ok;
+            state.contentLength = value.toLongLong(&ok);
+
+            if (!ok || state.contentLength < 0)
+                return false;
+        } else if (name == "connection")
+            state.keepAlive = (value.toLower() != "close");
+        else if (name == "x-ccq-token")
+            state.token = value;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Sends a JSON response to a client and closes the connection if it should not be kept alive.
+ * \param socket = The client's socket
+ * \param state = The client's parse state
+ * \param status = The HTTP status code
+ * \param reason = The HTTP reason phrase
+ * \param body = The JSON body
+ * \param extraHeaders = Any additional headers, each ending in "\r\n"
+ */
+void IngestionServer::sendResponse(QTcpSocket *socket, const ClientState &state, const int &status,
+                                   const QByteArray &reason, const QByteArray &body, const QByteArray &extraHeaders)
+{
+    QByteArray response("HTTP/1.1 " + QByteArray::number(status) + " " + reason + "\r\n"
+                        "Content-Type: application/json\r\n"
+                        "Content-Length: " + QByteArray::number(body.size()) + "\r\n" +
+                        (state.keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n") +
+                        extraHeaders + "\r\n" + body);
+
+    socket->write(response);
+
+    if (!state.keepAlive)
+        socket->disconnectFromHost();
+}
+
+/*!
+ * \brief Validates the surveys in a request body and adds the valid ones to the pending batch.
+ * \param body = The JSON body of the request
+ * \param accepted = Is increased by the amount of surveys that were queued
+ * \param rejected = Is increased by the amount of surveys that were invalid
+ */
+void IngestionServer::queueSurveys(const QByteArray &body, int &accepted, int &rejected)
+{
+    QJsonParseError parseError;
+    QJsonDocument doc(QJsonDocument::fromJson(body, &parseError));
+
+    if (parseError.error != QJsonParseError::NoError) {
+        ++rejected;
+        return;
+    }
+
+    QJsonArray items;
+
+    if (doc.isArray())
+        items = doc.array();
+    else if (doc.isObject())
+        items.append(doc.object());
+
+    for (const QJsonValue &item : items) {
+        QJsonObject obj(item.toObject());
+        QJsonValue answers(obj.value("answers"));
+        bool answersValid(true);
+
+        Survey survey(QDate::fromString(obj.value("survey_date").toString(), Qt::ISODate),
+                      obj.value("emp_id").toInt(-1),
+                      0,
+                      obj.value("temperature").toDouble());
+
+        if (answers.isArray()) {
+            const QJsonArray answerList(answers.toArray());
+            answersValid = answerList.size() <= QuestionSet::MaxQuestions;
+
+            for (int bit = 0; answersValid && bit < answerList.size(); ++bit)
+                survey.setAnswer(bit, answerList.at(bit).toBool());
+        } else if (answers.isDouble()) {
+            qint64 mask(answers.toInteger(-1));
+            answersValid = (mask >= 0 && mask <= 0xFFFFFFFFLL);
+            survey.setAnswers(static_cast<quint32>(mask));
+        } else
+            answersValid = false;
+
+        double temperature(survey.getTemperature());
+
+        // Unknown employees would fail the foreign key of the whole batch, so they are rejected here.
+        if (answersValid && obj.value("temperature").isDouble() && survey.isValid() &&
+            temperature >= MinTemperature && temperature <= MaxTemperature &&
+            surveyDb->employeeExist(survey.getEmployeeId())) {
+            pending.append(survey);
+            ++accepted;
+        } else
+            ++rejected;
+    }
+
+    if (pending.size() >= BatchSize)
+        flushPending();
+    else if (!pending.isEmpty() && !flushTimer.isActive())
+        flushTimer.start();
+}
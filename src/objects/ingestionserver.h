@@ -0,0 +1,88 @@
+#ifndef INGESTIONSERVER_H
+#define INGESTIONSERVER_H
+
+#include "survey.h"
+
+#include <QObject>
+#include <QTcpServer>
+#include <QHostAddress>
+#include <QHash>
+#include <QTimer>
+
+class QTcpSocket;
+class SurveyDatabase;
+
+/*!
+ * \brief Accepts surveys submitted by entry tablets over HTTP and adds them to the SurveyDatabase in batches.
+ *
+ * Tablets send a POST request to /surveys with a JSON object, or an array of objects, of the form:
+ * {"survey_date": "yyyy-MM-dd", "emp_id": 1, "answers": [false, false, false], "temperature": 36.5}
+ *
+ * The answers are either an array with an answer per question bit (see QuestionSet), or the answers bitmask itself.
+ *
+ * Every survey is validated with Survey::isValid() before it is queued, and must belong to an existing employee and
+ * have a plausible temperature. Queued surveys are written in a single transaction whenever the batch is full or the
+ * flush timer fires. A survey that still cannot be written is dropped and reported, instead of blocking the batch.
+ * All sockets are handled asynchronously by the event loop, so the GUI never waits on a client.
+ *
+ * Without an access token the server only listens on a loopback address, as anyone on the network could add surveys.
+ *
+ * When too many surveys are waiting to be written, new requests are answered with "503 Service Unavailable" and a
+ * Retry-After header. When too many clients are connected, new connections are not accepted until one closes.
+ */
+class IngestionServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit IngestionServer(SurveyDatabase *db, QObject *parent = nullptr);
+    ~IngestionServer();
+
+    bool start(const quint16 &port, const QHostAddress &address = QHostAddress::LocalHost);
+    void stop();
+    bool isListening() const;
+    quint16 getPort() const;
+    QString getLastError() const;
+
+    void setAccessToken(const QString &token);
+
+signals:
+    void surveysIngested(const int &count);
+    void surveysDropped(const int &count);
+
+private slots:
+    void acceptConnections();
+    void readClient();
+    void clientDisconnected();
+    void flushPending();
+
+private:
+    /*!
+     * \brief The parse state of a single client connection.
+     */
+    struct ClientState
+    {
+        QByteArray buffer;          ///< The bytes received but not yet handled.
+        qint64 contentLength = -1;  ///< The length of the body of the current request, or -1 if its headers are not parsed yet.
+        int headerLength = 0;       ///< The length of the headers of the current request.
+        QByteArray method;          ///< The method of the current request.
+        QByteArray path;            ///< The path of the current request.
+        QByteArray token;           ///< The access token sent with the current request.
+        bool keepAlive = true;      ///< Should the connection stay open after the response?
+    };
+
+    SurveyDatabase *surveyDb;               ///< The database the surveys are added to.
+    QTcpServer server;                      ///< The server listening for tablets.
+    QHash<QTcpSocket *, ClientState> clients; ///< The parse state of every connected client.
+    QList<Survey> pending;                  ///< The validated surveys waiting to be written.
+    QTimer flushTimer;                      ///< Writes the pending surveys if the batch does not fill up in time.
+    QByteArray accessToken;                 ///< The token clients must send in the X-CCQ-Token header (empty to allow all).
+    QString lastError;                      ///< The reason the server could not start, if it did not.
+
+    bool handleRequest(QTcpSocket *socket, ClientState &state);
+    bool parseHeaders(ClientState &state);
+    void sendResponse(QTcpSocket *socket, const ClientState &state, const int &status,
+                      const QByteArray &reason, const QByteArray &body, const QByteArray &extraHeaders = QByteArray());
+    void queueSurveys(const QByteArray &body, int &accepted, int &rejected);
+};
+
+#endif // INGESTIONSERVER_H
@@ -0,0 +1,183 @@
+#include "profilebenchmark.h"
+#include "surveydatabase.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+const int BatchSize(500);   ///< The amount of surveys per batch, the same as the ingestion server writes.
+}
+
+/*!
+ * \brief The constructor for the ProfileBenchmark.
+ * \param employees = The amount of employees the surveys are spread over
+ * \param singleInserts = The amount of surveys added one transaction at a time
+ * \param batchInserts = The amount of surveys added in batches
+ */
+ProfileBenchmark::ProfileBenchmark(const int &employees, const int &singleInserts, const int &batchInserts) :
+    employees(qMax(1, employees)),
+    singleInserts(singleInserts),
+    batchInserts(batchInserts)
+{
+}
+
+/*!
+ * \brief Runs the benchmark for a single profile.
+ * \param profile = The profile to measure
+ * \param directory = The directory the temporary database is created in
+ * \return The ProfileResult with the measurements, or with an error if the database could not be used.
+ * \note The database file is removed again afterwards.
+ */
+ProfileResult ProfileBenchmark::run(const DurabilityProfile &profile, const QString &directory) const
+{
+    ProfileResult result;
+    result.profile = profile.name;
+
+    QString location(directory + "/benchmark-" + profile.name + ".data");
+    QFile::remove(location);
+
+    {
+        SurveyDatabase surveyDb;
+        surveyDb.setDurabilityProfile(profile);
+
+        if (!surveyDb.createDatabase(location)) {
+            result.error = "Could not create the database.";
+            return result;
+        }
+
+        result.journalMode = surveyDb.getJournalMode();
+
+        QStringList names;
+
+        for (int i = 0; i < employees; ++i)
+            names.append("Employee " + QString::number(i + 1));
+
+        if (surveyDb.addEmployees(names) != employees) {
+            result.error = "Could not add the employees.";
+            return result;
+        }
+
+        // SQLite starts numbering the employees at 1, and every survey date is a new day.
+        QDate firstDate(QDate::currentDate().addYears(-10));
+        int surveyIndex(0);
+
+        auto nextSurvey = [&]() -> Survey {
+            int empId(surveyIndex % employees + 1);
+            QDate date(firstDate.addDays(surveyIndex / employees));
+            ++surveyIndex;
+
+            return Survey(date, empId, static_cast<quint32>(surveyIndex % 8), 36.0 + (surveyIndex % 20) / 10.0);
+        };
+
+        QList<double> insertLatencies;
+        QElapsedTimer timer;
+        QElapsedTimer totalTimer;
+
+        totalTimer.start();
+
+        for (int i = 0; i < singleInserts; ++i) {
+            Survey survey(nextSurvey());
+
+            timer.start();
+
+            if (!surveyDb.addSurvey(survey)) {
+                result.error = "Could not add a survey.";
+                return result;
+            }
+
+            insertLatencies.append(timer.nsecsElapsed() / 1000000.0);
+        }
+
+        if (singleInserts > 0) {
+            result.insertsPerSec = singleInserts / (totalTimer.nsecsElapsed() / 1000000000.0);
+            result.insertP50Ms = percentile(insertLatencies, 0.50);
+            result.insertP99Ms = percentile(insertLatencies, 0.99);
+        }
+
+        totalTimer.start();
+
+        for (int added = 0; added < batchInserts; added += BatchSize) {
+            QList<Survey> batch;
+
+            for (int i = 0; i < qMin(BatchSize, batchInserts - added); ++i)
+                batch.append(nextSurvey());
+
+            if (surveyDb.addSurveys(batch) < 0) {
+                result.error = "Could not add a batch of surveys.";
+                return result;
+            }
+        }
+
+        if (batchInserts > 0)
+            result.batchPerSec = batchInserts / (totalTimer.nsecsElapsed() / 1000000000.0);
+
+        QList<double> readLatencies;
+
+        for (int empId = 1; empId <= employees; ++empId) {
+            surveyDb.setCurrentEmployeeId(empId);
+
+            timer.start();
+            surveyDb.updateSurveyTableModel();
+            readLatencies.append(timer.nsecsElapsed() / 1000000.0);
+        }
+
+        result.readP50Ms = percentile(readLatencies, 0.50);
+    }
+
+    QFile::remove(location);
+    QFile::remove(location + "-wal");
+    QFile::remove(location + "-shm");
+    QFile::remove(location + "-journal");
+
+    return result;
+}
+
+/*!
+ * \brief Formats the results of the benchmark as a readable text table.
+ * \param results = The results to report
+ * \return A QString with one row per profile.
+ */
+QString ProfileBenchmark::formatReport(const QList<ProfileResult> &results)
+{
+    QString report(QString("%1 %2 %3 %4 %5 %6 %7\n")
+                   .arg("profile", -10).arg("journal", -8)
+                   .arg("insert p50", 11).arg("insert p99", 11).arg("inserts/s", 10)
+                   .arg("batch/s", 10).arg("read p50", 10));
+
+    for (const ProfileResult &result : results) {
+        if (!result.error.isEmpty()) {
+            report += QString("%1 %2\n").arg(result.profile, -10).arg(result.error);
+            continue;
+        }
+
+        report += QString("%1 %2 %3 %4 %5 %6 %7\n")
+                .arg(result.profile, -10).arg(result.journalMode, -8)
+                .arg(QString::number(result.insertP50Ms, 'f', 3) + "ms", 11)
+                .arg(QString::number(result.insertP99Ms, 'f', 3) + "ms", 11)
+                .arg(QString::number(result.insertsPerSec, 'f', 0), 10)
+                .arg(QString::number(result.batchPerSec, 'f', 0), 10)
+                .arg(QString::number(result.readP50Ms, 'f', 3) + "ms", 10);
+    }
+
+    return report;
+}
+
+/*!
+ * \brief Calculates a percentile of a list of samples (nearest rank).
+ * \param samples = The samples
+ * \param fraction = The percentile as a fraction between 0 and 1
+ * \return A double with the sample at the percentile, or 0 if there are no samples.
+ */
+double ProfileBenchmark::percentile(QList<double> samples, const double &fraction)
+{
+    if (samples.isEmpty())
+        return 0;
+
+    std::sort(samples.begin(), samples.end());
+
+    int rank(qBound(0, qCeil(fraction * samples.size()) - 1, static_cast<int>(samples.size()) - 1));
+
+    return samples.at(rank);
+}
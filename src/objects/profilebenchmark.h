@@ -0,0 +1,45 @@
+#ifndef PROFILEBENCHMARK_H
+#define PROFILEBENCHMARK_H
+
+#include "durabilityprofile.h"
+
+#include <QList>
+
+/*!
+ * \brief The measurements of a single durability profile.
+ */
+struct ProfileResult
+{
+    QString profile;            ///< The name of the profile.
+    QString journalMode;        ///< The journal mode the database actually ran in.
+    QString error;              ///< The error if the benchmark could not run, otherwise empty.
+    double insertP50Ms = 0;     ///< The median latency (in milliseconds) of adding a single survey.
+    double insertP99Ms = 0;     ///< The 99th percentile latency (in milliseconds) of adding a single survey.
+    double insertsPerSec = 0;   ///< The throughput of adding surveys one transaction at a time.
+    double batchPerSec = 0;     ///< The throughput of adding surveys in batches, as the ingestion server does.
+    double readP50Ms = 0;       ///< The median latency (in milliseconds) of loading the surveys of one employee.
+};
+
+/*!
+ * \brief Measures the write throughput and latency of every durability profile on a temporary database.
+ *
+ * Every profile gets a fresh database in the same temporary directory, so the results only differ by the
+ * PRAGMA settings. Run it on the disk the real database is stored on, the results depend heavily on it.
+ */
+class ProfileBenchmark
+{
+public:
+    ProfileBenchmark(const int &employees = 50, const int &singleInserts = 500, const int &batchInserts = 10000);
+
+    ProfileResult run(const DurabilityProfile &profile, const QString &directory) const;
+    static QString formatReport(const QList<ProfileResult> &results);
+
+private:
+    int employees;      ///< The amount of employees the surveys are spread over.
+    int singleInserts;  ///< The amount of surveys added one transaction at a time.
+    int batchInserts;   ///< The amount of surveys added in batches.
+
+    static double percentile(QList<double> samples, const double &fraction);
+};
+
+#endif // PROFILEBENCHMARK_H
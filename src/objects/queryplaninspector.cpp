@@ -0,0 +1,237 @@
+#include "queryplaninspector.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QRegularExpression>
+#include <QHash>
+#include <QSet>
+
+/*!
+ * \brief The constructor for the QueryPlanInspector.
+ * \param db = The open database the statements are explained against
+ */
+QueryPlanInspector::QueryPlanInspector(const QSqlDatabase &db) :
+    database(db)
+{
+}
+
+/*!
+ * \brief Explains a statement and flags full table scans and temporary B-tree sorts.
+ * \param sql = The statement to explain, with named (:name) or positional (?) placeholders
+ * \param expected = Is a full scan or sort intended for this statement? Such plans are not reported as issues.
+ * \return The QueryPlan of the statement.
+ * \note Every placeholder is bound to NULL. Only the plan is retrieved, the statement itself is never run.
+ */
+QueryPlan QueryPlanInspector::explain(const QString &sql, const bool &expected) const
+{
+    static const QRegularExpression placeholderExp(":(\\w+)");
+    static const QStringList nonTables({"SUBQUERY", "CONSTANT", "CO-ROUTINE"});
+
+    QueryPlan plan;
+    plan.sql = sql.simplified();
+    plan.expected = expected;
+
+    QString statement(plan.sql);
+
+    if (statement.endsWith(';'))
+        statement.chop(1);
+
+    QSqlQuery planQry(database);
+
+    if (!planQry.prepare("EXPLAIN QUERY PLAN " + statement)) {
+        plan.error = planQry.lastError().text();
+        return plan;
+    }
+
+    QSet<QString> placeholders;
+    QRegularExpressionMatchIterator matches(placeholderExp.globalMatch(statement));
+
+    while (matches.hasNext())
+        placeholders.insert(":" + matches.next().captured(1));
+
+    for (const QString &placeholder : placeholders)
+        planQry.bindValue(placeholder, QVariant());
+
+    for (int i = 0; i < statement.count('?'); ++i)
+        planQry.addBindValue(QVariant());
+
+    if (!planQry.exec()) {
+        plan.error = planQry.lastError().text();
+        return plan;
+    }
+
+    QString scannedTable;
+
+    while (planQry.next()) {
+        // The columns are: id, parent, notused, detail.
+        QString detail(planQry.value(3).toString());
+        plan.details.append(detail);
+
+        if (detail.startsWith("SCAN ") && !detail.contains("USING INDEX") &&
+                !detail.contains("USING COVERING INDEX") && !detail.contains("USING INTEGER PRIMARY KEY")) {
+            QString table(detail.section(' ', 1, 1));
+
+            // Older SQLite versions report "SCAN TABLE <name>".
+            if (table == "TABLE")
+                table = detail.section(' ', 2, 2);
+
+            if (!nonTables.contains(table)) {
+                plan.fullScan = true;
+
+                if (scannedTable.isEmpty())
+                    scannedTable = table;
+            }
+        }
+
+        if (detail.contains("USE TEMP B-TREE"))
+            plan.tempBTree = true;
+    }
+
+    if (plan.expected)
+        return plan;
+
+    if (plan.fullScan)
+        plan.suggestedIndex = suggestIndex(statement, scannedTable, plan.tempBTree);
+    else if (plan.tempBTree) {
+        static const QRegularExpression fromExp("\\bFROM\\s+(\\w+)", QRegularExpression::CaseInsensitiveOption);
+        plan.suggestedIndex = suggestIndex(statement, fromExp.match(statement).captured(1), true);
+    }
+
+    return plan;
+}
+
+/*!
+ * \brief Formats a list of query plans as a readable text report.
+ * \param plans = The plans to report
+ * \return A QString with one section per plan, the plans with issues first.
+ */
+QString QueryPlanInspector::formatReport(const QList<QueryPlan> &plans)
+{
+    QString report;
+
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const QueryPlan &plan : plans) {
+            // Plans with issues are reported in the first pass.
+            if ((pass == 0) != (plan.hasIssues() || !plan.error.isEmpty()))
+                continue;
+
+            QString status("[OK]");
+
+            if (!plan.error.isEmpty())
+                status = "[ERROR]";
+            else if (plan.expected && (plan.fullScan || plan.tempBTree))
+                status = "[EXPECTED]";
+            else if (plan.fullScan)
+                status = "[FULL SCAN]";
+            else if (plan.tempBTree)
+                status = "[TEMP B-TREE]";
+
+            report += status + " " + plan.sql + "\n";
+
+            for (const QString &detail : plan.details)
+                report += "    " + detail + "\n";
+
+            if (!plan.error.isEmpty())
+                report += "    " + plan.error + "\n";
+
+            if (!plan.suggestedIndex.isEmpty())
+                report += "    Suggested: " + plan.suggestedIndex + "\n";
+
+            report += "\n";
+        }
+    }
+
+    return report;
+}
+
+/*!
+ * \brief Suggests an index for a table that is scanned or sorted by a statement.
+ * \param sql = The statement
+ * \param table = The name or alias of the table as reported in the plan
+ * \param includeOrdering = Should the ORDER BY or GROUP BY columns be added to the index?
+ * \return A CREATE INDEX statement, or an empty string if no useful columns were found.
+ */
+QString QueryPlanInspector::suggestIndex(const QString &sql, const QString &table, const bool &includeOrdering) const
+{
+    static const QRegularExpression tableExp("\\b(?:FROM|JOIN)\\s+(\\w+)(?:\\s+(?:AS\\s+)?(\\w+))?",
+                                             QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression comparisonExp("(?:(\\w+)\\.)?(\\w+)\\s*(=|<=|>=|<|>|\\bIN\\b|\\bBETWEEN\\b)",
+                                                  QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression orderingExp("\\b(?:ORDER|GROUP)\\s+BY\\s+(.+?)(?:\\bLIMIT\\b|\\bHAVING\\b|$)",
+                                                QRegularExpression::CaseInsensitiveOption);
+    static const QStringList keywords({"WHERE", "ON", "JOIN", "LEFT", "INNER", "CROSS", "ORDER", "GROUP", "LIMIT", "USING", "SET"});
+
+    // Map every alias to its table.
+    QHash<QString, QString> tables;
+    QRegularExpressionMatchIterator tableMatches(tableExp.globalMatch(sql));
+
+    while (tableMatches.hasNext()) {
+        QRegularExpressionMatch match(tableMatches.next());
+        tables.insert(match.captured(1), match.captured(1));
+
+        if (!match.captured(2).isEmpty() && !keywords.contains(match.captured(2).toUpper()))
+            tables.insert(match.captured(2), match.captured(1));
+    }
+
+    QString tableName(tables.value(table, table));
+
+    // Columns without a qualifier are assumed to belong to the table if the statement only uses one table.
+    auto belongsToTable = [&](const QString &qualifier) -> bool {
+        if (qualifier.isEmpty())
+            return QSet<QString>(tables.cbegin(), tables.cend()).size() <= 1;
+
+        return tables.value(qualifier) == tableName;
+    };
+
+    QStringList equalityColumns;
+    QStringList rangeColumns;
+    QString filter(sql);
+
+    filter.remove(orderingExp);
+
+    int fromIndex(filter.indexOf(QRegularExpression("\\bFROM\\b", QRegularExpression::CaseInsensitiveOption)));
+    QRegularExpressionMatchIterator comparisons(comparisonExp.globalMatch(filter, qMax(0, fromIndex)));
+
+    while (comparisons.hasNext()) {
+        QRegularExpressionMatch match(comparisons.next());
+        QString column(match.captured(2));
+
+        if (!belongsToTable(match.captured(1)) || keywords.contains(column.toUpper()))
+            continue;
+
+        if (match.captured(3) == "=" || match.captured(3).toUpper() == "IN") {
+            if (!equalityColumns.contains(column))
+                equalityColumns.append(column);
+        } else if (!rangeColumns.contains(column))
+            rangeColumns.append(column);
+    }
+
+    QStringList columns(equalityColumns);
+
+    // Only the first range column can use the index.
+    if (!rangeColumns.isEmpty() && !columns.contains(rangeColumns.first()))
+        columns.append(rangeColumns.first());
+
+    if (includeOrdering) {
+        const QStringList orderTerms(orderingExp.match(sql).captured(1).remove(';').split(',', Qt::SkipEmptyParts));
+
+        for (const QString &term : orderTerms) {
+            QString column(term.simplified().section(' ', 0, 0));
+            QString qualifier;
+
+            if (column.contains('.')) {
+                qualifier = column.section('.', 0, 0);
+                column = column.section('.', 1, 1);
+            }
+
+            if (belongsToTable(qualifier) && !columns.contains(column))
+                columns.append(column);
+        }
+    }
+
+    if (columns.isEmpty())
+        return QString();
+
+    return "CREATE INDEX IF NOT EXISTS idx_" + tableName.toLower() + "_" + columns.join('_') +
+            " ON " + tableName + "(" + columns.join(", ") + ");";
+}
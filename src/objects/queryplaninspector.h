@@ -0,0 +1,43 @@
+#ifndef QUERYPLANINSPECTOR_H
+#define QUERYPLANINSPECTOR_H
+
+#include <QSqlDatabase>
+#include <QStringList>
+
+/*!
+ * \brief The query plan of a single SQL statement, as reported by EXPLAIN QUERY PLAN.
+ */
+struct QueryPlan
+{
+    QString sql;            ///< The statement that was explained.
+    QStringList details;    ///< The detail column of every step in the plan.
+    QString error;          ///< The error if the statement could not be explained, otherwise empty.
+    bool fullScan = false;  ///< Does the plan scan a whole table without an index?
+    bool tempBTree = false; ///< Does the plan build a temporary B-tree to sort or group?
+    QString suggestedIndex; ///< A CREATE INDEX statement that would avoid the scan or sort, or empty if there is none.
+    bool expected = false;  ///< Is the scan or sort intended, e.g. because the statement reads every row of a small table?
+
+    bool hasIssues() const { return (fullScan || tempBTree) && !expected; }
+};
+
+/*!
+ * \brief Explains SQL statements with EXPLAIN QUERY PLAN and suggests indexes for full scans and sorts.
+ *
+ * Index suggestions are heuristic: the columns compared in the WHERE clause of the scanned table come first
+ * (equality before ranges), followed by the ORDER BY or GROUP BY columns when the plan builds a temporary B-tree.
+ */
+class QueryPlanInspector
+{
+public:
+    explicit QueryPlanInspector(const QSqlDatabase &db);
+
+    QueryPlan explain(const QString &sql, const bool &expected = false) const;
+    static QString formatReport(const QList<QueryPlan> &plans);
+
+private:
+    QSqlDatabase database;  ///< The open database the statements are explained against.
+
+    QString suggestIndex(const QString &sql, const QString &table, const bool &includeOrdering) const;
+};
+
+#endif // QUERYPLANINSPECTOR_H
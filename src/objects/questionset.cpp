@@ -0,0 +1,147 @@
+#include "questionset.h"
+
+#include <QTextDocumentFragment>
+
+#include <algorithm>
+
+/*!
+ * \brief The default constructor for a question set without any questions.
+ */
+QuestionSet::QuestionSet() :
+    questions()
+{
+}
+
+/*!
+ * \brief Constructor that assigns the questions of the set.
+ * \param questions = The questions, in any order
+ */
+QuestionSet::QuestionSet(const QList<Question> &questions) :
+    questions(questions)
+{
+    std::sort(this->questions.begin(), this->questions.end(), [](const Question &a, const Question &b) {
+        return a.bit < b.bit;
+    });
+}
+
+/*!
+ * \brief Retrieves all questions, including the retired ones.
+ * \return A QList with the questions, ordered by bit.
+ */
+QList<Question> QuestionSet::getQuestions() const
+{
+    return questions;
+}
+
+/*!
+ * \brief Retrieves the questions that are still asked.
+ * \return A QList with the active questions, ordered by bit.
+ */
+QList<Question> QuestionSet::getActiveQuestions() const
+{
+    QList<Question> active;
+
+    for (const Question &question : questions) {
+        if (question.active)
+            active.append(question);
+    }
+
+    return active;
+}
+
+/*!
+ * \brief Retrieves the amount of questions, including the retired ones.
+ * \return An integer with the amount of questions.
+ */
+int QuestionSet::size() const
+{
+    return questions.size();
+}
+
+/*!
+ * \brief Retrieves the bits of all questions that are still asked.
+ * \return A bitmask with the bit of every active question set.
+ */
+quint32 QuestionSet::getActiveMask() const
+{
+    quint32 mask(0);
+
+    for (const Question &question : questions) {
+        if (question.active)
+            mask |= getMask(question.bit);
+    }
+
+    return mask;
+}
+
+/*!
+ * \brief Finds the lowest bit that has never been assigned to a question.
+ * \return An integer with the bit, or -1 if all bits are in use.
+ */
+int QuestionSet::getFreeBit() const
+{
+    quint32 used(0);
+
+    for (const Question &question : questions)
+        used |= getMask(question.bit);
+
+    for (int bit = 0; bit < MaxQuestions; ++bit) {
+        if (!(used & getMask(bit)))
+            return bit;
+    }
+
+    return -1;
+}
+
+/*!
+ * \brief Converts the rich text of a question to plain text.
+ * \param text = The rich text of the question
+ * \return A QString with the plain text on a single line.
+ */
+QString QuestionSet::getPlainText(const QString &text)
+{
+    return QTextDocumentFragment::fromHtml(text).toPlainText().simplified();
+}
+
+/*!
+ * \brief Retrieves the bitmask of a single question.
+ * \param bit = The bit of the question
+ * \return A bitmask with only the bit of the question set, or 0 if the bit is out of range.
+ */
+quint32 QuestionSet::getMask(const int &bit)
+{
+    return (bit >= 0 && bit < MaxQuestions) ? (quint32(1) << bit) : 0;
+}
+
+/*!
+ * \brief Determines if a question was answered "Yes".
+ * \param answers = The answers bitmask of the survey
+ * \param bit = The bit of the question
+ * \return A boolean value that is true if the answer is "Yes".
+ */
+bool QuestionSet::isYes(const quint32 &answers, const int &bit)
+{
+    return (answers & getMask(bit)) != 0;
+}
+
+/*!
+ * \brief Determines if any of the given questions was answered "Yes".
+ * \param answers = The answers bitmask of the survey
+ * \param mask = The bits of the questions to check
+ * \return A boolean value that is true if at least one of the questions was answered "Yes".
+ */
+bool QuestionSet::anyYes(const quint32 &answers, const quint32 &mask)
+{
+    return (answers & mask) != 0;
+}
+
+/*!
+ * \brief Determines if all of the given questions were answered "Yes".
+ * \param answers = The answers bitmask of the survey
+ * \param mask = The bits of the questions to check
+ * \return A boolean value that is true if every one of the questions was answered "Yes".
+ */
+bool QuestionSet::allYes(const quint32 &answers, const quint32 &mask)
+{
+    return (answers & mask) == mask;
+}
@@ -0,0 +1,48 @@
+#ifndef QUESTIONSET_H
+#define QUESTIONSET_H
+
+#include <QList>
+#include <QString>
+
+/*!
+ * \brief A single yes/no question of the survey.
+ */
+struct Question
+{
+    int bit = -1;           ///< The bit of the answers bitmask that holds the answer to this question.
+    QString text;           ///< The question as rich text.
+    bool active = true;     ///< Is the question still asked? Answers to retired questions are kept.
+};
+
+/*!
+ * \brief The questions of the survey, as defined in the database.
+ *
+ * The answers of a survey are stored as a single bitmask, bit N being set if question N was answered "Yes".
+ * Every question keeps its bit once assigned, even after it is retired, so old answers never change meaning.
+ * Filters such as "any yes" are evaluated with bit operations on the mask.
+ */
+class QuestionSet
+{
+public:
+    static const int MaxQuestions = 32;     ///< The amount of bits in the answers bitmask.
+
+    QuestionSet();
+    explicit QuestionSet(const QList<Question> &questions);
+
+    QList<Question> getQuestions() const;
+    QList<Question> getActiveQuestions() const;
+    int size() const;
+    quint32 getActiveMask() const;
+    int getFreeBit() const;
+
+    static QString getPlainText(const QString &text);
+    static quint32 getMask(const int &bit);
+    static bool isYes(const quint32 &answers, const int &bit);
+    static bool anyYes(const quint32 &answers, const quint32 &mask);
+    static bool allYes(const quint32 &answers, const quint32 &mask);
+
+private:
+    QList<Question> questions;  ///< All questions, ordered by bit.
+};
+
+#endif // QUESTIONSET_H
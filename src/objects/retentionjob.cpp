@@ -0,0 +1,289 @@
+#include "retentionjob.h"
+#include "surveydatabase.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtDebug>
+
+namespace {
+const int InitialBatchSize(500);    ///< The amount of surveys deleted in the first batch.
+const int MinBatchSize(50);         ///< The smallest batch the job will shrink to.
+const int MaxBatchSize(20000);      ///< The largest batch the job will grow to.
+const int StepInterval(25);         ///< The time (in milliseconds) left for user operations between two batches.
+const int VacuumPagesPerStep(256);  ///< The amount of free pages released per vacuum step.
+const int LockRetryInterval(250);   ///< The time (in milliseconds) before a step that found the database locked is tried again.
+const int MaxLockRetries(40);       ///< The amount of times in a row a step is tried again before the job gives up.
+}
+
+/*!
+ * \brief The constructor for the RetentionJob.
+ * \param db = The database from which expired surveys are purged
+ * \param parent = The QObject to which this object is bound to
+ */
+RetentionJob::RetentionJob(SurveyDatabase *db, QObject *parent) :
+    QObject(parent),
+    surveyDb(db),
+    batchTimer(this),
+    cutoffDate(QDate()),
+    report(),
+    batchSize(InitialBatchSize),
+    timeBudgetMs(50),
+    vacuuming(false),
+    running(false),
+    lockRetries(0),
+    compactThread(nullptr)
+{
+    batchTimer.setSingleShot(true);
+    batchTimer.setInterval(StepInterval);
+
+    connect(&batchTimer, &QTimer::timeout, this, &RetentionJob::runStep);
+}
+
+/*!
+ * \brief The destructor for the RetentionJob.
+ * \note A running compaction cannot be interrupted, its thread is waited for.
+ */
+RetentionJob::~RetentionJob()
+{
+    if (compactThread != nullptr) {
+        compactThread->wait();
+        delete compactThread;
+    }
+}
+
+/*!
+ * \brief Starts purging all surveys that are older than the given amount of days.
+ * \param retentionDays = The amount of days a survey is kept
+ * \return A boolean value that states whether the job was started or not.
+ * \note The job will not start if it is already running.
+ * \note The free pages are only released if the database uses incremental auto vacuum, otherwise the report states that
+ * the vacuum was skipped. Switching the database over is left to compact().
+ * \note The job will not start while the database is being compacted.
+ */
+bool RetentionJob::start(const int &retentionDays)
+{
+    if (running || compactThread != nullptr || retentionDays < 0)
+        return false;
+
+    cutoffDate = QDate::currentDate().addDays(-retentionDays);
+    report = RetentionReport();
+    report.vacuumSkipped = !surveyDb->isIncrementalVacuum();
+    batchSize = InitialBatchSize;
+    vacuuming = false;
+    running = true;
+    lockRetries = 0;
+
+    batchTimer.start();
+    return true;
+}
+
+/*!
+ * \brief Stops the job after the current batch.
+ * \note The surveys purged so far stay deleted. The finished() signal is still emitted with the partial totals.
+ */
+void RetentionJob::cancel()
+{
+    if (running) {
+        batchTimer.stop();
+        finish();
+    }
+}
+
+/*!
+ * \brief Determines if the job is currently running.
+ * \return A boolean value that states whether the job is running.
+ */
+bool RetentionJob::isRunning() const
+{
+    return running;
+}
+
+/*!
+ * \brief Switches the database to incremental auto vacuum in the background, so the next jobs can release free pages.
+ * \return A boolean value that is false if the job or another compaction is running, or the database only lives in memory.
+ * \note The rebuild runs SurveyDatabase::enableIncrementalVacuum() on a SurveyDatabase of its own, so the thread that
+ * started it keeps handling user input. The database is locked until compacted() is emitted, writes on other
+ * connections report the lock through SurveyDatabase::isLockBusy() in the meantime.
+ */
+bool RetentionJob::compact()
+{
+    // A database in memory cannot be reached from another connection.
+    if (running || compactThread != nullptr || surveyDb->isInMemory())
+        return false;
+
+    QString location(surveyDb->getDatabaseLocation());
+    DurabilityProfile profile(surveyDb->getDurabilityProfile());
+
+    compactThread = QThread::create([this, location, profile]() {
+        bool success(false);
+        QString error;
+
+        // A connection can only be used by the thread that created it.
+        {
+            SurveyDatabase db;
+            db.setDurabilityProfile(profile);
+
+            success = db.createDatabase(location) && db.enableIncrementalVacuum();
+            error = db.getLastError();
+        }
+
+        QMetaObject::invokeMethod(this, [this, success, error]() {
+            compactThread->wait();
+            delete compactThread;
+            compactThread = nullptr;
+
+            emit compacted(success, error);
+        }, Qt::QueuedConnection);
+    });
+
+    compactThread->start(QThread::LowPriority);
+    return true;
+}
+
+/*!
+ * \brief Determines if the database is being compacted.
+ * \return A boolean value that states whether a compaction is running.
+ */
+bool RetentionJob::isCompacting() const
+{
+    return compactThread != nullptr;
+}
+
+/*!
+ * \brief Assigns the maximum time a single batch may hold the database lock.
+ * \param ms = The time budget in milliseconds
+ * \note Values smaller than 1 are ignored.
+ */
+void RetentionJob::setTimeBudget(const int &ms)
+{
+    if (ms > 0)
+        timeBudgetMs = ms;
+}
+
+/*!
+ * \brief Retrieves the maximum time a single batch may hold the database lock.
+ * \return An integer with the time budget in milliseconds.
+ */
+int RetentionJob::getTimeBudget() const
+{
+    return timeBudgetMs;
+}
+
+/*!
+ * \brief Runs the next step of the job whenever the batch timer fires.
+ */
+void RetentionJob::runStep()
+{
+    if (!running)
+        return;
+
+    // A retry after a lock waits longer, every other step only leaves room for user input.
+    batchTimer.setInterval(StepInterval);
+
+    if (vacuuming)
+        vacuumStep();
+    else
+        purgeBatch();
+}
+
+/*!
+ * \brief Deletes the next batch of expired surveys and adapts the batch size to the time budget.
+ */
+void RetentionJob::purgeBatch()
+{
+    int requestedRows(batchSize);
+
+    QElapsedTimer lockTimer;
+    lockTimer.start();
+
+    int rowsDeleted(surveyDb->purgeSurveys(cutoffDate, requestedRows));
+
+    double elapsedMs(lockTimer.nsecsElapsed() / 1000000.0);
+
+    if (rowsDeleted < 0) {
+        if (retryWhileLocked())
+            return;
+
+        qDebug() << "(Retention) Purge stopped after" << report.rowsPurged << "surveys." << Qt::endl;
+        finish();
+        return;
+    }
+
+    lockRetries = 0;
+
+    report.rowsPurged += rowsDeleted;
+    report.maxLockHoldMs = qMax(report.maxLockHoldMs, elapsedMs);
+    ++report.batches;
+
+    emit progress(report.rowsPurged);
+
+    // Keep each batch within the time budget.
+    if (elapsedMs > timeBudgetMs)
+        batchSize = qMax(MinBatchSize, batchSize / 2);
+    else if (elapsedMs < timeBudgetMs / 2.0)
+        batchSize = qMin(MaxBatchSize, batchSize * 2);
+
+    // A short batch means there is nothing left to delete.
+    if (rowsDeleted < requestedRows) {
+        if (report.vacuumSkipped) {
+            finish();
+            return;
+        }
+
+        vacuuming = true;
+    }
+
+    batchTimer.start();
+}
+
+/*!
+ * \brief Releases the next few free pages to the file system.
+ */
+void RetentionJob::vacuumStep()
+{
+    QElapsedTimer lockTimer;
+    lockTimer.start();
+
+    qint64 bytesReclaimed(surveyDb->reclaimFreePages(VacuumPagesPerStep));
+
+    report.maxLockHoldMs = qMax(report.maxLockHoldMs, lockTimer.nsecsElapsed() / 1000000.0);
+
+    if (bytesReclaimed < 0 && retryWhileLocked())
+        return;
+
+    lockRetries = 0;
+
+    if (bytesReclaimed > 0)
+        report.bytesReclaimed += bytesReclaimed;
+
+    if (bytesReclaimed <= 0 || surveyDb->getFreePageCount() <= 0)
+        finish();
+    else
+        batchTimer.start();
+}
+
+/*!
+ * \brief Schedules the current step again if it failed because another workstation held the write lock.
+ * \return A boolean value that is true if the step was scheduled again, false if the job should stop.
+ * \note The main thread only waits briefly for the lock, so the job waits between tries on the event loop instead.
+ */
+bool RetentionJob::retryWhileLocked()
+{
+    if (!surveyDb->isLockBusy() || lockRetries >= MaxLockRetries)
+        return false;
+
+    ++lockRetries;
+    batchTimer.start(LockRetryInterval);
+    return true;
+}
+
+/*!
+ * \brief Stops the job and reports its totals.
+ */
+void RetentionJob::finish()
+{
+    running = false;
+    vacuuming = false;
+
+    emit finished(report);
+}
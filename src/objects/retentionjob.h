@@ -0,0 +1,75 @@
+#ifndef RETENTIONJOB_H
+#define RETENTIONJOB_H
+
+#include <QObject>
+#include <QDate>
+#include <QTimer>
+
+class SurveyDatabase;
+class QThread;
+
+/*!
+ * \brief The results of a finished retention job.
+ */
+struct RetentionReport
+{
+    int rowsPurged = 0;         ///< The amount of surveys that were deleted.
+    qint64 bytesReclaimed = 0;  ///< The amount of bytes by which the database file shrunk.
+    double maxLockHoldMs = 0;   ///< The longest time (in milliseconds) that a single batch held the database lock.
+    int batches = 0;            ///< The amount of delete batches it took to purge all expired surveys.
+    bool vacuumSkipped = false; ///< Were the free pages kept because the database does not use incremental auto vacuum?
+};
+
+/*!
+ * \brief Deletes expired surveys from the SurveyDatabase in small batches between user operations.
+ *
+ * Every batch is a short transaction of its own. The batch size adapts so that a single batch stays within the time budget.
+ * A batch that finds the database locked by another workstation is tried again a little later.
+ * Once all expired surveys are deleted, the freed pages are returned to the file system a few at a time. Databases that
+ * do not use incremental auto vacuum keep their free pages for new surveys, the job never rebuilds the database by itself.
+ * That rebuild only runs when compact() is called, on a thread and connection of its own.
+ */
+class RetentionJob : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RetentionJob(SurveyDatabase *db, QObject *parent = nullptr);
+    ~RetentionJob();
+
+    bool start(const int &retentionDays);
+    void cancel();
+    bool isRunning() const;
+
+    bool compact();
+    bool isCompacting() const;
+
+    void setTimeBudget(const int &ms);
+    int getTimeBudget() const;
+
+signals:
+    void progress(const int &rowsPurged);
+    void finished(const RetentionReport &report);
+    void compacted(const bool &success, const QString &error);
+
+private slots:
+    void runStep();
+
+private:
+    SurveyDatabase *surveyDb;   ///< The database from which the surveys are purged.
+    QTimer batchTimer;          ///< Schedules the next batch once the event loop had a chance to handle user input.
+    QDate cutoffDate;           ///< Surveys answered before this date are expired.
+    RetentionReport report;     ///< The running totals of the current job.
+    int batchSize;              ///< The amount of surveys deleted in the next batch.
+    int timeBudgetMs;           ///< The maximum time a single batch may hold the database lock.
+    bool vacuuming;             ///< Is the job busy returning free pages to the file system?
+    bool running;               ///< Is the job currently running?
+    int lockRetries;            ///< The amount of times in a row a step found the database locked by another workstation.
+    QThread *compactThread;     ///< The thread of the running compaction, or nullptr if none is running.
+
+    void purgeBatch();
+    void vacuumStep();
+    bool retryWhileLocked();
+    void finish();
+};
+
+#endif // RETENTIONJOB_H
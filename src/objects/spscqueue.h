@@ -0,0 +1,95 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+/*!
+ * \brief A bounded, lock-free queue between exactly one producer thread and one consumer thread.
+ *
+ * The producer only writes the tail and the consumer only writes the head, so neither ever waits on a lock.
+ * A full queue makes tryPush() fail, which is how a fast producer is held back by a slow consumer.
+ * The head and tail are kept on separate cache lines, so the two threads do not invalidate each other's cache.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+    /*!
+     * \brief The constructor for the SpscQueue.
+     * \param capacity = The maximum amount of items in the queue
+     */
+    explicit SpscQueue(const size_t &capacity) :
+        ring(capacity + 1),
+        head(0),
+        tail(0)
+    {
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /*!
+     * \brief Adds an item to the back of the queue. May only be called by the producer.
+     * \param item = The item, which is moved into the queue if there is room
+     * \return A boolean value that is false if the queue is full.
+     */
+    bool tryPush(T &item)
+    {
+        size_t current(tail.load(std::memory_order_relaxed));
+        size_t next(increment(current));
+
+        if (next == head.load(std::memory_order_acquire))
+            return false;
+
+        ring[current] = std::move(item);
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * \brief Removes the item at the front of the queue. May only be called by the consumer.
+     * \param item = Receives the item if the queue was not empty
+     * \return A boolean value that is false if the queue is empty.
+     */
+    bool tryPop(T &item)
+    {
+        size_t current(head.load(std::memory_order_relaxed));
+
+        if (current == tail.load(std::memory_order_acquire))
+            return false;
+
+        item = std::move(ring[current]);
+        head.store(increment(current), std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * \brief Retrieves the amount of items in the queue. The result is only a snapshot when called from a third thread.
+     * \return The amount of items.
+     */
+    size_t size() const
+    {
+        size_t currentHead(head.load(std::memory_order_acquire));
+        size_t currentTail(tail.load(std::memory_order_acquire));
+
+        return currentTail >= currentHead ? currentTail - currentHead : currentTail + ring.size() - currentHead;
+    }
+
+private:
+    static const size_t CacheLine = 64;    ///< The assumed size of a cache line.
+
+    std::vector<T> ring;                    ///< The ring buffer, with one slot that always stays empty.
+    alignas(CacheLine) std::atomic<size_t> head; ///< The next slot to pop, written by the consumer.
+    alignas(CacheLine) std::atomic<size_t> tail; ///< The next slot to push to, written by the producer.
+
+    size_t increment(const size_t &index) const
+    {
+        return index + 1 == ring.size() ? 0 : index + 1;
+    }
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,41 @@
+#ifndef SQLITEHANDLE_H
+#define SQLITEHANDLE_H
+
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlQuery>
+#include <QVariant>
+
+#include <sqlite3.h>
+
+/*!
+ * \brief Retrieves the SQLite handle of an open QSQLITE connection, for the parts of the C API that Qt does not wrap.
+ * \param db = The open connection
+ * \param error = Receives why there is no handle
+ * \return The handle, or nullptr if the connection is not open or its driver uses another copy of SQLite.
+ * \note The connection keeps owning the handle, it must never be closed with sqlite3_close().
+ * \note The application links the system SQLite library. A Qt driver with its own bundled copy would hand out a handle
+ * of that copy, and two copies in one process also drop each other's POSIX locks on the database file. The handle is
+ * therefore only returned if the driver reports the same SQLite source ID, which requires Qt built with -system-sqlite.
+ */
+inline sqlite3 *getSqliteHandle(const QSqlDatabase &db, QString &error)
+{
+    QVariant handle(db.isOpen() ? db.driver()->handle() : QVariant());
+
+    if (!handle.isValid() || qstrcmp(handle.typeName(), "sqlite3*") != 0 || *static_cast<sqlite3 **>(handle.data()) == nullptr) {
+        error = "The database is not an open SQLite connection.";
+        return nullptr;
+    }
+
+    QSqlQuery versionQry(db);
+
+    if (!versionQry.exec("SELECT sqlite_source_id();") || !versionQry.next() ||
+            versionQry.value(0).toString() != QString::fromLatin1(sqlite3_sourceid())) {
+        error = "The SQLite driver of Qt does not use the system SQLite library, Qt must be built with -system-sqlite.";
+        return nullptr;
+    }
+
+    return *static_cast<sqlite3 **>(handle.data());
+}
+
+#endif // SQLITEHANDLE_H
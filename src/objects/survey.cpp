@@ -1,4 +1,5 @@
 #include "survey.h"
+#include "questionset.h"
 
 /*!
  * \brief The default constructor for the Survey class.
@@ -8,9 +9,7 @@
 Survey::Survey() :
     surveyDate(QDate()),
     empId(-1),
-    qOne(false),
-    qTwo(false),
-    qThree(false),
+    answerBits(0),
     temp(0)
 {
 }
@@ -19,22 +18,16 @@ Survey::Survey() :
  * \brief Constructor that assigns values to all members of the Survey class.
  * \param date = The date the survey was answered.
  * \param employeeId = The ID of the employee to which this survey belongs to.
- * \param questOne = The answer for question one.
- * \param questTwo = The answer for question two.
- * \param questThree = The answer for question three.
+ * \param answers = The answers as a bitmask, bit N is set if question N was answered "Yes".
  * \param temperature = The employee's temperature in degrees Celsius.
  */
 Survey::Survey(const QDate &date,
                const int &employeeId,
-               const bool &questOne,
-               const bool &questTwo,
-               const bool &questThree,
+               const quint32 &answers,
                const double &temperature) :
     surveyDate(date),
     empId(employeeId),
-    qOne(questOne),
-    qTwo(questTwo),
-    qThree(questThree),
+    answerBits(answers),
     temp(temperature)
 {
 }
@@ -58,30 +51,25 @@ void Survey::setEmployeeId(const int &employeeId)
 }
 
 /*!
- * \brief Assigns a new answer for question one.
- * \param questionOne = The answer for question one.
+ * \brief Assigns new answers to all questions.
+ * \param answers = The answers as a bitmask, bit N is set if question N was answered "Yes".
  */
-void Survey::setQuestionOne(const bool &questionOne)
+void Survey::setAnswers(const quint32 &answers)
 {
-    qOne = questionOne;
+    answerBits = answers;
 }
 
 /*!
- * \brief Assigns a new answer for question two.
- * \param questionTwo = The answer for question two.
+ * \brief Assigns a new answer for a single question.
+ * \param bit = The bit of the question
+ * \param yes = Was the question answered "Yes"?
  */
-void Survey::setQuestionTwo(const bool &questionTwo)
+void Survey::setAnswer(const int &bit, const bool &yes)
 {
-    qTwo = questionTwo;
-}
-
-/*!
- * \brief Assigns a new answer for question three.
- * \param questionThree = The answer for question three.
- */
-void Survey::setQuestionThree(const bool &questionThree)
-{
-    qThree = questionThree;
+    if (yes)
+        answerBits |= QuestionSet::getMask(bit);
+    else
+        answerBits &= ~QuestionSet::getMask(bit);
 }
 
 /*!
@@ -112,30 +100,22 @@ int Survey::getEmployeeId() const
 }
 
 /*!
- * \brief Retrieves the answer to question one.
- * \return A boolean value with question one's answer.
- */
-bool Survey::getQuestionOne() const
-{
-    return qOne;
-}
-
-/*!
- * \brief Retrieves the answer to question two.
- * \return A boolean value with question two's answer.
+ * \brief Retrieves the answers to all questions.
+ * \return The answers as a bitmask, bit N is set if question N was answered "Yes".
  */
-bool Survey::getQuestionTwo() const
+quint32 Survey::getAnswers() const
 {
-    return qTwo;
+    return answerBits;
 }
 
 /*!
- * \brief Retrieves the answer to question three.
- * \return A boolean value with question three's answer.
+ * \brief Retrieves the answer to a single question.
+ * \param bit = The bit of the question
+ * \return A boolean value that is true if the question was answered "Yes".
  */
-bool Survey::getQuestionThree() const
+bool Survey::getAnswer(const int &bit) const
 {
-    return qThree;
+    return QuestionSet::isYes(answerBits, bit);
 }
 
 /*!
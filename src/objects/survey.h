@@ -9,26 +9,24 @@
 class Survey
 {
 public:
+    static constexpr double FeverTemperature = 38.0; ///< The temperature (in degrees Celsius) from which an employee has a fever.
+
     Survey();
     Survey(const QDate &date,
            const int &employeeId,
-           const bool &questOne,
-           const bool &questTwo,
-           const bool &questThree,
+           const quint32 &answers,
            const double &temperature);
 
     void setSurveyDate(const QDate &date);
     void setEmployeeId(const int &employeeId);
-    void setQuestionOne(const bool &questionOne);
-    void setQuestionTwo(const bool &questionTwo);
-    void setQuestionThree(const bool &questionThree);
+    void setAnswers(const quint32 &answers);
+    void setAnswer(const int &bit, const bool &yes);
     void setTemperature(const double &temperature);
 
     QDate getSurveyDate() const;
     int getEmployeeId() const;
-    bool getQuestionOne() const;
-    bool getQuestionTwo() const;
-    bool getQuestionThree() const;
+    quint32 getAnswers() const;
+    bool getAnswer(const int &bit) const;
     double getTemperature() const;
 
     bool isValid() const;
@@ -36,9 +34,7 @@ public:
 private:
     QDate surveyDate;   ///< The date the survey was answered (Used in combination with the employee ID to uniquely identify any survey).
     int empId;          ///< The ID of the employee to which the survey belongs to.
-    bool qOne;          ///< Answer to the first question.
-    bool qTwo;          ///< Answer to the second question.
-    bool qThree;        ///< Answer to the third question.
+    quint32 answerBits; ///< The answers to the questions, bit N is set if question N was answered "Yes" (see QuestionSet).
     double temp;        ///< The temperature of the employee.
 };
 
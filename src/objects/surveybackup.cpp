@@ -0,0 +1,436 @@
+#include "surveybackup.h"
+
+#include <QThread>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QtDebug>
+
+#include "sqlitehandle.h"
+
+#include <zlib.h>
+
+namespace {
+const int StartStepPages(64);           ///< The amount of pages copied in the first step.
+const int ProgressInterval(200);        ///< The minimum time (in milliseconds) between two progress reports.
+const qint64 CompressChunkSize(1 << 20);///< The amount of bytes compressed at once (1 MiB).
+const int VacuumBusyTimeout(5000);      ///< The time (in milliseconds) VACUUM INTO waits for a writer to finish.
+
+/*!
+ * \brief Determines if a database is in WAL mode.
+ * \param db = The open connection
+ * \return A boolean value that is true if the database uses a write-ahead log.
+ */
+bool isWal(sqlite3 *db)
+{
+    sqlite3_stmt *modeStmt(nullptr);
+    bool wal(false);
+
+    if (sqlite3_prepare_v2(db, "PRAGMA journal_mode;", -1, &modeStmt, nullptr) == SQLITE_OK && sqlite3_step(modeStmt) == SQLITE_ROW)
+        wal = qstricmp(reinterpret_cast<const char *>(sqlite3_column_text(modeStmt, 0)), "wal") == 0;
+
+    sqlite3_finalize(modeStmt);
+    return wal;
+}
+
+/*!
+ * \brief Copies a database into a new file in a single read transaction.
+ * \param db = The open connection to the database
+ * \param fileName = The full path to the copy, which must not exist yet
+ * \return SQLITE_DONE if the database was copied, otherwise the SQLite error code.
+ */
+int vacuumInto(sqlite3 *db, const QString &fileName)
+{
+    sqlite3_stmt *vacuumStmt(nullptr);
+    QByteArray name(fileName.toUtf8());
+    int result(sqlite3_prepare_v2(db, "VACUUM INTO ?;", -1, &vacuumStmt, nullptr));
+
+    if (result == SQLITE_OK) {
+        sqlite3_bind_text(vacuumStmt, 1, name.constData(), name.size(), SQLITE_TRANSIENT);
+        result = sqlite3_step(vacuumStmt);
+    }
+
+    sqlite3_finalize(vacuumStmt);
+    return result;
+}
+}
+
+/*!
+ * \brief The constructor for the SurveyBackup.
+ * \param parent = The QObject to which this object is bound to
+ */
+SurveyBackup::SurveyBackup(QObject *parent) :
+    QObject(parent),
+    dbLocation(),
+    settings(),
+    scheduleTimer(this),
+    thread(nullptr),
+    cancelled(false)
+{
+    connect(&scheduleTimer, &QTimer::timeout, this, &SurveyBackup::start);
+}
+
+/*!
+ * \brief The destructor for the SurveyBackup.
+ * \note A running backup is cancelled and its thread is waited for.
+ */
+SurveyBackup::~SurveyBackup()
+{
+    cancel();
+
+    if (thread != nullptr) {
+        thread->wait();
+        delete thread;
+    }
+}
+
+/*!
+ * \brief Assigns the database file that is backed up.
+ * \param location = The full path to the database file
+ */
+void SurveyBackup::setDatabaseLocation(const QString &location)
+{
+    dbLocation = location;
+}
+
+/*!
+ * \brief Assigns the settings of the next backups and (re)starts the schedule.
+ * \param newSettings = The new settings
+ * \note An empty directory means a "backups" directory next to the database file.
+ */
+void SurveyBackup::setSettings(const BackupSettings &newSettings)
+{
+    settings = newSettings;
+
+    if (settings.intervalMinutes > 0)
+        scheduleTimer.start(settings.intervalMinutes * 60 * 1000);
+    else
+        scheduleTimer.stop();
+}
+
+/*!
+ * \brief Retrieves the settings of the next backups.
+ * \return The BackupSettings.
+ */
+BackupSettings SurveyBackup::getSettings() const
+{
+    return settings;
+}
+
+/*!
+ * \brief Starts a backup in the background.
+ * \return A boolean value that is false if a backup is already running or there is no database.
+ * \note progress() is emitted while the pages are copied, followed by finished().
+ */
+bool SurveyBackup::start()
+{
+    if (thread != nullptr || dbLocation.isEmpty())
+        return false;
+
+    BackupSettings backupSettings(settings);
+
+    if (backupSettings.directory.isEmpty())
+        backupSettings.directory = QFileInfo(dbLocation).absolutePath() + "/backups";
+
+    if (!QDir().mkpath(backupSettings.directory)) {
+        qDebug() << "(Backup) Error creating directory: " << backupSettings.directory << Qt::endl;
+        return false;
+    }
+
+    QString source(dbLocation);
+    cancelled = false;
+
+    thread = QThread::create([this, source, backupSettings]() {
+        BackupReport report(runBackup(source, backupSettings));
+
+        QMetaObject::invokeMethod(this, [this, report]() {
+            thread->wait();
+            delete thread;
+            thread = nullptr;
+
+            emit finished(report);
+        }, Qt::QueuedConnection);
+    });
+
+    // The backup must never take the CPU away from survey entry.
+    thread->start(QThread::LowPriority);
+    return true;
+}
+
+/*!
+ * \brief Stops the running backup after its current step. The partial copy is removed.
+ */
+void SurveyBackup::cancel()
+{
+    cancelled = true;
+}
+
+/*!
+ * \brief Determines if a backup is running.
+ * \return A boolean value that states whether a backup is running.
+ */
+bool SurveyBackup::isRunning() const
+{
+    return thread != nullptr;
+}
+
+/*!
+ * \brief Copies the database in small steps, then compresses the copy and removes the oldest backups.
+ * \param source = The full path to the database file
+ * \param backupSettings = The settings of this backup
+ * \return The BackupReport.
+ * \note Runs on the backup thread.
+ */
+BackupReport SurveyBackup::runBackup(const QString &source, const BackupSettings &backupSettings)
+{
+    BackupReport report;
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+
+    QString baseName(QFileInfo(source).completeBaseName());
+    QString copyName(backupSettings.directory + "/" + baseName + "-" +
+                     QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".data");
+    QString partName(copyName + ".part");
+
+    // A connection can only be used by the thread that created it.
+    QString connection("SurveyBackup" + QString::number(reinterpret_cast<quintptr>(QThread::currentThreadId())));
+
+    {
+        QSqlDatabase srcDb(QSqlDatabase::addDatabase("QSQLITE", connection + "Source"));
+        QSqlDatabase dstDb(QSqlDatabase::addDatabase("QSQLITE", connection + "Copy"));
+
+        // A step never waits for a writer, a busy step is tried again after the pause between steps.
+        srcDb.setDatabaseName(source);
+        srcDb.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=0");
+        dstDb.setDatabaseName(partName);
+
+        if (!srcDb.open()) {
+            report.error = srcDb.lastError().text();
+        } else if (!dstDb.open()) {
+            report.error = dstDb.lastError().text();
+        } else {
+            sqlite3 *src(getSqliteHandle(srcDb, report.error));
+
+            if (src != nullptr)
+                copyPages(src, dstDb, partName, backupSettings, report);
+        }
+
+        dstDb.close();
+        srcDb.close();
+    }
+
+    QSqlDatabase::removeDatabase(connection + "Copy");
+    QSqlDatabase::removeDatabase(connection + "Source");
+
+    if (!report.error.isEmpty()) {
+        QFile::remove(partName);
+        return report;
+    }
+
+    QString fileName(backupSettings.compress ? copyName + ".gz" : copyName);
+
+    if (backupSettings.compress) {
+        if (!compressFile(partName, fileName, report.error)) {
+            QFile::remove(partName);
+            return report;
+        }
+
+        QFile::remove(partName);
+    } else if (!QFile::rename(partName, fileName)) {
+        report.error = "Could not rename " + partName + ".";
+        QFile::remove(partName);
+        return report;
+    }
+
+    removeOldGenerations(backupSettings.directory, baseName, backupSettings.generations);
+
+    report.fileName = fileName;
+    report.bytes = QFileInfo(fileName).size();
+    report.elapsedMs = totalTimer.elapsed();
+
+    return report;
+}
+
+/*!
+ * \brief Copies the pages of the database in small steps, or with VACUUM INTO if the copy keeps starting over.
+ * \param src = The handle of the read-only connection to the database
+ * \param dstDb = The open connection to the copy, which is closed if VACUUM INTO creates the copy instead
+ * \param partName = The full path to the copy
+ * \param backupSettings = The settings of this backup
+ * \param report = Receives the statistics of the copy, and the error if it failed
+ * \note Runs on the backup thread.
+ */
+void SurveyBackup::copyPages(sqlite3 *src, QSqlDatabase &dstDb, const QString &partName, const BackupSettings &backupSettings,
+                             BackupReport &report)
+{
+    sqlite3 *dst(getSqliteHandle(dstDb, report.error));
+
+    if (dst == nullptr)
+        return;
+
+    sqlite3_backup *backup(sqlite3_backup_init(dst, "main", src, "main"));
+
+    if (backup == nullptr) {
+        report.error = QString::fromUtf8(sqlite3_errmsg(dst));
+        return;
+    }
+
+    // The read transaction pins the snapshot the copy is made of, so the copy never starts over.
+    bool snapshot(isWal(src) && sqlite3_exec(src, "BEGIN; SELECT COUNT(*) FROM sqlite_master;", nullptr, nullptr, nullptr) == SQLITE_OK);
+    bool restarting(false);
+    int budgetMs(qMax(1, backupSettings.stepBudgetMs));
+    int stepPages(StartStepPages);
+    int lastRemaining(-1);
+    int result(SQLITE_OK);
+    QElapsedTimer progressTimer;
+    progressTimer.start();
+
+    while (!cancelled) {
+        QElapsedTimer stepTimer;
+        stepTimer.start();
+
+        result = sqlite3_backup_step(backup, stepPages);
+
+        double stepMs(stepTimer.nsecsElapsed() / 1000000.0);
+        report.maxStepMs = qMax(report.maxStepMs, stepMs);
+        ++report.steps;
+
+        if (result == SQLITE_DONE)
+            break;
+
+        if (result == SQLITE_BUSY || result == SQLITE_LOCKED) {
+            ++report.busySteps;
+        } else if (result != SQLITE_OK) {
+            break;
+        } else {
+            // Back off quickly when a step is over budget, grow slowly while it is well within it.
+            if (stepMs > budgetMs)
+                stepPages = qMax(MinStepPages, stepPages / 2);
+            else if (stepMs < budgetMs / 2.0)
+                stepPages = qMin(MaxStepPages, stepPages + stepPages / 4 + 1);
+
+            int remaining(sqlite3_backup_remaining(backup));
+            int total(sqlite3_backup_pagecount(backup));
+
+            if (lastRemaining >= 0 && remaining > lastRemaining)
+                ++report.restarts;
+
+            lastRemaining = remaining;
+
+            // A database that is written to all the time would keep the step-wise copy from ever finishing.
+            if (report.restarts > MaxRestarts) {
+                restarting = true;
+                break;
+            }
+
+            if (progressTimer.elapsed() >= ProgressInterval) {
+                progressTimer.restart();
+                QMetaObject::invokeMethod(this, [this, remaining, total]() {
+                    emit progress(total - remaining, total);
+                }, Qt::QueuedConnection);
+            }
+        }
+
+        // Leave the database to the writers for at least as long as the step held it.
+        QThread::msleep(budgetMs);
+    }
+
+    report.pages = sqlite3_backup_pagecount(backup);
+    sqlite3_backup_finish(backup);
+
+    if (snapshot)
+        sqlite3_exec(src, "COMMIT;", nullptr, nullptr, nullptr);
+
+    if (restarting && !cancelled) {
+        // VACUUM INTO creates the copy itself.
+        dstDb.close();
+        QFile::remove(partName);
+
+        sqlite3_busy_timeout(src, VacuumBusyTimeout);
+        result = vacuumInto(src, partName);
+        report.vacuumed = (result == SQLITE_DONE);
+    }
+
+    if (result != SQLITE_DONE)
+        report.error = cancelled ? QString("The backup was cancelled.") : QString::fromUtf8(sqlite3_errstr(result));
+}
+
+/*!
+ * \brief Compresses a file with gzip.
+ * \param from = The full path to the file to compress
+ * \param to = The full path to the compressed file (it is overwritten if it exists)
+ * \param error = Receives a description of the error if the file could not be compressed
+ * \return A boolean value stating whether the file was compressed or not.
+ * \note The compressed file only appears once it is complete.
+ */
+bool SurveyBackup::compressFile(const QString &from, const QString &to, QString &error)
+{
+    QFile in(from);
+
+    if (!in.open(QIODevice::ReadOnly)) {
+        error = in.errorString();
+        return false;
+    }
+
+    QString partName(to + ".part");
+    gzFile out(gzopen(QFile::encodeName(partName).constData(), "wb6"));
+
+    if (out == nullptr) {
+        error = "Could not create " + partName + ".";
+        return false;
+    }
+
+    QByteArray chunk;
+
+    while (!(chunk = in.read(CompressChunkSize)).isEmpty()) {
+        if (gzwrite(out, chunk.constData(), static_cast<unsigned>(chunk.size())) != chunk.size()) {
+            error = "Could not write " + partName + ".";
+            gzclose(out);
+            QFile::remove(partName);
+            return false;
+        }
+    }
+
+    if (gzclose(out) != Z_OK || in.error() != QFileDevice::NoError) {
+        error = "Could not write " + partName + ".";
+        QFile::remove(partName);
+        return false;
+    }
+
+    QFile::remove(to);
+
+    if (!QFile::rename(partName, to)) {
+        error = "Could not rename " + partName + ".";
+        QFile::remove(partName);
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Removes all but the newest backups of a database.
+ * \param directory = The directory with the backups
+ * \param baseName = The name of the database file without its extension
+ * \param generations = The amount of backups to keep, or 0 to keep all of them
+ */
+void SurveyBackup::removeOldGenerations(const QString &directory, const QString &baseName, const int &generations)
+{
+    if (generations <= 0)
+        return;
+
+    QDir dir(directory);
+
+    // The time in the name sorts the backups from old to new.
+    const QStringList backups(dir.entryList({baseName + "-*.data", baseName + "-*.data.gz"},
+                                            QDir::Files, QDir::Name | QDir::Reversed));
+
+    for (int i = generations; i < backups.size(); ++i) {
+        if (!dir.remove(backups[i]))
+            qDebug() << "(Backup) Error removing old backup: " << backups[i] << Qt::endl;
+    }
+}
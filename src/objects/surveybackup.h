@@ -0,0 +1,94 @@
+#ifndef SURVEYBACKUP_H
+#define SURVEYBACKUP_H
+
+#include <QObject>
+#include <QTimer>
+
+#include <atomic>
+
+class QThread;
+class QSqlDatabase;
+struct sqlite3;
+
+/*!
+ * \brief The settings of the online backup.
+ */
+struct BackupSettings
+{
+    QString directory;          ///< The directory the backups are written to.
+    int generations = 7;        ///< The amount of backups that are kept, the oldest are removed.
+    bool compress = true;       ///< Should the backups be gzip compressed?
+    int stepBudgetMs = 5;       ///< The maximum time (in milliseconds) a single backup step may hold the read lock.
+    int intervalMinutes = 0;    ///< The time between scheduled backups, or 0 to only back up on request.
+};
+
+/*!
+ * \brief The results of a finished backup.
+ */
+struct BackupReport
+{
+    QString fileName;           ///< The full path to the backup, or empty if the backup failed.
+    QString error;              ///< Why the backup failed, or empty if it did not.
+    qint64 bytes = 0;           ///< The size of the backup file.
+    int pages = 0;              ///< The amount of database pages copied.
+    int steps = 0;              ///< The amount of backup steps it took.
+    int busySteps = 0;          ///< The amount of steps that had to wait because another connection was writing.
+    int restarts = 0;           ///< The amount of times the copy started over because another connection changed the database.
+    bool vacuumed = false;      ///< Was the copy made with VACUUM INTO because the step-wise copy kept starting over?
+    double maxStepMs = 0;       ///< The longest time (in milliseconds) a single step took.
+    qint64 elapsedMs = 0;       ///< The time (in milliseconds) the whole backup took.
+};
+
+/*!
+ * \brief Backs up the database while it is in use, with SQLite's online backup API on a background thread.
+ *
+ * The pages are copied in small steps on a separate connection. The amount of pages per step adapts so that a step
+ * stays within the time budget, and the thread sleeps between steps.
+ *
+ * In WAL mode the copy holds a read transaction on the source for its whole duration. Writers on other connections
+ * carry on as usual, and the backup is the snapshot of the moment it started. With a rollback journal a read
+ * transaction would lock out the writers, so every step only holds the read lock for a moment instead. If another
+ * connection changes the database, SQLite starts the copy over. After MaxRestarts restarts the database is copied
+ * with VACUUM INTO instead, which holds off the writers until it is done but always finishes.
+ *
+ * The copy is written to a temporary file first and then compressed or renamed, so a backup file is always complete.
+ * Backups are named after the database file and the time they were started, and only the newest generations are kept.
+ */
+class SurveyBackup : public QObject
+{
+    Q_OBJECT
+public:
+    static const int MinStepPages = 8;      ///< The smallest amount of pages copied in a single step.
+    static const int MaxStepPages = 8192;   ///< The largest amount of pages copied in a single step.
+    static const int MaxRestarts = 3;       ///< The amount of times the step-wise copy may start over before VACUUM INTO is used.
+
+    explicit SurveyBackup(QObject *parent = nullptr);
+    ~SurveyBackup();
+
+    void setDatabaseLocation(const QString &location);
+    void setSettings(const BackupSettings &newSettings);
+    BackupSettings getSettings() const;
+
+    bool start();
+    void cancel();
+    bool isRunning() const;
+
+signals:
+    void progress(const int &pagesCopied, const int &pagesTotal);
+    void finished(const BackupReport &report);
+
+private:
+    QString dbLocation;         ///< The full path to the database file.
+    BackupSettings settings;    ///< The settings of the next backup.
+    QTimer scheduleTimer;       ///< Starts the scheduled backups.
+    QThread *thread;            ///< The thread of the running backup, or nullptr if none is running.
+    std::atomic<bool> cancelled;///< Should the running backup stop?
+
+    BackupReport runBackup(const QString &source, const BackupSettings &backupSettings);
+    void copyPages(sqlite3 *src, QSqlDatabase &dstDb, const QString &partName, const BackupSettings &backupSettings,
+                   BackupReport &report);
+    static bool compressFile(const QString &from, const QString &to, QString &error);
+    static void removeOldGenerations(const QString &directory, const QString &baseName, const int &generations);
+};
+
+#endif // SURVEYBACKUP_H
@@ -0,0 +1,395 @@
+#include "surveydaemon.h"
+
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtDebug>
+
+#include <functional>
+
+namespace {
+const int MaxRequestSize(4096);         ///< The maximum size of a single request line.
+const int DayCheckInterval(60 * 1000);  ///< The interval (in milliseconds) at which the day is checked for a change.
+
+/*!
+ * \brief A QLocalServer that hands the descriptors of new clients to a function instead of creating their sockets.
+ * \note The sockets are created by the worker thread that serves them, because a socket belongs to the thread that created it.
+ */
+class DaemonListener : public QLocalServer
+{
+public:
+    DaemonListener(const std::function<void (quintptr)> &accept, QObject *parent) :
+        QLocalServer(parent),
+        accept(accept)
+    {
+    }
+
+protected:
+    void incomingConnection(quintptr socketDescriptor) override
+    {
+        accept(socketDescriptor);
+    }
+
+private:
+    std::function<void (quintptr)> accept;  ///< Receives the descriptor of every new client.
+};
+
+/*!
+ * \brief Determines why an employee is or is not cleared.
+ * \param status = The status of the employee on the day
+ * \param activeMask = The bits of the questions that are still asked
+ * \return "ok" if the employee is cleared, otherwise "no_survey", "symptoms", "fever" or "anomaly".
+ */
+QByteArray getClearanceReason(const DailyStatus &status, const quint32 &activeMask)
+{
+    if (!status.surveyed)
+        return "no_survey";
+
+    if (QuestionSet::anyYes(status.answers, activeMask))
+        return "symptoms";
+
+    if (status.temperature >= Survey::FeverTemperature)
+        return "fever";
+
+    if (status.anomaly)
+        return "anomaly";
+
+    return "ok";
+}
+}
+
+/*!
+ * \brief The constructor for the SurveyDaemon.
+ * \param parent = The QObject to which this object is bound to
+ */
+SurveyDaemon::SurveyDaemon(QObject *parent) :
+    QObject(parent),
+    surveyDb(nullptr, "SurveyDaemon"),
+    server(new DaemonListener([this](quintptr descriptor) { acceptClient(descriptor); }, this)),
+    workers(),
+    workerContexts(),
+    nextWorker(0),
+    dayTimer(this),
+    snapshot(std::make_shared<const ClearanceSnapshot>()),
+    requests(0)
+{
+    for (std::atomic<qint64> &count : latencyHistogram)
+        count = 0;
+
+    dayTimer.setInterval(DayCheckInterval);
+
+    connect(&dayTimer, &QTimer::timeout, this, [this]() {
+        if (std::atomic_load(&snapshot)->date != QDate::currentDate())
+            refreshSnapshot();
+    });
+
+    // Surveys submitted by the workstations are picked up through the change detection of the database.
+    connect(&surveyDb, &SurveyDatabase::databaseChanged, this, &SurveyDaemon::refreshSnapshot);
+}
+
+/*!
+ * \brief The destructor for the SurveyDaemon.
+ */
+SurveyDaemon::~SurveyDaemon()
+{
+    stop();
+}
+
+/*!
+ * \brief Opens the database, builds the first snapshot and starts listening for clients.
+ * \param socketName = The name of the local socket (or the full path of a Unix socket)
+ * \param dbLocation = The full path to the database file
+ * \param profile = The durability profile the database is opened with
+ * \param threads = The amount of worker threads, or 0 to use one less than the amount of cores
+ * \return A boolean value that states whether the daemon is listening.
+ */
+bool SurveyDaemon::start(const QString &socketName, const QString &dbLocation, const DurabilityProfile &profile, const int &threads)
+{
+    if (server->isListening())
+        return true;
+
+    surveyDb.setDurabilityProfile(profile);
+
+    if (!surveyDb.createDatabase(dbLocation) || !refreshSnapshot())
+        return false;
+
+    int workerCount(threads > 0 ? threads : qMax(1, QThread::idealThreadCount() - 1));
+
+    for (int i = 0; i < workerCount; ++i) {
+        QThread *worker(new QThread());
+        QObject *context(new QObject());
+
+        context->moveToThread(worker);
+        connect(worker, &QThread::finished, context, &QObject::deleteLater);
+        worker->start();
+
+        workers.push_back(worker);
+        workerContexts.push_back(context);
+    }
+
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+
+    // A daemon that crashed leaves its socket file behind.
+    if (!server->listen(socketName) && server->serverError() == QAbstractSocket::AddressInUseError) {
+        QLocalServer::removeServer(socketName);
+        server->listen(socketName);
+    }
+
+    if (!server->isListening()) {
+        qDebug() << "(Daemon) Error starting server: " << server->errorString() << Qt::endl;
+        stop();
+        return false;
+    }
+
+    dayTimer.start();
+    return true;
+}
+
+/*!
+ * \brief Stops listening, disconnects all clients and stops the worker threads.
+ */
+void SurveyDaemon::stop()
+{
+    server->close();
+    dayTimer.stop();
+
+    for (QThread *worker : workers) {
+        worker->quit();
+        worker->wait();
+        delete worker;
+    }
+
+    workers.clear();
+    workerContexts.clear();
+}
+
+/*!
+ * \brief Retrieves the full name of the socket clients connect to.
+ * \return The full server name, or an empty string if the daemon is not listening.
+ */
+QString SurveyDaemon::getServerName() const
+{
+    return server->fullServerName();
+}
+
+/*!
+ * \brief Answers a single request from the current snapshot.
+ * \param request = The request line, without the line break
+ * \return The response as a single line of JSON, without the line break.
+ * \note This is called by the worker threads at the same time, it only reads the snapshot.
+ */
+QByteArray SurveyDaemon::answer(const QByteArray &request) const
+{
+    const std::shared_ptr<const ClearanceSnapshot> current(std::atomic_load(&snapshot));
+
+    int space(request.indexOf(' '));
+    QByteArray command(space < 0 ? request : request.left(space));
+    QByteArray argument(space < 0 ? QByteArray() : request.mid(space + 1).trimmed());
+
+    if (command == "cleared") {
+        bool ok;
+        int empId(argument.toInt(&ok));
+
+        if (!ok)
+            return "{\"error\":\"invalid employee id\"}";
+
+        auto status(current->statuses.constFind(empId));
+
+        // The argument is echoed as the parsed number, so the response is always valid JSON.
+        if (status == current->statuses.constEnd())
+            return "{\"emp_id\":" + QByteArray::number(empId) + ",\"error\":\"unknown employee\"}";
+
+        QByteArray reason(getClearanceReason(*status, current->activeMask));
+
+        return "{\"emp_id\":" + QByteArray::number(empId) +
+                ",\"date\":\"" + current->date.toString(Qt::ISODate).toLatin1() +
+                "\",\"cleared\":" + (reason == "ok" ? "true" : "false") +
+                ",\"reason\":\"" + reason + "\"}";
+    }
+
+    if (command == "lookup") {
+        QString name(QString::fromUtf8(argument));
+        auto empId(current->idsByName.constFind(SurveyDatabase::normalizeName(name)));
+
+        if (empId == current->idsByName.constEnd())
+            return QJsonDocument(QJsonObject({{"name", name}, {"error", "unknown employee"}})).toJson(QJsonDocument::Compact);
+
+        return QJsonDocument(QJsonObject({{"emp_id", *empId},
+                                          {"name", current->statuses.value(*empId).name}})).toJson(QJsonDocument::Compact);
+    }
+
+    if (command == "stats") {
+        return "{\"date\":\"" + current->date.toString(Qt::ISODate).toLatin1() +
+                "\",\"employees\":" + QByteArray::number(current->statuses.size()) +
+                ",\"surveyed\":" + QByteArray::number(current->surveyed) +
+                ",\"cleared\":" + QByteArray::number(current->cleared) +
+                ",\"symptoms\":" + QByteArray::number(current->symptoms) +
+                ",\"fever\":" + QByteArray::number(current->fever) +
+                ",\"anomalies\":" + QByteArray::number(current->anomalies) + "}";
+    }
+
+    if (command == "status") {
+        return "{\"requests\":" + QByteArray::number(requests.load()) +
+                ",\"p50_us\":" + QByteArray::number(getLatencyPercentile(0.50)) +
+                ",\"p99_us\":" + QByteArray::number(getLatencyPercentile(0.99)) +
+                ",\"threads\":" + QByteArray::number(static_cast<int>(workers.size())) +
+                ",\"snapshot_age_ms\":" + QByteArray::number(QDateTime::currentMSecsSinceEpoch() - current->builtAt) + "}";
+    }
+
+    if (command == "ping")
+        return "{\"pong\":true}";
+
+    return "{\"error\":\"unknown command\"}";
+}
+
+/*!
+ * \brief Rebuilds the snapshot from the database and swaps it in for the workers.
+ * \return A boolean value that is false if the database could not be read.
+ * \note Runs on the main thread. Workers still answering from the previous snapshot keep it alive until they are done.
+ * \note If the database could not be read, the previous snapshot is kept. It is rebuilt with the next change,
+ * or within DayCheckInterval if the day changed.
+ */
+bool SurveyDaemon::refreshSnapshot()
+{
+    std::shared_ptr<ClearanceSnapshot> next(std::make_shared<ClearanceSnapshot>());
+    next->date = QDate::currentDate();
+    next->builtAt = QDateTime::currentMSecsSinceEpoch();
+    next->activeMask = surveyDb.getQuestionSet().getActiveMask();
+
+    bool ok;
+    const QList<DailyStatus> statuses(surveyDb.getDailyStatus(next->date, &ok));
+
+    if (!ok) {
+        qDebug() << "(Daemon) Error refreshing snapshot, the previous one is kept." << Qt::endl;
+        return false;
+    }
+
+    next->statuses.reserve(statuses.size());
+    next->idsByName.reserve(statuses.size());
+
+    for (const DailyStatus &status : statuses) {
+        next->statuses.insert(status.empId, status);
+        next->idsByName.insert(SurveyDatabase::normalizeName(status.name), status.empId);
+
+        QByteArray reason(getClearanceReason(status, next->activeMask));
+
+        if (status.surveyed)
+            ++next->surveyed;
+
+        if (reason == "ok")
+            ++next->cleared;
+        else if (reason == "symptoms")
+            ++next->symptoms;
+        else if (reason == "fever")
+            ++next->fever;
+        else if (reason == "anomaly")
+            ++next->anomalies;
+    }
+
+    std::atomic_store(&snapshot, std::shared_ptr<const ClearanceSnapshot>(std::move(next)));
+    return true;
+}
+
+/*!
+ * \brief Hands a new client to the next worker thread.
+ * \param descriptor = The socket descriptor of the client
+ */
+void SurveyDaemon::acceptClient(const quintptr &descriptor)
+{
+    QObject *context(workerContexts[nextWorker]);
+    nextWorker = (nextWorker + 1) % static_cast<int>(workerContexts.size());
+
+    QMetaObject::invokeMethod(context, [this, context, descriptor]() { serveClient(context, descriptor); }, Qt::QueuedConnection);
+}
+
+/*!
+ * \brief Creates the socket of a new client on the worker thread that serves it.
+ * \param context = The object of the worker thread, which owns the socket
+ * \param descriptor = The socket descriptor of the client
+ */
+void SurveyDaemon::serveClient(QObject *context, const quintptr &descriptor)
+{
+    QLocalSocket *socket(new QLocalSocket(context));
+
+    if (!socket->setSocketDescriptor(descriptor)) {
+        qDebug() << "(Daemon) Error accepting client: " << socket->errorString() << Qt::endl;
+        delete socket;
+        return;
+    }
+
+    connect(socket, &QLocalSocket::readyRead, context, [this, socket]() { readClient(socket); });
+    connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+}
+
+/*!
+ * \brief Answers every complete request a client sent.
+ * \param socket = The client's socket
+ * \note Runs on the worker thread of the client.
+ */
+void SurveyDaemon::readClient(QLocalSocket *socket)
+{
+    while (socket->canReadLine()) {
+        QElapsedTimer latencyTimer;
+        latencyTimer.start();
+
+        QByteArray response(answer(socket->readLine().trimmed()));
+        response.append('\n');
+        socket->write(response);
+
+        recordLatency(latencyTimer.nsecsElapsed());
+    }
+
+    if (socket->bytesAvailable() > MaxRequestSize) {
+        socket->write("{\"error\":\"request too long\"}\n");
+        socket->disconnectFromServer();
+    }
+}
+
+/*!
+ * \brief Adds the latency of a request to the histogram.
+ * \param nsecs = The time (in nanoseconds) from reading the request until the response was written to the socket
+ */
+void SurveyDaemon::recordLatency(const qint64 &nsecs)
+{
+    qint64 usecs(nsecs / 1000);
+    int bucket(0);
+
+    // Bucket N holds the latencies below 2^N microseconds.
+    while (bucket < LatencyBuckets - 1 && (Q_INT64_C(1) << bucket) <= usecs)
+        ++bucket;
+
+    ++latencyHistogram[bucket];
+    ++requests;
+}
+
+/*!
+ * \brief Estimates a percentile of the request latency from the histogram.
+ * \param percentile = The percentile as a fraction, for example 0.99
+ * \return The upper bound (in microseconds) of the bucket that holds the percentile, or 0 if there were no requests.
+ */
+double SurveyDaemon::getLatencyPercentile(const double &percentile) const
+{
+    qint64 counts[LatencyBuckets];
+    qint64 total(0);
+
+    for (int i = 0; i < LatencyBuckets; ++i) {
+        counts[i] = latencyHistogram[i].load();
+        total += counts[i];
+    }
+
+    qint64 target(qMax(Q_INT64_C(1), static_cast<qint64>(total * percentile + 0.5)));
+    qint64 seen(0);
+
+    for (int i = 0; total > 0 && i < LatencyBuckets; ++i) {
+        seen += counts[i];
+
+        if (seen >= target)
+            return static_cast<double>(Q_INT64_C(1) << i);
+    }
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+#ifndef SURVEYDAEMON_H
+#define SURVEYDAEMON_H
+
+#include "surveydatabase.h"
+
+#include <QObject>
+#include <QHash>
+#include <QDate>
+#include <QTimer>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class QLocalServer;
+class QLocalSocket;
+class QThread;
+
+/*!
+ * \brief The clearance of every employee on a single day, kept in memory to answer queries without the database.
+ */
+struct ClearanceSnapshot
+{
+    QDate date;                         ///< The day the snapshot is for.
+    qint64 builtAt = 0;                 ///< When the snapshot was built, in milliseconds since the epoch.
+    quint32 activeMask = 0;             ///< The bits of the questions that are still asked.
+    QHash<int, DailyStatus> statuses;   ///< The status of every employee by ID.
+    QHash<QString, int> idsByName;      ///< The IDs of the employees by normalized name (see SurveyDatabase::normalizeName()).
+    int surveyed = 0;                   ///< The amount of employees that submitted a survey.
+    int cleared = 0;                    ///< The amount of employees that are cleared.
+    int symptoms = 0;                   ///< The amount of employees that answered "Yes" to an active question.
+    int fever = 0;                      ///< The amount of employees with a fever.
+    int anomalies = 0;                  ///< The amount of employees with an abnormally high temperature.
+};
+
+/*!
+ * \brief Answers clearance, lookup and aggregate queries from other tools over a local socket, without a GUI.
+ *
+ * Today's status of every employee is kept in an immutable ClearanceSnapshot that is rebuilt on the main thread
+ * when the database changes or the day changes, and swapped in atomically. Clients are spread over a pool of
+ * threads that each run their own event loop, so a query is answered on the thread that read it, from memory,
+ * without locks.
+ *
+ * The protocol is line based: every request is a single line, every response a single line of JSON.
+ *
+ *     cleared <emp_id>    Is the employee cleared today?
+ *     lookup <name>       The ID of an employee by name (case insensitive).
+ *     stats               Today's totals.
+ *     status              The amount of requests served and their latency.
+ *     ping                Checks if the daemon is alive.
+ *
+ * An employee is cleared if they submitted a survey today, answered "No" to every active question, has no fever
+ * (see Survey::FeverTemperature) and the temperature was not flagged as abnormally high for them.
+ */
+class SurveyDaemon : public QObject
+{
+    Q_OBJECT
+public:
+    static const int LatencyBuckets = 24;           ///< The amount of power of two microsecond buckets in the latency histogram.
+
+    explicit SurveyDaemon(QObject *parent = nullptr);
+    ~SurveyDaemon();
+
+    bool start(const QString &socketName, const QString &dbLocation, const DurabilityProfile &profile, const int &threads = 0);
+    void stop();
+    QString getServerName() const;
+
+    QByteArray answer(const QByteArray &request) const;
+
+private slots:
+    bool refreshSnapshot();
+
+private:
+    SurveyDatabase surveyDb;        ///< The database the snapshot is built from.
+    QLocalServer *server;           ///< Accepts the clients and hands them to the workers.
+    std::vector<QThread *> workers; ///< The threads that serve the clients.
+    std::vector<QObject *> workerContexts; ///< An object living in every worker thread, which owns its clients.
+    int nextWorker;                 ///< The worker the next client is handed to.
+    QTimer dayTimer;                ///< Rebuilds the snapshot when the day changes.
+    std::shared_ptr<const ClearanceSnapshot> snapshot;  ///< The current snapshot, only accessed with std::atomic_load and std::atomic_store.
+
+    std::atomic<qint64> requests;   ///< The amount of requests answered.
+    std::atomic<qint64> latencyHistogram[LatencyBuckets];  ///< The amount of requests per power of two microseconds of latency.
+
+    void acceptClient(const quintptr &descriptor);
+    void serveClient(QObject *context, const quintptr &descriptor);
+    void readClient(QLocalSocket *socket);
+    void recordLatency(const qint64 &nsecs);
+    double getLatencyPercentile(const double &percentile) const;
+};
+
+#endif // SURVEYDAEMON_H
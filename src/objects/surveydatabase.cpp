@@ -1,95 +1,554 @@
 ﻿#include "surveydatabase.h"
+#include "tracer.h"
 
 #include <QSqlDatabase>
-#include <QSqlQueryModel>
 #include <QFile>
 #include <QSqlQuery>
 #include <QtDebug>
 #include <QSqlError>
 #include <QDateTime>
 #include <QDate>
+#include <QFileInfo>
+#include <QStorageInfo>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QRandomGenerator>
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+namespace {
+/*!
+ * \brief The schema version of a fully upgraded database, stored in PRAGMA user_version.
+ * \note Increase this with every new step in SurveyDatabase::upgradeDatabase().
+ */
+const int SchemaVersion(7);
+
+const int BusyTimeout(1000);        ///< The time (in milliseconds) SQLite waits for a lock held by another workstation.
+const int MainBusyTimeout(100);     ///< The BusyTimeout of connections on the main thread, which must keep handling user input.
+const int MaxWriteAttempts(4);      ///< The amount of times a write transaction is tried before it fails (once on the main thread).
+const int RetryBackoff(50);         ///< The wait (in milliseconds) before the first retry, doubled for every next retry.
+const int ChangePollInterval(1000); ///< The interval (in milliseconds) at which changes by other workstations are checked.
+
+/*!
+ * \brief Determines if the calling thread is the main thread, which runs the event loop that handles user input.
+ * \return A boolean value that is true on the main thread (or when there is no application object).
+ */
+bool isMainThread()
+{
+    return QCoreApplication::instance() == nullptr || QThread::currentThread() == QCoreApplication::instance()->thread();
+}
+
+/*!
+ * \brief Determines if a statement failed because another connection holds a lock.
+ * \param error = The error of the statement
+ * \return A boolean value that is true for SQLITE_BUSY (5) and SQLITE_LOCKED (6), the only errors worth retrying.
+ */
+bool isBusyError(const QSqlError &error)
+{
+    return error.nativeErrorCode() == "5" || error.nativeErrorCode() == "6";
+}
+
+/*!
+ * \brief Waits before the next attempt of a write that found the database locked.
+ * \param attempt = The attempt that failed, starting at 1
+ * \note The wait grows with every attempt and is randomized, so workstations that collided do not retry in lockstep.
+ */
+void waitBeforeRetry(const int &attempt)
+{
+    QThread::msleep(static_cast<unsigned long>(RetryBackoff * (1 << (attempt - 1)) +
+                                               QRandomGenerator::global()->bounded(RetryBackoff)));
+}
+
+/*!
+ * \brief Determines if a database file is stored on a network share.
+ * \param location = The full path to the database file
+ * \return A boolean value that is true if the file is (most likely) on a network file system.
+ * \note WAL needs shared memory between all connections, which network file systems do not provide.
+ */
+bool isNetworkLocation(const QString &location)
+{
+    if (location == SurveyDatabase::InMemoryLocation)
+        return false;
+
+    static const QList<QByteArray> networkTypes({"nfs", "nfs4", "cifs", "smbfs", "smb2", "smb3", "afpfs", "webdav", "fuse.sshfs"});
+
+    if (location.startsWith("//") || location.startsWith("\\\\"))
+        return true;
+
+    QStorageInfo storage(QFileInfo(location).absolutePath());
+
+    return networkTypes.contains(storage.fileSystemType().toLower());
+}
+
+/*!
+ * \brief Converts the ID of a site or department to a value that can be bound to a statement.
+ * \param id = The ID, or -1 for none
+ * \return The ID, or a NULL value if there is none.
+ */
+QVariant idOrNull(const int &id)
+{
+    return id >= 0 ? QVariant(id) : QVariant();
+}
+
+/*!
+ * \brief Creates a connection name that no other SurveyDatabase in the process uses.
+ * \return The connection name.
+ */
+QString createConnectionName()
+{
+    static std::atomic<int> nextConnection(1);
+
+    return "SurveyCon" + QString::number(nextConnection++);
+}
+}
 
 /*!
  * \brief The constructor for the SurveyDatabase.
  * \param parent = The QObject to which this object is bound to.
+ * \param connection = The name of the connection, which must be unique for every SurveyDatabase that exists at the same time,
+ *                     or empty to generate a unique one
  * The currentEmpId member is initialized to 1. This is because it is the number with which SQLite starts with.
+ * \note A connection can only be used by the thread that created it, so every thread needs its own SurveyDatabase.
  */
-SurveyDatabase::SurveyDatabase(QObject *parent) :
+SurveyDatabase::SurveyDatabase(QObject *parent, const QString &connection) :
     QObject(parent),
-    surveyDb(QSharedPointer<QSqlDatabase>(new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", "SurveyCon")))),
+    connectionName(connection.isEmpty() ? createConnectionName() : connection),
+    surveyDb(QSharedPointer<QSqlDatabase>(new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", connectionName)))),
     surveyModel(QSharedPointer<SurveyTableModel>(new SurveyTableModel(this))),
     employeeModel(QSharedPointer<EmployeeTableModel>(new EmployeeTableModel(this))),
     dbLocation(""),
-    currentEmpId(-1)
+    currentEmpId(-1),
+    issuedQueries(),
+    questionSet(),
+    journalMode(),
+    lastError(),
+    lockBusy(false),
+    contentionStats(),
+    profile(DurabilityProfile::balanced()),
+    dataVersion(-1),
+    changeTimer(this),
+    pageCache(),
+    pageLoader(this),
+    loadEpoch(0),
+    idsByNameKey(),
+    nameKeysById(),
+    auditLog(this),
+    daySketches(),
+    staleSketchDays(),
+    sketchesLoaded(false),
+    backup(this),
+    partition()
 {
+    changeTimer.setInterval(ChangePollInterval);
+
+    connect(&changeTimer, &QTimer::timeout, this, &SurveyDatabase::checkForChanges);
+    connect(&pageLoader, &SurveyPageLoader::chunkLoaded, this, &SurveyDatabase::surveyChunkLoaded);
+    connect(&pageLoader, &SurveyPageLoader::loadFinished, this, &SurveyDatabase::surveyLoadFinished);
+    connect(&pageLoader, &SurveyPageLoader::pagePrefetched, this, &SurveyDatabase::surveyPagePrefetched);
+}
+
+/*!
+ * \brief The destructor for the SurveyDatabase.
+ */
+SurveyDatabase::~SurveyDatabase()
+{
+    closeDb();
+
+    // Release the connection name, so another SurveyDatabase can be created afterwards.
+    surveyDb.reset();
+    QSqlDatabase::removeDatabase(connectionName);
 }
 
 /*!
  * \brief Creates the database file if it doesn't exist and updates the survey model.
- * \param dir = The full path to where the database file should be stored
+ * \param dir = The full path to where the database file should be stored, or InMemoryLocation
  * \return A boolean value stating whether the creation was successful or not.
+ * \note An in-memory database always starts empty and is gone once it is closed. Surveys are loaded on the
+ *       calling thread, and there are no backups, audit log or changes by other workstations.
  */
 bool SurveyDatabase::createDatabase(const QString &dir)
 {
+    bool isNew(dir == InMemoryLocation || !QFile::exists(dir));
+
+    closeDb();
     dbLocation = dir;
+    openDb();
+
+    if (!surveyDb->isOpen()) {
+        qDebug() << "(DB) Error opening database: " << surveyDb->lastError().text() << Qt::endl;
+        return false;
+    }
+
+    if (isNew) {
+        QSqlQuery surveyQry(*surveyDb);
+
+        prepareQuery(surveyQry, "CREATE TABLE Employee ("
+                          "emp_id INTEGER UNIQUE NOT NULL PRIMARY KEY AUTOINCREMENT,"
+                          "name TEXT NOT NULL COLLATE NOCASE);");
+
+        if (!surveyQry.exec()) {
+            qDebug() << "(DB) Error creating employee info: " << surveyQry.lastError().text() << Qt::endl;
+            return false;
+        }
+
+        prepareQuery(surveyQry, "CREATE TABLE Survey ("
+                          "survey_date INTEGER NOT NULL,"
+                          "emp_id INTEGER NOT NULL,"
+                          "q_one INTEGER,"
+                          "q_two INTEGER,"
+                          "q_three INTEGER,"
+                          "temperature REAL,"
+                          "PRIMARY KEY(survey_date, emp_id),"
+                          "FOREIGN KEY(emp_id) REFERENCES Employee(emp_id)"
+                          ");");
+
+        if (!surveyQry.exec()) {
+            qDebug() << "(DB) Error creating survey info: " << surveyQry.lastError().text() << Qt::endl;
+            return false;
+        }
+    }
+
+    if (!upgradeDatabase() || !loadQuestionSet() || !loadEmployeeKeys())
+        return false;
+
+    // The background loads and the backups open their own connections, which cannot reach an in-memory database.
+    if (isInMemory()) {
+        pageLoader.setDatabaseLocation(QString());
+        backup.setDatabaseLocation(QString());
+        auditLog.setLocation(QString());
+    } else {
+        QFileInfo dbInfo(dbLocation);
 
-    if (!QFile::exists(dir)) {
-        surveyDb->setDatabaseName(dir);
+        pageLoader.setDatabaseLocation(dbLocation);
+        backup.setDatabaseLocation(dbLocation);
+        auditLog.setLocation(dbInfo.absolutePath() + "/" + dbInfo.completeBaseName() + ".audit");
+    }
+
+    updateEmployeeTableModel();
+    updateSurveyTableModel();
+
+    checkForChanges();
+
+    if (!isInMemory())
+        changeTimer.start();
+
+    return true;
+}
+
+/*!
+ * \brief Brings the schema of an existing database up to date.
+ * \return A boolean value stating whether the upgrade was successful or not.
+ * \note The schema version is kept in PRAGMA user_version. Every step runs in a single transaction.
+ *
+ * Version 1: Rebuilds the Survey table so its employee foreign key cascades on delete and indexes the surveys by employee.
+ * Version 2: Adds the per-employee temperature trends and alerts, and builds them from the existing surveys.
+ * Version 3: Moves the questions into the Question table and packs the answers of every survey into a single bitmask.
+ * Version 4: Adds the EmployeeSummary table, kept up to date by triggers on Employee and Survey.
+ * Version 5: Adds the normalized name key of every employee with a unique index.
+ * Version 6: Adds the per-day temperature bins behind TemperatureSketch, kept up to date by triggers on Survey.
+ * Version 7: Adds the sites and departments, and indexes the employees by them.
+ */
+bool SurveyDatabase::upgradeDatabase()
+{
+    openDb();
+
+    QSqlQuery surveyQry(*surveyDb);
+    int version(0);
+
+    if (surveyQry.exec("PRAGMA user_version;") && surveyQry.next())
+        version = surveyQry.value(0).toInt();
+
+    if (version >= SchemaVersion)
+        return true;
+
+    // Tables can only be rebuilt while foreign keys are not enforced.
+    // This has no effect inside a transaction, so it is switched around the whole upgrade.
+    surveyQry.exec("PRAGMA foreign_keys = OFF;");
+
+    bool upgraded(upgradeSchema());
+
+    surveyQry.exec("PRAGMA foreign_keys = ON;");
+
+    return upgraded;
+}
+
+/*!
+ * \brief Runs the upgrade steps the database still needs in a single write transaction.
+ * \return A boolean value stating whether the upgrade was successful or not.
+ * \note Foreign keys must be switched off by the caller.
+ */
+bool SurveyDatabase::upgradeSchema()
+{
+    if (!beginWrite())
+        return false;
+
+    QSqlQuery surveyQry(*surveyDb);
+    int version(0);
+
+    // Read the version again under the write lock, another workstation may have upgraded the file in the meantime.
+    if (surveyQry.exec("PRAGMA user_version;") && surveyQry.next())
+        version = surveyQry.value(0).toInt();
 
-        if (surveyDb->open()) {
-            QSqlQuery surveyQry(*surveyDb);
+    if (version >= SchemaVersion) {
+        surveyDb->rollback();
+        return true;
+    }
+
+    QStringList statements;
+
+    if (version < 1) {
+        statements << "CREATE TABLE Survey_new ("
+                      "survey_date INTEGER NOT NULL,"
+                      "emp_id INTEGER NOT NULL,"
+                      "q_one INTEGER,"
+                      "q_two INTEGER,"
+                      "q_three INTEGER,"
+                      "temperature REAL,"
+                      "PRIMARY KEY(survey_date, emp_id),"
+                      "FOREIGN KEY(emp_id) REFERENCES Employee(emp_id) ON DELETE CASCADE"
+                      ");"
+                   << "INSERT INTO Survey_new SELECT survey_date, emp_id, q_one, q_two, q_three, temperature FROM Survey;"
+                   << "DROP TABLE Survey;"
+                   << "ALTER TABLE Survey_new RENAME TO Survey;"
+                   << "CREATE INDEX idx_survey_emp ON Survey(emp_id, survey_date);";
+    }
+
+    if (version < 2) {
+        statements << "CREATE TABLE TemperatureTrend ("
+                      "emp_id INTEGER NOT NULL PRIMARY KEY,"
+                      "mean REAL NOT NULL,"
+                      "variance REAL NOT NULL,"
+                      "samples INTEGER NOT NULL,"
+                      "last_date INTEGER NOT NULL,"
+                      "prev_mean REAL NOT NULL,"
+                      "prev_variance REAL NOT NULL,"
+                      "prev_samples INTEGER NOT NULL,"
+                      "FOREIGN KEY(emp_id) REFERENCES Employee(emp_id) ON DELETE CASCADE"
+                      ");"
+                   << "CREATE TABLE TemperatureAlert ("
+                      "survey_date INTEGER NOT NULL,"
+                      "emp_id INTEGER NOT NULL,"
+                      "temperature REAL NOT NULL,"
+                      "baseline REAL NOT NULL,"
+                      "zscore REAL NOT NULL,"
+                      "PRIMARY KEY(survey_date, emp_id),"
+                      "FOREIGN KEY(survey_date, emp_id) REFERENCES Survey(survey_date, emp_id) ON DELETE CASCADE ON UPDATE CASCADE"
+                      ");"
+                   << "CREATE INDEX idx_alert_emp ON TemperatureAlert(emp_id, survey_date);";
+    }
+
+    if (version < 3) {
+        statements << "CREATE TABLE Question ("
+                      "bit INTEGER NOT NULL PRIMARY KEY CHECK(bit >= 0 AND bit < 32),"
+                      "text TEXT NOT NULL,"
+                      "active INTEGER NOT NULL DEFAULT 1"
+                      ");"
+                   << "INSERT INTO Question (bit, text) VALUES "
+                      "(0, '<p><b>Do you or anyone in your household have ANY of these symptoms:</b></p>"
+                      "<p>- Fever of 38 °C or more<br/>- Cough<br/>- Sore throat<br/>- Loss of sense of smell or taste<br/>- Shortness of breath</p>"
+                      "<p><b>WITH OR WITHOUT these other symptoms:</b></p>"
+                      "<p>- Weakness<br/>- Muscle pain<br/>- Diarrhoea</p>'),"
+                      "(1, 'Have you been in close contact with a person who has confirmed COVID-19 in the last 24 hours?'),"
+                      "(2, 'Have you been asked to isolate or quarantine by a health professional in the last 24 hours?');"
+                   << "CREATE TABLE Survey_new ("
+                      "survey_date INTEGER NOT NULL,"
+                      "emp_id INTEGER NOT NULL,"
+                      "answers INTEGER NOT NULL DEFAULT 0,"
+                      "temperature REAL,"
+                      "PRIMARY KEY(survey_date, emp_id),"
+                      "FOREIGN KEY(emp_id) REFERENCES Employee(emp_id) ON DELETE CASCADE"
+                      ");"
+                   << "INSERT INTO Survey_new SELECT survey_date, emp_id, "
+                      "(IFNULL(q_one, 0) != 0) | ((IFNULL(q_two, 0) != 0) << 1) | ((IFNULL(q_three, 0) != 0) << 2), "
+                      "temperature FROM Survey;"
+                   << "DROP TABLE Survey;"
+                   << "ALTER TABLE Survey_new RENAME TO Survey;"
+                   << "CREATE INDEX idx_survey_emp ON Survey(emp_id, survey_date);";
+    }
+
+    // The summary is kept up to date by triggers, so every write to Survey updates it in the same transaction.
+    // The Survey triggers are dropped with the table, so any later step that rebuilds Survey must create them again.
+    if (version < 4) {
+        statements << "CREATE TABLE EmployeeSummary ("
+                      "emp_id INTEGER NOT NULL PRIMARY KEY,"
+                      "survey_count INTEGER NOT NULL DEFAULT 0,"
+                      "last_date INTEGER,"
+                      "last_temperature REAL,"
+                      "FOREIGN KEY(emp_id) REFERENCES Employee(emp_id) ON DELETE CASCADE"
+                      ");"
+                   << "INSERT INTO EmployeeSummary (emp_id, survey_count, last_date, last_temperature) "
+                      "SELECT e.emp_id, COUNT(s.emp_id), MAX(s.survey_date), "
+                      "(SELECT temperature FROM Survey WHERE emp_id = e.emp_id ORDER BY survey_date DESC LIMIT 1) "
+                      "FROM Employee e LEFT JOIN Survey s ON s.emp_id = e.emp_id "
+                      "GROUP BY e.emp_id;"
+                   << "CREATE TRIGGER trg_employee_summary_add AFTER INSERT ON Employee BEGIN "
+                      "INSERT OR IGNORE INTO EmployeeSummary (emp_id) VALUES (NEW.emp_id); "
+                      "END;"
+                   // A new survey only replaces the last one if it is not older.
+                   << "CREATE TRIGGER trg_survey_summary_insert AFTER INSERT ON Survey BEGIN "
+                      "UPDATE EmployeeSummary SET "
+                      "survey_count = survey_count + 1, "
+                      "last_temperature = CASE WHEN last_date IS NULL OR NEW.survey_date >= last_date "
+                      "THEN NEW.temperature ELSE last_temperature END, "
+                      "last_date = CASE WHEN last_date IS NULL OR NEW.survey_date >= last_date "
+                      "THEN NEW.survey_date ELSE last_date END "
+                      "WHERE emp_id = NEW.emp_id; "
+                      "END;"
+                   // Only removing the last survey needs a lookup, which is a single step back in idx_survey_emp.
+                   << "CREATE TRIGGER trg_survey_summary_delete AFTER DELETE ON Survey BEGIN "
+                      "UPDATE EmployeeSummary SET survey_count = survey_count - 1 WHERE emp_id = OLD.emp_id; "
+                      "UPDATE EmployeeSummary SET (last_date, last_temperature) = "
+                      "(SELECT survey_date, temperature FROM Survey WHERE emp_id = OLD.emp_id ORDER BY survey_date DESC LIMIT 1) "
+                      "WHERE emp_id = OLD.emp_id AND last_date = OLD.survey_date; "
+                      "END;"
+                   << "CREATE TRIGGER trg_survey_summary_update AFTER UPDATE OF survey_date, emp_id, temperature ON Survey BEGIN "
+                      "UPDATE EmployeeSummary SET survey_count = survey_count - 1 WHERE emp_id = OLD.emp_id; "
+                      "UPDATE EmployeeSummary SET survey_count = survey_count + 1 WHERE emp_id = NEW.emp_id; "
+                      "UPDATE EmployeeSummary SET (last_date, last_temperature) = "
+                      "(SELECT survey_date, temperature FROM Survey WHERE emp_id = EmployeeSummary.emp_id ORDER BY survey_date DESC LIMIT 1) "
+                      "WHERE emp_id IN (OLD.emp_id, NEW.emp_id); "
+                      "END;";
+    }
+
+    // The keys are filled in below, SQLite can neither fold case nor normalize Unicode.
+    if (version < 5)
+        statements << "ALTER TABLE Employee ADD COLUMN name_key TEXT;";
+
+    // Like the summary, the bins are kept up to date by triggers, which also catch the cascading deletes.
+    if (version < 6) {
+        const QString newBin(TemperatureSketch::getBinExpression("NEW.temperature"));
+        const QString oldBin(TemperatureSketch::getBinExpression("OLD.temperature"));
+        const QString addNew("INSERT INTO TemperatureBin (survey_date, bin, count) "
+                             "SELECT NEW.survey_date, " + newBin + ", 1 WHERE NEW.temperature IS NOT NULL "
+                             "ON CONFLICT(survey_date, bin) DO UPDATE SET count = count + 1; ");
+        const QString removeOld("UPDATE TemperatureBin SET count = count - 1 "
+                                "WHERE survey_date = OLD.survey_date AND bin = " + oldBin + "; "
+                                "DELETE FROM TemperatureBin "
+                                "WHERE survey_date = OLD.survey_date AND bin = " + oldBin + " AND count <= 0; ");
+
+        statements << "CREATE TABLE TemperatureBin ("
+                      "survey_date INTEGER NOT NULL,"
+                      "bin INTEGER NOT NULL,"
+                      "count INTEGER NOT NULL,"
+                      "PRIMARY KEY(survey_date, bin)"
+                      ") WITHOUT ROWID;"
+                   << "INSERT INTO TemperatureBin (survey_date, bin, count) "
+                      "SELECT survey_date, " + TemperatureSketch::getBinExpression("temperature") + " AS bin, COUNT(*) "
+                      "FROM Survey WHERE temperature IS NOT NULL "
+                      "GROUP BY survey_date, bin;"
+                   << "CREATE TRIGGER trg_survey_sketch_insert AFTER INSERT ON Survey BEGIN " + addNew + "END;"
+                   << "CREATE TRIGGER trg_survey_sketch_delete AFTER DELETE ON Survey "
+                      "WHEN OLD.temperature IS NOT NULL BEGIN " + removeOld + "END;"
+                   << "CREATE TRIGGER trg_survey_sketch_update AFTER UPDATE OF survey_date, temperature ON Survey BEGIN " +
+                      removeOld + addNew + "END;";
+    }
+
+    // Partitioned queries find the employees of a site or department through these indexes first,
+    // then only read the surveys of those employees through idx_survey_emp.
+    if (version < 7) {
+        statements << "CREATE TABLE Site ("
+                      "site_id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,"
+                      "name TEXT NOT NULL UNIQUE COLLATE NOCASE"
+                      ");"
+                   << "CREATE TABLE Department ("
+                      "dept_id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,"
+                      "name TEXT NOT NULL UNIQUE COLLATE NOCASE"
+                      ");"
+                   << "ALTER TABLE Employee ADD COLUMN site_id INTEGER REFERENCES Site(site_id) ON DELETE SET NULL;"
+                   << "ALTER TABLE Employee ADD COLUMN dept_id INTEGER REFERENCES Department(dept_id) ON DELETE SET NULL;"
+                   << "CREATE INDEX idx_employee_site ON Employee(site_id, dept_id);"
+                   << "CREATE INDEX idx_employee_dept ON Employee(dept_id);";
+    }
+
+    statements << "PRAGMA user_version = " + QString::number(SchemaVersion) + ";";
+
+    for (const QString &statement : statements) {
+        if (!surveyQry.exec(statement)) {
+            qDebug() << "(DB) Error upgrading database: " << surveyQry.lastError().text() << Qt::endl;
+            surveyDb->rollback();
+            return false;
+        }
+    }
 
-            surveyQry.prepare("CREATE TABLE Employee ("
-                              "emp_id INTEGER UNIQUE NOT NULL PRIMARY KEY AUTOINCREMENT,"
-                              "name TEXT NOT NULL COLLATE NOCASE);");
+    if (version < 2) {
+        QList<int> empIds;
+
+        if (surveyQry.exec("SELECT emp_id FROM Employee;")) {
+            while (surveyQry.next())
+                empIds.append(surveyQry.value(0).toInt());
+        }
 
-            if (!surveyQry.exec()) {
-                qDebug() << "(DB) Error creating employee info: " << surveyQry.lastError().text() << Qt::endl;
-                closeDb();
+        for (const int &empId : empIds) {
+            if (!rebuildTrend(empId)) {
+                surveyDb->rollback();
                 return false;
             }
+        }
+    }
+
+    // Existing duplicates cannot share a key. Only the oldest employee gets it, the others keep
+    // a NULL key (which the unique index allows) until they are merged into it.
+    if (version < 5) {
+        QHash<QString, int> keys;
+
+        if (surveyQry.exec("SELECT emp_id, name FROM Employee ORDER BY emp_id;")) {
+            while (surveyQry.next()) {
+                QString key(normalizeName(surveyQry.value(1).toString()));
+
+                if (!key.isEmpty() && !keys.contains(key))
+                    keys.insert(key, surveyQry.value(0).toInt());
+            }
+        }
+
+        QSqlQuery keyQry(*surveyDb);
+        keyQry.prepare("UPDATE Employee SET name_key = :key WHERE emp_id = :id;");
 
-            surveyQry.prepare("CREATE TABLE Survey ("
-                              "survey_date INTEGER NOT NULL,"
-                              "emp_id INTEGER NOT NULL,"
-                              "q_one INTEGER,"
-                              "q_two INTEGER,"
-                              "q_three INTEGER,"
-                              "temperature REAL,"
-                              "PRIMARY KEY(survey_date, emp_id),"
-                              "FOREIGN KEY(emp_id) REFERENCES Employee(emp_id)"
-                              ");");
-
-            if (!surveyQry.exec()) {
-                qDebug() << "(DB) Error creating survey info: " << surveyQry.lastError().text() << Qt::endl;
-                closeDb();
+        for (auto it = keys.cbegin(); it != keys.cend(); ++it) {
+            keyQry.bindValue(":key", it.key());
+            keyQry.bindValue(":id", it.value());
+
+            if (!keyQry.exec()) {
+                qDebug() << "(DB) Error upgrading database: " << keyQry.lastError().text() << Qt::endl;
+                surveyDb->rollback();
                 return false;
             }
         }
+
+        if (!surveyQry.exec("CREATE UNIQUE INDEX idx_employee_name_key ON Employee(name_key);")) {
+            qDebug() << "(DB) Error upgrading database: " << surveyQry.lastError().text() << Qt::endl;
+            surveyDb->rollback();
+            return false;
+        }
     }
 
-    updateEmployeeTableModel();
-    updateSurveyTableModel();
+    if (!surveyDb->commit()) {
+        qDebug() << "(DB) Error committing upgrade: " << surveyDb->lastError().text() << Qt::endl;
+        surveyDb->rollback();
+        return false;
+    }
 
     return true;
 }
 
 /*!
  * \brief Returns a pointer to the DB's survey model.
- * \return A QSqlQueryModel pointer of the model.
+ * \return A pointer to the model.
  * \note The returned pointer MUST NOT be deleted.
  */
-QSqlQueryModel *SurveyDatabase::getSurveyModel()
+SurveyTableModel *SurveyDatabase::getSurveyModel()
 {
     return surveyModel.data();
 }
 
 /*!
  * \brief Returns a pointer to the DB's employee model.
- * \return A QSqlQueryModel pointer of the model.
+ * \return A pointer to the model.
  * \note The returned pointer MUST NOT be deleted.
  */
-QSqlQueryModel *SurveyDatabase::getEmployeeModel()
+EmployeeTableModel *SurveyDatabase::getEmployeeModel()
 {
     return employeeModel.data();
 }
@@ -103,6 +562,43 @@ int SurveyDatabase::getCurrentEmployeeId() const
     return currentEmpId;
 }
 
+/*!
+ * \brief Retrieves the full path to where the database file is stored.
+ * \return A QString with the database location.
+ */
+QString SurveyDatabase::getDatabaseLocation() const
+{
+    return dbLocation;
+}
+
+/*!
+ * \brief Determines if the database only lives in memory.
+ * \return A boolean value that states whether the database was created at InMemoryLocation.
+ */
+bool SurveyDatabase::isInMemory() const
+{
+    return dbLocation == InMemoryLocation;
+}
+
+/*!
+ * \brief Returns a pointer to the DB's online backup.
+ * \return A pointer to the backup.
+ * \note The returned pointer MUST NOT be deleted.
+ */
+SurveyBackup *SurveyDatabase::getBackup()
+{
+    return &backup;
+}
+
+/*!
+ * \brief Retrieves the location of the audit log of survey edits and removals.
+ * \return The full path to the audit log, next to the database file.
+ */
+QString SurveyDatabase::getAuditLogLocation() const
+{
+    return auditLog.getLocation();
+}
+
 /*!
  * \brief Assigns a new employee ID to use by the database.
  * \param id = The new employee ID
@@ -119,28 +615,90 @@ void SurveyDatabase::setCurrentEmployeeId(const int &id)
  * \param name = The name of the new employee
  * \return A boolean value that states whether the transaction was successful or not.
  * \note This will check if the name doesn't already exist and that it is not an empty string.
- * \note It uses the employeeExists() function to verify its existence.
+ * \note Names are compared by their normalized key (see normalizeName()), so no database lookup is needed.
+ * \note The employee is added to the current partition, so it is listed with the other employees shown.
  */
 bool SurveyDatabase::addEmployee(const QString &name)
 {
-    if (name.length() > 0 && !employeeExist(name)) {
-        openDb();
+    QString key(normalizeName(name));
 
-        QSqlQuery surveyQry(*surveyDb);
+    if (key.isEmpty() || idsByNameKey.contains(key))
+        return false;
 
-        surveyQry.prepare("INSERT INTO Employee (name) VALUES (?);");
-        surveyQry.addBindValue(name);
+    openDb();
 
-        if (surveyQry.exec()) {
-            closeDb();
-            return true;
-        } else {
+    QSqlQuery surveyQry(*surveyDb);
+
+    prepareQuery(surveyQry, "INSERT INTO Employee (name, name_key, site_id, dept_id) VALUES (?, ?, ?, ?);");
+    surveyQry.addBindValue(name.simplified());
+    surveyQry.addBindValue(key);
+    surveyQry.addBindValue(idOrNull(partition.siteId));
+    surveyQry.addBindValue(idOrNull(partition.deptId));
+
+    if (surveyQry.exec()) {
+        setNameKey(surveyQry.lastInsertId().toInt(), key);
+        return true;
+    }
+
+    qDebug() << "(DB) Error adding new employee: " << surveyQry.lastError().text() << Qt::endl;
+
+    // Another workstation may have added the name since the keys were loaded.
+    loadEmployeeKeys();
+
+    return false;
+}
+
+/*!
+ * \brief Adds new employees to the database in a single transaction.
+ * \param names = The names of the new employees
+ * \return The amount of employees that were added, or -1 if the transaction failed.
+ * \note Empty names and names that already exist, in the database or earlier in the list, are skipped.
+ * \note Either all of the employees are added or none of them are.
+ * \note The employees are added to the current partition.
+ */
+int SurveyDatabase::addEmployees(const QStringList &names)
+{
+    openDb();
+
+    if (!beginWrite())
+        return -1;
+
+    QSqlQuery surveyQry(*surveyDb);
+    QHash<QString, int> added;
+
+    prepareQuery(surveyQry, "INSERT INTO Employee (name, name_key, site_id, dept_id) VALUES (?, ?, ?, ?);");
+
+    for (const QString &name : names) {
+        QString key(normalizeName(name));
+
+        if (key.isEmpty() || idsByNameKey.contains(key) || added.contains(key))
+            continue;
+
+        surveyQry.addBindValue(name.simplified());
+        surveyQry.addBindValue(key);
+        surveyQry.addBindValue(idOrNull(partition.siteId));
+        surveyQry.addBindValue(idOrNull(partition.deptId));
+
+        if (!surveyQry.exec()) {
             qDebug() << "(DB) Error adding new employee: " << surveyQry.lastError().text() << Qt::endl;
-            closeDb();
+            surveyDb->rollback();
+            loadEmployeeKeys();
+            return -1;
         }
+
+        added.insert(key, surveyQry.lastInsertId().toInt());
     }
 
-    return false;
+    if (!surveyDb->commit()) {
+        qDebug() << "(DB) Error committing new employees: " << surveyDb->lastError().text() << Qt::endl;
+        surveyDb->rollback();
+        return -1;
+    }
+
+    for (auto it = added.cbegin(); it != added.cend(); ++it)
+        setNameKey(it.value(), it.key());
+
+    return added.size();
 }
 
 /*!
@@ -150,35 +708,69 @@ bool SurveyDatabase::addEmployee(const QString &name)
  * \note This will also delete all surveys associated with this employee.
  */
 bool SurveyDatabase::removeEmployee(const int &empId)
+{
+    return removeEmployees(QList<int>() << empId);
+}
+
+/*!
+ * \brief Removes the given employees from the database in a single transaction.
+ * \param empIds = The IDs of the employees
+ * \return A boolean value that states whether the transaction was successful or not.
+ * \note This will also delete all surveys associated with these employees through the cascading foreign key.
+ * Every deleted survey is recorded in the audit log.
+ * \note Either all of the employees are removed or none of them are.
+ */
+bool SurveyDatabase::removeEmployees(const QList<int> &empIds)
 {
     openDb();
 
+    if (!beginWrite())
+        return false;
+
     QSqlQuery surveyQry(*surveyDb);
+    QList<AuditRecord> audits;
 
-    // Delete all surveys belonging to this employee.
-    surveyQry.prepare("DELETE FROM Survey "
+    // The surveys of every employee are deleted by the cascading foreign key, using idx_survey_emp.
+    prepareQuery(surveyQry, "DELETE FROM Employee "
                       "WHERE emp_id = :id;");
-    surveyQry.bindValue(":id", empId);
-
-    if (surveyQry.exec()) {
 
-        // Delete this employee.
-        surveyQry.prepare("DELETE FROM Employee "
-                          "WHERE emp_id = :id;");
+    for (const int &empId : empIds) {
+        if (!loadAuditRecords(empId, audits)) {
+            surveyDb->rollback();
+            return false;
+        }
 
         surveyQry.bindValue(":id", empId);
 
-        if (surveyQry.exec()) {
-            closeDb();
-            return true;
-        } else
+        if (!surveyQry.exec()) {
             qDebug() << "(DB) Error removing employee: " << surveyQry.lastError().text() << Qt::endl;
+            surveyDb->rollback();
+            return false;
+        }
+    }
 
-    } else
-        qDebug() << "(DB) Error removing employee surveys: " << surveyQry.lastError().text() << Qt::endl;
+    if (!surveyDb->commit()) {
+        qDebug() << "(DB) Error committing employee removal: " << surveyDb->lastError().text() << Qt::endl;
+        surveyDb->rollback();
+        return false;
+    }
 
-    closeDb();
-    return false;
+    for (const int &empId : empIds) {
+        pageCache.invalidate(empId);
+        forgetNameKey(empId);
+    }
+
+    qint64 timestamp(QDateTime::currentMSecsSinceEpoch());
+
+    for (AuditRecord &audit : audits) {
+        audit.timestamp = timestamp;
+        auditLog.append(audit);
+    }
+
+    // The surveys of the employees can be on any day.
+    clearSketches();
+
+    return true;
 }
 
 /*!
@@ -186,28 +778,35 @@ bool SurveyDatabase::removeEmployee(const int &empId)
  * \param empId = The ID of the employee
  * \param newName = The employee's new name to be assigned
  * \return A boolean value that states whether the transaction was successful or not.
+ * \note The edit is rejected if the new name is empty or already belongs to another employee.
  */
 bool SurveyDatabase::editEmployee(const int &empId, const QString &newName)
 {
+    QString key(normalizeName(newName));
+
+    // Only the employee that already has the name may keep it, for example to change its case.
+    if (key.isEmpty() || idsByNameKey.value(key, empId) != empId)
+        return false;
+
     openDb();
 
     QSqlQuery surveyQry(*surveyDb);
 
     // Find the employee by ID and change their name.
-    surveyQry.prepare("UPDATE Employee "
-                      "SET name = :name "
+    prepareQuery(surveyQry, "UPDATE Employee "
+                      "SET name = :name, name_key = :key "
                       "WHERE emp_id = :id;");
 
-    surveyQry.bindValue(":name", newName);
+    surveyQry.bindValue(":name", newName.simplified());
+    surveyQry.bindValue(":key", key);
     surveyQry.bindValue(":id", empId);
 
     if (surveyQry.exec()) {
-        closeDb();
+        setNameKey(empId, key);
         return true;
     } else
         qDebug() << "(DB) Error editing employee by id: " << surveyQry.lastError().text() << Qt::endl;
 
-    closeDb();
     return false;
 }
 
@@ -216,87 +815,375 @@ bool SurveyDatabase::editEmployee(const int &empId, const QString &newName)
  * \param currentName = The employee's current name before the change
  * \param newName = The employee's new name to be assigned
  * \return A boolean value that states whether the transaction was successful or not.
+ * \note The employee is found through the normalized name, so only a single employee is ever renamed.
  */
 bool SurveyDatabase::editEmployee(const QString &currentName, const QString &newName)
 {
-    openDb();
+    int empId(getEmployeeId(currentName));
 
-    QSqlQuery surveyQry(*surveyDb);
-
-    // Find the employee by their current name and change it.
-    surveyQry.prepare("UPDATE Employee "
-                      "SET name = :newname "
-                      "WHERE name = :curname;");
-
-    surveyQry.bindValue(":newname", newName);
-    surveyQry.bindValue(":curname", currentName);
-
-    if (surveyQry.exec()) {
-        closeDb();
-        return true;
-    } else
-        qDebug() << "(DB) Error editing employee by name: " << surveyQry.lastError().text() << Qt::endl;
+    if (empId < 0)
+        return false;
 
-    closeDb();
-    return false;
+    return editEmployee(empId, newName);
 }
 
 /*!
- * \brief Adds a new survey to the database.
- * \param newSurvey = The new survey to be added
- * \return A boolean value that states whether the transaction was successful or not.
- * \note This will also check if a combination of this date and employee ID hasn't already been added. It will return false if it was.
- * \note The new survey will be rejected if it is not valid. This function will return false.
+ * \brief Renames employees in a single transaction.
+ * \param renames = Pairs of an employee's current name and their new name
+ * \return The amount of employees that were renamed, or -1 if the transaction failed.
+ * \note A rename is skipped if the new name is empty or already belongs to another employee. Use mergeEmployees() for duplicates.
+ * \note Either all of the renames are applied or none of them are.
  */
-bool SurveyDatabase::addSurvey(const Survey &newSurvey)
+int SurveyDatabase::renameEmployees(const QList<QPair<QString, QString>> &renames)
 {
-    if (newSurvey.isValid()) {
-        openDb();
+    openDb();
 
-        QDateTime surveyDate(newSurvey.getSurveyDate(), QTime(12,0));
-        int surveyDateUnix(surveyDate.toSecsSinceEpoch());
+    if (!beginWrite())
+        return -1;
 
-        QSqlQuery surveyQry(*surveyDb);
+    QSqlQuery renameQry(*surveyDb);
+    // The keys as they will be after the transaction, so a later rename in the list sees the earlier ones.
+    QHash<QString, int> ids(idsByNameKey);
+    QList<QPair<int, QString>> renamed;
 
-        surveyQry.prepare("SELECT COUNT(*) FROM Survey WHERE survey_date = :date AND emp_id = :id;");
-        surveyQry.bindValue(":date", surveyDateUnix);
-        surveyQry.bindValue(":id", newSurvey.getEmployeeId());
+    prepareQuery(renameQry, "UPDATE Employee "
+                      "SET name = :newname, name_key = :key "
+                      "WHERE emp_id = :id;");
 
-        if (surveyQry.exec()) {
-            if (surveyQry.next()) {
-                if (surveyQry.value(0).toInt() == 0) {
+    for (const QPair<QString, QString> &rename : renames) {
+        QString currentKey(normalizeName(rename.first));
+        QString newKey(normalizeName(rename.second));
+        int empId(ids.value(currentKey, -1));
 
-                    surveyQry.prepare("INSERT INTO Survey (survey_date, emp_id, q_one, q_two, q_three, temperature) "
-                                      "VALUES (:date, :id, :q1, :q2, :q3, :temp);");
+        // Only the employee that already has the name may keep it, for example to change its case.
+        if (empId < 0 || newKey.isEmpty() || ids.value(newKey, empId) != empId)
+            continue;
 
-                    surveyQry.bindValue(":date", surveyDateUnix);
-                    surveyQry.bindValue(":id", newSurvey.getEmployeeId());
-                    surveyQry.bindValue(":q1", newSurvey.getQuestionOne());
-                    surveyQry.bindValue(":q2", newSurvey.getQuestionTwo());
-                    surveyQry.bindValue(":q3", newSurvey.getQuestionThree());
-                    surveyQry.bindValue(":temp", newSurvey.getTemperature());
+        renameQry.bindValue(":newname", rename.second.simplified());
+        renameQry.bindValue(":key", newKey);
+        renameQry.bindValue(":id", empId);
 
-                    if (surveyQry.exec()) {
-                        closeDb();
-                        return true;
-                    } else
-                        qDebug() << "(DB) Error adding survey: " << surveyQry.lastError().text() << Qt::endl;
-                }
-            }
-        } else
-            qDebug() << "(DB) Error verifying survey: " << surveyQry.lastError().text() << Qt::endl;
+        if (!renameQry.exec()) {
+            qDebug() << "(DB) Error renaming employee: " << renameQry.lastError().text() << Qt::endl;
+            surveyDb->rollback();
+            return -1;
+        }
 
-        closeDb();
+        ids.remove(currentKey);
+        ids.insert(newKey, empId);
+        renamed.append(qMakePair(empId, newKey));
     }
 
-    return false;
-}
+    if (!surveyDb->commit()) {
+        qDebug() << "(DB) Error committing employee renames: " << surveyDb->lastError().text() << Qt::endl;
+        surveyDb->rollback();
+        return -1;
+    }
+
+    for (const QPair<int, QString> &rename : renamed)
+        setNameKey(rename.first, rename.second);
+
+    return renamed.size();
+}
+
+/*!
+ * \brief Merges duplicate employees into one employee in a single transaction.
+ * \param keepId = The ID of the employee that is kept
+ * \param duplicateIds = The IDs of the employees that are merged into keepId and then removed
+ * \return A boolean value that states whether the transaction was successful or not.
+ * \note All surveys of the duplicates are moved to keepId. If keepId already has a survey on the same date, keepId's survey is kept
+ * and the removal of the duplicate's survey is recorded in the audit log.
+ */
+bool SurveyDatabase::mergeEmployees(const int &keepId, const QList<int> &duplicateIds)
+{
+    openDb();
+
+    if (!beginWrite())
+        return false;
+
+    QSqlQuery moveQry(*surveyDb);
+    QSqlQuery removeQry(*surveyDb);
+    QList<AuditRecord> audits;
+
+    prepareQuery(moveQry, "UPDATE OR IGNORE Survey "
+                    "SET emp_id = :keep "
+                    "WHERE emp_id = :dup;");
+    // Surveys that could not be moved are deleted by the cascading foreign key.
+    prepareQuery(removeQry, "DELETE FROM Employee "
+                      "WHERE emp_id = :dup;");
+
+    for (const int &duplicateId : duplicateIds) {
+        if (duplicateId == keepId)
+            continue;
+
+        moveQry.bindValue(":keep", keepId);
+        moveQry.bindValue(":dup", duplicateId);
+        removeQry.bindValue(":dup", duplicateId);
+
+        // The surveys left after the move clashed with one of keepId's and are removed with the duplicate.
+        if (!moveQry.exec() || !loadAuditRecords(duplicateId, audits) || !removeQry.exec()) {
+            qDebug() << "(DB) Error merging employee: " << moveQry.lastError().text() << removeQry.lastError().text() << Qt::endl;
+            surveyDb->rollback();
+            return false;
+        }
+    }
+
+    if (!rebuildTrend(keepId)) {
+        surveyDb->rollback();
+        return false;
+    }
+
+    if (!surveyDb->commit()) {
+        qDebug() << "(DB) Error committing employee merge: " << surveyDb->lastError().text() << Qt::endl;
+        surveyDb->rollback();
+        return false;
+    }
+
+    pageCache.invalidate(keepId);
+
+    for (const int &duplicateId : duplicateIds) {
+        if (duplicateId == keepId)
+            continue;
+
+        pageCache.invalidate(duplicateId);
+        forgetNameKey(duplicateId);
+    }
+
+    qint64 timestamp(QDateTime::currentMSecsSinceEpoch());
+
+    for (AuditRecord &audit : audits) {
+        audit.timestamp = timestamp;
+        auditLog.append(audit);
+    }
+
+    // Surveys that clashed with one of keepId's were removed, on any day.
+    clearSketches();
+
+    return true;
+}
+
+/*!
+ * \brief Adds a site, or finds the site if one with the same name exists.
+ * \param name = The name of the site
+ * \return The ID of the site, or -1 if it could not be added.
+ */
+int SurveyDatabase::addSite(const QString &name)
+{
+    return addPartitionName("Site", "site_id", name);
+}
+
+/*!
+ * \brief Adds a department, or finds the department if one with the same name exists.
+ * \param name = The name of the department
+ * \return The ID of the department, or -1 if it could not be added.
+ */
+int SurveyDatabase::addDepartment(const QString &name)
+{
+    return addPartitionName("Department", "dept_id", name);
+}
+
+/*!
+ * \brief Retrieves every site.
+ * \return The name of every site by ID.
+ */
+QMap<int, QString> SurveyDatabase::getSites()
+{
+    return getPartitionNames("Site", "site_id");
+}
+
+/*!
+ * \brief Retrieves every department.
+ * \return The name of every department by ID.
+ */
+QMap<int, QString> SurveyDatabase::getDepartments()
+{
+    return getPartitionNames("Department", "dept_id");
+}
+
+/*!
+ * \brief Moves employees to a site and department.
+ * \param empIds = The IDs of the employees
+ * \param siteId = The ID of the site, or -1 for none
+ * \param deptId = The ID of the department, or -1 for none
+ * \return A boolean value that states whether the employees were moved or not.
+ * \note Either all of the employees are moved or none of them are.
+ */
+bool SurveyDatabase::setEmployeePartition(const QList<int> &empIds, const int &siteId, const int &deptId)
+{
+    openDb();
+
+    if (!beginWrite())
+        return false;
+
+    QSqlQuery partitionQry(*surveyDb);
+
+    prepareQuery(partitionQry, "UPDATE Employee SET site_id = :site, dept_id = :dept WHERE emp_id = :id;");
+
+    for (const int &empId : empIds) {
+        partitionQry.bindValue(":site", idOrNull(siteId));
+        partitionQry.bindValue(":dept", idOrNull(deptId));
+        partitionQry.bindValue(":id", empId);
+
+        if (!partitionQry.exec()) {
+            qDebug() << "(DB) Error moving employee: " << partitionQry.lastError().text() << Qt::endl;
+            surveyDb->rollback();
+            return false;
+        }
+    }
+
+    if (!surveyDb->commit()) {
+        qDebug() << "(DB) Error committing employee move: " << surveyDb->lastError().text() << Qt::endl;
+        surveyDb->rollback();
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Adds a new survey to the database.
+ * \param newSurvey = The new survey to be added
+ * \return A boolean value that states whether the transaction was successful or not.
+ * \note This will also check if a combination of this date and employee ID hasn't already been added. It will return false if it was.
+ * \note The new survey will be rejected if it is not valid. This function will return false.
+ * \note The employee's temperature trend is updated in the same transaction.
+ */
+bool SurveyDatabase::addSurvey(const Survey &newSurvey)
+{
+    TraceSpan span("SurveyDatabase::addSurvey");
+
+    if (newSurvey.isValid()) {
+        openDb();
+
+        QDateTime surveyDate(newSurvey.getSurveyDate(), QTime(12,0));
+        int surveyDateUnix(surveyDate.toSecsSinceEpoch());
+
+        if (!beginWrite())
+            return false;
+
+        QSqlQuery surveyQry(*surveyDb);
+        TraceSpan countSpan("SurveyDatabase::addSurvey count");
+
+        prepareQuery(surveyQry, "SELECT COUNT(*) FROM Survey WHERE survey_date = :date AND emp_id = :id;");
+        surveyQry.bindValue(":date", surveyDateUnix);
+        surveyQry.bindValue(":id", newSurvey.getEmployeeId());
+
+        if (surveyQry.exec()) {
+            if (surveyQry.next()) {
+                countSpan.end();
+
+                if (surveyQry.value(0).toInt() == 0) {
+                    TraceSpan insertSpan("SurveyDatabase::addSurvey insert");
+
+                    prepareQuery(surveyQry, "INSERT INTO Survey (survey_date, emp_id, answers, temperature) "
+                                      "VALUES (:date, :id, :answers, :temp);");
+
+                    surveyQry.bindValue(":date", surveyDateUnix);
+                    surveyQry.bindValue(":id", newSurvey.getEmployeeId());
+                    surveyQry.bindValue(":answers", newSurvey.getAnswers());
+                    surveyQry.bindValue(":temp", newSurvey.getTemperature());
+
+                    if (surveyQry.exec()) {
+                        insertSpan.end();
+
+                        if (applyTrendReading(newSurvey.getEmployeeId(), surveyDateUnix, newSurvey.getTemperature())) {
+                            TraceSpan commitSpan("SurveyDatabase::addSurvey commit");
+
+                            if (surveyDb->commit()) {
+                                pageCache.invalidate(newSurvey.getEmployeeId());
+                                staleSketchDays.insert(surveyDateUnix);
+                                return true;
+                            }
+                        }
+                    } else
+                        qDebug() << "(DB) Error adding survey: " << surveyQry.lastError().text() << Qt::endl;
+                }
+            }
+        } else
+            qDebug() << "(DB) Error verifying survey: " << surveyQry.lastError().text() << Qt::endl;
+
+        surveyDb->rollback();
+    }
+
+    return false;
+}
+
+/*!
+ * \brief Adds a batch of new surveys to the database in a single transaction.
+ * \param newSurveys = The new surveys to be added
+ * \return The amount of surveys that were added, or -1 if the transaction failed.
+ * \note Invalid surveys and surveys of which the date and employee ID combination already exists are skipped.
+ * \note Either all of the valid surveys are added or none of them are.
+ * \note The temperature trends of the employees are updated in the same transaction.
+ */
+int SurveyDatabase::addSurveys(const QList<Survey> &newSurveys)
+{
+    openDb();
+
+    if (!beginWrite())
+        return -1;
+
+    QSqlQuery surveyQry(*surveyDb);
+    QHash<int, QList<QPair<qint64, double>>> addedReadings;
+    QSet<qint64> changedDates;
+    int added(0);
+
+    prepareQuery(surveyQry, "INSERT OR IGNORE INTO Survey (survey_date, emp_id, answers, temperature) "
+                      "VALUES (:date, :id, :answers, :temp);");
+
+    for (const Survey &newSurvey : newSurveys) {
+        if (!newSurvey.isValid())
+            continue;
+
+        QDateTime surveyDate(newSurvey.getSurveyDate(), QTime(12,0));
+        qint64 surveyDateUnix(surveyDate.toSecsSinceEpoch());
+
+        surveyQry.bindValue(":date", surveyDateUnix);
+        surveyQry.bindValue(":id", newSurvey.getEmployeeId());
+        surveyQry.bindValue(":answers", newSurvey.getAnswers());
+        surveyQry.bindValue(":temp", newSurvey.getTemperature());
+
+        if (!surveyQry.exec()) {
+            qDebug() << "(DB) Error adding survey batch: " << surveyQry.lastError().text() << Qt::endl;
+            surveyDb->rollback();
+            return -1;
+        }
+
+        if (surveyQry.numRowsAffected() > 0) {
+            addedReadings[newSurvey.getEmployeeId()].append(qMakePair(surveyDateUnix, newSurvey.getTemperature()));
+            changedDates.insert(surveyDateUnix);
+            ++added;
+        }
+    }
+
+    // The trends are updated once all rows are in, so every employee is replayed at most once per batch.
+    for (auto it = addedReadings.begin(); it != addedReadings.end(); ++it) {
+        if (!applyTrendReadings(it.key(), it.value())) {
+            surveyDb->rollback();
+            return -1;
+        }
+    }
+
+    if (!surveyDb->commit()) {
+        qDebug() << "(DB) Error committing survey batch: " << surveyDb->lastError().text() << Qt::endl;
+        surveyDb->rollback();
+        return -1;
+    }
+
+    for (auto it = addedReadings.cbegin(); it != addedReadings.cend(); ++it)
+        pageCache.invalidate(it.key());
+
+    staleSketchDays.unite(changedDates);
+
+    return added;
+}
 
 /*!
  * \brief Removes a survey from the database.
  * \param date = The survey date
  * \param empId = The employee's ID
  * \return A boolean value that states whether the transaction was successful or not.
+ * \note The employee's temperature trend is updated in the same transaction.
  */
 bool SurveyDatabase::removeSurvey(const QDate &date, const int &empId)
 {
@@ -305,21 +1192,64 @@ bool SurveyDatabase::removeSurvey(const QDate &date, const int &empId)
     QDateTime surveyDate(date, QTime(12, 0));
     int surveyDateUnix(surveyDate.toSecsSinceEpoch());
 
+    if (!beginWrite())
+        return false;
+
     QSqlQuery surveyQry(*surveyDb);
+    AuditRecord audit;
+
+    if (!loadAuditRecord(surveyDateUnix, empId, audit)) {
+        surveyDb->rollback();
+        return false;
+    }
 
-    surveyQry.prepare("DELETE FROM Survey "
+    prepareQuery(surveyQry, "DELETE FROM Survey "
                       "WHERE survey_date = :date AND emp_id = :id;");
 
     surveyQry.bindValue(":date", surveyDateUnix);
     surveyQry.bindValue(":id", empId);
 
     if (surveyQry.exec()) {
-        closeDb();
-        return true;
+        TemperatureTrend trend(loadTrend(empId));
+        bool trendUpdated(false);
+
+        // Removing the latest reading is O(1), any other reading means replaying the readings after it.
+        // The date of the reading before it is a single step back in idx_survey_emp, so the next reading is O(1) too.
+        if (trend.getLastDate() == surveyDateUnix) {
+            QSqlQuery previousQry(*surveyDb);
+
+            prepareQuery(previousQry, "SELECT MAX(survey_date) FROM Survey WHERE emp_id = :id;");
+            previousQry.bindValue(":id", empId);
+
+            if (!previousQry.exec() || !previousQry.next()) {
+                qDebug() << "(DB) Error reading previous survey: " << previousQry.lastError().text() << Qt::endl;
+                surveyDb->rollback();
+                return false;
+            }
+
+            qint64 previousDate(previousQry.value(0).isNull() ? -1 : previousQry.value(0).toLongLong());
+
+            trendUpdated = trend.removeLastReading(previousDate) ? saveTrend(empId, trend)
+                                                                 : rebuildTrend(empId, surveyDateUnix);
+        } else
+            trendUpdated = rebuildTrend(empId, surveyDateUnix);
+
+        if (trendUpdated && surveyDb->commit()) {
+            pageCache.invalidate(empId);
+            staleSketchDays.insert(surveyDateUnix);
+
+            if (audit.empId >= 0) {
+                audit.timestamp = QDateTime::currentMSecsSinceEpoch();
+                audit.action = AuditRecord::Remove;
+                auditLog.append(audit);
+            }
+
+            return true;
+        }
     } else
         qDebug() << "(DB) Error removing survey: " << surveyQry.lastError().text() << Qt::endl;
 
-    closeDb();
+    surveyDb->rollback();
     return false;
 }
 
@@ -328,6 +1258,7 @@ bool SurveyDatabase::removeSurvey(const QDate &date, const int &empId)
  * \param editSurvey = The survey data to edit the survey with
  * \return A boolean value that states whether the transaction was successful or not.
  * \note The survey will be rejected if it is not valid. This function will return false.
+ * \note The employee's temperature trend is updated in the same transaction.
  */
 bool SurveyDatabase::editSurvey(const Survey &editSurvey)
 {
@@ -337,112 +1268,1806 @@ bool SurveyDatabase::editSurvey(const Survey &editSurvey)
         QDateTime surveyDate(editSurvey.getSurveyDate(), QTime(12,0));
         int surveyDateUnix(surveyDate.toSecsSinceEpoch());
 
+        if (!beginWrite())
+            return false;
+
         QSqlQuery surveyQry(*surveyDb);
+        AuditRecord audit;
+
+        if (!loadAuditRecord(surveyDateUnix, editSurvey.getEmployeeId(), audit)) {
+            surveyDb->rollback();
+            return false;
+        }
 
-        surveyQry.prepare("UPDATE Survey "
-                          "SET q_one = :q1, q_two = :q2, q_three = :q3, temperature = :temp "
+        prepareQuery(surveyQry, "UPDATE Survey "
+                          "SET answers = :answers, temperature = :temp "
                           "WHERE survey_date = :date AND emp_id = :id;");
 
         surveyQry.bindValue(":date", surveyDateUnix);
         surveyQry.bindValue(":id", editSurvey.getEmployeeId());
-        surveyQry.bindValue(":q1", editSurvey.getQuestionOne());
-        surveyQry.bindValue(":q2", editSurvey.getQuestionTwo());
-        surveyQry.bindValue(":q3", editSurvey.getQuestionThree());
+        surveyQry.bindValue(":answers", editSurvey.getAnswers());
         surveyQry.bindValue(":temp", editSurvey.getTemperature());
 
         if (surveyQry.exec()) {
-            closeDb();
-            return true;
+            int empId(editSurvey.getEmployeeId());
+            TemperatureTrend trend(loadTrend(empId));
+            TemperatureTrend before(trend);
+            bool trendUpdated(false);
+
+            // Editing the latest reading is O(1), any other reading means replaying the readings after it.
+            if (trend.getLastDate() == surveyDateUnix && before.removeLastReading() &&
+                    trend.replaceLastReading(editSurvey.getTemperature())) {
+                trendUpdated = saveTrend(empId, trend) &&
+                        updateAlert(empId, surveyDateUnix, editSurvey.getTemperature(), before);
+            } else
+                trendUpdated = rebuildTrend(empId, surveyDateUnix);
+
+            if (trendUpdated && surveyDb->commit()) {
+                pageCache.invalidate(empId);
+                staleSketchDays.insert(surveyDateUnix);
+
+                if (audit.empId >= 0) {
+                    audit.timestamp = QDateTime::currentMSecsSinceEpoch();
+                    audit.action = AuditRecord::Edit;
+                    audit.newAnswers = editSurvey.getAnswers();
+                    audit.newTemperature = editSurvey.getTemperature();
+                    auditLog.append(audit);
+                }
+
+                return true;
+            }
         } else
             qDebug() << "(DB) Error updating survey: " << surveyQry.lastError().text() << Qt::endl;
 
-
-        closeDb();
+        surveyDb->rollback();
     }
 
     return false;
 }
 
 /*!
- * \brief Checks if a given employee name is already in the database.
- * \param name = The employee's name
- * \return A boolean value that is true if it does exist, and is false if it does not exist.
- * \note This is not case sensitive.
+ * \brief Finds the surveys in a date range by their answers.
+ * \param from = The first survey date to include
+ * \param to = The last survey date to include
+ * \param mask = The bits of the questions to filter on (see QuestionSet)
+ * \param matchAll = Must all of the questions be answered "Yes", instead of any of them?
+ * \return A QList with the matching surveys, ordered by date.
+ * \note The filter is a bit operation on the answers column, so any combination of questions costs the same.
  */
-bool SurveyDatabase::employeeExist(const QString &name)
+QList<Survey> SurveyDatabase::findSurveys(const QDate &from, const QDate &to, const quint32 &mask, const bool &matchAll)
 {
     openDb();
 
+    QList<Survey> surveys;
     QSqlQuery surveyQry(*surveyDb);
 
-    surveyQry.prepare("SELECT COUNT(*) FROM Employee WHERE name = :n;");
-    surveyQry.bindValue(":n", name);
+    surveyQry.setForwardOnly(true);
+
+    if (matchAll)
+        prepareQuery(surveyQry, "SELECT survey_date, emp_id, answers, temperature FROM Survey "
+                          "WHERE survey_date BETWEEN :from AND :to AND (answers & :mask) = :all "
+                          "ORDER BY survey_date;");
+    else
+        prepareQuery(surveyQry, "SELECT survey_date, emp_id, answers, temperature FROM Survey "
+                          "WHERE survey_date BETWEEN :from AND :to AND (answers & :mask) != 0 "
+                          "ORDER BY survey_date;");
+
+    surveyQry.bindValue(":from", QDateTime(from, QTime(12, 0)).toSecsSinceEpoch());
+    surveyQry.bindValue(":to", QDateTime(to, QTime(12, 0)).toSecsSinceEpoch());
+    surveyQry.bindValue(":mask", mask);
+
+    if (matchAll)
+        surveyQry.bindValue(":all", mask);
 
     if (surveyQry.exec()) {
-        if (surveyQry.next()) {
-            if (surveyQry.value(0).toInt() == 0) {
-                closeDb();
-                return false;
-            }
+        while (surveyQry.next()) {
+            surveys.append(Survey(QDateTime::fromSecsSinceEpoch(surveyQry.value(0).toLongLong()).date(),
+                                  surveyQry.value(1).toInt(),
+                                  surveyQry.value(2).toUInt(),
+                                  surveyQry.value(3).toDouble()));
         }
     } else
-        qDebug() << "(DB) Error verifying employee name: " << surveyQry.lastError().text() << Qt::endl;
+        qDebug() << "(DB) Error finding surveys: " << surveyQry.lastError().text() << Qt::endl;
 
-    closeDb();
-    return true;
+    return surveys;
 }
 
 /*!
- * \brief Update the survey model with the current employee ID.
- *
- * Updates the survey model to display the current state of survey data from the current employee ID from currentEmpId.
+ * \brief Retrieves the questions of the survey.
+ * \return The QuestionSet as last loaded from the database.
  */
-void SurveyDatabase::updateSurveyTableModel()
+QuestionSet SurveyDatabase::getQuestionSet() const
+{
+    return questionSet;
+}
+
+/*!
+ * \brief Adds a new question to the survey.
+ * \param text = The question as rich text
+ * \return A boolean value that states whether the question was added or not.
+ * \note The question gets the lowest bit that was never used. It fails once QuestionSet::MaxQuestions questions exist.
+ */
+bool SurveyDatabase::addQuestion(const QString &text)
 {
+    int bit(questionSet.getFreeBit());
+
+    if (bit < 0 || text.trimmed().isEmpty())
+        return false;
+
     openDb();
 
-    surveyModel->setQuery("SELECT survey_date, q_one, q_two, q_three, temperature "
-                          "FROM Survey "
-                          "WHERE emp_id = " + QString::number(currentEmpId) + " "
-                          "ORDER BY survey_date;", *surveyDb);
+    QSqlQuery questionQry(*surveyDb);
 
-    surveyModel->setHeaderData(SurveyTableColumns::Date, Qt::Horizontal, tr("Survey Date"));
-    surveyModel->setHeaderData(SurveyTableColumns::Question1, Qt::Horizontal, tr("Question 1"));
-    surveyModel->setHeaderData(SurveyTableColumns::Question2, Qt::Horizontal, tr("Question 2"));
-    surveyModel->setHeaderData(SurveyTableColumns::Question3, Qt::Horizontal, tr("Question 3"));
-    surveyModel->setHeaderData(SurveyTableColumns::Temperature, Qt::Horizontal, tr("Temperature (°C)"));
+    prepareQuery(questionQry, "INSERT INTO Question (bit, text) VALUES (:bit, :text);");
+    questionQry.bindValue(":bit", bit);
+    questionQry.bindValue(":text", text.trimmed());
 
-    closeDb();
+    if (!questionQry.exec()) {
+        qDebug() << "(DB) Error adding question: " << questionQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    return loadQuestionSet();
 }
 
-void SurveyDatabase::updateEmployeeTableModel()
+/*!
+ * \brief Retires a question, or asks a retired question again.
+ * \param bit = The bit of the question
+ * \param active = Should the question be asked?
+ * \return A boolean value that states whether the question was changed or not.
+ * \note The answers to retired questions are kept and still shown with the surveys.
+ */
+bool SurveyDatabase::setQuestionActive(const int &bit, const bool &active)
 {
     openDb();
 
-    employeeModel->setQuery("SELECT emp_id, name FROM Employee ORDER BY name;", *surveyDb);
+    QSqlQuery questionQry(*surveyDb);
 
-    employeeModel->setHeaderData(EmployeeTableColumns::ID, Qt::Horizontal, tr("ID"));
-    employeeModel->setHeaderData(EmployeeTableColumns::Name, Qt::Horizontal, tr("Name"));
+    prepareQuery(questionQry, "UPDATE Question SET active = :active WHERE bit = :bit;");
+    questionQry.bindValue(":active", active);
+    questionQry.bindValue(":bit", bit);
 
-    closeDb();
+    if (!questionQry.exec() || questionQry.numRowsAffected() == 0) {
+        qDebug() << "(DB) Error changing question: " << questionQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    return loadQuestionSet();
 }
 
 /*!
- * \brief Opens a connection to the database.
+ * \brief Retrieves the alerts for all abnormally high temperatures since the given date.
+ * \param since = The earliest survey date to include
+ * \return A list of alerts, the most recent first.
+ * \note Only the alerts of the employees in the current partition are included.
  */
-void SurveyDatabase::openDb()
+QList<TemperatureAlert> SurveyDatabase::getTemperatureAlerts(const QDate &since)
 {
-    if (!surveyDb->isOpen()) {
-        surveyDb->setDatabaseName(dbLocation);
-        surveyDb->open();
+    openDb();
+
+    QDateTime sinceDate(since, QTime(12, 0));
+    QList<TemperatureAlert> alerts;
+    QSqlQuery surveyQry(*surveyDb);
+
+    prepareQuery(surveyQry, "SELECT a.survey_date, a.emp_id, e.name, a.temperature, a.baseline, a.zscore "
+                      "FROM TemperatureAlert a JOIN Employee e ON e.emp_id = a.emp_id "
+                      "WHERE a.survey_date >= :since" + getPartitionFilter("AND") + " "
+                      "ORDER BY a.survey_date DESC;");
+    surveyQry.bindValue(":since", sinceDate.toSecsSinceEpoch());
+    bindPartition(surveyQry);
+
+    if (surveyQry.exec()) {
+        while (surveyQry.next()) {
+            TemperatureAlert alert;
+            alert.surveyDate = QDateTime::fromSecsSinceEpoch(surveyQry.value(0).toLongLong()).date();
+            alert.empId = surveyQry.value(1).toInt();
+            alert.name = surveyQry.value(2).toString();
+            alert.temperature = surveyQry.value(3).toDouble();
+            alert.baseline = surveyQry.value(4).toDouble();
+            alert.zScore = surveyQry.value(5).toDouble();
+            alerts.append(alert);
+        }
+    } else
+        qDebug() << "(DB) Error retrieving temperature alerts: " << surveyQry.lastError().text() << Qt::endl;
+
+    return alerts;
+}
+
+/*!
+ * \brief Finds the workdays on which employees did not submit a survey.
+ * \param from = The first date of the range
+ * \param to = The last date of the range
+ * \param calendar = The calendar with the days on which a survey is required
+ * \param missedOnly = Should only employees that missed at least one day be returned?
+ * \return The ComplianceRecords of the employees, ordered by name.
+ * \note The surveys in the range are read once in primary key order and set bits in a bitmap per employee,
+ * instead of an anti-join of every employee with every day.
+ * \note Only the employees in the current partition are included, and only their surveys are read.
+ */
+QList<ComplianceRecord> SurveyDatabase::getCompliance(const QDate &from, const QDate &to, const WorkdayCalendar &calendar,
+                                                      const bool &missedOnly)
+{
+    openDb();
+
+    ComplianceEngine engine(from, to, calendar);
+    QSqlQuery employeeQry(*surveyDb);
+
+    employeeQry.setForwardOnly(true);
+    prepareQuery(employeeQry, "SELECT e.emp_id, e.name FROM Employee e" + getPartitionFilter("WHERE") + " ORDER BY e.name;", true);
+    bindPartition(employeeQry);
+
+    if (!employeeQry.exec()) {
+        qDebug() << "(DB) Error retrieving employees: " << employeeQry.lastError().text() << Qt::endl;
+        return QList<ComplianceRecord>();
+    }
+
+    while (employeeQry.next())
+        engine.addEmployee(employeeQry.value(0).toInt(), employeeQry.value(1).toString());
+
+    QSqlQuery surveyQry(*surveyDb);
+
+    surveyQry.setForwardOnly(true);
+
+    if (getPartitionFilter("WHERE").isEmpty())
+        prepareQuery(surveyQry, "SELECT emp_id, survey_date FROM Survey "
+                                "WHERE survey_date BETWEEN :from AND :to;");
+    else
+        prepareQuery(surveyQry, "SELECT s.emp_id, s.survey_date FROM Employee e "
+                                "JOIN Survey s ON s.emp_id = e.emp_id AND s.survey_date BETWEEN :from AND :to" +
+                                getPartitionFilter("WHERE") + ";");
+
+    surveyQry.bindValue(":from", QDateTime(from, QTime(12, 0)).toSecsSinceEpoch());
+    surveyQry.bindValue(":to", QDateTime(to, QTime(12, 0)).toSecsSinceEpoch());
+    bindPartition(surveyQry);
+
+    if (!surveyQry.exec()) {
+        qDebug() << "(DB) Error retrieving surveys: " << surveyQry.lastError().text() << Qt::endl;
+        return QList<ComplianceRecord>();
     }
+
+    while (surveyQry.next())
+        engine.markPresent(surveyQry.value(0).toInt(), surveyQry.value(1).toLongLong());
+
+    return engine.getRecords(missedOnly);
 }
 
 /*!
- * \brief Closes the connection to the database if it is open.
+ * \brief Retrieves the survey of every employee on a single day.
+ * \param date = The survey date
+ * \param ok = Is set to false if the statuses could not be read, so an empty list can be told apart from a failure
+ * \return The DailyStatus of every employee, ordered by ID. Employees without a survey on the day are included.
+ * \note Only the employees in the current partition are included.
  */
-void SurveyDatabase::closeDb()
+QList<DailyStatus> SurveyDatabase::getDailyStatus(const QDate &date, bool *ok)
 {
-    if (surveyDb->isOpen())
-        surveyDb->close();
+    openDb();
+
+    if (ok != nullptr)
+        *ok = false;
+
+    QDateTime surveyDate(date, QTime(12, 0));
+    QList<DailyStatus> statuses;
+    QSqlQuery statusQry(*surveyDb);
+
+    statusQry.setForwardOnly(true);
+    prepareQuery(statusQry, "SELECT e.emp_id, e.name, s.answers, s.temperature, a.emp_id IS NOT NULL, s.emp_id IS NOT NULL "
+                            "FROM Employee e "
+                            "LEFT JOIN Survey s ON s.survey_date = :date AND s.emp_id = e.emp_id "
+                            "LEFT JOIN TemperatureAlert a ON a.survey_date = :date AND a.emp_id = e.emp_id" +
+                            getPartitionFilter("WHERE") + " "
+                            "ORDER BY e.emp_id;", true);
+    statusQry.bindValue(":date", surveyDate.toSecsSinceEpoch());
+    bindPartition(statusQry);
+
+    if (!statusQry.exec()) {
+        qDebug() << "(DB) Error retrieving daily status: " << statusQry.lastError().text() << Qt::endl;
+        return statuses;
+    }
+
+    while (statusQry.next()) {
+        DailyStatus status;
+        status.empId = statusQry.value(0).toInt();
+        status.name = statusQry.value(1).toString();
+        // The survey's key is never NULL, unlike its temperature.
+        status.surveyed = statusQry.value(5).toBool();
+        status.answers = statusQry.value(2).toUInt();
+        status.temperature = statusQry.value(3).toDouble();
+        status.anomaly = statusQry.value(4).toBool();
+        statuses.append(status);
+    }
+
+    // A step that fails ends the loop like the last row does.
+    if (statusQry.lastError().isValid()) {
+        qDebug() << "(DB) Error retrieving daily status: " << statusQry.lastError().text() << Qt::endl;
+        return QList<DailyStatus>();
+    }
+
+    if (ok != nullptr)
+        *ok = true;
+
+    return statuses;
+}
+
+/*!
+ * \brief Loads the surveys of a team over a range of days, pivoted into a day by employee matrix.
+ * \param matrix = Receives the surveys, with the employees ordered by name
+ * \param empIds = The IDs of the employees in the team, IDs that do not exist are skipped
+ * \param from = The first day of the range
+ * \param to = The last day of the range
+ * \return A boolean value that states whether the surveys were loaded or not.
+ * \note The team is written to a temporary table and joined, so the whole team is read with a single query
+ *       (through idx_survey_emp) instead of one query per employee.
+ */
+bool SurveyDatabase::loadTeamMatrix(TeamMatrix &matrix, const QList<int> &empIds, const QDate &from, const QDate &to)
+{
+    openDb();
+
+    matrix.reset(from, to);
+
+    if (empIds.isEmpty() || matrix.days == 0)
+        return true;
+
+    // The temporary table belongs to this connection, so filling it never locks the database file.
+    QSqlQuery teamQry(*surveyDb);
+
+    if (!teamQry.exec("CREATE TEMP TABLE IF NOT EXISTS TeamMember (emp_id INTEGER PRIMARY KEY);")) {
+        qDebug() << "(DB) Error creating team table: " << teamQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    if (!surveyDb->transaction()) {
+        qDebug() << "(DB) Error starting team transaction: " << surveyDb->lastError().text() << Qt::endl;
+        return false;
+    }
+
+    if (!teamQry.exec("DELETE FROM TeamMember;")) {
+        qDebug() << "(DB) Error clearing team table: " << teamQry.lastError().text() << Qt::endl;
+        surveyDb->rollback();
+        return false;
+    }
+
+    prepareQuery(teamQry, "INSERT OR IGNORE INTO TeamMember (emp_id) VALUES (?);");
+
+    for (const int &empId : empIds) {
+        teamQry.addBindValue(empId);
+
+        if (!teamQry.exec()) {
+            qDebug() << "(DB) Error filling team table: " << teamQry.lastError().text() << Qt::endl;
+            surveyDb->rollback();
+            return false;
+        }
+    }
+
+    // Employees without surveys in the range still get a column, hence the left join.
+    QSqlQuery matrixQry(*surveyDb);
+
+    matrixQry.setForwardOnly(true);
+    prepareQuery(matrixQry, "SELECT e.emp_id, e.name, s.survey_date, s.answers, s.temperature "
+                            "FROM TeamMember t "
+                            "JOIN Employee e ON e.emp_id = t.emp_id "
+                            "LEFT JOIN Survey s ON s.emp_id = t.emp_id AND s.survey_date BETWEEN :from AND :to "
+                            "ORDER BY e.name, e.emp_id;", true);
+    matrixQry.bindValue(":from", QDateTime(from, QTime(12, 0)).toSecsSinceEpoch());
+    matrixQry.bindValue(":to", QDateTime(to, QTime(12, 0)).toSecsSinceEpoch());
+
+    if (!matrixQry.exec()) {
+        qDebug() << "(DB) Error retrieving team surveys: " << matrixQry.lastError().text() << Qt::endl;
+        surveyDb->rollback();
+        matrix.reset(from, to);
+        return false;
+    }
+
+    while (matrixQry.next()) {
+        int column(matrix.addEmployee(matrixQry.value(0).toInt(), matrixQry.value(1).toString()));
+
+        if (!matrixQry.value(2).isNull())
+            matrix.setSurvey(matrixQry.value(2).toLongLong(), column,
+                             matrixQry.value(3).toUInt(), matrixQry.value(4).toFloat());
+    }
+
+    // Nothing in the database file was changed, only the temporary table.
+    surveyDb->commit();
+
+    return true;
+}
+
+/*!
+ * \brief Loads the temperature readings of an employee, or of the whole company, and builds their levels of detail.
+ * \param series = Receives the readings, in date order
+ * \param empId = The ID of the employee, or -1 for the readings of all employees
+ * \return A boolean value that states whether the readings were loaded or not.
+ */
+bool SurveyDatabase::loadTemperatureSeries(TemperatureSeries &series, const int &empId)
+{
+    openDb();
+
+    QSqlQuery seriesQry(*surveyDb);
+
+    seriesQry.setForwardOnly(true);
+
+    if (empId < 0 && !getPartitionFilter("WHERE").isEmpty()) {
+        prepareQuery(seriesQry, "SELECT s.survey_date, s.temperature FROM Employee e "
+                                "JOIN Survey s ON s.emp_id = e.emp_id" + getPartitionFilter("WHERE") + " "
+                                "AND s.temperature IS NOT NULL ORDER BY s.survey_date;");
+        bindPartition(seriesQry);
+    } else if (empId < 0)
+        prepareQuery(seriesQry, "SELECT survey_date, temperature FROM Survey "
+                                "WHERE temperature IS NOT NULL ORDER BY survey_date;");
+    else {
+        prepareQuery(seriesQry, "SELECT survey_date, temperature FROM Survey "
+                                "WHERE emp_id = :id AND temperature IS NOT NULL ORDER BY survey_date;");
+        seriesQry.bindValue(":id", empId);
+    }
+
+    series.clear();
+
+    if (!seriesQry.exec()) {
+        qDebug() << "(DB) Error retrieving temperatures: " << seriesQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    while (seriesQry.next())
+        series.append(seriesQry.value(0).toLongLong(), seriesQry.value(1).toFloat());
+
+    series.buildLevels();
+    return true;
+}
+
+/*!
+ * \brief Retrieves the temperature sketch of all surveys in a date range, to calculate percentiles with.
+ * \param from = The first survey date
+ * \param to = The last survey date
+ * \return The merged sketch of every day in the range, which is empty if there are no surveys or they could not be read.
+ * \note The sketches of the days are kept in memory, so only days that changed since the last call are read.
+ * \note The kept sketches cover the whole company. Within a partition, the bins are counted from the surveys of
+ *       the employees in it instead.
+ */
+TemperatureSketch SurveyDatabase::getTemperatureSketch(const QDate &from, const QDate &to)
+{
+    TemperatureSketch sketch;
+    qint64 fromUnix(QDateTime(from, QTime(12, 0)).toSecsSinceEpoch());
+    qint64 toUnix(QDateTime(to, QTime(12, 0)).toSecsSinceEpoch());
+
+    if (!getPartitionFilter("WHERE").isEmpty()) {
+        openDb();
+
+        QSqlQuery binQry(*surveyDb);
+
+        binQry.setForwardOnly(true);
+        prepareQuery(binQry, "SELECT " + TemperatureSketch::getBinExpression("s.temperature") + " AS bin, COUNT(*) "
+                             "FROM Employee e "
+                             "JOIN Survey s ON s.emp_id = e.emp_id AND s.survey_date BETWEEN :from AND :to" +
+                             getPartitionFilter("WHERE") + " "
+                             "AND s.temperature IS NOT NULL GROUP BY bin;", true);
+        binQry.bindValue(":from", fromUnix);
+        binQry.bindValue(":to", toUnix);
+        bindPartition(binQry);
+
+        if (!binQry.exec()) {
+            qDebug() << "(DB) Error retrieving temperature bins: " << binQry.lastError().text() << Qt::endl;
+            return sketch;
+        }
+
+        while (binQry.next())
+            sketch.addBin(binQry.value(0).toInt(), binQry.value(1).toUInt());
+
+        return sketch;
+    }
+
+    if (!loadSketches())
+        return sketch;
+
+    for (auto it = std::as_const(daySketches).lowerBound(fromUnix); it != daySketches.cend() && it.key() <= toUnix; ++it)
+        sketch.merge(it.value());
+
+    return sketch;
+}
+
+/*!
+ * \brief Loads the temperature sketches of all days, or only those of the days that changed if they were loaded before.
+ * \return A boolean value stating whether the sketches are up to date or not.
+ */
+bool SurveyDatabase::loadSketches()
+{
+    if (sketchesLoaded && staleSketchDays.isEmpty())
+        return true;
+
+    openDb();
+
+    QSqlQuery sketchQry(*surveyDb);
+    sketchQry.setForwardOnly(true);
+
+    if (!sketchesLoaded) {
+        prepareQuery(sketchQry, "SELECT survey_date, bin, count FROM TemperatureBin ORDER BY survey_date, bin;", true);
+
+        if (!sketchQry.exec()) {
+            qDebug() << "(DB) Error loading temperature sketches: " << sketchQry.lastError().text() << Qt::endl;
+            return false;
+        }
+
+        daySketches.clear();
+
+        while (sketchQry.next())
+            daySketches[sketchQry.value(0).toLongLong()].addBin(sketchQry.value(1).toInt(), sketchQry.value(2).toUInt());
+
+        sketchesLoaded = true;
+        staleSketchDays.clear();
+        return true;
+    }
+
+    prepareQuery(sketchQry, "SELECT bin, count FROM TemperatureBin WHERE survey_date = :date;");
+
+    for (const qint64 &surveyDate : std::as_const(staleSketchDays)) {
+        sketchQry.bindValue(":date", surveyDate);
+
+        if (!sketchQry.exec()) {
+            qDebug() << "(DB) Error loading temperature sketch: " << sketchQry.lastError().text() << Qt::endl;
+            return false;
+        }
+
+        TemperatureSketch sketch;
+
+        while (sketchQry.next())
+            sketch.addBin(sketchQry.value(0).toInt(), sketchQry.value(1).toUInt());
+
+        if (sketch.getCount() > 0)
+            daySketches.insert(surveyDate, sketch);
+        else
+            daySketches.remove(surveyDate);
+    }
+
+    staleSketchDays.clear();
+    return true;
+}
+
+/*!
+ * \brief Forgets the temperature sketches in memory, so they are all loaded again when they are needed.
+ */
+void SurveyDatabase::clearSketches()
+{
+    daySketches.clear();
+    staleSketchDays.clear();
+    sketchesLoaded = false;
+}
+
+/*!
+ * \brief Loads the questions from the database and assigns them to the survey model.
+ * \return A boolean value that states whether the questions were loaded or not.
+ */
+bool SurveyDatabase::loadQuestionSet()
+{
+    openDb();
+
+    QSqlQuery questionQry(*surveyDb);
+    QList<Question> questions;
+
+    prepareQuery(questionQry, "SELECT bit, text, active FROM Question ORDER BY bit;", true);
+
+    if (!questionQry.exec()) {
+        qDebug() << "(DB) Error retrieving questions: " << questionQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    while (questionQry.next()) {
+        Question question;
+        question.bit = questionQry.value(0).toInt();
+        question.text = questionQry.value(1).toString();
+        question.active = questionQry.value(2).toBool();
+        questions.append(question);
+    }
+
+    questionSet = QuestionSet(questions);
+    surveyModel->setQuestionSet(questionSet);
+
+    return true;
+}
+
+/*!
+ * \brief Loads an employee's stored temperature trend.
+ * \param empId = The employee's ID
+ * \return The employee's trend, or an empty trend if none is stored.
+ * \note The database must already be open.
+ */
+TemperatureTrend SurveyDatabase::loadTrend(const int &empId)
+{
+    QSqlQuery trendQry(*surveyDb);
+
+    prepareQuery(trendQry, "SELECT mean, variance, samples, last_date, prev_mean, prev_variance, prev_samples "
+                     "FROM TemperatureTrend WHERE emp_id = :id;");
+    trendQry.bindValue(":id", empId);
+
+    if (trendQry.exec() && trendQry.next()) {
+        return TemperatureTrend(trendQry.value(0).toDouble(),
+                                trendQry.value(1).toDouble(),
+                                trendQry.value(2).toInt(),
+                                trendQry.value(3).toLongLong(),
+                                trendQry.value(4).toDouble(),
+                                trendQry.value(5).toDouble(),
+                                trendQry.value(6).toInt());
+    }
+
+    return TemperatureTrend();
+}
+
+/*!
+ * \brief Stores an employee's temperature trend.
+ * \param empId = The employee's ID
+ * \param trend = The trend to store
+ * \return A boolean value that states whether the trend was stored or not.
+ * \note The database must already be open.
+ */
+bool SurveyDatabase::saveTrend(const int &empId, const TemperatureTrend &trend)
+{
+    QSqlQuery trendQry(*surveyDb);
+
+    prepareQuery(trendQry, "INSERT OR REPLACE INTO TemperatureTrend "
+                     "(emp_id, mean, variance, samples, last_date, prev_mean, prev_variance, prev_samples) "
+                     "VALUES (:id, :mean, :var, :samples, :last, :pmean, :pvar, :psamples);");
+    trendQry.bindValue(":id", empId);
+    trendQry.bindValue(":mean", trend.getMean());
+    trendQry.bindValue(":var", trend.getVariance());
+    trendQry.bindValue(":samples", trend.getSamples());
+    trendQry.bindValue(":last", trend.getLastDate());
+    trendQry.bindValue(":pmean", trend.getPreviousMean());
+    trendQry.bindValue(":pvar", trend.getPreviousVariance());
+    trendQry.bindValue(":psamples", trend.getPreviousSamples());
+
+    if (!trendQry.exec()) {
+        qDebug() << "(DB) Error storing temperature trend: " << trendQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Adds or removes the alert of a reading, depending on whether it is an anomaly compared to the trend before it.
+ * \param empId = The employee's ID
+ * \param surveyDate = The survey date (unix time) of the reading
+ * \param temperature = The reading in degrees Celsius
+ * \param before = The employee's trend before the reading was added
+ * \return A boolean value that states whether the alert was updated or not.
+ * \note The database must already be open.
+ */
+bool SurveyDatabase::updateAlert(const int &empId, const qint64 &surveyDate, const double &temperature, const TemperatureTrend &before)
+{
+    QSqlQuery alertQry(*surveyDb);
+
+    if (before.isAnomaly(temperature)) {
+        prepareQuery(alertQry, "INSERT OR REPLACE INTO TemperatureAlert (survey_date, emp_id, temperature, baseline, zscore) "
+                         "VALUES (:date, :id, :temp, :baseline, :z);");
+        alertQry.bindValue(":temp", temperature);
+        alertQry.bindValue(":baseline", before.getMean());
+        alertQry.bindValue(":z", before.getZScore(temperature));
+    } else
+        prepareQuery(alertQry, "DELETE FROM TemperatureAlert WHERE survey_date = :date AND emp_id = :id;");
+
+    alertQry.bindValue(":date", surveyDate);
+    alertQry.bindValue(":id", empId);
+
+    if (!alertQry.exec()) {
+        qDebug() << "(DB) Error updating temperature alert: " << alertQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Adds a new reading to an employee's temperature trend and flags it if it is an anomaly.
+ * \param empId = The employee's ID
+ * \param surveyDate = The survey date (unix time) of the reading
+ * \param temperature = The reading in degrees Celsius
+ * \return A boolean value that states whether the trend was updated or not.
+ * \note This is O(1) for a reading newer than all others. Older readings cause the readings after it to be replayed.
+ * \note The database must already be open.
+ */
+bool SurveyDatabase::applyTrendReading(const int &empId, const qint64 &surveyDate, const double &temperature)
+{
+    TraceSpan span("SurveyDatabase::applyTrendReading");
+    TemperatureTrend trend(loadTrend(empId));
+
+    if (trend.getSamples() > 0 && (trend.getLastDate() < 0 || surveyDate <= trend.getLastDate()))
+        return rebuildTrend(empId, trend.getLastDate() < 0 ? 0 : surveyDate);
+
+    if (!updateAlert(empId, surveyDate, temperature, trend))
+        return false;
+
+    trend.addReading(temperature, surveyDate);
+    return saveTrend(empId, trend);
+}
+
+/*!
+ * \brief Adds a batch of new readings to an employee's temperature trend and flags the anomalies among them.
+ * \param empId = The employee's ID
+ * \param readings = The survey dates (unix time) and temperatures of the readings, which are already in the Survey table
+ * \return A boolean value that states whether the trend was updated or not.
+ * \note Readings newer than all others are added in O(1) each. If any reading is older, the trend is rebuilt once
+ * from the oldest of them, instead of once for every reading.
+ * \note The database must already be open.
+ */
+bool SurveyDatabase::applyTrendReadings(const int &empId, QList<QPair<qint64, double>> readings)
+{
+    TraceSpan span("SurveyDatabase::applyTrendReadings");
+    if (readings.isEmpty())
+        return true;
+
+    TemperatureTrend trend(loadTrend(empId));
+
+    std::sort(readings.begin(), readings.end());
+
+    if (trend.getSamples() > 0 && (trend.getLastDate() < 0 || readings.first().first <= trend.getLastDate()))
+        return rebuildTrend(empId, trend.getLastDate() < 0 ? 0 : readings.first().first);
+
+    for (const QPair<qint64, double> &reading : readings) {
+        if (!updateAlert(empId, reading.first, reading.second, trend))
+            return false;
+
+        trend.addReading(reading.second, reading.first);
+    }
+
+    return saveTrend(empId, trend);
+}
+
+/*!
+ * \brief Rebuilds an employee's temperature trend and re-evaluates the alerts of all readings from a given date on.
+ * \param empId = The employee's ID
+ * \param fromDate = The survey date (unix time) of the oldest reading that changed, 0 to replay all readings
+ * \return A boolean value that states whether the trend was rebuilt or not.
+ * \note The trend is seeded with the last TemperatureTrend::ReplayReadings readings before fromDate, without touching
+ * their alerts. Every later reading is then replayed and its alert is updated, so no reading is judged on a trend that
+ * is still warming up unless the employee really had no earlier readings.
+ * \note Both lookups use idx_survey_emp.
+ * \note The database must already be open.
+ */
+bool SurveyDatabase::rebuildTrend(const int &empId, const qint64 &fromDate)
+{
+    QSqlQuery historyQry(*surveyDb);
+    QList<QPair<qint64, double>> seedReadings;
+    QList<QPair<qint64, double>> readings;
+
+    prepareQuery(historyQry, "SELECT survey_date, temperature FROM Survey "
+                       "WHERE emp_id = :id AND survey_date < :from "
+                       "ORDER BY survey_date DESC LIMIT :n;");
+    historyQry.bindValue(":id", empId);
+    historyQry.bindValue(":from", fromDate);
+    historyQry.bindValue(":n", TemperatureTrend::ReplayReadings);
+
+    if (!historyQry.exec()) {
+        qDebug() << "(DB) Error reading temperature history: " << historyQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    while (historyQry.next())
+        seedReadings.prepend(qMakePair(historyQry.value(0).toLongLong(), historyQry.value(1).toDouble()));
+
+    prepareQuery(historyQry, "SELECT survey_date, temperature FROM Survey "
+                       "WHERE emp_id = :id AND survey_date >= :from "
+                       "ORDER BY survey_date;");
+    historyQry.bindValue(":id", empId);
+    historyQry.bindValue(":from", fromDate);
+
+    if (!historyQry.exec()) {
+        qDebug() << "(DB) Error reading temperature history: " << historyQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    while (historyQry.next())
+        readings.append(qMakePair(historyQry.value(0).toLongLong(), historyQry.value(1).toDouble()));
+
+    QSqlQuery trendQry(*surveyDb);
+
+    if (seedReadings.isEmpty() && readings.isEmpty()) {
+        prepareQuery(trendQry, "DELETE FROM TemperatureTrend WHERE emp_id = :id;");
+        trendQry.bindValue(":id", empId);
+        return trendQry.exec();
+    }
+
+    TemperatureTrend trend;
+
+    // The alerts of the seed readings were evaluated when they were added and did not change.
+    for (const QPair<qint64, double> &reading : seedReadings)
+        trend.addReading(reading.second, reading.first);
+
+    for (const QPair<qint64, double> &reading : readings) {
+        if (!updateAlert(empId, reading.first, reading.second, trend))
+            return false;
+
+        trend.addReading(reading.second, reading.first);
+    }
+
+    return saveTrend(empId, trend);
+}
+
+/*!
+ * \brief Checks if a given employee name is already in the database.
+ * \param name = The employee's name
+ * \return A boolean value that is true if it does exist, and is false if it does not exist.
+ * \note Names are compared by their normalized key (see normalizeName()), without a database lookup.
+ */
+bool SurveyDatabase::employeeExist(const QString &name)
+{
+    return idsByNameKey.contains(normalizeName(name));
+}
+
+/*!
+ * \brief Checks if an employee with the given ID is in the database.
+ * \param empId = The employee's ID
+ * \return A boolean value that is true if it does exist, and is false if it does not exist.
+ * \note Most employees are found in memory, only employees without a name key (duplicate names from before the keys
+ * existed) and unknown IDs need a database lookup.
+ */
+bool SurveyDatabase::employeeExist(const int &empId)
+{
+    if (nameKeysById.contains(empId))
+        return true;
+
+    if (empId < 0)
+        return false;
+
+    openDb();
+
+    QSqlQuery employeeQry(*surveyDb);
+
+    prepareQuery(employeeQry, "SELECT 1 FROM Employee WHERE emp_id = :id;");
+    employeeQry.bindValue(":id", empId);
+
+    return employeeQry.exec() && employeeQry.next();
+}
+
+/*!
+ * \brief Retrieves the ID of an employee by name.
+ * \param name = The employee's name
+ * \return An integer with the employee's ID, or -1 if there is no employee with the name.
+ * \note Names are compared by their normalized key (see normalizeName()), without a database lookup.
+ */
+int SurveyDatabase::getEmployeeId(const QString &name)
+{
+    return idsByNameKey.value(normalizeName(name), -1);
+}
+
+/*!
+ * \brief Reads the current state of a survey for the audit log, before it is changed.
+ * \param surveyDate = The survey date as unix time
+ * \param empId = The ID of the employee
+ * \param record = Receives the employee, the date and the current answers and temperature of the survey
+ * \return A boolean value that is false if the survey could not be read.
+ * \note The empId of the record stays -1 if there is no such survey, since then nothing changes.
+ */
+bool SurveyDatabase::loadAuditRecord(const qint64 &surveyDate, const int &empId, AuditRecord &record)
+{
+    QSqlQuery surveyQry(*surveyDb);
+
+    prepareQuery(surveyQry, "SELECT answers, temperature FROM Survey "
+                      "WHERE survey_date = :date AND emp_id = :id;");
+
+    surveyQry.bindValue(":date", surveyDate);
+    surveyQry.bindValue(":id", empId);
+
+    if (!surveyQry.exec()) {
+        qDebug() << "(DB) Error reading survey for the audit log: " << surveyQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    if (surveyQry.next()) {
+        record.empId = empId;
+        record.surveyDate = surveyDate;
+        record.oldAnswers = surveyQry.value(0).toUInt();
+        record.oldTemperature = surveyQry.value(1).toFloat();
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Reads every survey of an employee for the audit log, before the surveys are removed.
+ * \param empId = The ID of the employee
+ * \param records = Receives a record with the current answers and temperature of every survey
+ * \return A boolean value that is false if the surveys could not be read.
+ */
+bool SurveyDatabase::loadAuditRecords(const int &empId, QList<AuditRecord> &records)
+{
+    QSqlQuery surveyQry(*surveyDb);
+
+    prepareQuery(surveyQry, "SELECT survey_date, answers, temperature FROM Survey "
+                      "WHERE emp_id = :id;");
+
+    surveyQry.bindValue(":id", empId);
+
+    if (!surveyQry.exec()) {
+        qDebug() << "(DB) Error reading surveys for the audit log: " << surveyQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    while (surveyQry.next()) {
+        AuditRecord record;
+        record.action = AuditRecord::Remove;
+        record.empId = empId;
+        record.surveyDate = surveyQry.value(0).toLongLong();
+        record.oldAnswers = surveyQry.value(1).toUInt();
+        record.oldTemperature = surveyQry.value(2).toFloat();
+        records.append(record);
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Retrieves the IDs of all employees by name.
+ * \return A QHash with the ID of every employee name.
+ */
+QHash<QString, int> SurveyDatabase::getEmployeeIds()
+{
+    openDb();
+
+    QSqlQuery employeeQry(*surveyDb);
+    QHash<QString, int> ids;
+
+    employeeQry.setForwardOnly(true);
+    prepareQuery(employeeQry, "SELECT emp_id, name FROM Employee;", true);
+
+    if (employeeQry.exec()) {
+        while (employeeQry.next())
+            ids.insert(employeeQry.value(1).toString(), employeeQry.value(0).toInt());
+    } else
+        qDebug() << "(DB) Error retrieving employee IDs: " << employeeQry.lastError().text() << Qt::endl;
+
+    return ids;
+}
+
+/*!
+ * \brief Normalizes an employee name into the key that identifies the employee.
+ * \param name = The employee's name
+ * \return The name in Unicode normalization form C, case folded, with every run of whitespace collapsed to a single space.
+ * \note Accents are kept, so "José" and "Jose" are different employees, but a composed and a decomposed "é" are not.
+ */
+QString SurveyDatabase::normalizeName(const QString &name)
+{
+    return name.simplified().toCaseFolded().normalized(QString::NormalizationForm_C);
+}
+
+/*!
+ * \brief Loads the normalized name keys of all employees into memory.
+ * \return A boolean value stating whether the keys were loaded or not.
+ */
+bool SurveyDatabase::loadEmployeeKeys()
+{
+    openDb();
+
+    QSqlQuery keyQry(*surveyDb);
+
+    keyQry.setForwardOnly(true);
+    prepareQuery(keyQry, "SELECT emp_id, name_key FROM Employee WHERE name_key IS NOT NULL;");
+
+    if (!keyQry.exec()) {
+        qDebug() << "(DB) Error loading employee names: " << keyQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    idsByNameKey.clear();
+    nameKeysById.clear();
+
+    while (keyQry.next())
+        setNameKey(keyQry.value(0).toInt(), keyQry.value(1).toString());
+
+    return true;
+}
+
+/*!
+ * \brief Assigns a normalized name key to an employee in memory, replacing the employee's previous key.
+ * \param empId = The ID of the employee
+ * \param key = The normalized name
+ */
+void SurveyDatabase::setNameKey(const int &empId, const QString &key)
+{
+    forgetNameKey(empId);
+
+    idsByNameKey.insert(key, empId);
+    nameKeysById.insert(empId, key);
+}
+
+/*!
+ * \brief Removes the normalized name key of an employee from memory.
+ * \param empId = The ID of the employee
+ */
+void SurveyDatabase::forgetNameKey(const int &empId)
+{
+    auto key(nameKeysById.constFind(empId));
+
+    if (key == nameKeysById.constEnd())
+        return;
+
+    // The key may already belong to another employee that was renamed to it.
+    if (idsByNameKey.value(key.value(), -1) == empId)
+        idsByNameKey.remove(key.value());
+
+    nameKeysById.erase(key);
+}
+
+/*!
+ * \brief Deletes a single batch of surveys older than the given date.
+ * \param before = Surveys answered before this date are deleted
+ * \param limit = The maximum amount of surveys to delete in this batch
+ * \return The amount of surveys deleted, or -1 if the transaction failed.
+ * \note The batch runs as its own short transaction so that the database is never locked for long.
+ * \note The (survey_date, emp_id) primary key makes the date range lookup index backed.
+ * \note The temperature trend of every employee with a purged survey is rebuilt in the same transaction.
+ */
+int SurveyDatabase::purgeSurveys(const QDate &before, const int &limit)
+{
+    openDb();
+
+    QDateTime cutoffDate(before, QTime(12, 0));
+    int cutoffUnix(cutoffDate.toSecsSinceEpoch());
+
+    if (!beginWrite())
+        return -1;
+
+    QSqlQuery surveyQry(*surveyDb);
+    QSet<int> empIds;
+    int rowsDeleted(-1);
+
+    // The write lock is held, so the batch subquery selects the same surveys in both statements.
+    prepareQuery(surveyQry, "SELECT DISTINCT emp_id FROM Survey "
+                      "WHERE rowid IN (SELECT rowid FROM Survey WHERE survey_date < :date LIMIT :limit);", true);
+    surveyQry.bindValue(":date", cutoffUnix);
+    surveyQry.bindValue(":limit", limit);
+
+    if (surveyQry.exec()) {
+        while (surveyQry.next())
+            empIds.insert(surveyQry.value(0).toInt());
+
+        prepareQuery(surveyQry, "DELETE FROM Survey "
+                          "WHERE rowid IN (SELECT rowid FROM Survey WHERE survey_date < :date LIMIT :limit);");
+        surveyQry.bindValue(":date", cutoffUnix);
+        surveyQry.bindValue(":limit", limit);
+
+        if (surveyQry.exec())
+            rowsDeleted = surveyQry.numRowsAffected();
+    }
+
+    bool trendsUpdated(rowsDeleted >= 0);
+
+    // Only the oldest surveys are purged, so the alerts of the remaining surveys are kept as they are.
+    for (auto it = empIds.cbegin(); trendsUpdated && it != empIds.cend(); ++it)
+        trendsUpdated = rebuildTrend(*it, std::numeric_limits<qint64>::max());
+
+    if (trendsUpdated && surveyDb->commit()) {
+        // The purged surveys can belong to any employee.
+        if (rowsDeleted > 0) {
+            pageCache.clear();
+            clearSketches();
+        }
+
+        return rowsDeleted;
+    }
+
+    qDebug() << "(DB) Error purging surveys: " << surveyQry.lastError().text() << Qt::endl;
+    surveyDb->rollback();
+    return -1;
+}
+
+/*!
+ * \brief Determines if the database is using incremental auto vacuum, which lets free pages be released a few at a time.
+ * \return A boolean value that states whether the database is using incremental auto vacuum.
+ */
+bool SurveyDatabase::isIncrementalVacuum()
+{
+    openDb();
+
+    QSqlQuery surveyQry(*surveyDb);
+
+    // 2 is INCREMENTAL.
+    return surveyQry.exec("PRAGMA auto_vacuum;") && surveyQry.next() && surveyQry.value(0).toInt() == 2;
+}
+
+/*!
+ * \brief Switches the database to incremental auto vacuum if it is not already using it.
+ * \return A boolean value that states whether the database is using incremental auto vacuum.
+ * \note Databases created before the retention job existed have to be rebuilt once with VACUUM for the change to apply.
+ * \note This rebuild locks the database and blocks the calling thread until it is done, which can take a while on a
+ * large database. The GUI runs it on a thread of its own through RetentionJob::compact().
+ * \note VACUUM cannot run inside a transaction, so it waits for the lock itself and is retried like beginWrite().
+ * A lock failure is reported through isLockBusy() and getLastError().
+ */
+bool SurveyDatabase::enableIncrementalVacuum()
+{
+    if (isIncrementalVacuum())
+        return true;
+
+    TraceSpan span("SurveyDatabase::enableIncrementalVacuum");
+    QSqlQuery surveyQry(*surveyDb);
+    QElapsedTimer waitTimer;
+    int maxAttempts(isMainThread() ? 1 : MaxWriteAttempts);
+
+    waitTimer.start();
+
+    if (!surveyQry.exec("PRAGMA auto_vacuum = INCREMENTAL;")) {
+        qDebug() << "(DB) Error enabling incremental vacuum: " << surveyQry.lastError().text() << Qt::endl;
+        lastError = surveyQry.lastError().text();
+        return false;
+    }
+
+    for (int attempt = 1; attempt <= maxAttempts; ++attempt) {
+        if (surveyQry.exec("VACUUM;")) {
+            ++contentionStats.writeTransactions;
+            return true;
+        }
+
+        if (!isBusyError(surveyQry.lastError()) || attempt == maxAttempts)
+            break;
+
+        ++contentionStats.busyRetries;
+        waitBeforeRetry(attempt);
+    }
+
+    qDebug() << "(DB) Error enabling incremental vacuum: " << surveyQry.lastError().text() << Qt::endl;
+    writeFailed(surveyQry.lastError(), waitTimer.nsecsElapsed() / 1000000.0);
+    return false;
+}
+
+/*!
+ * \brief Returns up to the given amount of free pages to the file system.
+ * \param pages = The maximum amount of pages to release
+ * \return The amount of bytes by which the database file shrunk, or -1 if the vacuum failed.
+ * \note The pages are released in a write transaction of their own, so a lock held by another workstation is
+ * reported through isLockBusy() like any other write.
+ */
+qint64 SurveyDatabase::reclaimFreePages(const int &pages)
+{
+    openDb();
+
+    if (!beginWrite())
+        return -1;
+
+    QSqlQuery surveyQry(*surveyDb);
+    qint64 pageSize(0);
+    qint64 pagesBefore(0);
+
+    if (surveyQry.exec("PRAGMA page_size;") && surveyQry.next())
+        pageSize = surveyQry.value(0).toLongLong();
+
+    if (surveyQry.exec("PRAGMA page_count;") && surveyQry.next())
+        pagesBefore = surveyQry.value(0).toLongLong();
+
+    if (surveyQry.exec("PRAGMA incremental_vacuum(" + QString::number(pages) + ");")) {
+        // Each freed page is reported as a row, the vacuum only completes once all of them are stepped through.
+        while (surveyQry.next()) {}
+
+        if (surveyQry.exec("PRAGMA page_count;") && surveyQry.next()) {
+            qint64 pagesAfter(surveyQry.value(0).toLongLong());
+
+            if (surveyDb->commit())
+                return (pagesBefore - pagesAfter) * pageSize;
+        }
+    }
+
+    qDebug() << "(DB) Error reclaiming free pages: " << surveyQry.lastError().text() << Qt::endl;
+
+    surveyDb->rollback();
+    return -1;
+}
+
+/*!
+ * \brief Retrieves the amount of unused pages in the database file.
+ * \return An integer with the amount of free pages, or -1 if it could not be determined.
+ */
+int SurveyDatabase::getFreePageCount()
+{
+    openDb();
+
+    QSqlQuery surveyQry(*surveyDb);
+
+    if (surveyQry.exec("PRAGMA freelist_count;") && surveyQry.next()) {
+        int freePages(surveyQry.value(0).toInt());
+        return freePages;
+    } else
+        qDebug() << "(DB) Error counting free pages: " << surveyQry.lastError().text() << Qt::endl;
+
+    return -1;
+}
+
+/*!
+ * \brief Update the survey model with the current employee ID.
+ *
+ * Updates the survey model to display the current state of survey data from the current employee ID from currentEmpId.
+ * \note The surveys are taken from the page cache if the employee was viewed recently and has not changed since.
+ */
+void SurveyDatabase::updateSurveyTableModel()
+{
+    TraceSpan span("SurveyDatabase::updateSurveyTableModel");
+
+    pageLoader.cancel();
+
+    const SurveyPage *cached(pageCache.find(currentEmpId));
+
+    if (cached != nullptr) {
+        surveyModel->load(*cached);
+        return;
+    }
+
+    SurveyPage page;
+
+    // A page that could not be read completely is shown, but not cached.
+    if (loadSurveyPage(currentEmpId, page))
+        pageCache.insert(currentEmpId, page);
+
+    surveyModel->load(page);
+}
+
+/*!
+ * \brief Updates the survey model with the surveys of the current employee without blocking on the database.
+ *
+ * A cached page is shown at once. Otherwise the model is emptied and filled in chunks by a background load,
+ * which cancels the load that was still running. surveyLoadProgress() is emitted for every chunk.
+ * \note surveysLoaded() is emitted once the model is complete, which is right away for a cached page.
+ * \note An in-memory database cannot be read by the background loader, so its surveys are loaded right away.
+ */
+void SurveyDatabase::updateSurveyTableModelAsync()
+{
+    TraceSpan span("SurveyDatabase::updateSurveyTableModelAsync");
+
+    const SurveyPage *cached(pageCache.find(currentEmpId));
+
+    if (cached != nullptr) {
+        pageLoader.cancel();
+        surveyModel->load(*cached);
+        emit surveysLoaded();
+        return;
+    }
+
+    if (isInMemory()) {
+        updateSurveyTableModel();
+        emit surveysLoaded();
+        return;
+    }
+
+    surveyModel->load(SurveyPage());
+    loadEpoch = pageCache.getEpoch();
+    pageLoader.load(currentEmpId);
+}
+
+/*!
+ * \brief Determines if the survey model is still being filled by a background load.
+ * \return A boolean value that states whether surveys are being loaded.
+ */
+bool SurveyDatabase::isLoadingSurveys() const
+{
+    return pageLoader.isLoading();
+}
+
+/*!
+ * \brief Adds a chunk of a background load to the survey model.
+ * \param empId = The ID of the employee the surveys belong to
+ * \param chunk = The surveys
+ * \param loaded = The amount of surveys loaded so far
+ * \param total = The amount of surveys expected
+ */
+void SurveyDatabase::surveyChunkLoaded(const int &empId, const SurveyPage &chunk, const int &loaded, const int &total)
+{
+    if (empId != currentEmpId)
+        return;
+
+    TraceSpan span("SurveyDatabase::surveyChunkLoaded");
+
+    surveyModel->append(chunk);
+    emit surveyLoadProgress(loaded, total);
+}
+
+/*!
+ * \brief Caches the page of a completed background load and reports that the survey model is complete.
+ * \param empId = The ID of the employee the surveys belong to
+ * \param complete = Were all surveys read?
+ * \note The page is not cached if a write invalidated the cache while it was being read.
+ */
+void SurveyDatabase::surveyLoadFinished(const int &empId, const bool &complete)
+{
+    if (empId != currentEmpId)
+        return;
+
+    TraceSpan span("SurveyDatabase::surveyLoadFinished");
+
+    if (complete && loadEpoch == pageCache.getEpoch())
+        pageCache.insert(empId, surveyModel->getPage());
+
+    emit surveysLoaded();
+}
+
+/*!
+ * \brief Caches a page that was read ahead of time.
+ * \param empId = The ID of the employee the surveys belong to
+ * \param page = The surveys
+ * \param epoch = The epoch of the page cache when the read started
+ */
+void SurveyDatabase::surveyPagePrefetched(const int &empId, const SurveyPage &page, const quint64 &epoch)
+{
+    if (epoch == pageCache.getEpoch() && !pageCache.contains(empId))
+        pageCache.insert(empId, page, true);
+}
+
+/*!
+ * \brief Reads the surveys of an employee and flags their temperature anomalies.
+ * \param empId = The ID of the employee
+ * \param page = Receives the surveys
+ * \return A boolean value that states whether the surveys and anomalies were read or not.
+ */
+bool SurveyDatabase::loadSurveyPage(const int &empId, SurveyPage &page)
+{
+    openDb();
+
+    QSqlQuery modelQry(*surveyDb);
+
+    modelQry.setForwardOnly(true);
+    prepareQuery(modelQry, "SELECT survey_date, answers, temperature "
+                           "FROM Survey "
+                           "WHERE emp_id = :id "
+                           "ORDER BY survey_date;");
+    modelQry.bindValue(":id", empId);
+
+    if (!modelQry.exec()) {
+        qDebug() << "(DB) Error retrieving surveys: " << modelQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    page.read(modelQry);
+
+    QSqlQuery alertQry(*surveyDb);
+    QSet<qint64> anomalyDates;
+
+    prepareQuery(alertQry, "SELECT survey_date FROM TemperatureAlert WHERE emp_id = :id;");
+    alertQry.bindValue(":id", empId);
+
+    if (!alertQry.exec()) {
+        qDebug() << "(DB) Error retrieving temperature alerts: " << alertQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    while (alertQry.next())
+        anomalyDates.insert(alertQry.value(0).toLongLong());
+
+    page.setAnomalyDates(anomalyDates);
+    return true;
+}
+
+/*!
+ * \brief Reads the survey pages of employees that are likely to be viewed next into the page cache, in the background.
+ * \param empIds = The IDs of the employees
+ * \note Pages that are already cached are skipped and do not count as lookups.
+ * \note The next background load of the survey model cancels the prefetch.
+ */
+void SurveyDatabase::prefetchSurveyPages(const QList<int> &empIds)
+{
+    if (isInMemory())
+        return;
+
+    QList<int> missing;
+
+    for (const int &empId : empIds) {
+        if (empId >= 0 && !pageCache.contains(empId))
+            missing.append(empId);
+    }
+
+    pageLoader.prefetch(missing, pageCache.getEpoch());
+}
+
+/*!
+ * \brief Retrieves the hit rate and memory use of the survey page cache.
+ * \return The PageCacheStats of the cache.
+ */
+PageCacheStats SurveyDatabase::getPageCacheStats() const
+{
+    return pageCache.getStats();
+}
+
+/*!
+ * \brief Assigns the memory budget of the survey page cache.
+ * \param maxBytes = The memory budget in bytes, 0 disables the cache
+ */
+void SurveyDatabase::setPageCacheSize(const qint64 &maxBytes)
+{
+    pageCache.setMaxBytes(qMax(Q_INT64_C(0), maxBytes));
+}
+
+void SurveyDatabase::updateEmployeeTableModel()
+{
+    openDb();
+
+    QSqlQuery modelQry(*surveyDb);
+
+    modelQry.setForwardOnly(true);
+    prepareQuery(modelQry, "SELECT e.emp_id, e.name, IFNULL(s.survey_count, 0), s.last_date, s.last_temperature "
+                           "FROM Employee e LEFT JOIN EmployeeSummary s ON s.emp_id = e.emp_id" +
+                           getPartitionFilter("WHERE") + " "
+                           "ORDER BY e.name;", true);
+    bindPartition(modelQry);
+
+    if (!modelQry.exec())
+        qDebug() << "(DB) Error retrieving employees: " << modelQry.lastError().text() << Qt::endl;
+
+    employeeModel->load(modelQry);
+}
+
+/*!
+ * \brief Explains every statement this database has prepared so far and flags full scans and temporary sorts.
+ * \return The query plans, ordered by statement.
+ * \note The scans and sorts of statements prepared with scanExpected are reported, but not as issues.
+ */
+QList<QueryPlan> SurveyDatabase::inspectQueryPlans()
+{
+    openDb();
+
+    QueryPlanInspector inspector(*surveyDb);
+    QList<QueryPlan> plans;
+    QStringList statements(issuedQueries.keys());
+
+    statements.sort();
+
+    for (const QString &statement : statements)
+        plans.append(inspector.explain(statement, issuedQueries.value(statement)));
+
+    return plans;
+}
+
+/*!
+ * \brief Creates an index, typically one suggested by inspectQueryPlans().
+ * \param statement = The CREATE INDEX statement
+ * \return A boolean value that states whether the index was created or not.
+ * \note Any statement that is not a CREATE INDEX statement is rejected.
+ */
+bool SurveyDatabase::createIndex(const QString &statement)
+{
+    if (!statement.trimmed().startsWith("CREATE INDEX", Qt::CaseInsensitive))
+        return false;
+
+    openDb();
+
+    QSqlQuery surveyQry(*surveyDb);
+
+    if (surveyQry.exec(statement)) {
+        return true;
+    } else
+        qDebug() << "(DB) Error creating index: " << surveyQry.lastError().text() << Qt::endl;
+
+    return false;
+}
+
+/*!
+ * \brief Prepares a statement and remembers it for inspectQueryPlans().
+ * \param query = The query to prepare
+ * \param sql = The statement, with bound values as placeholders
+ * \param scanExpected = Does the statement intentionally read a whole table or sort its rows, e.g. to list every employee by name?
+ * \return A boolean value that states whether the statement was prepared or not.
+ * \note Every statement SurveyDatabase runs with bound values should be prepared through this function.
+ */
+bool SurveyDatabase::prepareQuery(QSqlQuery &query, const QString &sql, const bool &scanExpected)
+{
+    issuedQueries.insert(sql, scanExpected);
+    return query.prepare(sql);
+}
+
+/*!
+ * \brief Opens the connection to the database if it is not open yet, and configures it for sharing the file.
+ * \note The connection stays open until closeDb() is called, so that it can follow the changes of other workstations.
+ */
+void SurveyDatabase::openDb()
+{
+    lastError.clear();
+    lockBusy = false;
+
+    if (!surveyDb->isOpen()) {
+        bool isNew(isInMemory() || !QFile::exists(dbLocation));
+
+        surveyDb->setDatabaseName(dbLocation);
+        surveyDb->setConnectOptions("QSQLITE_BUSY_TIMEOUT=" + QString::number(isMainThread() ? MainBusyTimeout : BusyTimeout));
+
+        if (!surveyDb->open()) {
+            lastError = surveyDb->lastError().text();
+            return;
+        }
+
+        QSqlQuery pragmaQry(*surveyDb);
+
+        // Foreign keys are enforced per connection, the cascading employee delete depends on them.
+        pragmaQry.exec("PRAGMA foreign_keys = ON;");
+
+        // Free pages are only released by the retention job, a few at a time. This has to be set before the first
+        // table is created and before the file is switched to WAL, which silently ignores it from then on.
+        if (isNew && !pragmaQry.exec("PRAGMA auto_vacuum = INCREMENTAL;"))
+            qDebug() << "(DB) Error enabling incremental vacuum: " << pragmaQry.lastError().text() << Qt::endl;
+
+        // WAL lets the other workstations keep reading while one writes, but it only works on a local file system.
+        journalMode = isNetworkLocation(dbLocation) ? "delete" : profile.journalMode;
+
+        if (pragmaQry.exec("PRAGMA journal_mode = " + journalMode + ";") && pragmaQry.next())
+            journalMode = pragmaQry.value(0).toString();
+
+        // Syncing less than FULL is only safe from corruption with WAL, so the rollback journal never goes below it.
+        QString synchronous(profile.synchronous);
+
+        if (journalMode != "wal" && (synchronous == "OFF" || synchronous == "NORMAL"))
+            synchronous = "FULL";
+
+        pragmaQry.exec("PRAGMA synchronous = " + synchronous + ";");
+        pragmaQry.exec("PRAGMA cache_size = " + QString::number(-profile.cacheSizeKiB) + ";");
+        // Memory mapped I/O is not coherent across machines, so it is never used on a network share.
+        pragmaQry.exec("PRAGMA mmap_size = " + QString::number(isNetworkLocation(dbLocation) ? 0 : profile.mmapSize) + ";");
+        pragmaQry.exec(QString("PRAGMA temp_store = ") + (profile.tempStoreMemory ? "MEMORY;" : "DEFAULT;"));
+
+        dataVersion = -1;
+    }
+}
+
+/*!
+ * \brief Starts a write transaction, waiting for other workstations that hold the write lock.
+ * \return A boolean value that states whether the transaction was started or not.
+ * \note The write lock is taken right away (BEGIN IMMEDIATE), so a transaction can never fail halfway on a lock.
+ * \note SQLite waits up to BusyTimeout for the lock on every attempt. The attempts are spread out with a growing,
+ * randomized backoff so that workstations that collided do not retry in lockstep.
+ * \note On the main thread the lock is only waited for once, up to MainBusyTimeout, so the GUI never stalls. A lock
+ * failure is then reported through isLockBusy() and getLastError(), so the caller can retry from the event loop.
+ */
+bool SurveyDatabase::beginWrite()
+{
+    TraceSpan span("SurveyDatabase::beginWrite");
+    QSqlQuery beginQry(*surveyDb);
+    QElapsedTimer waitTimer;
+    int maxAttempts(isMainThread() ? 1 : MaxWriteAttempts);
+
+    waitTimer.start();
+
+    for (int attempt = 1; attempt <= maxAttempts; ++attempt) {
+        if (beginQry.exec("BEGIN IMMEDIATE;")) {
+            double waitMs(waitTimer.nsecsElapsed() / 1000000.0);
+
+            ++contentionStats.writeTransactions;
+            contentionStats.totalLockWaitMs += waitMs;
+            contentionStats.maxLockWaitMs = qMax(contentionStats.maxLockWaitMs, waitMs);
+            return true;
+        }
+
+        if (!isBusyError(beginQry.lastError()) || attempt == maxAttempts)
+            break;
+
+        ++contentionStats.busyRetries;
+        waitBeforeRetry(attempt);
+    }
+
+    qDebug() << "(DB) Error starting write transaction: " << beginQry.lastError().text() << Qt::endl;
+    writeFailed(beginQry.lastError(), waitTimer.nsecsElapsed() / 1000000.0);
+    return false;
+}
+
+/*!
+ * \brief Records a write that could not get the write lock, so the caller can report it or try again.
+ * \param error = The error of the last attempt
+ * \param waitMs = The time (in milliseconds) spent waiting for the lock
+ */
+void SurveyDatabase::writeFailed(const QSqlError &error, const double &waitMs)
+{
+    ++contentionStats.failedWrites;
+    contentionStats.totalLockWaitMs += waitMs;
+    contentionStats.maxLockWaitMs = qMax(contentionStats.maxLockWaitMs, waitMs);
+
+    lockBusy = isBusyError(error);
+    lastError = lockBusy ? tr("The database is in use by another workstation. Please try again in a moment.")
+                         : error.text();
+}
+
+/*!
+ * \brief Checks if another workstation (or connection) changed the database, and emits databaseChanged() if it did.
+ * \note PRAGMA data_version only changes when another connection commits, so this never fires for own changes.
+ */
+void SurveyDatabase::checkForChanges()
+{
+    if (!surveyDb->isOpen())
+        return;
+
+    QSqlQuery versionQry(*surveyDb);
+
+    if (versionQry.exec("PRAGMA data_version;") && versionQry.next()) {
+        qint64 version(versionQry.value(0).toLongLong());
+
+        // Another workstation could have changed the surveys of any employee.
+        if (dataVersion >= 0 && version != dataVersion) {
+            pageCache.clear();
+            clearSketches();
+            loadEmployeeKeys();
+            emit databaseChanged();
+        }
+
+        dataVersion = version;
+    }
+}
+
+/*!
+ * \brief Retrieves the lock statistics of the write transactions since the database was created or the statistics were reset.
+ * \return The ContentionStats of this workstation.
+ */
+ContentionStats SurveyDatabase::getContentionStats() const
+{
+    return contentionStats;
+}
+
+/*!
+ * \brief Resets the lock statistics of the write transactions.
+ */
+void SurveyDatabase::resetContentionStats()
+{
+    contentionStats = ContentionStats();
+}
+
+/*!
+ * \brief Retrieves the journal mode the database file is used in.
+ * \return A QString with the journal mode ("wal" on local disks, "delete" on network shares).
+ */
+QString SurveyDatabase::getJournalMode() const
+{
+    return journalMode;
+}
+
+/*!
+ * \brief Retrieves a description of the last error that can be shown to the user.
+ * \return A QString with the error, or an empty string if the last operation did not report one.
+ */
+QString SurveyDatabase::getLastError() const
+{
+    return lastError;
+}
+
+/*!
+ * \brief Determines if the last write failed because another workstation held the write lock.
+ * \return A boolean value that is true if the write is worth retrying in a moment.
+ */
+bool SurveyDatabase::isLockBusy() const
+{
+    return lockBusy;
+}
+
+/*!
+ * \brief Assigns the durability profile the database is opened with.
+ * \param newProfile = The DurabilityProfile to use
+ * \note The profile takes effect the next time the database is opened, so call this before createDatabase().
+ */
+void SurveyDatabase::setDurabilityProfile(const DurabilityProfile &newProfile)
+{
+    profile = newProfile;
+}
+
+/*!
+ * \brief Retrieves the durability profile the database is opened with.
+ * \return The DurabilityProfile.
+ */
+DurabilityProfile SurveyDatabase::getDurabilityProfile() const
+{
+    return profile;
+}
+
+/*!
+ * \brief Limits the employees, reports and aggregates to a site and department.
+ * \param newPartition = The Partition, with -1 for every site or department
+ * \note New employees are added to the partition. Call updateEmployeeTableModel() to list the employees in it.
+ */
+void SurveyDatabase::setPartition(const Partition &newPartition)
+{
+    partition = newPartition;
+}
+
+/*!
+ * \brief Retrieves the site and department the employees, reports and aggregates are limited to.
+ * \return The Partition.
+ */
+Partition SurveyDatabase::getPartition() const
+{
+    return partition;
+}
+
+/*!
+ * \brief Adds a row to the Site or Department table, or finds the row with the same name.
+ * \param table = The table
+ * \param idColumn = The ID column of the table
+ * \param name = The name
+ * \return The ID of the row, or -1 if it could not be added.
+ */
+int SurveyDatabase::addPartitionName(const QString &table, const QString &idColumn, const QString &name)
+{
+    QString simplified(name.simplified());
+
+    if (simplified.isEmpty())
+        return -1;
+
+    openDb();
+
+    QSqlQuery nameQry(*surveyDb);
+
+    prepareQuery(nameQry, "INSERT OR IGNORE INTO " + table + " (name) VALUES (:name);");
+    nameQry.bindValue(":name", simplified);
+
+    if (!nameQry.exec()) {
+        qDebug() << "(DB) Error adding " << table << ": " << nameQry.lastError().text() << Qt::endl;
+        return -1;
+    }
+
+    prepareQuery(nameQry, "SELECT " + idColumn + " FROM " + table + " WHERE name = :name;");
+    nameQry.bindValue(":name", simplified);
+
+    if (!nameQry.exec() || !nameQry.next()) {
+        qDebug() << "(DB) Error retrieving " << table << ": " << nameQry.lastError().text() << Qt::endl;
+        return -1;
+    }
+
+    return nameQry.value(0).toInt();
+}
+
+/*!
+ * \brief Retrieves every row of the Site or Department table.
+ * \param table = The table
+ * \param idColumn = The ID column of the table
+ * \return The name of every row by ID.
+ */
+QMap<int, QString> SurveyDatabase::getPartitionNames(const QString &table, const QString &idColumn)
+{
+    openDb();
+
+    QMap<int, QString> names;
+    QSqlQuery nameQry(*surveyDb);
+
+    nameQry.setForwardOnly(true);
+    prepareQuery(nameQry, "SELECT " + idColumn + ", name FROM " + table + ";", true);
+
+    if (!nameQry.exec()) {
+        qDebug() << "(DB) Error retrieving " << table << ": " << nameQry.lastError().text() << Qt::endl;
+        return names;
+    }
+
+    while (nameQry.next())
+        names.insert(nameQry.value(0).toInt(), nameQry.value(1).toString());
+
+    return names;
+}
+
+/*!
+ * \brief Builds the condition that limits a query to the employees in the current partition.
+ * \param keyword = The keyword the condition follows, "WHERE" or "AND"
+ * \return The condition on the Employee table (aliased as e) with a leading space, or an empty string for every employee.
+ * \note Bind the values of the condition with bindPartition().
+ */
+QString SurveyDatabase::getPartitionFilter(const QString &keyword) const
+{
+    QStringList conditions;
+
+    if (partition.siteId >= 0)
+        conditions.append("e.site_id = :site");
+
+    if (partition.deptId >= 0)
+        conditions.append("e.dept_id = :dept");
+
+    return conditions.isEmpty() ? QString() : " " + keyword + " " + conditions.join(" AND ");
+}
+
+/*!
+ * \brief Binds the values of the condition built by getPartitionFilter().
+ * \param query = The prepared query
+ */
+void SurveyDatabase::bindPartition(QSqlQuery &query) const
+{
+    if (partition.siteId >= 0)
+        query.bindValue(":site", partition.siteId);
+
+    if (partition.deptId >= 0)
+        query.bindValue(":dept", partition.deptId);
+}
+
+/*!
+ * \brief Closes the connection to the database if it is open and forgets the cached survey pages.
+ */
+void SurveyDatabase::closeDb()
+{
+    if (surveyDb->isOpen())
+        surveyDb->close();
+
+    auditLog.flush();
+    pageCache.clear();
+    clearSketches();
+    idsByNameKey.clear();
+    nameKeysById.clear();
 }
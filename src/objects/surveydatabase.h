@@ -4,50 +4,221 @@
 #include "surveytablemodel.h"
 #include "employeetablemodel.h"
 #include "survey.h"
+#include "questionset.h"
+#include "temperaturetrend.h"
+#include "queryplaninspector.h"
+#include "durabilityprofile.h"
+#include "complianceengine.h"
+#include "temperatureseries.h"
+#include "surveypagecache.h"
+#include "surveypageloader.h"
+#include "auditlog.h"
+#include "temperaturesketch.h"
+#include "surveybackup.h"
+#include "teammatrixmodel.h"
 
 #include <QSharedPointer>
 #include <QGuiApplication>
+#include <QSet>
+#include <QTimer>
+#include <QHash>
+#include <QMap>
 
 class QSqlDatabase;
-class QSqlQueryModel;
+class QSqlQuery;
+class QSqlError;
+
+/*!
+ * \brief The lock statistics of the write transactions of a single workstation.
+ */
+struct ContentionStats
+{
+    qint64 writeTransactions = 0;   ///< The amount of write transactions that were started.
+    qint64 busyRetries = 0;         ///< The amount of times a write transaction was retried because another workstation held the lock.
+    qint64 failedWrites = 0;        ///< The amount of write transactions that gave up waiting for the lock.
+    double totalLockWaitMs = 0;     ///< The total time (in milliseconds) spent waiting for the write lock.
+    double maxLockWaitMs = 0;       ///< The longest time (in milliseconds) a single transaction waited for the write lock.
+};
+
+/*!
+ * \brief The survey of a single employee on a single day, or the lack of one.
+ */
+struct DailyStatus
+{
+    int empId = -1;             ///< The ID of the employee.
+    QString name;               ///< The name of the employee.
+    bool surveyed = false;      ///< Did the employee submit a survey on the day?
+    quint32 answers = 0;        ///< The answers of the survey as a bitmask (see QuestionSet).
+    double temperature = 0;     ///< The temperature of the survey in degrees Celsius.
+    bool anomaly = false;       ///< Was the temperature flagged as abnormally high for the employee?
+};
+
+/*!
+ * \brief A site and department that the employees, reports and aggregates are limited to.
+ */
+struct Partition
+{
+    int siteId = -1;            ///< The ID of the site, or -1 for every site.
+    int deptId = -1;            ///< The ID of the department, or -1 for every department.
+};
 
 /*!
  * \brief The database class for storing survey data.
+ *
+ * The connection stays open for the lifetime of the object, so several workstations can share one database file.
+ * Write transactions take the write lock up front and retry with a backoff while another workstation holds it.
+ * Commits by other workstations are detected with PRAGMA data_version and reported through databaseChanged().
  */
 class SurveyDatabase : public QObject
 {
     Q_OBJECT
 public:
-    explicit SurveyDatabase(QObject *parent = nullptr);
+    static constexpr const char *InMemoryLocation = ":memory:"; ///< The location of a private database that only lives in memory.
+
+    explicit SurveyDatabase(QObject *parent = nullptr, const QString &connection = QString());
+    ~SurveyDatabase();
     bool createDatabase(const QString &dir = QGuiApplication::applicationDirPath() + "/survey.data");
+    bool isInMemory() const;
     void updateSurveyTableModel();
+    void updateSurveyTableModelAsync();
+    bool isLoadingSurveys() const;
     void updateEmployeeTableModel();
 
-    QSqlQueryModel *getSurveyModel();
-    QSqlQueryModel *getEmployeeModel();
+    SurveyTableModel *getSurveyModel();
+    EmployeeTableModel *getEmployeeModel();
+    SurveyBackup *getBackup();
     int getCurrentEmployeeId() const;
+    Partition getPartition() const;
+    QString getDatabaseLocation() const;
+    QString getAuditLogLocation() const;
 
     void setCurrentEmployeeId(const int &id);
+    void setPartition(const Partition &newPartition);
+    void prefetchSurveyPages(const QList<int> &empIds);
+    PageCacheStats getPageCacheStats() const;
+    void setPageCacheSize(const qint64 &maxBytes);
 
     bool addEmployee(const QString &name);
+    int addEmployees(const QStringList &names);
     bool removeEmployee(const int &empId);
+    bool removeEmployees(const QList<int> &empIds);
     bool editEmployee(const int &empId, const QString &newName);
     bool editEmployee(const QString &currentName, const QString &newName);
+    int renameEmployees(const QList<QPair<QString, QString>> &renames);
+    bool mergeEmployees(const int &keepId, const QList<int> &duplicateIds);
+
+    int addSite(const QString &name);
+    int addDepartment(const QString &name);
+    QMap<int, QString> getSites();
+    QMap<int, QString> getDepartments();
+    bool setEmployeePartition(const QList<int> &empIds, const int &siteId, const int &deptId);
 
     bool addSurvey(const Survey &newSurvey);
+    int addSurveys(const QList<Survey> &newSurveys);
     bool removeSurvey(const QDate &date,
                       const int &empId);
     bool editSurvey(const Survey &editSurvey);
+    QList<Survey> findSurveys(const QDate &from, const QDate &to, const quint32 &mask, const bool &matchAll = false);
+
+    QuestionSet getQuestionSet() const;
+    bool addQuestion(const QString &text);
+    bool setQuestionActive(const int &bit, const bool &active);
 
     bool employeeExist(const QString &name);
+    bool employeeExist(const int &empId);
+    int getEmployeeId(const QString &name);
+    QHash<QString, int> getEmployeeIds();
+    static QString normalizeName(const QString &name);
+
+    QList<TemperatureAlert> getTemperatureAlerts(const QDate &since);
+    QList<ComplianceRecord> getCompliance(const QDate &from, const QDate &to, const WorkdayCalendar &calendar,
+                                          const bool &missedOnly = false);
+    bool loadTemperatureSeries(TemperatureSeries &series, const int &empId = -1);
+    QList<DailyStatus> getDailyStatus(const QDate &date, bool *ok = nullptr);
+    bool loadTeamMatrix(TeamMatrix &matrix, const QList<int> &empIds, const QDate &from, const QDate &to);
+    TemperatureSketch getTemperatureSketch(const QDate &from, const QDate &to);
+
+    QList<QueryPlan> inspectQueryPlans();
+    bool createIndex(const QString &statement);
+
+    int purgeSurveys(const QDate &before, const int &limit);
+    bool isIncrementalVacuum();
+    bool enableIncrementalVacuum();
+    qint64 reclaimFreePages(const int &pages);
+    int getFreePageCount();
+
+    ContentionStats getContentionStats() const;
+    void resetContentionStats();
+    QString getJournalMode() const;
+    QString getLastError() const;
+    bool isLockBusy() const;
+
+    void setDurabilityProfile(const DurabilityProfile &newProfile);
+    DurabilityProfile getDurabilityProfile() const;
+
+signals:
+    void databaseChanged();
+    void surveyLoadProgress(const int &loaded, const int &total);
+    void surveysLoaded();
+
+private slots:
+    void checkForChanges();
+    void surveyChunkLoaded(const int &empId, const SurveyPage &chunk, const int &loaded, const int &total);
+    void surveyLoadFinished(const int &empId, const bool &complete);
+    void surveyPagePrefetched(const int &empId, const SurveyPage &page, const quint64 &epoch);
 
 private:
+    QString connectionName;     ///< The name of the connection, unique for every SurveyDatabase.
     QSharedPointer<QSqlDatabase> surveyDb;      ///< The SQL Database variable where the data is stored.
     QSharedPointer<SurveyTableModel> surveyModel; ///< The data model used to display survey data from the DB in a view.
     QSharedPointer<EmployeeTableModel> employeeModel; ///< The data model used to display employee data from the DB in a view.
     QString dbLocation;     ///< The full path to where the database file is stored.
     int currentEmpId;       ///< The current employee ID being focussed on.
+    QHash<QString, bool> issuedQueries; ///< Every statement prepared through prepareQuery(), and whether its full scan or sort is expected.
+    QuestionSet questionSet;    ///< The questions of the survey, loaded from the Question table.
+    QString journalMode;        ///< The journal mode of the database file.
+    QString lastError;          ///< A description of the last error that can be shown to the user.
+    bool lockBusy;              ///< Was the last write refused because another workstation held the write lock?
+    ContentionStats contentionStats; ///< The lock statistics of the write transactions.
+    DurabilityProfile profile;  ///< The PRAGMA settings applied when the database is opened.
+    qint64 dataVersion;         ///< The last PRAGMA data_version seen, or -1 if it has not been read yet.
+    QTimer changeTimer;         ///< Polls for changes made by other workstations.
+    SurveyPageCache pageCache;  ///< The recently viewed survey pages, so switching between employees does not read the database.
+    SurveyPageLoader pageLoader;///< Reads survey pages in the background.
+    quint64 loadEpoch;          ///< The epoch of pageCache when the running background load started.
+    QHash<QString, int> idsByNameKey;   ///< The ID of every employee by normalized name (see normalizeName()).
+    QHash<int, QString> nameKeysById;   ///< The normalized name of every employee in idsByNameKey by ID.
+    AuditLog auditLog;          ///< The history of every survey edit and removal.
+    QMap<qint64, TemperatureSketch> daySketches; ///< The temperature sketch of every survey date (unix time), loaded on first use.
+    QSet<qint64> staleSketchDays;   ///< The survey dates whose sketch changed since it was loaded.
+    bool sketchesLoaded;        ///< Have the sketches been loaded since they were last cleared?
+    SurveyBackup backup;        ///< Backs up the database file while it is in use.
+    Partition partition;        ///< The site and department the employees, reports and aggregates are limited to.
 
+    bool upgradeDatabase();
+    bool upgradeSchema();
+    bool beginWrite();
+    void writeFailed(const QSqlError &error, const double &waitMs);
+    bool loadQuestionSet();
+    bool loadEmployeeKeys();
+    void setNameKey(const int &empId, const QString &key);
+    void forgetNameKey(const int &empId);
+    bool loadSurveyPage(const int &empId, SurveyPage &page);
+    bool loadAuditRecord(const qint64 &surveyDate, const int &empId, AuditRecord &record);
+    bool loadAuditRecords(const int &empId, QList<AuditRecord> &records);
+    bool loadSketches();
+    void clearSketches();
+    int addPartitionName(const QString &table, const QString &idColumn, const QString &name);
+    QMap<int, QString> getPartitionNames(const QString &table, const QString &idColumn);
+    QString getPartitionFilter(const QString &keyword) const;
+    void bindPartition(QSqlQuery &query) const;
+    bool prepareQuery(QSqlQuery &query, const QString &sql, const bool &scanExpected = false);
+    TemperatureTrend loadTrend(const int &empId);
+    bool saveTrend(const int &empId, const TemperatureTrend &trend);
+    bool updateAlert(const int &empId, const qint64 &surveyDate, const double &temperature, const TemperatureTrend &before);
+    bool applyTrendReading(const int &empId, const qint64 &surveyDate, const double &temperature);
+    bool applyTrendReadings(const int &empId, QList<QPair<qint64, double>> readings);
+    bool rebuildTrend(const int &empId, const qint64 &fromDate = 0);
     void openDb();
     void closeDb();
 };
@@ -0,0 +1,499 @@
+#include "surveyexporter.h"
+
+#include <QDateTime>
+#include <QThread>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QtEndian>
+#include <QtDebug>
+
+#include "sqlitehandle.h"
+
+#include <limits>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+const size_t BufferSize(1 << 20);   ///< The size of the write buffer (1 MiB).
+const size_t MaxRowSize(4096);      ///< The space reserved in the buffer for the fixed columns of a row, the name is reserved on top.
+
+/*!
+ * \brief Enum for the columns returned by ExportQuery.
+ */
+enum ExportColumns {
+    ExportDate,
+    ExportEmpId,
+    ExportName,
+    ExportAnswers,
+    ExportTemperature
+};
+
+// Surveys are read in primary key order, so no sorting is needed.
+const char ExportQuery[] = "SELECT s.survey_date, s.emp_id, e.name, s.answers, s.temperature "
+                           "FROM Survey s JOIN Employee e ON e.emp_id = s.emp_id "
+                           "ORDER BY s.survey_date, s.emp_id;";
+}
+
+/*!
+ * \brief The constructor for the SurveyExporter.
+ * \param databaseLocation = The full path to the database file to export from
+ */
+SurveyExporter::SurveyExporter(const QString &databaseLocation) :
+    dbLocation(databaseLocation),
+    outFile(),
+    buffer(BufferSize),
+    bufferUsed(0),
+    rowsExported(0),
+    lastError(""),
+    cachedDateUnix(-1)
+{
+}
+
+/*!
+ * \brief Exports all surveys in the database to the given file.
+ * \param fileName = The full path of the file to write to (it is overwritten if it exists)
+ * \param format = The format in which the surveys are written
+ * \return A boolean value that states whether the export was successful or not.
+ */
+bool SurveyExporter::exportSurveys(const QString &fileName, const ExportFormat &format)
+{
+    rowsExported = 0;
+    bufferUsed = 0;
+    cachedDateUnix = -1;
+    lastError.clear();
+
+    // A connection can only be used by the thread that created it.
+    QString connection("SurveyExporter" + QString::number(reinterpret_cast<quintptr>(QThread::currentThreadId())));
+    bool ok(false);
+
+    {
+        QSqlDatabase db(QSqlDatabase::addDatabase("QSQLITE", connection));
+        db.setDatabaseName(dbLocation);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+
+        if (!db.open()) {
+            lastError = db.lastError().text();
+        } else {
+            sqlite3 *handle(getSqliteHandle(db, lastError));
+
+            if (handle != nullptr)
+                ok = exportRows(handle, fileName, format);
+        }
+
+        db.close();
+    }
+
+    QSqlDatabase::removeDatabase(connection);
+
+    if (!ok)
+        qDebug() << "(Export) Error exporting surveys: " << lastError << Qt::endl;
+
+    return ok;
+}
+
+/*!
+ * \brief Runs the export query on the given connection and writes its rows to the given file.
+ * \param db = The handle of the read-only connection to the database
+ * \param fileName = The full path of the file to write to (it is overwritten if it exists)
+ * \param format = The format in which the surveys are written
+ * \return A boolean value that states whether the export was successful or not.
+ */
+bool SurveyExporter::exportRows(sqlite3 *db, const QString &fileName, const ExportFormat &format)
+{
+    sqlite3_stmt *stmt(nullptr);
+
+    if (sqlite3_prepare_v2(db, ExportQuery, -1, &stmt, nullptr) != SQLITE_OK) {
+        lastError = QString::fromUtf8(sqlite3_errmsg(db));
+        return false;
+    }
+
+    outFile.setFileName(fileName);
+
+    bool ok(outFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+
+    if (ok) {
+        switch (format) {
+        case ExportFormat::Csv:
+            ok = writeCsv(stmt);
+            break;
+        case ExportFormat::JsonLines:
+            ok = writeJsonLines(stmt);
+            break;
+        case ExportFormat::Columnar:
+            ok = writeColumnar(stmt);
+            break;
+        }
+
+        ok = flush() && ok;
+        outFile.close();
+    } else
+        lastError = outFile.errorString();
+
+    if (!ok && lastError.isEmpty())
+        lastError = QString::fromUtf8(sqlite3_errmsg(db));
+
+    // The statement must be finalized before the connection is closed.
+    sqlite3_finalize(stmt);
+
+    return ok;
+}
+
+/*!
+ * \brief Retrieves the amount of surveys written by the last export.
+ * \return The amount of surveys exported.
+ */
+qint64 SurveyExporter::getRowsExported() const
+{
+    return rowsExported;
+}
+
+/*!
+ * \brief Retrieves a description of the last error that occurred.
+ * \return A QString with the error, or an empty string if the last export was successful.
+ */
+QString SurveyExporter::getLastError() const
+{
+    return lastError;
+}
+
+/*!
+ * \brief Writes all rows of the query as CSV.
+ * \param stmt = The prepared export query
+ * \return A boolean value that states whether all rows were written.
+ */
+bool SurveyExporter::writeCsv(sqlite3_stmt *stmt)
+{
+    static const char header[] = "survey_date,emp_id,name,answers,temperature\n";
+    append(header, sizeof(header) - 1);
+
+    int rc;
+
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const unsigned char *name(sqlite3_column_text(stmt, ExportName));
+        int nameLength(sqlite3_column_bytes(stmt, ExportName));
+
+        // Every quote of the name can be doubled, plus the enclosing quotes.
+        if (!reserve(MaxRowSize + 2 * static_cast<size_t>(nameLength) + 2))
+            return false;
+
+        appendDate(sqlite3_column_int64(stmt, ExportDate));
+        append(",", 1);
+        appendInt(sqlite3_column_int64(stmt, ExportEmpId));
+        append(",", 1);
+        appendCsvText(name, nameLength);
+        append(",", 1);
+        appendInt(sqlite3_column_int64(stmt, ExportAnswers));
+        append(",", 1);
+
+        // A missing temperature is an empty field.
+        if (sqlite3_column_type(stmt, ExportTemperature) != SQLITE_NULL)
+            appendTemperature(sqlite3_column_double(stmt, ExportTemperature));
+
+        append("\n", 1);
+
+        ++rowsExported;
+    }
+
+    return rc == SQLITE_DONE;
+}
+
+/*!
+ * \brief Writes all rows of the query as JSON lines.
+ * \param stmt = The prepared export query
+ * \return A boolean value that states whether all rows were written.
+ */
+bool SurveyExporter::writeJsonLines(sqlite3_stmt *stmt)
+{
+    static const char dateKey[] = "{\"survey_date\":\"";
+    static const char idKey[] = "\",\"emp_id\":";
+    static const char nameKey[] = ",\"name\":\"";
+    static const char answersKey[] = "\",\"answers\":";
+    static const char tempKey[] = ",\"temperature\":";
+
+    int rc;
+
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const unsigned char *name(sqlite3_column_text(stmt, ExportName));
+        int nameLength(sqlite3_column_bytes(stmt, ExportName));
+
+        // A control character is escaped as \u00XX, the longest escape.
+        if (!reserve(MaxRowSize + 6 * static_cast<size_t>(nameLength)))
+            return false;
+
+        append(dateKey, sizeof(dateKey) - 1);
+        appendDate(sqlite3_column_int64(stmt, ExportDate));
+        append(idKey, sizeof(idKey) - 1);
+        appendInt(sqlite3_column_int64(stmt, ExportEmpId));
+        append(nameKey, sizeof(nameKey) - 1);
+        appendJsonText(name, nameLength);
+        append(answersKey, sizeof(answersKey) - 1);
+        appendInt(sqlite3_column_int64(stmt, ExportAnswers));
+        append(tempKey, sizeof(tempKey) - 1);
+
+        if (sqlite3_column_type(stmt, ExportTemperature) == SQLITE_NULL)
+            append("null", 4);
+        else
+            appendTemperature(sqlite3_column_double(stmt, ExportTemperature));
+
+        append("}\n", 2);
+
+        ++rowsExported;
+    }
+
+    return rc == SQLITE_DONE;
+}
+
+/*!
+ * \brief Writes all rows of the query in the columnar binary format.
+ * \param stmt = The prepared export query
+ * \return A boolean value that states whether all rows were written.
+ * \note Only one row group is held in memory at a time.
+ */
+bool SurveyExporter::writeColumnar(sqlite3_stmt *stmt)
+{
+    std::vector<qint32> dates(RowGroupSize);
+    std::vector<qint32> empIds(RowGroupSize);
+    std::vector<quint32> answers(RowGroupSize);
+    std::vector<float> temperatures(RowGroupSize);
+
+    append("CCQC", 4);
+    quint16 version(qToLittleEndian<quint16>(2));
+    quint16 columns(qToLittleEndian<quint16>(4));
+    append(reinterpret_cast<const char *>(&version), sizeof(version));
+    append(reinterpret_cast<const char *>(&columns), sizeof(columns));
+
+    // Writes the given column values in little-endian byte order.
+    auto writeColumn = [this](const auto &column, const quint32 &rows) -> bool {
+        using Value = typename std::decay_t<decltype(column)>::value_type;
+
+        for (quint32 row = 0; row < rows; ++row) {
+            if (!reserve(sizeof(Value)))
+                return false;
+
+            Value value(qToLittleEndian(column[row]));
+            append(reinterpret_cast<const char *>(&value), sizeof(Value));
+        }
+
+        return true;
+    };
+
+    auto writeRowGroup = [&](const quint32 &rows) -> bool {
+        if (!reserve(sizeof(quint32)))
+            return false;
+
+        quint32 rowCount(qToLittleEndian(rows));
+        append(reinterpret_cast<const char *>(&rowCount), sizeof(rowCount));
+
+        return writeColumn(dates, rows) && writeColumn(empIds, rows) &&
+                writeColumn(answers, rows) && writeColumn(temperatures, rows);
+    };
+
+    quint32 rows(0);
+    int rc;
+
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        dates[rows] = static_cast<qint32>(sqlite3_column_int64(stmt, ExportDate));
+        empIds[rows] = sqlite3_column_int(stmt, ExportEmpId);
+        answers[rows] = static_cast<quint32>(sqlite3_column_int64(stmt, ExportAnswers));
+        temperatures[rows] = (sqlite3_column_type(stmt, ExportTemperature) == SQLITE_NULL) ?
+                    std::numeric_limits<float>::quiet_NaN() :
+                    static_cast<float>(sqlite3_column_double(stmt, ExportTemperature));
+
+        ++rowsExported;
+
+        if (++rows == RowGroupSize) {
+            if (!writeRowGroup(rows))
+                return false;
+
+            rows = 0;
+        }
+    }
+
+    if (rc != SQLITE_DONE)
+        return false;
+
+    if (rows > 0 && !writeRowGroup(rows))
+        return false;
+
+    // The empty row group marks the end of the file.
+    return writeRowGroup(0);
+}
+
+/*!
+ * \brief Makes sure the write buffer has room for the given amount of bytes, flushing it if needed.
+ * \param bytes = The amount of bytes about to be appended
+ * \return A boolean value that states whether the buffer could be flushed.
+ * \note The buffer grows if a single row does not fit in it, which only happens with unusually long names.
+ */
+bool SurveyExporter::reserve(const size_t &bytes)
+{
+    if (bufferUsed + bytes <= buffer.size())
+        return true;
+
+    if (!flush())
+        return false;
+
+    if (bytes > buffer.size())
+        buffer.resize(bytes);
+
+    return true;
+}
+
+/*!
+ * \brief Writes the contents of the write buffer to the output file.
+ * \return A boolean value that states whether the write was successful or not.
+ */
+bool SurveyExporter::flush()
+{
+    if (bufferUsed == 0)
+        return true;
+
+    qint64 written(outFile.write(buffer.data(), static_cast<qint64>(bufferUsed)));
+
+    if (written != static_cast<qint64>(bufferUsed)) {
+        lastError = outFile.errorString();
+        return false;
+    }
+
+    bufferUsed = 0;
+    return true;
+}
+
+/*!
+ * \brief Appends raw bytes to the write buffer.
+ * \param data = The bytes to append
+ * \param length = The amount of bytes to append
+ * \note The caller must have reserved enough space beforehand.
+ */
+void SurveyExporter::append(const char *data, const size_t &length)
+{
+    std::memcpy(buffer.data() + bufferUsed, data, length);
+    bufferUsed += length;
+}
+
+/*!
+ * \brief Appends the decimal text of an integer to the write buffer.
+ * \param value = The integer to append
+ */
+void SurveyExporter::appendInt(qint64 value)
+{
+    char digits[20];
+    int count(0);
+    bool negative(value < 0);
+    quint64 magnitude(negative ? 0 - static_cast<quint64>(value) : static_cast<quint64>(value));
+
+    do {
+        digits[count++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    if (negative)
+        buffer[bufferUsed++] = '-';
+
+    while (count > 0)
+        buffer[bufferUsed++] = digits[--count];
+}
+
+/*!
+ * \brief Appends a temperature to the write buffer with a precision of 1.
+ * \param value = The temperature in degrees Celsius
+ */
+void SurveyExporter::appendTemperature(const double &value)
+{
+    qint64 tenths(std::llround(value * 10));
+
+    if (tenths < 0) {
+        buffer[bufferUsed++] = '-';
+        tenths = -tenths;
+    }
+
+    appendInt(tenths / 10);
+    buffer[bufferUsed++] = '.';
+    buffer[bufferUsed++] = static_cast<char>('0' + tenths % 10);
+}
+
+/*!
+ * \brief Appends a survey date to the write buffer in the form yyyy-MM-dd.
+ * \param unixTime = The survey date as stored in the database
+ * \note Surveys are exported in date order, so the date is only converted when it changes.
+ */
+void SurveyExporter::appendDate(const qint64 &unixTime)
+{
+    if (unixTime != cachedDateUnix) {
+        QDate date(QDateTime::fromSecsSinceEpoch(unixTime).date());
+        int year(date.year());
+        int month(date.month());
+        int day(date.day());
+
+        cachedDate[0] = static_cast<char>('0' + year / 1000 % 10);
+        cachedDate[1] = static_cast<char>('0' + year / 100 % 10);
+        cachedDate[2] = static_cast<char>('0' + year / 10 % 10);
+        cachedDate[3] = static_cast<char>('0' + year % 10);
+        cachedDate[4] = '-';
+        cachedDate[5] = static_cast<char>('0' + month / 10);
+        cachedDate[6] = static_cast<char>('0' + month % 10);
+        cachedDate[7] = '-';
+        cachedDate[8] = static_cast<char>('0' + day / 10);
+        cachedDate[9] = static_cast<char>('0' + day % 10);
+
+        cachedDateUnix = unixTime;
+    }
+
+    append(cachedDate, sizeof(cachedDate));
+}
+
+/*!
+ * \brief Appends a text value as a CSV field, quoting it only when needed.
+ * \param text = The UTF-8 text to append
+ * \param length = The length of the text in bytes
+ * \note The caller must have reserved twice the length plus two bytes, in case every character is a quote.
+ */
+void SurveyExporter::appendCsvText(const unsigned char *text, const int &length)
+{
+    bool needsQuotes(false);
+
+    for (int i = 0; i < length && !needsQuotes; ++i)
+        needsQuotes = (text[i] == ',' || text[i] == '"' || text[i] == '\n' || text[i] == '\r');
+
+    if (!needsQuotes) {
+        append(reinterpret_cast<const char *>(text), static_cast<size_t>(length));
+        return;
+    }
+
+    buffer[bufferUsed++] = '"';
+
+    for (int i = 0; i < length; ++i) {
+        if (text[i] == '"')
+            buffer[bufferUsed++] = '"';
+
+        buffer[bufferUsed++] = static_cast<char>(text[i]);
+    }
+
+    buffer[bufferUsed++] = '"';
+}
+
+/*!
+ * \brief Appends a text value as the contents of a JSON string.
+ * \param text = The UTF-8 text to append
+ * \param length = The length of the text in bytes
+ * \note The caller must have reserved six times the length, in case every character is a control character.
+ */
+void SurveyExporter::appendJsonText(const unsigned char *text, const int &length)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    for (int i = 0; i < length; ++i) {
+        unsigned char c(text[i]);
+
+        if (c == '"' || c == '\\') {
+            buffer[bufferUsed++] = '\\';
+            buffer[bufferUsed++] = static_cast<char>(c);
+        } else if (c < 0x20) {
+            append("\\u00", 4);
+            buffer[bufferUsed++] = hex[c >> 4];
+            buffer[bufferUsed++] = hex[c & 0xF];
+        } else
+            buffer[bufferUsed++] = static_cast<char>(c);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef SURVEYEXPORTER_H
+#define SURVEYEXPORTER_H
+
+#include <QString>
+#include <QFile>
+
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+/*!
+ * \brief Enum for the file formats surveys can be exported to.
+ */
+enum class ExportFormat {
+    Csv,        ///< Comma separated values with a header row.
+    JsonLines,  ///< One JSON object per line.
+    Columnar    ///< The compact binary column layout described in SurveyExporter.
+};
+
+/*!
+ * \brief Streams all surveys in a database file straight to disk.
+ *
+ * Rows are read with the SQLite C API on a separate read-only connection and formatted into a single reusable write buffer.
+ * The connection is opened through the QSQLITE driver, so Qt must be built with -system-sqlite (see getSqliteHandle()).
+ * No QVariant or QString is created per row, so memory use stays flat no matter how many surveys are exported.
+ *
+ * The columnar format is a sequence of row groups of at most RowGroupSize rows, all values little-endian:
+ * - File header: the magic "CCQC", a quint16 version (2) and a quint16 column count (4).
+ * - Row group: a quint32 row count followed by every column in turn:
+ *   survey_date (qint32 unix time), emp_id (qint32), answers (quint32 bitmask, see QuestionSet), temperature (float).
+ * - The file ends with a row group of 0 rows.
+ *
+ * In the CSV and JSON lines formats the answers are written as the same bitmask.
+ * A missing temperature is written as an empty CSV field, a JSON null, or a NaN in the columnar format, never as 0.
+ */
+class SurveyExporter
+{
+public:
+    static const int RowGroupSize = 65536;  ///< The maximum amount of rows in a columnar row group.
+
+    explicit SurveyExporter(const QString &databaseLocation);
+
+    bool exportSurveys(const QString &fileName, const ExportFormat &format);
+
+    qint64 getRowsExported() const;
+    QString getLastError() const;
+
+private:
+    QString dbLocation;             ///< The full path to the database file that is exported.
+    QFile outFile;                  ///< The file the surveys are written to.
+    std::vector<char> buffer;       ///< The reusable write buffer.
+    size_t bufferUsed;              ///< The amount of bytes currently in the write buffer.
+    qint64 rowsExported;            ///< The amount of surveys written by the last export.
+    QString lastError;              ///< A description of the last error that occurred.
+    qint64 cachedDateUnix;          ///< The last survey date that was converted to text.
+    char cachedDate[10];            ///< The text (yyyy-MM-dd) of cachedDateUnix.
+
+    bool exportRows(sqlite3 *db, const QString &fileName, const ExportFormat &format);
+    bool writeCsv(sqlite3_stmt *stmt);
+    bool writeJsonLines(sqlite3_stmt *stmt);
+    bool writeColumnar(sqlite3_stmt *stmt);
+
+    bool reserve(const size_t &bytes);
+    bool flush();
+    void append(const char *data, const size_t &length);
+    void appendInt(qint64 value);
+    void appendTemperature(const double &value);
+    void appendDate(const qint64 &unixTime);
+    void appendCsvText(const unsigned char *text, const int &length);
+    void appendJsonText(const unsigned char *text, const int &length);
+};
+
+#endif // SURVEYEXPORTER_H
@@ -0,0 +1,576 @@
+#include "surveyimporter.h"
+#include "surveydatabase.h"
+
+#include <QThread>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtNumeric>
+#include <QtDebug>
+
+namespace {
+const size_t ChunkSize(1024);       ///< The amount of surveys a parser pushes into its queue at once.
+const size_t QueueChunks(64);       ///< The amount of chunks a queue holds before its parser has to wait.
+const int WriteBatchSize(2000);     ///< The amount of surveys the writer adds in a single transaction, small enough to hold the write lock only briefly.
+const unsigned long PollWait(200);  ///< The time (in microseconds) a thread sleeps while its queue is full or empty.
+const int ProgressInterval(250);    ///< The interval (in milliseconds) at which the progress is reported.
+
+const QByteArray CsvHeader("survey_date,emp_id,name,answers,temperature");
+
+/*!
+ * \brief Splits a CSV line into its fields.
+ * \param line = The line, without the line break
+ * \param fields = Receives the fields, with the quotes of quoted fields removed
+ */
+void splitCsvLine(const QByteArray &line, QList<QByteArray> &fields)
+{
+    fields.clear();
+
+    QByteArray field;
+    bool quoted(false);
+
+    for (int i = 0; i < line.size(); ++i) {
+        char c(line.at(i));
+
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line.at(i + 1) == '"') {
+                field.append('"');
+                ++i;
+            } else if (c == '"')
+                quoted = false;
+            else
+                field.append(c);
+        } else if (c == '"')
+            quoted = true;
+        else if (c == ',') {
+            fields.append(field);
+            field.clear();
+        } else
+            field.append(c);
+    }
+
+    fields.append(field);
+}
+}
+
+/*!
+ * \brief The constructor for the SurveyImporter.
+ * \param parent = The QObject to which this object is bound to
+ */
+SurveyImporter::SurveyImporter(QObject *parent) :
+    QObject(parent),
+    files(),
+    dbLocation(),
+    dbProfile(),
+    queues(),
+    parsers(),
+    writer(nullptr),
+    progressTimer(this),
+    elapsedTimer(),
+    errorMutex(),
+    errors(),
+    filesTotal(0),
+    bytesTotal(0),
+    nextFile(0),
+    filesDone(0),
+    parsersDone(0),
+    cancelled(false),
+    bytesParsed(0),
+    recordsParsed(0),
+    recordsRejected(0),
+    recordsWritten(0),
+    recordsSkipped(0),
+    parseNs(0),
+    parseWaitNs(0),
+    writeNs(0),
+    writeIdleNs(0)
+{
+    progressTimer.setInterval(ProgressInterval);
+
+    connect(&progressTimer, &QTimer::timeout, this, &SurveyImporter::reportProgress);
+}
+
+/*!
+ * \brief The destructor for the SurveyImporter.
+ * \note A running import is cancelled and the threads are waited for.
+ */
+SurveyImporter::~SurveyImporter()
+{
+    cancel();
+
+    for (QThread *parser : parsers) {
+        parser->wait();
+        delete parser;
+    }
+
+    if (writer != nullptr) {
+        writer->wait();
+        delete writer;
+    }
+}
+
+/*!
+ * \brief Starts importing survey files in the background.
+ * \param fileNames = The full paths of the files to import
+ * \param databaseLocation = The full path to the database file the surveys are added to
+ * \param profile = The durability profile the writer opens the database with
+ * \param threads = The amount of parser threads, or 0 to use one less than the amount of cores
+ * \return A boolean value that is false if an import is already running or there are no files.
+ * \note Every transaction of the writer is committed on its own, so a cancelled import keeps the surveys written so far.
+ */
+bool SurveyImporter::start(const QStringList &fileNames, const QString &databaseLocation,
+                           const DurabilityProfile &profile, const int &threads)
+{
+    if (isRunning() || fileNames.isEmpty())
+        return false;
+
+    // Clean up the threads of the previous import.
+    for (QThread *parser : parsers)
+        delete parser;
+
+    delete writer;
+
+    files = fileNames;
+    dbLocation = databaseLocation;
+    dbProfile = profile;
+    filesTotal = static_cast<int>(files.size());
+    bytesTotal = 0;
+    errors.clear();
+
+    for (const QString &fileName : files)
+        bytesTotal += QFileInfo(fileName).size();
+
+    nextFile = 0;
+    filesDone = 0;
+    parsersDone = 0;
+    cancelled = false;
+    bytesParsed = 0;
+    recordsParsed = 0;
+    recordsRejected = 0;
+    recordsWritten = 0;
+    recordsSkipped = 0;
+    parseNs = 0;
+    parseWaitNs = 0;
+    writeNs = 0;
+    writeIdleNs = 0;
+
+    // The writer gets a core of its own, there is no use in more parsers than files.
+    int parserCount(threads > 0 ? threads : qMax(1, QThread::idealThreadCount() - 1));
+    parserCount = qMin(parserCount, filesTotal);
+
+    queues.clear();
+    parsers.clear();
+
+    for (int i = 0; i < parserCount; ++i)
+        queues.push_back(std::make_unique<SpscQueue<ImportChunk>>(QueueChunks));
+
+    for (int i = 0; i < parserCount; ++i)
+        parsers.push_back(QThread::create([this, i]() { parseFiles(i); }));
+
+    writer = QThread::create([this]() { writeRecords(); });
+    connect(writer, &QThread::finished, this, &SurveyImporter::writerFinished);
+
+    elapsedTimer.start();
+
+    writer->start();
+
+    for (QThread *parser : parsers)
+        parser->start();
+
+    progressTimer.start();
+    return true;
+}
+
+/*!
+ * \brief Stops the import as soon as possible. The finished() signal is still emitted.
+ */
+void SurveyImporter::cancel()
+{
+    cancelled = true;
+}
+
+/*!
+ * \brief Determines if an import is running.
+ * \return A boolean value that states whether an import is running.
+ */
+bool SurveyImporter::isRunning() const
+{
+    // The timer runs until the parsers are waited for as well.
+    return progressTimer.isActive();
+}
+
+/*!
+ * \brief Retrieves the progress of the current (or last) import.
+ * \return The ImportProgress.
+ */
+ImportProgress SurveyImporter::getProgress() const
+{
+    ImportProgress current;
+
+    current.filesTotal = filesTotal;
+    current.filesDone = filesDone;
+    current.bytesTotal = bytesTotal;
+    current.bytesParsed = bytesParsed;
+    current.recordsParsed = recordsParsed;
+    current.recordsRejected = recordsRejected;
+    current.recordsWritten = recordsWritten;
+    current.recordsSkipped = recordsSkipped;
+    current.parserThreads = static_cast<int>(parsers.size());
+    current.elapsedSec = elapsedTimer.isValid() ? elapsedTimer.nsecsElapsed() / 1e9 : 0;
+    current.parseSec = parseNs / 1e9;
+    current.parseWaitSec = parseWaitNs / 1e9;
+    current.writeSec = writeNs / 1e9;
+    current.writeIdleSec = writeIdleNs / 1e9;
+    current.cancelled = cancelled;
+
+    for (const auto &queue : queues)
+        current.recordsQueued += static_cast<qint64>(queue->size() * ChunkSize);
+
+    QMutexLocker locker(&errorMutex);
+    current.errors = errors;
+
+    return current;
+}
+
+/*!
+ * \brief Formats the progress of an import as a readable text report.
+ * \param progress = The progress to report
+ * \return A QString with the totals and the throughput of every stage.
+ */
+QString SurveyImporter::formatReport(const ImportProgress &progress)
+{
+    auto rate = [](const qint64 &records, const double &seconds) -> QString {
+        return QString::number(seconds > 0 ? records / seconds : 0, 'f', 0);
+    };
+
+    QString report(QString("Files: %1 of %2 (%3 MB of %4 MB)\n")
+                   .arg(progress.filesDone).arg(progress.filesTotal)
+                   .arg(progress.bytesParsed / 1e6, 0, 'f', 1).arg(progress.bytesTotal / 1e6, 0, 'f', 1));
+
+    report += QString("Surveys: %1 written, %2 already existed, %3 rejected\n")
+            .arg(progress.recordsWritten).arg(progress.recordsSkipped).arg(progress.recordsRejected);
+    report += QString("Parse: %1 threads, %2 surveys/s per thread, %3 s waiting for the writer\n")
+            .arg(progress.parserThreads).arg(rate(progress.recordsParsed, progress.parseSec))
+            .arg(progress.parseWaitSec, 0, 'f', 1);
+    report += QString("Write: %1 surveys/s, %2 s waiting for the parsers\n")
+            .arg(rate(progress.recordsWritten + progress.recordsSkipped, progress.writeSec))
+            .arg(progress.writeIdleSec, 0, 'f', 1);
+    report += QString("Total: %1 surveys/s in %2 s\n")
+            .arg(rate(progress.recordsWritten + progress.recordsSkipped, progress.elapsedSec))
+            .arg(progress.elapsedSec, 0, 'f', 1);
+
+    if (progress.cancelled)
+        report += "The import was stopped before all files were imported.\n";
+
+    for (const QString &error : progress.errors)
+        report += error + "\n";
+
+    return report;
+}
+
+/*!
+ * \brief Emits the current progress.
+ */
+void SurveyImporter::reportProgress()
+{
+    emit progress(getProgress());
+}
+
+/*!
+ * \brief Waits for the parser threads once the writer stopped and emits the final progress.
+ */
+void SurveyImporter::writerFinished()
+{
+    // The writer only stops early on an error, in which case the parsers must stop as well.
+    cancelled = cancelled || nextFile < filesTotal;
+
+    for (QThread *parser : parsers)
+        parser->wait();
+
+    progressTimer.stop();
+
+    ImportProgress result(getProgress());
+    result.cancelled = cancelled || result.filesDone < result.filesTotal;
+
+    emit finished(result);
+}
+
+/*!
+ * \brief Parses files until all files are taken. Runs on a parser thread.
+ * \param parser = The index of the parser, and of its queue
+ */
+void SurveyImporter::parseFiles(const int &parser)
+{
+    SpscQueue<ImportChunk> &queue(*queues[static_cast<size_t>(parser)]);
+    ImportChunk chunk;
+
+    chunk.reserve(ChunkSize);
+
+    while (!cancelled) {
+        int index(nextFile.fetch_add(1));
+
+        if (index >= filesTotal)
+            break;
+
+        QElapsedTimer fileTimer;
+        qint64 waitedBefore(parseWaitNs);
+
+        fileTimer.start();
+
+        if (parseFile(files[index], queue, chunk))
+            ++filesDone;
+
+        // The time spent waiting for the writer is not parse time. The wait counter is shared, so this is an estimate.
+        parseNs += qMax<qint64>(0, fileTimer.nsecsElapsed() - (parseWaitNs - waitedBefore));
+    }
+
+    if (!chunk.empty())
+        pushChunk(queue, chunk);
+
+    ++parsersDone;
+}
+
+/*!
+ * \brief Decodes and validates the surveys in a single file and pushes them into the parser's queue.
+ * \param fileName = The full path of the file
+ * \param queue = The queue of the parser
+ * \param chunk = The chunk the surveys are collected in, pushed whenever it is full
+ * \return A boolean value that states whether the whole file was parsed.
+ */
+bool SurveyImporter::parseFile(const QString &fileName, SpscQueue<ImportChunk> &queue, ImportChunk &chunk)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        addError(fileName, file.errorString());
+        return false;
+    }
+
+    QByteArray first(file.peek(4));
+
+    if (first == "CCQC") {
+        addError(fileName, "Columnar exports do not contain employee names and cannot be imported.");
+        return false;
+    }
+
+    bool json(first.startsWith('{'));
+
+    if (!json) {
+        QByteArray header(file.readLine());
+        bytesParsed += header.size();
+
+        if (header.trimmed() != CsvHeader) {
+            addError(fileName, "Unknown file format.");
+            return false;
+        }
+    }
+
+    QList<QByteArray> fields;
+    QByteArray lastDateText;
+    QDate lastDate;
+
+    // Exports are in date order, so the date is only parsed when it changes.
+    auto parseDate = [&](const QByteArray &text) -> QDate {
+        if (text != lastDateText) {
+            lastDateText = text;
+            lastDate = QDate::fromString(QString::fromLatin1(text), Qt::ISODate);
+        }
+
+        return lastDate;
+    };
+
+    while (!file.atEnd()) {
+        if (cancelled)
+            return false;
+
+        QByteArray line(file.readLine());
+        bytesParsed += line.size();
+
+        ImportRecord record;
+        bool ok(false);
+
+        if (json) {
+            QJsonObject obj(QJsonDocument::fromJson(line).object());
+            qint64 answers(obj.value("answers").toInteger(-1));
+
+            record.name = obj.value("name").toString().trimmed();
+            record.survey = Survey(parseDate(obj.value("survey_date").toString().toLatin1()), -1,
+                                   static_cast<quint32>(answers), obj.value("temperature").toDouble());
+            // A null or missing temperature is rejected, a survey always has a temperature.
+            ok = answers >= 0 && answers <= 0xFFFFFFFFLL && obj.value("temperature").isDouble() &&
+                    qIsFinite(obj.value("temperature").toDouble());
+        } else {
+            // A quoted name can contain a line break.
+            while (line.count('"') % 2 != 0 && !file.atEnd()) {
+                QByteArray next(file.readLine());
+                bytesParsed += next.size();
+                line += next;
+            }
+
+            if (line.trimmed().isEmpty())
+                continue;
+
+            splitCsvLine(line.endsWith('\n') ? line.chopped(line.endsWith("\r\n") ? 2 : 1) : line, fields);
+
+            if (fields.size() == 5) {
+                bool answersOk;
+                bool temperatureOk;
+                quint32 answers(fields[3].toUInt(&answersOk));
+                double temperature(fields[4].toDouble(&temperatureOk));
+
+                record.name = QString::fromUtf8(fields[2]).trimmed();
+                record.survey = Survey(parseDate(fields[0]), -1, answers, temperature);
+
+                // An empty temperature field (a missing temperature) does not convert and is rejected.
+                ok = answersOk && temperatureOk && qIsFinite(temperature);
+            }
+        }
+
+        if (!ok || record.name.isEmpty() || !record.survey.getSurveyDate().isValid()) {
+            ++recordsRejected;
+            continue;
+        }
+
+        chunk.push_back(std::move(record));
+        ++recordsParsed;
+
+        if (chunk.size() >= ChunkSize && !pushChunk(queue, chunk))
+            return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Pushes a chunk into a queue, waiting while the queue is full.
+ * \param queue = The queue of the parser
+ * \param chunk = The chunk, which is replaced by an empty one
+ * \return A boolean value that is false if the import was cancelled while waiting.
+ */
+bool SurveyImporter::pushChunk(SpscQueue<ImportChunk> &queue, ImportChunk &chunk)
+{
+    QElapsedTimer waitTimer;
+
+    while (!queue.tryPush(chunk)) {
+        if (cancelled)
+            return false;
+
+        if (!waitTimer.isValid())
+            waitTimer.start();
+
+        QThread::usleep(PollWait);
+    }
+
+    if (waitTimer.isValid())
+        parseWaitNs += waitTimer.nsecsElapsed();
+
+    chunk = ImportChunk();
+    chunk.reserve(ChunkSize);
+    return true;
+}
+
+/*!
+ * \brief Drains the queues of all parsers and writes the surveys in large transactions. Runs on the writer thread.
+ * \note The writer has its own connection, so the main window can keep reading while it writes.
+ */
+void SurveyImporter::writeRecords()
+{
+    SurveyDatabase surveyDb(nullptr, "SurveyImport");
+    surveyDb.setDurabilityProfile(dbProfile);
+
+    if (!surveyDb.createDatabase(dbLocation)) {
+        addError(dbLocation, "Could not open the database.");
+        cancelled = true;
+        return;
+    }
+
+    QList<Survey> batch;
+    batch.reserve(WriteBatchSize);
+
+    auto writeBatch = [&]() -> bool {
+        if (batch.isEmpty())
+            return true;
+
+        QElapsedTimer writeTimer;
+        writeTimer.start();
+
+        int added(surveyDb.addSurveys(batch));
+
+        writeNs += writeTimer.nsecsElapsed();
+
+        if (added < 0) {
+            addError(dbLocation, "Could not write the surveys. " + surveyDb.getLastError());
+            return false;
+        }
+
+        recordsWritten += added;
+        recordsSkipped += batch.size() - added;
+        batch.clear();
+        return true;
+    };
+
+    ImportChunk chunk;
+
+    while (!cancelled) {
+        // Read this before draining, so no chunk pushed by a parser that just stopped is missed.
+        bool parsersStopped(parsersDone == static_cast<int>(queues.size()));
+        bool received(false);
+
+        for (const auto &queue : queues) {
+            while (queue->tryPop(chunk)) {
+                received = true;
+
+                for (ImportRecord &record : chunk) {
+                    // Names are matched by their normalized key, so a name that only differs in case,
+                    // spacing or Unicode normalization from an existing employee is not added again.
+                    int empId(surveyDb.getEmployeeId(record.name));
+
+                    if (empId < 0) {
+                        surveyDb.addEmployee(record.name);
+                        empId = surveyDb.getEmployeeId(record.name);
+                    }
+
+                    if (empId < 0) {
+                        ++recordsRejected;
+                        continue;
+                    }
+
+                    record.survey.setEmployeeId(empId);
+                    batch.append(record.survey);
+
+                    if (batch.size() >= WriteBatchSize && !writeBatch()) {
+                        cancelled = true;
+                        return;
+                    }
+                }
+            }
+        }
+
+        if (!received) {
+            if (parsersStopped)
+                break;
+
+            QElapsedTimer idleTimer;
+            idleTimer.start();
+            QThread::usleep(PollWait);
+            writeIdleNs += idleTimer.nsecsElapsed();
+        }
+    }
+
+    if (!writeBatch())
+        cancelled = true;
+}
+
+/*!
+ * \brief Records why a file could not be imported.
+ * \param fileName = The full path of the file
+ * \param error = The reason
+ */
+void SurveyImporter::addError(const QString &fileName, const QString &error)
+{
+    qDebug() << "(Import) Error importing" << fileName << ":" << error << Qt::endl;
+
+    QMutexLocker locker(&errorMutex);
+    errors.append(QFileInfo(fileName).fileName() + ": " + error);
+}
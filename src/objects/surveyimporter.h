@@ -0,0 +1,127 @@
+#ifndef SURVEYIMPORTER_H
+#define SURVEYIMPORTER_H
+
+#include "survey.h"
+#include "durabilityprofile.h"
+#include "spscqueue.h"
+
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QMutex>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class QThread;
+
+/*!
+ * \brief A survey read from an import file, with the name of the employee it still has to be matched to.
+ */
+struct ImportRecord
+{
+    QString name;   ///< The name of the employee, as written in the file.
+    Survey survey;  ///< The survey, without an employee ID.
+};
+
+/*!
+ * \brief The progress of an import, with the throughput of every stage.
+ *
+ * A parse wait time that is high compared to the parse time means the writer is the bottleneck,
+ * a writer idle time that is high compared to the write time means the parsers are.
+ */
+struct ImportProgress
+{
+    int filesTotal = 0;         ///< The amount of files to import.
+    int filesDone = 0;          ///< The amount of files that were parsed completely.
+    qint64 bytesTotal = 0;      ///< The size of all files together.
+    qint64 bytesParsed = 0;     ///< The amount of bytes parsed so far.
+    qint64 recordsParsed = 0;   ///< The amount of valid surveys parsed.
+    qint64 recordsRejected = 0; ///< The amount of lines or surveys that were invalid.
+    qint64 recordsWritten = 0;  ///< The amount of surveys added to the database.
+    qint64 recordsSkipped = 0;  ///< The amount of surveys that already existed in the database.
+    qint64 recordsQueued = 0;   ///< The amount of parsed surveys waiting for the writer (in whole chunks).
+    int parserThreads = 0;      ///< The amount of parser threads.
+    double elapsedSec = 0;      ///< The time since the import started.
+    double parseSec = 0;        ///< The time the parsers spent parsing, summed over all parser threads.
+    double parseWaitSec = 0;    ///< The time the parsers spent waiting for room in a full queue.
+    double writeSec = 0;        ///< The time the writer spent writing transactions.
+    double writeIdleSec = 0;    ///< The time the writer spent waiting for parsed surveys.
+    bool cancelled = false;     ///< Was the import cancelled or stopped by an error?
+    QStringList errors;         ///< The files that could not be imported and why.
+};
+
+/*!
+ * \brief Imports survey files exported by other sites, parsing several files in parallel.
+ *
+ * Every parser thread takes the next file, decodes and validates its surveys and pushes them in chunks into its
+ * own bounded lock-free queue. A single writer thread drains all queues, matches the employees by name (adding
+ * new ones) and writes the surveys in large transactions on its own connection. A full queue holds its parser back,
+ * so memory use stays bounded however fast the files are parsed.
+ *
+ * The CSV and JSON lines formats of SurveyExporter are supported. Columnar files are rejected, because they only
+ * contain the employee IDs of the site that exported them.
+ */
+class SurveyImporter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SurveyImporter(QObject *parent = nullptr);
+    ~SurveyImporter();
+
+    bool start(const QStringList &fileNames, const QString &databaseLocation,
+               const DurabilityProfile &profile = DurabilityProfile::balanced(), const int &threads = 0);
+    void cancel();
+    bool isRunning() const;
+
+    ImportProgress getProgress() const;
+    static QString formatReport(const ImportProgress &progress);
+
+signals:
+    void progress(const ImportProgress &progress);
+    void finished(const ImportProgress &progress);
+
+private slots:
+    void reportProgress();
+    void writerFinished();
+
+private:
+    typedef std::vector<ImportRecord> ImportChunk;
+
+    QStringList files;          ///< The files being imported.
+    QString dbLocation;         ///< The full path to the database file the surveys are added to.
+    DurabilityProfile dbProfile;///< The profile the writer opens the database with.
+    std::vector<std::unique_ptr<SpscQueue<ImportChunk>>> queues; ///< One queue per parser thread, all drained by the writer.
+    std::vector<QThread *> parsers; ///< The parser threads.
+    QThread *writer;            ///< The writer thread.
+    QTimer progressTimer;       ///< Reports the progress at a regular interval.
+    QElapsedTimer elapsedTimer; ///< Measures the time since the import started.
+    mutable QMutex errorMutex;  ///< Guards errors.
+    QStringList errors;         ///< The files that could not be imported and why.
+    int filesTotal;             ///< The amount of files to import.
+    qint64 bytesTotal;          ///< The size of all files together.
+
+    std::atomic<int> nextFile;          ///< The index of the next file a parser takes.
+    std::atomic<int> filesDone;         ///< The amount of files parsed completely.
+    std::atomic<int> parsersDone;       ///< The amount of parser threads that stopped.
+    std::atomic<bool> cancelled;        ///< Should all threads stop as soon as possible?
+    std::atomic<qint64> bytesParsed;    ///< The amount of bytes parsed so far.
+    std::atomic<qint64> recordsParsed;  ///< The amount of valid surveys parsed.
+    std::atomic<qint64> recordsRejected;///< The amount of invalid lines or surveys.
+    std::atomic<qint64> recordsWritten; ///< The amount of surveys added to the database.
+    std::atomic<qint64> recordsSkipped; ///< The amount of surveys that already existed.
+    std::atomic<qint64> parseNs;        ///< The time spent parsing, summed over all parsers.
+    std::atomic<qint64> parseWaitNs;    ///< The time spent waiting for room in a full queue.
+    std::atomic<qint64> writeNs;        ///< The time spent writing transactions.
+    std::atomic<qint64> writeIdleNs;    ///< The time the writer spent waiting for surveys.
+
+    void parseFiles(const int &parser);
+    bool parseFile(const QString &fileName, SpscQueue<ImportChunk> &queue, ImportChunk &chunk);
+    bool pushChunk(SpscQueue<ImportChunk> &queue, ImportChunk &chunk);
+    void writeRecords();
+    void addError(const QString &fileName, const QString &error);
+};
+
+#endif // SURVEYIMPORTER_H
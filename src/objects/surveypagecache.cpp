@@ -0,0 +1,108 @@
+#include "surveypagecache.h"
+
+/*!
+ * \brief The constructor for the SurveyPageCache.
+ * \param maxBytes = The memory budget of the cache
+ */
+SurveyPageCache::SurveyPageCache(const qint64 &maxBytes) :
+    pages(maxBytes),
+    stats(),
+    epoch(0)
+{
+}
+
+/*!
+ * \brief Looks up the page of an employee and marks it as the most recently used.
+ * \param empId = The ID of the employee
+ * \return A pointer to the page, or nullptr if it is not cached.
+ * \note The pointer is only valid until the cache is changed.
+ */
+const SurveyPage *SurveyPageCache::find(const int &empId)
+{
+    const SurveyPage *page(pages.object(empId));
+
+    if (page != nullptr)
+        ++stats.hits;
+    else
+        ++stats.misses;
+
+    return page;
+}
+
+/*!
+ * \brief Determines if the page of an employee is cached, without counting it as a lookup.
+ * \param empId = The ID of the employee
+ * \return A boolean value that states whether the page is cached.
+ */
+bool SurveyPageCache::contains(const int &empId) const
+{
+    return pages.contains(empId);
+}
+
+/*!
+ * \brief Adds or replaces the page of an employee, evicting the least recently used pages if it does not fit.
+ * \param empId = The ID of the employee
+ * \param page = The decoded surveys of the employee
+ * \param prefetched = Was the page read ahead of time instead of for a lookup?
+ * \note A page larger than the whole budget is not cached.
+ */
+void SurveyPageCache::insert(const int &empId, const SurveyPage &page, const bool &prefetched)
+{
+    if (prefetched)
+        ++stats.prefetches;
+
+    pages.insert(empId, new SurveyPage(page), page.getMemoryFootprint());
+}
+
+/*!
+ * \brief Removes the page of an employee, so it is read from the database the next time.
+ * \param empId = The ID of the employee
+ */
+void SurveyPageCache::invalidate(const int &empId)
+{
+    pages.remove(empId);
+    ++epoch;
+}
+
+/*!
+ * \brief Removes all pages.
+ */
+void SurveyPageCache::clear()
+{
+    pages.clear();
+    ++epoch;
+}
+
+/*!
+ * \brief Assigns the memory budget, evicting the least recently used pages if the cache no longer fits.
+ * \param maxBytes = The memory budget in bytes
+ */
+void SurveyPageCache::setMaxBytes(const qint64 &maxBytes)
+{
+    pages.setMaxCost(maxBytes);
+}
+
+/*!
+ * \brief Retrieves the hit rate and memory use of the cache.
+ * \return The PageCacheStats of the cache.
+ */
+PageCacheStats SurveyPageCache::getStats() const
+{
+    PageCacheStats current(stats);
+
+    current.pages = static_cast<int>(pages.count());
+    current.bytes = pages.totalCost();
+    current.maxBytes = pages.maxCost();
+
+    return current;
+}
+
+
+/*!
+ * \brief Retrieves the invalidation epoch of the cache.
+ * \return The epoch. A page read in the background may only be inserted if the epoch did not change since the read started.
+ */
+quint64 SurveyPageCache::getEpoch() const
+{
+    return epoch;
+}
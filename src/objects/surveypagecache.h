@@ -0,0 +1,52 @@
+#ifndef SURVEYPAGECACHE_H
+#define SURVEYPAGECACHE_H
+
+#include "surveytablemodel.h"
+
+#include <QCache>
+
+/*!
+ * \brief The hit rate and memory use of a SurveyPageCache.
+ */
+struct PageCacheStats
+{
+    qint64 hits = 0;        ///< The amount of lookups that found the employee's page.
+    qint64 misses = 0;      ///< The amount of lookups that had to read the page from the database.
+    qint64 prefetches = 0;  ///< The amount of pages read ahead of time.
+    int pages = 0;          ///< The amount of pages in the cache.
+    qint64 bytes = 0;       ///< The memory used by the pages in the cache.
+    qint64 maxBytes = 0;    ///< The memory budget of the cache.
+
+    double getHitRate() const { return hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0; }
+};
+
+/*!
+ * \brief A least recently used cache of the decoded survey pages of employees, bounded by memory.
+ *
+ * The cost of a page is its memory footprint, so the cache holds as many pages as fit in its budget and
+ * evicts the least recently viewed pages first. SurveyDatabase invalidates the page of every employee it writes to.
+ */
+class SurveyPageCache
+{
+public:
+    static const qint64 DefaultMaxBytes = 16 * 1024 * 1024; ///< The default memory budget.
+
+    explicit SurveyPageCache(const qint64 &maxBytes = DefaultMaxBytes);
+
+    const SurveyPage *find(const int &empId);
+    bool contains(const int &empId) const;
+    void insert(const int &empId, const SurveyPage &page, const bool &prefetched = false);
+    void invalidate(const int &empId);
+    void clear();
+
+    void setMaxBytes(const qint64 &maxBytes);
+    PageCacheStats getStats() const;
+    quint64 getEpoch() const;
+
+private:
+    QCache<int, SurveyPage> pages;  ///< The pages by employee ID, with their memory footprint as cost.
+    PageCacheStats stats;           ///< The lookup statistics.
+    quint64 epoch;                  ///< Increased by every invalidation, so a page read before it can be recognised as stale.
+};
+
+#endif // SURVEYPAGECACHE_H
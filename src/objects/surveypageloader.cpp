@@ -0,0 +1,235 @@
+#include "surveypageloader.h"
+#include "tracer.h"
+
+#include <QThread>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QSet>
+#include <QtDebug>
+
+namespace {
+const int BusyTimeout(5000);    ///< The time (in milliseconds) a read waits while another connection holds a lock.
+}
+
+/*!
+ * \brief The constructor for the SurveyPageLoader.
+ * \param parent = The QObject to which this object is bound to
+ */
+SurveyPageLoader::SurveyPageLoader(QObject *parent) :
+    QObject(parent),
+    dbLocation(),
+    threads(),
+    loading(false),
+    generation(0)
+{
+}
+
+/*!
+ * \brief The destructor for the SurveyPageLoader.
+ * \note Running loads are cancelled and their threads are waited for.
+ */
+SurveyPageLoader::~SurveyPageLoader()
+{
+    cancel();
+
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+}
+
+/*!
+ * \brief Assigns the database file the pages are read from.
+ * \param location = The full path to the database file
+ * \note Running loads are cancelled.
+ */
+void SurveyPageLoader::setDatabaseLocation(const QString &location)
+{
+    cancel();
+    dbLocation = location;
+}
+
+/*!
+ * \brief Starts reading the surveys of an employee in the background, cancelling the load that is running.
+ * \param empId = The ID of the employee
+ * \note chunkLoaded() is emitted for every chunk, followed by loadFinished().
+ */
+void SurveyPageLoader::load(const int &empId)
+{
+    quint64 current(++generation);
+    loading = true;
+
+    startThread([this, empId, current](QSqlDatabase &db) {
+        bool complete(readPage(db, empId, current, [this, empId, current](const SurveyPage &chunk, const int &loaded, const int &total) {
+            QMetaObject::invokeMethod(this, [this, empId, current, chunk, loaded, total]() {
+                if (current == generation)
+                    emit chunkLoaded(empId, chunk, loaded, total);
+            }, Qt::QueuedConnection);
+        }));
+
+        // A cancelled load reports nothing, the load that replaced it does.
+        QMetaObject::invokeMethod(this, [this, empId, current, complete]() {
+            if (current != generation)
+                return;
+
+            loading = false;
+            emit loadFinished(empId, complete);
+        }, Qt::QueuedConnection);
+    });
+}
+
+/*!
+ * \brief Reads the complete survey pages of employees in the background, one after the other.
+ * \param empIds = The IDs of the employees
+ * \param epoch = Passed back with every page, so the receiver can tell if the page went stale while it was read
+ * \note Prefetching stops when the next load is started or the loader is cancelled.
+ */
+void SurveyPageLoader::prefetch(const QList<int> &empIds, const quint64 &epoch)
+{
+    if (empIds.isEmpty())
+        return;
+
+    quint64 current(generation);
+
+    startThread([this, empIds, epoch, current](QSqlDatabase &db) {
+        for (const int &empId : empIds) {
+            SurveyPage page;
+
+            if (!readPage(db, empId, current, [&page](const SurveyPage &chunk, const int &, const int &) { page.append(chunk); }))
+                return;
+
+            QMetaObject::invokeMethod(this, [this, empId, page, epoch]() {
+                emit pagePrefetched(empId, page, epoch);
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
+/*!
+ * \brief Cancels the running load and prefetches.
+ */
+void SurveyPageLoader::cancel()
+{
+    ++generation;
+    loading = false;
+}
+
+/*!
+ * \brief Determines if the latest load is still running.
+ * \return A boolean value that states whether a load is running.
+ */
+bool SurveyPageLoader::isLoading() const
+{
+    return loading;
+}
+
+/*!
+ * \brief Runs work on a new thread with its own read-only connection to the database.
+ * \param work = The work, which receives the connection (which may have failed to open)
+ */
+void SurveyPageLoader::startThread(const std::function<void (QSqlDatabase &)> &work)
+{
+    QString location(dbLocation);
+
+    QThread *thread(QThread::create([location, work]() {
+        // A connection can only be used by the thread that created it.
+        QString connection("SurveyLoader" + QString::number(reinterpret_cast<quintptr>(QThread::currentThreadId())));
+
+        {
+            QSqlDatabase db(QSqlDatabase::addDatabase("QSQLITE", connection));
+            db.setDatabaseName(location);
+            db.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=" + QString::number(BusyTimeout));
+
+            if (!db.open())
+                qDebug() << "(Loader) Error opening database: " << db.lastError().text() << Qt::endl;
+
+            work(db);
+            db.close();
+        }
+
+        QSqlDatabase::removeDatabase(connection);
+    }));
+
+    threads.append(thread);
+
+    connect(thread, &QThread::finished, this, [this, thread]() {
+        threads.removeOne(thread);
+        thread->deleteLater();
+    });
+
+    thread->start();
+}
+
+/*!
+ * \brief Reads the surveys of an employee in chunks and flags their temperature anomalies.
+ * \param db = The open connection of the current thread
+ * \param empId = The ID of the employee
+ * \param current = The generation the read belongs to
+ * \param deliver = Receives every chunk with the amount of surveys read so far and the expected total
+ * \return A boolean value that is false if the read failed or went stale before it was complete.
+ * \note Runs on the loader's thread. The last chunk has less than ChunkRows surveys, and may be empty.
+ */
+bool SurveyPageLoader::readPage(QSqlDatabase &db, const int &empId, const quint64 &current,
+                                const std::function<void (const SurveyPage &, const int &, const int &)> &deliver)
+{
+    if (!db.isOpen())
+        return false;
+
+    TraceSpan span("SurveyPageLoader::readPage");
+
+    // The total is only used for the progress, so a missing summary is not an error.
+    QSqlQuery countQry(db);
+    int total(0);
+
+    countQry.prepare("SELECT survey_count FROM EmployeeSummary WHERE emp_id = :id;");
+    countQry.bindValue(":id", empId);
+
+    if (countQry.exec() && countQry.next())
+        total = countQry.value(0).toInt();
+
+    QSqlQuery alertQry(db);
+    QSet<qint64> anomalyDates;
+
+    alertQry.prepare("SELECT survey_date FROM TemperatureAlert WHERE emp_id = :id;");
+    alertQry.bindValue(":id", empId);
+
+    if (!alertQry.exec()) {
+        qDebug() << "(Loader) Error retrieving temperature alerts: " << alertQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    while (alertQry.next())
+        anomalyDates.insert(alertQry.value(0).toLongLong());
+
+    QSqlQuery surveyQry(db);
+
+    surveyQry.setForwardOnly(true);
+    surveyQry.prepare("SELECT survey_date, answers, temperature "
+                      "FROM Survey "
+                      "WHERE emp_id = :id "
+                      "ORDER BY survey_date;");
+    surveyQry.bindValue(":id", empId);
+
+    if (!surveyQry.exec()) {
+        qDebug() << "(Loader) Error retrieving surveys: " << surveyQry.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    SurveyPage chunk;
+    int loaded(0);
+    int rows(ChunkRows);
+
+    while (rows == ChunkRows) {
+        if (generation != current)
+            return false;
+
+        rows = chunk.read(surveyQry, ChunkRows);
+        chunk.setAnomalyDates(anomalyDates);
+        loaded += rows;
+
+        deliver(chunk, loaded, qMax(total, loaded));
+    }
+
+    return true;
+}
@@ -0,0 +1,54 @@
+#ifndef SURVEYPAGELOADER_H
+#define SURVEYPAGELOADER_H
+
+#include "surveytablemodel.h"
+
+#include <QObject>
+#include <QList>
+
+#include <atomic>
+#include <functional>
+
+class QThread;
+class QSqlDatabase;
+
+/*!
+ * \brief Reads the survey pages of employees on background threads, so the GUI never waits for the database.
+ *
+ * Every load runs on its own thread with its own read-only connection and delivers the surveys in chunks of
+ * ChunkRows, so a view can fill while the rest is still being read. Starting a new load cancels the running one:
+ * the thread stops after its current chunk and any chunks it already sent are dropped when they arrive.
+ * Only the chunks of the latest load are ever reported.
+ */
+class SurveyPageLoader : public QObject
+{
+    Q_OBJECT
+public:
+    static const int ChunkRows = 2000;  ///< The amount of surveys read before a chunk is delivered.
+
+    explicit SurveyPageLoader(QObject *parent = nullptr);
+    ~SurveyPageLoader();
+
+    void setDatabaseLocation(const QString &location);
+    void load(const int &empId);
+    void prefetch(const QList<int> &empIds, const quint64 &epoch);
+    void cancel();
+    bool isLoading() const;
+
+signals:
+    void chunkLoaded(const int &empId, const SurveyPage &chunk, const int &loaded, const int &total);
+    void loadFinished(const int &empId, const bool &complete);
+    void pagePrefetched(const int &empId, const SurveyPage &page, const quint64 &epoch);
+
+private:
+    QString dbLocation;             ///< The full path to the database file.
+    QList<QThread *> threads;       ///< The threads that have not finished yet.
+    bool loading;                   ///< Is the latest load still running?
+    std::atomic<quint64> generation;///< Increased by every load and cancel, so older threads know they are stale.
+
+    void startThread(const std::function<void (QSqlDatabase &)> &work);
+    bool readPage(QSqlDatabase &db, const int &empId, const quint64 &current,
+                  const std::function<void (const SurveyPage &, const int &, const int &)> &deliver);
+};
+
+#endif // SURVEYPAGELOADER_H
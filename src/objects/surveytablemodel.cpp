@@ -1,15 +1,40 @@
 #include "surveytablemodel.h"
 
+#include <QSqlQuery>
 #include <QDate>
+#include <QColor>
 
 /*!
  * \brief The constructor for the table model.
  * \param parent = The QObject to which this object is bound to
  */
-SurveyTableModel::SurveyTableModel(QObject *parent) : QSqlQueryModel(parent)
+SurveyTableModel::SurveyTableModel(QObject *parent) :
+    QAbstractTableModel(parent),
+    questions(),
+    page()
 {
 }
 
+/*!
+ * \brief Retrieves the amount of surveys in the model.
+ * \param parent = The parent index (the model is a flat table)
+ * \return An integer with the amount of rows.
+ */
+int SurveyTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(page.dates.size());
+}
+
+/*!
+ * \brief Retrieves the amount of columns in the model.
+ * \param parent = The parent index (the model is a flat table)
+ * \return An integer with the amount of columns.
+ */
+int SurveyTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : getTemperatureColumn() + 1;
+}
+
 /*!
  * \brief This function is used by the table view to retrieve and display individual items.
  * \param index = The current item index to be queried
@@ -18,85 +43,222 @@ SurveyTableModel::SurveyTableModel(QObject *parent) : QSqlQueryModel(parent)
  */
 QVariant SurveyTableModel::data(const QModelIndex &index, int role) const
 {
-    QVariant value(QSqlQueryModel::data(index, role));
+    if (!index.isValid() || index.row() >= rowCount())
+        return QVariant();
 
-    switch (index.column()) {
+    size_t row(static_cast<size_t>(index.row()));
 
-    case SurveyTableColumns::Date:
-        return convertDateValue(value);
+    // Highlight the rows of abnormally high temperatures.
+    if (role == Qt::BackgroundRole || role == Qt::ToolTipRole) {
+        if (page.anomalies[row]) {
+            if (role == Qt::BackgroundRole)
+                return QColor(255, 205, 205);
 
-    case SurveyTableColumns::Question1:
-    case SurveyTableColumns::Question2:
-    case SurveyTableColumns::Question3:
-        return convertBoolValue(value);
-
-    case SurveyTableColumns::Temperature:
-        return convertDoubleValue(value);
+            return tr("This temperature is abnormally high compared to the employee's recent readings.");
+        }
 
-    default:
-        return QVariant(QString("Unknown type"));
+        return QVariant();
     }
 
-    return value;
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    if (index.column() == SurveyTableColumns::Date)
+        return QDateTime::fromSecsSinceEpoch(page.dates[row]).date().toString("dd/MM/yyyy");
+
+    if (index.column() == getTemperatureColumn())
+        return QString::number(page.temperatures[row], 'f', 1);
+
+    const Question &question(questions[index.column() - SurveyTableColumns::FirstQuestion]);
+
+    return QString(QuestionSet::isYes(page.answers[row], question.bit) ? "Yes" : "No");
 }
 
 /*!
- * \brief Converts an integer value from the table model to a simple "Yes" or "No" value.
- * \param val = The QVariant value of the item index
- * \return A QVariant value with the current item index value converted to "Yes" or "No".
- * \note Converts a 0 to "No" and 1 to "Yes".
- * \note If the value is not a 0 or 1, or not an integer, then it will simply return the value as is.
+ * \brief Retrieves the column headers of the table.
+ * \param section = The column (or row) number
+ * \param orientation = The orientation of the header
+ * \param role = The Qt::DisplayRole of the header
+ * \return A QVariant with the header text, or the full question as its tooltip.
  */
-QVariant SurveyTableModel::convertBoolValue(const QVariant &val) const
+QVariant SurveyTableModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
-    QString valStr(val.toString());
-    bool ok;
-    int valInt(valStr.toInt(&ok));
+    if (orientation != Qt::Horizontal || (role != Qt::DisplayRole && role != Qt::ToolTipRole))
+        return QAbstractTableModel::headerData(section, orientation, role);
 
-    if (ok) {
-        switch(valInt){
-        case 0: return QVariant(QString("No"));
-        case 1: return QVariant(QString("Yes"));
-        default: return val;
-        }
-    }
+    if (section == SurveyTableColumns::Date)
+        return role == Qt::DisplayRole ? tr("Survey Date") : QVariant();
+
+    if (section == getTemperatureColumn())
+        return role == Qt::DisplayRole ? tr("Temperature (°C)") : QVariant();
 
-    return val;
+    if (section < SurveyTableColumns::FirstQuestion || section > getTemperatureColumn())
+        return QVariant();
+
+    const Question &question(questions[section - SurveyTableColumns::FirstQuestion]);
+
+    if (role == Qt::ToolTipRole)
+        return QuestionSet::getPlainText(question.text);
+
+    // Questions are numbered by their bit, so a number never changes meaning.
+    QString header(tr("Question") + " " + QString::number(question.bit + 1));
+
+    if (!question.active)
+        header += " " + tr("(retired)");
+
+    return header;
 }
 
 /*!
- * \brief Converts an integer value from the table model to a date string of the form "dd/MM/yyyy".
- * \param val = The QVariant value of the item index
- * \return A QVariant with the integer value converted to a date string.
- * \note If the value is not an ingeger value then it will return the value as is.
+ * \brief Replaces the surveys in the model.
+ * \param newPage = The surveys of the employee
  */
-QVariant SurveyTableModel::convertDateValue(const QVariant &val) const
+void SurveyTableModel::load(const SurveyPage &newPage)
 {
-    QString valStr(val.toString());
-    bool ok;
-    int valInt(valStr.toInt(&ok));
+    beginResetModel();
+    page = newPage;
+    endResetModel();
+}
 
-    if (ok)
-        return QDateTime::fromSecsSinceEpoch(valInt).date().toString("dd/MM/yyyy");
+/*!
+ * \brief Adds surveys after the surveys that are already in the model.
+ * \param chunk = The surveys, which must follow the existing ones in date order
+ */
+void SurveyTableModel::append(const SurveyPage &chunk)
+{
+    if (chunk.dates.empty())
+        return;
 
-    return val;
+    beginInsertRows(QModelIndex(), rowCount(), rowCount() + static_cast<int>(chunk.dates.size()) - 1);
+    page.append(chunk);
+    endInsertRows();
 }
 
 /*!
- * \brief Formats a double value to a precision of 1 with trailing zeros.
- * \param val = The QVariant value of the item index
- * \return A QVariant with the double value formatted.
- * \note If the value is not a double value then it will be returned as is.
+ * \brief Retrieves the surveys in the model.
+ * \return A reference to the SurveyPage.
  */
-QVariant SurveyTableModel::convertDoubleValue(const QVariant &val) const
+const SurveyPage &SurveyTableModel::getPage() const
 {
-    QString valStr(val.toString());
-    bool ok;
-    double valDouble(valStr.toDouble(&ok));
+    return page;
+}
 
-    if (ok)
-        return QString::number(valDouble, 'f', 1);
+/*!
+ * \brief Assigns the questions that are shown as columns.
+ * \param questionSet = The questions of the survey
+ */
+void SurveyTableModel::setQuestionSet(const QuestionSet &questionSet)
+{
+    beginResetModel();
+    questions = questionSet.getQuestions();
+    endResetModel();
+}
 
-    return val;
+/*!
+ * \brief Retrieves the survey of a row.
+ * \param row = The row in the table
+ * \param empId = The ID of the employee the surveys in the model belong to
+ * \return A Survey object with the survey values.
+ */
+Survey SurveyTableModel::getSurvey(const int &row, const int &empId) const
+{
+    size_t i(static_cast<size_t>(row));
+
+    // Round to the single decimal that is stored, so the float does not add noise to the value.
+    return Survey(getSurveyDate(row),
+                  empId,
+                  page.answers[i],
+                  qRound(page.temperatures[i] * 10.0) / 10.0);
 }
 
+/*!
+ * \brief Retrieves the survey date of a row.
+ * \param row = The row in the table
+ * \return A QDate with the survey date.
+ */
+QDate SurveyTableModel::getSurveyDate(const int &row) const
+{
+    return QDateTime::fromSecsSinceEpoch(page.dates[static_cast<size_t>(row)]).date();
+}
+
+/*!
+ * \brief Retrieves the column of the temperature, which follows the question columns.
+ * \return An integer with the column number.
+ */
+int SurveyTableModel::getTemperatureColumn() const
+{
+    return SurveyTableColumns::FirstQuestion + static_cast<int>(questions.size());
+}
+
+/*!
+ * \brief Retrieves the amount of memory used by the model.
+ * \return The size in bytes of the model and its columns.
+ */
+qint64 SurveyTableModel::getMemoryFootprint() const
+{
+    return static_cast<qint64>(sizeof(*this)) + page.getMemoryFootprint() - static_cast<qint64>(sizeof(page));
+}
+
+/*!
+ * \brief Replaces the surveys in the page with the next rows of an executed query.
+ * \param query = The executed query with the columns survey_date, answers and temperature
+ * \param maxRows = The maximum amount of rows to read, or -1 to read all remaining rows
+ * \return The amount of rows read. Less than maxRows means the query has no rows left.
+ * \note The query should be forward-only, the rows are copied into the page and not kept by the query.
+ * \note No survey is flagged as an anomaly until setAnomalyDates() is called.
+ */
+int SurveyPage::read(QSqlQuery &query, const int &maxRows)
+{
+    dates.clear();
+    answers.clear();
+    temperatures.clear();
+
+    while ((maxRows < 0 || static_cast<int>(dates.size()) < maxRows) && query.next()) {
+        dates.push_back(static_cast<qint32>(query.value(0).toLongLong()));
+        answers.push_back(query.value(1).toUInt());
+        temperatures.push_back(query.value(2).toFloat());
+    }
+
+    dates.shrink_to_fit();
+    answers.shrink_to_fit();
+    temperatures.shrink_to_fit();
+    anomalies.assign(dates.size(), false);
+    anomalies.shrink_to_fit();
+
+    return static_cast<int>(dates.size());
+}
+
+/*!
+ * \brief Adds the surveys of another page after the surveys of this page.
+ * \param other = The page, which must follow this page in date order
+ */
+void SurveyPage::append(const SurveyPage &other)
+{
+    dates.insert(dates.end(), other.dates.begin(), other.dates.end());
+    answers.insert(answers.end(), other.answers.begin(), other.answers.end());
+    temperatures.insert(temperatures.end(), other.temperatures.begin(), other.temperatures.end());
+    anomalies.insert(anomalies.end(), other.anomalies.begin(), other.anomalies.end());
+}
+
+/*!
+ * \brief Assigns the survey dates of the readings that should be flagged as temperature anomalies.
+ * \param anomalyDates = The survey dates as unix time
+ */
+void SurveyPage::setAnomalyDates(const QSet<qint64> &anomalyDates)
+{
+    for (size_t row = 0; row < dates.size(); ++row)
+        anomalies[row] = anomalyDates.contains(dates[row]);
+}
+
+/*!
+ * \brief Retrieves the amount of memory used by the page.
+ * \return The size in bytes of the page and its columns.
+ */
+qint64 SurveyPage::getMemoryFootprint() const
+{
+    return static_cast<qint64>(sizeof(*this) +
+                               dates.capacity() * sizeof(qint32) +
+                               answers.capacity() * sizeof(quint32) +
+                               temperatures.capacity() * sizeof(float) +
+                               anomalies.capacity() / 8);
+}
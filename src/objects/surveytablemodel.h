@@ -1,34 +1,70 @@
 #ifndef SURVEYTABLEMODEL_H
 #define SURVEYTABLEMODEL_H
 
-#include <QSqlQueryModel>
+#include "survey.h"
+#include "questionset.h"
+
+#include <QAbstractTableModel>
+#include <QSet>
+#include <vector>
+
+class QSqlQuery;
 
 /*!
- * \brief Enum for the column headers found in the survey table.
- * \note The order in which they appear here is also their order in the table.
+ * \brief The decoded surveys of a single employee, as packed columns in date order.
+ */
+struct SurveyPage
+{
+    std::vector<qint32> dates;          ///< The survey dates as unix time.
+    std::vector<quint32> answers;       ///< The answers as bitmasks (see QuestionSet).
+    std::vector<float> temperatures;    ///< The temperatures in degrees Celsius.
+    std::vector<bool> anomalies;        ///< Is the temperature flagged as an anomaly?
+
+    int read(QSqlQuery &query, const int &maxRows = -1);
+    void append(const SurveyPage &other);
+    void setAnomalyDates(const QSet<qint64> &anomalyDates);
+    qint64 getMemoryFootprint() const;
+};
+
+/*!
+ * \brief Enum for the fixed column headers found in the survey table.
+ * \note The questions follow the date, one column per question in the QuestionSet, and the temperature is the last column.
  */
 enum SurveyTableColumns {
     Date,           ///< 0
-    Question1,      ///< 1
-    Question2,      ///< 2
-    Question3,      ///< 3
-    Temperature     ///< 4
+    FirstQuestion   ///< 1
 };
 
 /*!
  * \brief The model for displaying the SurveyDatabase items in a table.
+ *
+ * The surveys are stored as packed columns (12 bytes per survey) instead of one record of QVariants per row.
+ * The displayed strings are only created when the view asks for them. The question columns are generated from the QuestionSet.
  */
-class SurveyTableModel : public QSqlQueryModel
+class SurveyTableModel : public QAbstractTableModel
 {
     Q_OBJECT
 public:
     explicit SurveyTableModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &item, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void load(const SurveyPage &newPage);
+    void append(const SurveyPage &chunk);
+    const SurveyPage &getPage() const;
+    void setQuestionSet(const QuestionSet &questionSet);
+
+    Survey getSurvey(const int &row, const int &empId) const;
+    QDate getSurveyDate(const int &row) const;
+    int getTemperatureColumn() const;
+    qint64 getMemoryFootprint() const;
 
 private:
-    QVariant convertBoolValue(const QVariant &val) const;
-    QVariant convertDateValue(const QVariant &val) const;
-    QVariant convertDoubleValue(const QVariant &val) const;
+    QList<Question> questions;          ///< The questions shown as columns, ordered by bit.
+    SurveyPage page;                    ///< The surveys shown as rows.
 };
 
 #endif // SURVEYTABLEMODEL_H
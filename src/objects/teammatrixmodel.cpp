@@ -0,0 +1,244 @@
+#include "teammatrixmodel.h"
+
+#include <QDateTime>
+#include <QColor>
+
+#include <cmath>
+#include <limits>
+
+/*!
+ * \brief Empties the matrix and sizes it for a range of days, without any employees.
+ * \param first = The first day of the range
+ * \param last = The last day of the range
+ */
+void TeamMatrix::reset(const QDate &first, const QDate &last)
+{
+    from = first;
+    days = first.isValid() && last >= first ? static_cast<int>(first.daysTo(last)) + 1 : 0;
+    empIds.clear();
+    names.clear();
+    columns.clear();
+    answers.clear();
+    temperatures.clear();
+}
+
+/*!
+ * \brief Adds a column for an employee, without any surveys.
+ * \param empId = The ID of the employee
+ * \param name = The name of the employee
+ * \return The column of the employee, the existing one if it was already added.
+ * \note The cells are stored column by column, so adding a column never moves the existing cells.
+ */
+int TeamMatrix::addEmployee(const int &empId, const QString &name)
+{
+    auto it(columns.constFind(empId));
+
+    if (it != columns.constEnd())
+        return it.value();
+
+    int column(static_cast<int>(empIds.size()));
+
+    answers.resize(answers.size() + static_cast<size_t>(days), 0);
+    temperatures.resize(temperatures.size() + static_cast<size_t>(days), std::numeric_limits<float>::quiet_NaN());
+    empIds.append(empId);
+    names.append(name);
+    columns.insert(empId, column);
+
+    return column;
+}
+
+/*!
+ * \brief Fills a cell with a survey.
+ * \param surveyDate = The survey date as unix time
+ * \param column = The column of the employee, see addEmployee()
+ * \param answers = The answers as a bitmask
+ * \param temperature = The temperature in degrees Celsius
+ * \note Surveys outside of the range are ignored.
+ */
+void TeamMatrix::setSurvey(const qint64 &surveyDate, const int &column, const quint32 &answers, const float &temperature)
+{
+    int row(static_cast<int>(from.daysTo(QDateTime::fromSecsSinceEpoch(surveyDate).date())));
+    int cell(getCell(row, column));
+
+    if (cell < 0)
+        return;
+
+    this->answers[static_cast<size_t>(cell)] = answers;
+    temperatures[static_cast<size_t>(cell)] = temperature;
+}
+
+/*!
+ * \brief Determines where a cell is stored.
+ * \param row = The row (day) of the cell
+ * \param column = The column (employee) of the cell
+ * \return The index of the cell in the packed columns, or -1 if it is outside of the matrix.
+ */
+int TeamMatrix::getCell(const int &row, const int &column) const
+{
+    if (row < 0 || row >= days || column < 0 || column >= empIds.size())
+        return -1;
+
+    return column * days + row;
+}
+
+/*!
+ * \brief Retrieves the amount of memory used by the matrix.
+ * \return The size in bytes of the matrix and its cells.
+ */
+qint64 TeamMatrix::getMemoryFootprint() const
+{
+    qint64 size(sizeof(*this));
+
+    size += static_cast<qint64>(answers.capacity() * sizeof(quint32));
+    size += static_cast<qint64>(temperatures.capacity() * sizeof(float));
+    size += empIds.size() * static_cast<qint64>(sizeof(int) * 3);
+
+    for (const QString &name : names)
+        size += name.size() * static_cast<qint64>(sizeof(QChar));
+
+    return size;
+}
+
+/*!
+ * \brief The constructor for the table model.
+ * \param parent = The QObject to which this object is bound to
+ */
+TeamMatrixModel::TeamMatrixModel(QObject *parent) :
+    QAbstractTableModel(parent),
+    questionSet(),
+    matrix()
+{
+}
+
+/*!
+ * \brief Retrieves the amount of days in the model.
+ * \param parent = The parent index (the model is a flat table)
+ * \return An integer with the amount of rows.
+ */
+int TeamMatrixModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() || matrix.empIds.isEmpty() ? 0 : matrix.days;
+}
+
+/*!
+ * \brief Retrieves the amount of employees in the model.
+ * \param parent = The parent index (the model is a flat table)
+ * \return An integer with the amount of columns.
+ */
+int TeamMatrixModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(matrix.empIds.size());
+}
+
+/*!
+ * \brief This function is used by the table view to retrieve and display individual items.
+ * \param index = The current item index to be queried
+ * \param role = The Qt::DisplayRole of the item index
+ * \return A QVariant with the value of the item index to be displayed.
+ */
+QVariant TeamMatrixModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    int cell(matrix.getCell(index.row(), index.column()));
+
+    if (cell < 0)
+        return QVariant();
+
+    float temperature(matrix.temperatures[static_cast<size_t>(cell)]);
+    quint32 answers(matrix.answers[static_cast<size_t>(cell)]);
+
+    if (std::isnan(temperature))
+        return QVariant();
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return QString::number(temperature, 'f', 1);
+
+    case Qt::TextAlignmentRole:
+        return Qt::AlignCenter;
+
+    case Qt::BackgroundRole:
+        if (temperature >= Survey::FeverTemperature)
+            return QColor(255, 205, 205);
+
+        if (QuestionSet::anyYes(answers, questionSet.getActiveMask()))
+            return QColor(255, 235, 190);
+
+        return QVariant();
+
+    case Qt::ToolTipRole: {
+        QStringList yes;
+        const QList<Question> questions(questionSet.getQuestions());
+
+        for (const Question &question : questions) {
+            if (QuestionSet::isYes(answers, question.bit))
+                yes.append(tr("Question") + " " + QString::number(question.bit + 1) + ": " +
+                           QuestionSet::getPlainText(question.text));
+        }
+
+        return yes.isEmpty() ? tr("No questions answered \"Yes\".") : yes.join('\n');
+    }
+
+    default:
+        return QVariant();
+    }
+}
+
+/*!
+ * \brief Retrieves the headers of the table, the employee names across and the dates down.
+ * \param section = The column (or row) number
+ * \param orientation = The orientation of the header
+ * \param role = The Qt::DisplayRole of the header
+ * \return A QVariant with the header text.
+ */
+QVariant TeamMatrixModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole && role != Qt::ToolTipRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    if (orientation == Qt::Horizontal) {
+        if (section < 0 || section >= matrix.names.size())
+            return QVariant();
+
+        return matrix.names[section];
+    }
+
+    if (section < 0 || section >= matrix.days)
+        return QVariant();
+
+    return matrix.from.addDays(section).toString(role == Qt::DisplayRole ? "dd/MM/yyyy" : "dddd, d MMMM yyyy");
+}
+
+/*!
+ * \brief Replaces the cells in the model.
+ * \param newMatrix = The surveys of the team
+ */
+void TeamMatrixModel::load(const TeamMatrix &newMatrix)
+{
+    beginResetModel();
+    matrix = newMatrix;
+    endResetModel();
+}
+
+/*!
+ * \brief Retrieves the cells in the model.
+ * \return A reference to the TeamMatrix.
+ */
+const TeamMatrix &TeamMatrixModel::getMatrix() const
+{
+    return matrix;
+}
+
+/*!
+ * \brief Assigns the questions that are listed in the tooltips.
+ * \param newQuestionSet = The questions of the survey
+ */
+void TeamMatrixModel::setQuestionSet(const QuestionSet &newQuestionSet)
+{
+    questionSet = newQuestionSet;
+
+    if (rowCount() > 0)
+        emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1), {Qt::BackgroundRole, Qt::ToolTipRole});
+}
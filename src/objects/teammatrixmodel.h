@@ -0,0 +1,61 @@
+#ifndef TEAMMATRIXMODEL_H
+#define TEAMMATRIXMODEL_H
+
+#include "questionset.h"
+#include "survey.h"
+
+#include <QAbstractTableModel>
+#include <QDate>
+#include <QHash>
+#include <QStringList>
+#include <vector>
+
+/*!
+ * \brief The surveys of a team over a range of days, pivoted into a day by employee matrix.
+ *
+ * The cells are stored column by column in packed arrays (8 bytes per cell), a day without a survey has a NaN temperature.
+ */
+struct TeamMatrix
+{
+    QDate from;                         ///< The first day, the date of row 0.
+    int days = 0;                       ///< The amount of days, one row per day.
+    QList<int> empIds;                  ///< The employee of every column.
+    QStringList names;                  ///< The name of every column.
+    QHash<int, int> columns;            ///< The column of every employee by ID.
+    std::vector<quint32> answers;       ///< The answers of every cell as bitmasks (see QuestionSet).
+    std::vector<float> temperatures;    ///< The temperature of every cell, or NaN if there is no survey.
+
+    void reset(const QDate &first, const QDate &last);
+    int addEmployee(const int &empId, const QString &name);
+    void setSurvey(const qint64 &surveyDate, const int &column, const quint32 &answers, const float &temperature);
+    int getCell(const int &row, const int &column) const;
+    qint64 getMemoryFootprint() const;
+};
+
+/*!
+ * \brief The model for comparing the surveys of a team side by side, one row per day and one column per employee.
+ *
+ * A cell shows the temperature, its background shows a fever or a "Yes" to any active question, and its tooltip lists
+ * the questions answered "Yes". Nothing is formatted until the view asks for it, so wide teams scroll smoothly.
+ */
+class TeamMatrixModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit TeamMatrixModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &item, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void load(const TeamMatrix &newMatrix);
+    const TeamMatrix &getMatrix() const;
+    void setQuestionSet(const QuestionSet &newQuestionSet);
+
+private:
+    QuestionSet questionSet;    ///< The questions of the survey, for the tooltips and the symptom highlight.
+    TeamMatrix matrix;          ///< The cells shown in the table.
+};
+
+#endif // TEAMMATRIXMODEL_H
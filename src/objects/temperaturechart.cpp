@@ -0,0 +1,126 @@
+#include "temperaturechart.h"
+
+#include <QChartView>
+#include <QLineSeries>
+#include <QDateTimeAxis>
+#include <QValueAxis>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QtMath>
+
+/*!
+ * \brief The constructor for the TemperatureChart.
+ * \param chartView = The view the chart is shown in
+ * \param parent = The QObject to which this object is bound to
+ */
+TemperatureChart::TemperatureChart(QChartView *chartView, QObject *parent) :
+    QObject(parent),
+    view(chartView),
+    chart(new QChart()),
+    line(new QLineSeries()),
+    axisX(new QDateTimeAxis()),
+    axisY(new QValueAxis()),
+    series(),
+    lastRedrawMs(0),
+    updating(false)
+{
+    chart->addSeries(line);
+    chart->addAxis(axisX, Qt::AlignBottom);
+    chart->addAxis(axisY, Qt::AlignLeft);
+    chart->legend()->hide();
+
+    line->attachAxis(axisX);
+    line->attachAxis(axisY);
+
+    axisX->setFormat("dd/MM/yyyy");
+    axisY->setTitleText(tr("Temperature (°C)"));
+
+    view->setChart(chart);
+    view->setRenderHint(QPainter::Antialiasing, false);
+    view->setRubberBand(QChartView::HorizontalRubberBand);
+
+    connect(axisX, &QDateTimeAxis::rangeChanged, this, &TemperatureChart::updatePoints);
+    connect(chart, &QChart::plotAreaChanged, this, &TemperatureChart::updatePoints);
+}
+
+/*!
+ * \brief Replaces the series that is drawn and zooms out to show all of it.
+ * \param newSeries = The series, with its levels of detail built
+ * \param title = The title of the chart
+ */
+void TemperatureChart::setSeries(TemperatureSeries newSeries, const QString &title)
+{
+    series = std::move(newSeries);
+    chart->setTitle(title);
+
+    if (series.size() == 0) {
+        line->clear();
+        return;
+    }
+
+    // Half a degree of room above and below the readings.
+    axisY->setRange(qFloor(series.getMinTemperature() * 2 - 1) / 2.0, qCeil(series.getMaxTemperature() * 2 + 1) / 2.0);
+
+    QDateTime first(QDateTime::fromSecsSinceEpoch(series.getFirstTime()));
+    QDateTime last(QDateTime::fromSecsSinceEpoch(series.getLastTime()));
+
+    // A single day still gets a visible range.
+    if (first == last) {
+        first = first.addDays(-1);
+        last = last.addDays(1);
+    }
+
+    if (axisX->min() == first && axisX->max() == last)
+        updatePoints();
+    else
+        axisX->setRange(first, last);
+}
+
+/*!
+ * \brief Retrieves the series that is drawn.
+ * \return A reference to the TemperatureSeries.
+ */
+const TemperatureSeries &TemperatureChart::getSeries() const
+{
+    return series;
+}
+
+/*!
+ * \brief Retrieves the amount of points in the line that is drawn.
+ * \return An integer with the amount of points.
+ */
+int TemperatureChart::getPointCount() const
+{
+    return line->count();
+}
+
+/*!
+ * \brief Retrieves how long it took to replace the points the last time.
+ * \return A double with the time in milliseconds.
+ */
+double TemperatureChart::getLastRedrawMs() const
+{
+    return lastRedrawMs;
+}
+
+/*!
+ * \brief Replaces the points of the line with the downsampled points of the visible range.
+ */
+void TemperatureChart::updatePoints()
+{
+    if (updating || series.size() == 0)
+        return;
+
+    updating = true;
+
+    QElapsedTimer redrawTimer;
+    redrawTimer.start();
+
+    int pixels(qMax(1, qRound(chart->plotArea().width())));
+
+    // replace() updates the line in one go, instead of a repaint for every point.
+    line->replace(series.getPoints(axisX->min().toSecsSinceEpoch(), axisX->max().toSecsSinceEpoch(), pixels));
+
+    lastRedrawMs = redrawTimer.nsecsElapsed() / 1000000.0;
+    updating = false;
+}
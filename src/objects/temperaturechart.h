@@ -0,0 +1,46 @@
+#ifndef TEMPERATURECHART_H
+#define TEMPERATURECHART_H
+
+#include "temperatureseries.h"
+
+#include <QObject>
+
+class QChart;
+class QChartView;
+class QLineSeries;
+class QDateTimeAxis;
+class QValueAxis;
+
+/*!
+ * \brief Draws a TemperatureSeries in a QChartView, downsampled to the visible range and the width of the chart.
+ *
+ * The line only ever holds about two points per pixel. Whenever the visible range or the size of the plot area
+ * changes, the points are taken from the matching level of detail of the series and replaced in one go.
+ * Drag to zoom in on a range, right click to zoom out.
+ */
+class TemperatureChart : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TemperatureChart(QChartView *chartView, QObject *parent = nullptr);
+
+    void setSeries(TemperatureSeries newSeries, const QString &title);
+    const TemperatureSeries &getSeries() const;
+    int getPointCount() const;
+    double getLastRedrawMs() const;
+
+private slots:
+    void updatePoints();
+
+private:
+    QChartView *view;           ///< The view the chart is shown in.
+    QChart *chart;              ///< The chart, owned by the view.
+    QLineSeries *line;          ///< The downsampled line, owned by the chart.
+    QDateTimeAxis *axisX;       ///< The time axis, owned by the chart.
+    QValueAxis *axisY;          ///< The temperature axis, owned by the chart.
+    TemperatureSeries series;   ///< The readings with their levels of detail.
+    double lastRedrawMs;        ///< The time (in milliseconds) it took to replace the points the last time.
+    bool updating;              ///< Are the points being replaced right now?
+};
+
+#endif // TEMPERATURECHART_H
@@ -0,0 +1,252 @@
+#include "temperatureseries.h"
+
+#include <algorithm>
+#include <limits>
+
+/*!
+ * \brief The constructor for an empty series.
+ */
+TemperatureSeries::TemperatureSeries() :
+    levels(1),
+    minTemperature(std::numeric_limits<float>::max()),
+    maxTemperature(std::numeric_limits<float>::lowest())
+{
+}
+
+/*!
+ * \brief Removes all readings and levels.
+ */
+void TemperatureSeries::clear()
+{
+    levels.assign(1, Level());
+    minTemperature = std::numeric_limits<float>::max();
+    maxTemperature = std::numeric_limits<float>::lowest();
+}
+
+/*!
+ * \brief Reserves room for an amount of readings.
+ * \param readings = The expected amount of readings
+ */
+void TemperatureSeries::reserve(const int &readings)
+{
+    levels[0].times.reserve(static_cast<size_t>(readings));
+    levels[0].temperatures.reserve(static_cast<size_t>(readings));
+}
+
+/*!
+ * \brief Adds a reading to the end of the series.
+ * \param time = The time of the reading, as unix time (not before the previous reading)
+ * \param temperature = The reading in degrees Celsius
+ * \note Call buildLevels() after the last reading is added.
+ */
+void TemperatureSeries::append(const qint64 &time, const float &temperature)
+{
+    levels[0].times.push_back(time);
+    levels[0].temperatures.push_back(temperature);
+
+    minTemperature = qMin(minTemperature, temperature);
+    maxTemperature = qMax(maxTemperature, temperature);
+}
+
+/*!
+ * \brief Builds the coarser levels of detail from the readings.
+ */
+void TemperatureSeries::buildLevels()
+{
+    levels.resize(1);
+    levels[0].times.shrink_to_fit();
+    levels[0].temperatures.shrink_to_fit();
+
+    while (levels.back().times.size() > static_cast<size_t>(MinLevelPoints)) {
+        Level next;
+        const size_t count(levels.back().times.size());
+
+        next.times.reserve(count / 2 + 2);
+        next.temperatures.reserve(count / 2 + 2);
+
+        const Level &source(levels.back());
+
+        for (size_t begin = 0; begin < count; begin += 4) {
+            size_t end(qMin(begin + 4, count));
+            size_t low(begin);
+            size_t high(begin);
+
+            for (size_t i = begin + 1; i < end; ++i) {
+                if (source.temperatures[i] < source.temperatures[low])
+                    low = i;
+
+                if (source.temperatures[i] > source.temperatures[high])
+                    high = i;
+            }
+
+            // Keep both extremes in time order, or the single point if they are the same.
+            size_t first(qMin(low, high));
+            size_t second(qMax(low, high));
+
+            next.times.push_back(source.times[first]);
+            next.temperatures.push_back(source.temperatures[first]);
+
+            if (second != first) {
+                next.times.push_back(source.times[second]);
+                next.temperatures.push_back(source.temperatures[second]);
+            }
+        }
+
+        levels.push_back(std::move(next));
+    }
+}
+
+/*!
+ * \brief Retrieves the amount of readings.
+ * \return An integer with the amount of readings.
+ */
+int TemperatureSeries::size() const
+{
+    return static_cast<int>(levels[0].times.size());
+}
+
+/*!
+ * \brief Retrieves the amount of levels of detail.
+ * \return An integer with the amount of levels, including the readings themselves.
+ */
+int TemperatureSeries::getLevelCount() const
+{
+    return static_cast<int>(levels.size());
+}
+
+/*!
+ * \brief Retrieves the time of the first reading.
+ * \return The time as unix time, or 0 if there are no readings.
+ */
+qint64 TemperatureSeries::getFirstTime() const
+{
+    return levels[0].times.empty() ? 0 : levels[0].times.front();
+}
+
+/*!
+ * \brief Retrieves the time of the last reading.
+ * \return The time as unix time, or 0 if there are no readings.
+ */
+qint64 TemperatureSeries::getLastTime() const
+{
+    return levels[0].times.empty() ? 0 : levels[0].times.back();
+}
+
+/*!
+ * \brief Retrieves the lowest reading.
+ * \return A float with the temperature in degrees Celsius.
+ */
+float TemperatureSeries::getMinTemperature() const
+{
+    return minTemperature;
+}
+
+/*!
+ * \brief Retrieves the highest reading.
+ * \return A float with the temperature in degrees Celsius.
+ */
+float TemperatureSeries::getMaxTemperature() const
+{
+    return maxTemperature;
+}
+
+/*!
+ * \brief Retrieves the amount of memory used by the readings and all levels.
+ * \return The size in bytes.
+ */
+qint64 TemperatureSeries::getMemoryFootprint() const
+{
+    qint64 bytes(sizeof(*this));
+
+    for (const Level &level : levels)
+        bytes += static_cast<qint64>(level.times.capacity() * sizeof(qint64) + level.temperatures.capacity() * sizeof(float));
+
+    return bytes;
+}
+
+/*!
+ * \brief Retrieves the points to draw for a visible time range.
+ * \param from = The start of the visible range, as unix time
+ * \param to = The end of the visible range, as unix time
+ * \param pixels = The width of the plot area in pixels
+ * \return At most two points per pixel (plus one on either side of the range), with x in milliseconds since the epoch.
+ * \note This takes O(log n) to find the range plus O(pixels) to reduce it, regardless of the amount of readings.
+ */
+QList<QPointF> TemperatureSeries::getPoints(const qint64 &from, const qint64 &to, const int &pixels) const
+{
+    QList<QPointF> points;
+
+    if (levels[0].times.empty() || to < from || pixels <= 0)
+        return points;
+
+    const size_t maxPoints(static_cast<size_t>(pixels) * 2);
+    size_t levelIndex(0);
+    size_t begin(0);
+    size_t end(0);
+
+    // Use the finest level that has at most twice as many points in the range as will be drawn.
+    for (; levelIndex < levels.size(); ++levelIndex) {
+        const std::vector<qint64> &times(levels[levelIndex].times);
+
+        begin = static_cast<size_t>(std::lower_bound(times.begin(), times.end(), from) - times.begin());
+        end = static_cast<size_t>(std::upper_bound(times.begin(), times.end(), to) - times.begin());
+
+        if (end - begin <= maxPoints * 2 || levelIndex + 1 == levels.size())
+            break;
+    }
+
+    const Level &level(levels[levelIndex]);
+
+    // Include the points just outside the range, so the line continues to the edges of the chart.
+    if (begin > 0)
+        --begin;
+
+    if (end < level.times.size())
+        ++end;
+
+    auto addPoint = [&](const size_t &i) {
+        points.append(QPointF(level.times[i] * 1000.0, level.temperatures[i]));
+    };
+
+    points.reserve(static_cast<int>(qMin(end - begin, maxPoints + 2)));
+
+    if (end - begin <= maxPoints) {
+        for (size_t i = begin; i < end; ++i)
+            addPoint(i);
+
+        return points;
+    }
+
+    // Reduce to the lowest and highest point of every pixel column.
+    double pixelsPerSecond(static_cast<double>(pixels) / qMax<qint64>(1, to - from));
+    qint64 bucket(std::numeric_limits<qint64>::min());
+    size_t low(begin);
+    size_t high(begin);
+
+    auto flush = [&]() {
+        addPoint(qMin(low, high));
+
+        if (low != high)
+            addPoint(qMax(low, high));
+    };
+
+    for (size_t i = begin; i < end; ++i) {
+        qint64 pointBucket(static_cast<qint64>((level.times[i] - from) * pixelsPerSecond));
+
+        if (pointBucket != bucket) {
+            if (i != begin)
+                flush();
+
+            bucket = pointBucket;
+            low = i;
+            high = i;
+        } else if (level.temperatures[i] < level.temperatures[low])
+            low = i;
+        else if (level.temperatures[i] > level.temperatures[high])
+            high = i;
+    }
+
+    flush();
+
+    return points;
+}
@@ -0,0 +1,55 @@
+#ifndef TEMPERATURESERIES_H
+#define TEMPERATURESERIES_H
+
+#include <QList>
+#include <QPointF>
+#include <vector>
+
+/*!
+ * \brief A time series of temperature readings with precomputed levels of detail for drawing.
+ *
+ * Level 0 holds every reading. Every next level keeps the lowest and highest reading of every 4 points of the
+ * level below, so it has half the points, down to about MinLevelPoints. Because the extremes are kept, a single
+ * fever reading stays visible at every zoom level. All levels together use twice the memory of the readings.
+ *
+ * getPoints() picks the coarsest level that still has enough detail for the visible range and reduces it to at
+ * most two points per pixel, so the amount of points drawn only depends on the width of the chart.
+ */
+class TemperatureSeries
+{
+public:
+    static const int MinLevelPoints = 1024;     ///< The amount of points below which no coarser level is built.
+
+    TemperatureSeries();
+
+    void clear();
+    void reserve(const int &readings);
+    void append(const qint64 &time, const float &temperature);
+    void buildLevels();
+
+    int size() const;
+    int getLevelCount() const;
+    qint64 getFirstTime() const;
+    qint64 getLastTime() const;
+    float getMinTemperature() const;
+    float getMaxTemperature() const;
+    qint64 getMemoryFootprint() const;
+
+    QList<QPointF> getPoints(const qint64 &from, const qint64 &to, const int &pixels) const;
+
+private:
+    /*!
+     * \brief The points of a single level of detail, in time order.
+     */
+    struct Level
+    {
+        std::vector<qint64> times;      ///< The times of the points, as unix time.
+        std::vector<float> temperatures;///< The temperatures of the points.
+    };
+
+    std::vector<Level> levels;  ///< The levels of detail, level 0 holds every reading.
+    float minTemperature;       ///< The lowest reading.
+    float maxTemperature;       ///< The highest reading.
+};
+
+#endif // TEMPERATURESERIES_H
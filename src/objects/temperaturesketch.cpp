@@ -0,0 +1,129 @@
+#include "temperaturesketch.h"
+
+#include <QtMath>
+
+#include <limits>
+
+/*!
+ * \brief The default constructor for a sketch without any readings.
+ */
+TemperatureSketch::TemperatureSketch() :
+    bins(),
+    count(0)
+{
+}
+
+/*!
+ * \brief Determines the bin of a temperature.
+ * \param temperature = The reading in degrees Celsius
+ * \return The bin, 0 if the reading is below the range and BinCount - 1 if it is above it.
+ * \note This must match getBinExpression().
+ */
+int TemperatureSketch::getBin(const double &temperature)
+{
+    double offset(std::round((temperature - MinTemperature) / Resolution));
+
+    return static_cast<int>(qBound(0.0, offset + 1, BinCount - 1.0));
+}
+
+/*!
+ * \brief Determines the temperature a bin stands for.
+ * \param bin = The bin
+ * \return The temperature in degrees Celsius.
+ */
+double TemperatureSketch::getBinTemperature(const int &bin)
+{
+    return MinTemperature + (bin - 1) * Resolution;
+}
+
+/*!
+ * \brief Builds the SQL expression that calculates the bin of a temperature column, so triggers can maintain the bins.
+ * \param column = The column, for example "NEW.temperature"
+ * \return The SQL expression.
+ * \note SQLite's ROUND() rounds halves away from zero, like std::round() in getBin().
+ */
+QString TemperatureSketch::getBinExpression(const QString &column)
+{
+    return QString("MAX(0, MIN(%1, CAST(ROUND((%2 - %3) / %4) AS INTEGER) + 1))")
+            .arg(BinCount - 1)
+            .arg(column)
+            .arg(MinTemperature, 0, 'f', 1)
+            .arg(Resolution, 0, 'f', 1);
+}
+
+/*!
+ * \brief Adds a reading to the sketch.
+ * \param temperature = The reading in degrees Celsius
+ */
+void TemperatureSketch::add(const double &temperature)
+{
+    addBin(getBin(temperature), 1);
+}
+
+/*!
+ * \brief Adds readings to a bin.
+ * \param bin = The bin, see getBin()
+ * \param count = The amount of readings
+ * \note Bins outside of the sketch are ignored.
+ */
+void TemperatureSketch::addBin(const int &bin, const quint32 &count)
+{
+    if (bin < 0 || bin >= BinCount)
+        return;
+
+    bins[bin] += count;
+    this->count += count;
+}
+
+/*!
+ * \brief Adds the readings of another sketch to this one.
+ * \param other = The other sketch
+ */
+void TemperatureSketch::merge(const TemperatureSketch &other)
+{
+    for (int bin = 0; bin < BinCount; ++bin)
+        bins[bin] += other.bins[bin];
+
+    count += other.count;
+}
+
+/*!
+ * \brief Removes all readings from the sketch.
+ */
+void TemperatureSketch::clear()
+{
+    bins.fill(0);
+    count = 0;
+}
+
+/*!
+ * \brief Retrieves the amount of readings in the sketch.
+ * \return The amount of readings.
+ */
+qint64 TemperatureSketch::getCount() const
+{
+    return count;
+}
+
+/*!
+ * \brief Calculates a percentile of the readings, using the nearest rank.
+ * \param percentile = The percentile, from 0 to 100
+ * \return The temperature in degrees Celsius, or NaN if the sketch is empty.
+ */
+double TemperatureSketch::getPercentile(const double &percentile) const
+{
+    if (count == 0)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    qint64 rank(qBound<qint64>(1, static_cast<qint64>(std::ceil(percentile / 100 * count)), count));
+    qint64 seen(0);
+
+    for (int bin = 0; bin < BinCount; ++bin) {
+        seen += bins[bin];
+
+        if (seen >= rank)
+            return getBinTemperature(bin);
+    }
+
+    return getBinTemperature(BinCount - 1);
+}
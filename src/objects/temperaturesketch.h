@@ -0,0 +1,48 @@
+#ifndef TEMPERATURESKETCH_H
+#define TEMPERATURESKETCH_H
+
+#include <QString>
+
+#include <array>
+
+/*!
+ * \brief A mergeable summary of temperature readings that answers percentile queries.
+ *
+ * Temperatures are entered with one decimal and fall in a narrow range, so the sketch is a histogram with one bin
+ * per Resolution between MinTemperature and MaxTemperature, plus a bin for all readings below and one for all
+ * readings above the range. Merging two sketches adds their bins, so the sketch of a date range is the sum of the
+ * sketches of its days, and merging is as exact as the sketches themselves.
+ *
+ * Error bounds: the rank of every percentile is exact. The temperature is off by at most MaxError for readings in
+ * the range, and exact for readings entered with one decimal. A percentile that falls below or above the range is
+ * reported as MinTemperature - Resolution or MaxTemperature + Resolution, which only states it is out of range.
+ */
+class TemperatureSketch
+{
+public:
+    static constexpr double MinTemperature = 30.0;  ///< The lowest temperature (in degrees Celsius) with its own bin.
+    static constexpr double MaxTemperature = 45.0;  ///< The highest temperature (in degrees Celsius) with its own bin.
+    static constexpr double Resolution = 0.1;       ///< The width of a bin in degrees Celsius.
+    static constexpr double MaxError = Resolution / 2; ///< The largest error of a percentile in the range, in degrees Celsius.
+    static const int BinCount = 153;                ///< The bins in the range, plus one below and one above it.
+
+    TemperatureSketch();
+
+    static int getBin(const double &temperature);
+    static double getBinTemperature(const int &bin);
+    static QString getBinExpression(const QString &column);
+
+    void add(const double &temperature);
+    void addBin(const int &bin, const quint32 &count);
+    void merge(const TemperatureSketch &other);
+    void clear();
+
+    qint64 getCount() const;
+    double getPercentile(const double &percentile) const;
+
+private:
+    std::array<quint32, BinCount> bins; ///< The amount of readings in every bin.
+    qint64 count;                       ///< The amount of readings in all bins.
+};
+
+#endif // TEMPERATURESKETCH_H
@@ -0,0 +1,199 @@
+#include "temperaturetrend.h"
+
+#include <QtMath>
+
+namespace {
+/*!
+ * \brief The weight of a new reading, giving an effective window of WindowReadings readings.
+ */
+const double Alpha(2.0 / (TemperatureTrend::WindowReadings + 1));
+}
+
+/*!
+ * \brief The default constructor for a trend without any readings.
+ */
+TemperatureTrend::TemperatureTrend() :
+    mean(0),
+    variance(0),
+    samples(0),
+    lastDate(-1),
+    prevMean(0),
+    prevVariance(0),
+    prevSamples(-1)
+{
+}
+
+/*!
+ * \brief Constructor that restores a stored trend.
+ * \param mean = The rolling mean temperature
+ * \param variance = The rolling variance of the temperature
+ * \param samples = The amount of readings added
+ * \param lastDate = The survey date (unix time) of the last reading
+ * \param prevMean = The rolling mean before the last reading
+ * \param prevVariance = The rolling variance before the last reading
+ * \param prevSamples = The amount of readings before the last reading, or -1 if unknown
+ */
+TemperatureTrend::TemperatureTrend(const double &mean, const double &variance, const int &samples, const qint64 &lastDate,
+                                   const double &prevMean, const double &prevVariance, const int &prevSamples) :
+    mean(mean),
+    variance(variance),
+    samples(samples),
+    lastDate(lastDate),
+    prevMean(prevMean),
+    prevVariance(prevVariance),
+    prevSamples(prevSamples)
+{
+}
+
+/*!
+ * \brief Adds a new reading to the trend.
+ * \param temperature = The reading in degrees Celsius
+ * \param surveyDate = The survey date (unix time) of the reading
+ * \note Readings must be added in date order. Use SurveyDatabase to rebuild a trend when an older reading changes.
+ */
+void TemperatureTrend::addReading(const double &temperature, const qint64 &surveyDate)
+{
+    prevMean = mean;
+    prevVariance = variance;
+    prevSamples = samples;
+
+    if (samples == 0) {
+        mean = temperature;
+        variance = 0;
+    } else {
+        double diff(temperature - mean);
+        double increment(Alpha * diff);
+
+        mean += increment;
+        variance = (1 - Alpha) * (variance + diff * increment);
+    }
+
+    ++samples;
+    lastDate = surveyDate;
+}
+
+/*!
+ * \brief Replaces the temperature of the last reading.
+ * \param temperature = The new reading in degrees Celsius
+ * \return A boolean value that is false if the state before the last reading is unknown and the trend has to be rebuilt.
+ */
+bool TemperatureTrend::replaceLastReading(const double &temperature)
+{
+    if (prevSamples < 0)
+        return false;
+
+    qint64 date(lastDate);
+
+    mean = prevMean;
+    variance = prevVariance;
+    samples = prevSamples;
+
+    addReading(temperature, date);
+    return true;
+}
+
+/*!
+ * \brief Removes the last reading from the trend.
+ * \param previousDate = The survey date (unix time) of the reading before the last one, or -1 if it is unknown
+ * \return A boolean value that is false if the state before the last reading is unknown and the trend has to be rebuilt.
+ * \note With the previous date known, a newer reading can be added in O(1) again. Otherwise the next change to the
+ * trend is replayed from the database.
+ */
+bool TemperatureTrend::removeLastReading(const qint64 &previousDate)
+{
+    if (prevSamples < 0)
+        return false;
+
+    mean = prevMean;
+    variance = prevVariance;
+    samples = prevSamples;
+    lastDate = samples > 0 ? previousDate : -1;
+    prevSamples = -1;
+
+    return true;
+}
+
+/*!
+ * \brief Determines if a new reading is abnormally high compared to the trend.
+ * \param temperature = The reading in degrees Celsius
+ * \return A boolean value that states whether the reading is an anomaly.
+ */
+bool TemperatureTrend::isAnomaly(const double &temperature) const
+{
+    return samples >= MinSamples &&
+            temperature - mean >= MinRise &&
+            getZScore(temperature) >= ZThreshold;
+}
+
+/*!
+ * \brief Calculates how many rolling standard deviations a reading is above the rolling mean.
+ * \param temperature = The reading in degrees Celsius
+ * \return A double with the z-score (negative if the reading is below the mean).
+ */
+double TemperatureTrend::getZScore(const double &temperature) const
+{
+    return (temperature - mean) / qMax(qSqrt(variance), MinDeviation);
+}
+
+/*!
+ * \brief Retrieves the rolling mean temperature.
+ * \return A double with the mean in degrees Celsius.
+ */
+double TemperatureTrend::getMean() const
+{
+    return mean;
+}
+
+/*!
+ * \brief Retrieves the rolling variance of the temperature.
+ * \return A double with the variance.
+ */
+double TemperatureTrend::getVariance() const
+{
+    return variance;
+}
+
+/*!
+ * \brief Retrieves the amount of readings in the trend.
+ * \return An integer with the amount of readings.
+ */
+int TemperatureTrend::getSamples() const
+{
+    return samples;
+}
+
+/*!
+ * \brief Retrieves the survey date of the last reading.
+ * \return The survey date as unix time, or -1 if it is unknown.
+ */
+qint64 TemperatureTrend::getLastDate() const
+{
+    return lastDate;
+}
+
+/*!
+ * \brief Retrieves the rolling mean before the last reading.
+ * \return A double with the mean in degrees Celsius.
+ */
+double TemperatureTrend::getPreviousMean() const
+{
+    return prevMean;
+}
+
+/*!
+ * \brief Retrieves the rolling variance before the last reading.
+ * \return A double with the variance.
+ */
+double TemperatureTrend::getPreviousVariance() const
+{
+    return prevVariance;
+}
+
+/*!
+ * \brief Retrieves the amount of readings before the last reading.
+ * \return An integer with the amount of readings, or -1 if it is unknown.
+ */
+int TemperatureTrend::getPreviousSamples() const
+{
+    return prevSamples;
+}
@@ -0,0 +1,66 @@
+#ifndef TEMPERATURETREND_H
+#define TEMPERATURETREND_H
+
+#include <QDate>
+#include <QString>
+
+/*!
+ * \brief A temperature reading that is abnormally high compared to the employee's own baseline.
+ */
+struct TemperatureAlert
+{
+    QDate surveyDate;       ///< The date of the survey with the reading.
+    int empId = -1;         ///< The ID of the employee.
+    QString name;           ///< The name of the employee.
+    double temperature = 0; ///< The reading in degrees Celsius.
+    double baseline = 0;    ///< The employee's rolling mean temperature before the reading.
+    double zScore = 0;      ///< How many rolling standard deviations the reading is above the baseline.
+};
+
+/*!
+ * \brief The rolling temperature statistics of a single employee.
+ *
+ * The mean and variance are exponentially weighted moving averages over the last WindowReadings readings.
+ * Adding a reading is O(1). The state before the last reading is kept, so that the last reading can be
+ * edited or removed in O(1) as well.
+ */
+class TemperatureTrend
+{
+public:
+    static const int WindowReadings = 14;       ///< The amount of readings (one per day) the averages span.
+    static const int ReplayReadings = 3 * WindowReadings; ///< The amount of earlier readings that seed a rebuilt trend; older readings weigh less than 0.3%.
+    static const int MinSamples = 5;            ///< The amount of readings needed before anomalies are flagged.
+    static constexpr double ZThreshold = 3.0;   ///< The z-score from which a reading is an anomaly.
+    static constexpr double MinRise = 0.5;      ///< The minimum rise (in degrees Celsius) above the baseline for an anomaly.
+    static constexpr double MinDeviation = 0.15;///< The smallest standard deviation used, so a very stable baseline does not flag noise.
+
+    TemperatureTrend();
+    TemperatureTrend(const double &mean, const double &variance, const int &samples, const qint64 &lastDate,
+                     const double &prevMean, const double &prevVariance, const int &prevSamples);
+
+    void addReading(const double &temperature, const qint64 &surveyDate);
+    bool replaceLastReading(const double &temperature);
+    bool removeLastReading(const qint64 &previousDate = -1);
+
+    bool isAnomaly(const double &temperature) const;
+    double getZScore(const double &temperature) const;
+
+    double getMean() const;
+    double getVariance() const;
+    int getSamples() const;
+    qint64 getLastDate() const;
+    double getPreviousMean() const;
+    double getPreviousVariance() const;
+    int getPreviousSamples() const;
+
+private:
+    double mean;        ///< The rolling mean temperature.
+    double variance;    ///< The rolling variance of the temperature.
+    int samples;        ///< The amount of readings added.
+    qint64 lastDate;    ///< The survey date (unix time) of the last reading, or -1 if there is none.
+    double prevMean;    ///< The rolling mean before the last reading.
+    double prevVariance;///< The rolling variance before the last reading.
+    int prevSamples;    ///< The amount of readings before the last reading, or -1 if the previous state is unknown.
+};
+
+#endif // TEMPERATURETREND_H
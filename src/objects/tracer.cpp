@@ -0,0 +1,196 @@
+#include "tracer.h"
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QtDebug>
+
+#include <chrono>
+
+namespace {
+/*!
+ * \brief A single span in the ring buffer.
+ *
+ * The sequence is 0 while the event is being written, and the index of the event plus 1 once it is complete.
+ * A reader that sees the same sequence before and after copying the fields has a consistent copy.
+ */
+struct TraceEvent
+{
+    std::atomic<quint64> sequence{0};       ///< The index of the event plus 1, or 0 while it is written.
+    std::atomic<const char *> name{nullptr};///< The name of the span.
+    std::atomic<qint64> start{0};           ///< The start time in nanoseconds.
+    std::atomic<qint64> duration{0};        ///< The duration in nanoseconds, or -1 for an instant event.
+    std::atomic<int> thread{0};             ///< The number of the thread that recorded the event.
+};
+
+TraceEvent events[Tracer::Capacity];    ///< The ring buffer.
+std::atomic<quint64> head(0);           ///< The index of the next event.
+std::atomic<quint64> clearedAt(0);      ///< The index of the first event after the last clear().
+std::atomic<int> threadCount(0);        ///< The amount of threads that recorded events.
+thread_local int threadNumber(0);       ///< The number of the current thread in the trace, or 0 if it has none yet.
+
+/*!
+ * \brief Determines the index of the oldest event that is still in the ring buffer and was recorded after the last clear.
+ * \param end = The index of the next event
+ * \return The index of the oldest event.
+ */
+quint64 firstIndex(const quint64 &end)
+{
+    const quint64 capacity(Tracer::Capacity);
+
+    return qMax(clearedAt.load(std::memory_order_relaxed), end > capacity ? end - capacity : 0);
+}
+}
+
+std::atomic<bool> Tracer::enabled(false);
+
+/*!
+ * \brief Switches recording on or off.
+ * \param enable = Should spans be recorded?
+ * \note The events recorded so far are kept.
+ */
+void Tracer::setEnabled(const bool &enable)
+{
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+/*!
+ * \brief Retrieves the current time of the monotonic clock used for the spans.
+ * \return The time in nanoseconds.
+ */
+qint64 Tracer::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*!
+ * \brief Adds a span to the ring buffer, overwriting the oldest event if it is full.
+ * \param name = The name of the span, which must stay valid for the lifetime of the application
+ * \param start = The start time (see now())
+ * \param duration = The duration in nanoseconds, or -1 for an instant event
+ */
+void Tracer::record(const char *name, const qint64 &start, const qint64 &duration)
+{
+    if (threadNumber == 0)
+        threadNumber = ++threadCount;
+
+    quint64 index(head.fetch_add(1, std::memory_order_relaxed));
+    TraceEvent &event(events[index % Capacity]);
+
+    event.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    event.name.store(name, std::memory_order_relaxed);
+    event.start.store(start, std::memory_order_relaxed);
+    event.duration.store(duration, std::memory_order_relaxed);
+    event.thread.store(threadNumber, std::memory_order_relaxed);
+
+    event.sequence.store(index + 1, std::memory_order_release);
+}
+
+/*!
+ * \brief Adds an event without a duration, which marks a single moment.
+ * \param name = The name of the event, which must stay valid for the lifetime of the application
+ */
+void Tracer::instant(const char *name)
+{
+    if (isEnabled())
+        record(name, now(), -1);
+}
+
+/*!
+ * \brief Forgets all events recorded so far.
+ */
+void Tracer::clear()
+{
+    clearedAt.store(head.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+/*!
+ * \brief Retrieves the amount of events that would be written to a trace.
+ * \return An integer with the amount of events, at most Capacity.
+ */
+int Tracer::getEventCount()
+{
+    quint64 end(head.load(std::memory_order_acquire));
+
+    return static_cast<int>(end - firstIndex(end));
+}
+
+/*!
+ * \brief Converts the events in the ring buffer to a trace in the Chrome trace event format.
+ * \return The JSON document.
+ * \note Events that are overwritten while they are read are left out.
+ */
+QByteArray Tracer::toChromeTrace()
+{
+    const qint64 pid(QCoreApplication::applicationPid());
+
+    quint64 end(head.load(std::memory_order_acquire));
+    QJsonArray traceEvents;
+
+    for (quint64 index = firstIndex(end); index < end; ++index) {
+        const TraceEvent &event(events[index % Capacity]);
+
+        if (event.sequence.load(std::memory_order_acquire) != index + 1)
+            continue;
+
+        const char *name(event.name.load(std::memory_order_relaxed));
+        qint64 start(event.start.load(std::memory_order_relaxed));
+        qint64 duration(event.duration.load(std::memory_order_relaxed));
+        int thread(event.thread.load(std::memory_order_relaxed));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (event.sequence.load(std::memory_order_relaxed) != index + 1)
+            continue;
+
+        // The trace format uses microseconds.
+        QJsonObject traceEvent({{"name", QString::fromLatin1(name)},
+                                {"cat", "ccq"},
+                                {"ts", start / 1000.0},
+                                {"pid", pid},
+                                {"tid", thread}});
+
+        if (duration < 0) {
+            traceEvent.insert("ph", "i");
+            traceEvent.insert("s", "t");
+        } else {
+            traceEvent.insert("ph", "X");
+            traceEvent.insert("dur", duration / 1000.0);
+        }
+
+        traceEvents.append(traceEvent);
+    }
+
+    QJsonObject trace({{"traceEvents", traceEvents},
+                       {"displayTimeUnit", "ms"}});
+
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+/*!
+ * \brief Writes the events in the ring buffer to a file in the Chrome trace event format.
+ * \param fileName = The full path of the file
+ * \return A boolean value that states whether the file was written or not.
+ */
+bool Tracer::writeChromeTrace(const QString &fileName)
+{
+    QSaveFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "(Trace) Error opening trace file: " << file.errorString() << Qt::endl;
+        return false;
+    }
+
+    file.write(toChromeTrace());
+
+    if (!file.commit()) {
+        qDebug() << "(Trace) Error writing trace file: " << file.errorString() << Qt::endl;
+        return false;
+    }
+
+    return true;
+}
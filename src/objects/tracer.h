@@ -0,0 +1,68 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QByteArray>
+
+#include <atomic>
+
+/*!
+ * \brief Records timed spans of the application and writes them in the Chrome trace format.
+ *
+ * The spans are kept in a fixed ring buffer of Capacity events, so recording never allocates or takes a lock
+ * and the oldest events are overwritten once the buffer is full. Every thread can record at the same time.
+ * While tracing is disabled a TraceSpan only costs a single relaxed atomic load.
+ *
+ * The trace can be opened in chrome://tracing or ui.perfetto.dev.
+ */
+class Tracer
+{
+public:
+    static const int Capacity = 1 << 15;    ///< The amount of events kept in the ring buffer.
+
+    static void setEnabled(const bool &enable);
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    static qint64 now();
+    static void record(const char *name, const qint64 &start, const qint64 &duration);
+    static void instant(const char *name);
+    static void clear();
+
+    static int getEventCount();
+    static QByteArray toChromeTrace();
+    static bool writeChromeTrace(const QString &fileName);
+
+private:
+    static std::atomic<bool> enabled;   ///< Are spans being recorded?
+};
+
+/*!
+ * \brief Records the time from its construction until it is destroyed or ended as a span in the Tracer.
+ * \note The name must stay valid for the lifetime of the application, use a string literal.
+ */
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name) : name(name), start(Tracer::isEnabled() ? Tracer::now() : -1) {}
+    ~TraceSpan() { end(); }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    /*!
+     * \brief Ends the span before it is destroyed, for example before a modal dialog is shown.
+     */
+    void end()
+    {
+        if (start >= 0)
+            Tracer::record(name, start, Tracer::now() - start);
+
+        start = -1;
+    }
+
+private:
+    const char *name;   ///< The name of the span.
+    qint64 start;       ///< The start time (see Tracer::now()), or -1 if the span is not recorded.
+};
+
+#endif // TRACER_H
@@ -0,0 +1,107 @@
+#include "workdaycalendar.h"
+
+#include <QSettings>
+#include <QStringList>
+
+/*!
+ * \brief The constructor for a calendar with Monday to Friday as workdays and no holidays.
+ */
+WorkdayCalendar::WorkdayCalendar() :
+    weekdays(0x1F),
+    holidays()
+{
+}
+
+/*!
+ * \brief Determines if employees have to submit a survey on a date.
+ * \param date = The date to check
+ * \return A boolean value that states whether the date is a workday.
+ */
+bool WorkdayCalendar::isWorkday(const QDate &date) const
+{
+    return date.isValid() && isWorkingWeekday(date.dayOfWeek()) && !holidays.contains(date);
+}
+
+/*!
+ * \brief Determines if a weekday is a working day.
+ * \param dayOfWeek = The day of the week, 1 (Monday) to 7 (Sunday)
+ * \return A boolean value that states whether the weekday is a working day.
+ */
+bool WorkdayCalendar::isWorkingWeekday(const int &dayOfWeek) const
+{
+    return dayOfWeek >= 1 && dayOfWeek <= 7 && (weekdays & (1 << (dayOfWeek - 1))) != 0;
+}
+
+/*!
+ * \brief Retrieves the holidays.
+ * \return A QSet with the dates on which nobody has to submit a survey.
+ */
+QSet<QDate> WorkdayCalendar::getHolidays() const
+{
+    return holidays;
+}
+
+/*!
+ * \brief Assigns whether a weekday is a working day.
+ * \param dayOfWeek = The day of the week, 1 (Monday) to 7 (Sunday)
+ * \param working = Is the weekday a working day?
+ */
+void WorkdayCalendar::setWorkingWeekday(const int &dayOfWeek, const bool &working)
+{
+    if (dayOfWeek < 1 || dayOfWeek > 7)
+        return;
+
+    if (working)
+        weekdays |= static_cast<quint8>(1 << (dayOfWeek - 1));
+    else
+        weekdays &= static_cast<quint8>(~(1 << (dayOfWeek - 1)));
+}
+
+/*!
+ * \brief Assigns the holidays.
+ * \param dates = The dates on which nobody has to submit a survey
+ */
+void WorkdayCalendar::setHolidays(const QSet<QDate> &dates)
+{
+    holidays = dates;
+}
+
+/*!
+ * \brief Loads the calendar from the application settings.
+ * \return The stored WorkdayCalendar, or the default calendar if none was stored.
+ */
+WorkdayCalendar WorkdayCalendar::load()
+{
+    QSettings settings;
+    WorkdayCalendar calendar;
+
+    calendar.weekdays = static_cast<quint8>(settings.value("compliance/weekdays", calendar.weekdays).toUInt() & 0x7F);
+
+    const QStringList dates(settings.value("compliance/holidays").toStringList());
+
+    for (const QString &date : dates) {
+        QDate holiday(QDate::fromString(date, Qt::ISODate));
+
+        if (holiday.isValid())
+            calendar.holidays.insert(holiday);
+    }
+
+    return calendar;
+}
+
+/*!
+ * \brief Stores the calendar in the application settings.
+ */
+void WorkdayCalendar::save() const
+{
+    QSettings settings;
+    QStringList dates;
+
+    for (const QDate &holiday : holidays)
+        dates.append(holiday.toString(Qt::ISODate));
+
+    dates.sort();
+
+    settings.setValue("compliance/weekdays", weekdays);
+    settings.setValue("compliance/holidays", dates);
+}
@@ -0,0 +1,33 @@
+#ifndef WORKDAYCALENDAR_H
+#define WORKDAYCALENDAR_H
+
+#include <QDate>
+#include <QSet>
+
+/*!
+ * \brief The days on which employees are required to submit a survey.
+ *
+ * A day is a workday if its weekday is a workday and it is not a holiday. The calendar is stored in the
+ * application settings, so every workstation can be configured separately.
+ */
+class WorkdayCalendar
+{
+public:
+    WorkdayCalendar();
+
+    bool isWorkday(const QDate &date) const;
+    bool isWorkingWeekday(const int &dayOfWeek) const;
+    QSet<QDate> getHolidays() const;
+
+    void setWorkingWeekday(const int &dayOfWeek, const bool &working);
+    void setHolidays(const QSet<QDate> &dates);
+
+    static WorkdayCalendar load();
+    void save() const;
+
+private:
+    quint8 weekdays;        ///< Bit (day of week - 1) is set for every working weekday, Monday to Friday by default.
+    QSet<QDate> holidays;   ///< The dates on which nobody has to submit a survey.
+};
+
+#endif // WORKDAYCALENDAR_H
@@ -0,0 +1,58 @@
+# The application objects the tests are built against, and the fixtures they share.
+QT       += core gui sql network testlib
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+# The backup copies the database through the SQLite C API and compresses it with zlib.
+# Qt must be built with -system-sqlite so its driver uses the same SQLite library (see getSqliteHandle()).
+LIBS += -lsqlite3 -lz
+
+APP_OBJECTS = $$PWD/../src/objects
+
+INCLUDEPATH += \
+    $$APP_OBJECTS \
+    $$PWD/shared
+
+SOURCES += \
+    $$APP_OBJECTS/auditlog.cpp \
+    $$APP_OBJECTS/complianceengine.cpp \
+    $$APP_OBJECTS/durabilityprofile.cpp \
+    $$APP_OBJECTS/employeetablemodel.cpp \
+    $$APP_OBJECTS/queryplaninspector.cpp \
+    $$APP_OBJECTS/questionset.cpp \
+    $$APP_OBJECTS/survey.cpp \
+    $$APP_OBJECTS/surveybackup.cpp \
+    $$APP_OBJECTS/surveydatabase.cpp \
+    $$APP_OBJECTS/surveypagecache.cpp \
+    $$APP_OBJECTS/surveypageloader.cpp \
+    $$APP_OBJECTS/surveytablemodel.cpp \
+    $$APP_OBJECTS/teammatrixmodel.cpp \
+    $$APP_OBJECTS/temperatureseries.cpp \
+    $$APP_OBJECTS/temperaturesketch.cpp \
+    $$APP_OBJECTS/temperaturetrend.cpp \
+    $$APP_OBJECTS/tracer.cpp \
+    $$APP_OBJECTS/workdaycalendar.cpp \
+    $$PWD/shared/surveyfixtures.cpp
+
+HEADERS += \
+    $$APP_OBJECTS/auditlog.h \
+    $$APP_OBJECTS/complianceengine.h \
+    $$APP_OBJECTS/durabilityprofile.h \
+    $$APP_OBJECTS/employeetablemodel.h \
+    $$APP_OBJECTS/queryplaninspector.h \
+    $$APP_OBJECTS/questionset.h \
+    $$APP_OBJECTS/survey.h \
+    $$APP_OBJECTS/sqlitehandle.h \
+    $$APP_OBJECTS/surveybackup.h \
+    $$APP_OBJECTS/surveydatabase.h \
+    $$APP_OBJECTS/surveypagecache.h \
+    $$APP_OBJECTS/surveypageloader.h \
+    $$APP_OBJECTS/surveytablemodel.h \
+    $$APP_OBJECTS/teammatrixmodel.h \
+    $$APP_OBJECTS/temperatureseries.h \
+    $$APP_OBJECTS/temperaturesketch.h \
+    $$APP_OBJECTS/temperaturetrend.h \
+    $$APP_OBJECTS/tracer.h \
+    $$APP_OBJECTS/workdaycalendar.h \
+    $$PWD/shared/surveyfixtures.h
@@ -0,0 +1,218 @@
+#include "surveyfixtures.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDateTime>
+#include <QtDebug>
+
+#include <atomic>
+
+/*!
+ * \brief Opens a connection to a database file.
+ * \param path = The full path to the database file, which is created if it does not exist
+ */
+RawConnection::RawConnection(const QString &path) :
+    connectionName(),
+    db()
+{
+    static std::atomic<int> nextConnection(1);
+
+    connectionName = "RawCon" + QString::number(nextConnection++);
+    db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(path);
+
+    if (!db.open())
+        qDebug() << "(Test) Error opening database: " << db.lastError().text() << Qt::endl;
+}
+
+/*!
+ * \brief Closes the connection and releases its name.
+ */
+RawConnection::~RawConnection()
+{
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+/*!
+ * \brief Determines if the database file could be opened.
+ * \return A boolean value that is true if the connection is open.
+ */
+bool RawConnection::isOpen() const
+{
+    return db.isOpen();
+}
+
+/*!
+ * \brief Runs a single statement.
+ * \param sql = The statement
+ * \return A boolean value that states whether the statement succeeded or not.
+ */
+bool RawConnection::exec(const QString &sql)
+{
+    QSqlQuery query(db);
+
+    if (!query.exec(sql)) {
+        qDebug() << "(Test) Error running " << sql << ": " << query.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Runs a statement and reads the first column of its first row.
+ * \param sql = The statement
+ * \return The value, or an invalid QVariant if the statement failed or returned no rows.
+ */
+QVariant RawConnection::value(const QString &sql)
+{
+    QSqlQuery query(db);
+
+    if (!query.exec(sql) || !query.next())
+        return QVariant();
+
+    return query.value(0);
+}
+
+/*!
+ * \brief Converts a survey date to the unix time it is stored as.
+ * \param date = The survey date
+ * \return The unix time of noon on the date, like SurveyDatabase stores it.
+ */
+qint64 SurveyFixtures::toUnixTime(const QDate &date)
+{
+    return QDateTime(date, QTime(12, 0)).toSecsSinceEpoch();
+}
+
+/*!
+ * \brief Creates the same temperature for a number of days.
+ * \param temperature = The temperature in degrees Celsius
+ * \param days = The amount of days
+ * \return A QList with a temperature for every day.
+ */
+QList<double> SurveyFixtures::steady(const double &temperature, const int &days)
+{
+    return QList<double>(days, temperature);
+}
+
+/*!
+ * \brief Adds employees in a single transaction.
+ * \param db = The database to add them to
+ * \param names = The names of the employees
+ * \return The IDs of the employees in the order of the names, or an empty list if they could not be added.
+ */
+QList<int> SurveyFixtures::createEmployees(SurveyDatabase &db, const QStringList &names)
+{
+    QList<int> ids;
+
+    if (db.addEmployees(names) < 0)
+        return ids;
+
+    for (const QString &name : names)
+        ids.append(db.getEmployeeId(name));
+
+    return ids;
+}
+
+/*!
+ * \brief Creates one survey per day for an employee.
+ * \param empId = The ID of the employee
+ * \param first = The date of the first survey
+ * \param temperatures = The temperature of every day, starting at first
+ * \param answers = The answers of every survey as a bitmask
+ * \return A QList with the surveys, in date order.
+ */
+QList<Survey> SurveyFixtures::makeDailySurveys(const int &empId, const QDate &first, const QList<double> &temperatures,
+                                               const quint32 &answers)
+{
+    QList<Survey> surveys;
+
+    for (int day = 0; day < temperatures.size(); ++day)
+        surveys.append(Survey(first.addDays(day), empId, answers, temperatures[day]));
+
+    return surveys;
+}
+
+/*!
+ * \brief Adds one survey per day for an employee in a single transaction.
+ * \param db = The database to add them to
+ * \param empId = The ID of the employee
+ * \param first = The date of the first survey
+ * \param temperatures = The temperature of every day, starting at first
+ * \param answers = The answers of every survey as a bitmask
+ * \return The amount of surveys that were added, or -1 if the transaction failed.
+ */
+int SurveyFixtures::addDailySurveys(SurveyDatabase &db, const int &empId, const QDate &first,
+                                    const QList<double> &temperatures, const quint32 &answers)
+{
+    return db.addSurveys(makeDailySurveys(empId, first, temperatures, answers));
+}
+
+/*!
+ * \brief Adds questions to the survey.
+ * \param db = The database to add them to
+ * \param texts = The questions as rich text
+ * \return A boolean value that is true if every question was added.
+ */
+bool SurveyFixtures::addQuestions(SurveyDatabase &db, const QStringList &texts)
+{
+    for (const QString &text : texts) {
+        if (!db.addQuestion(text))
+            return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Creates a database file as the first release of the application wrote it, before PRAGMA user_version was used.
+ * \param path = The full path to the database file, which must not exist yet
+ * \param names = The names of the employees, who get the IDs 1, 2, 3... in this order
+ * \param surveys = The surveys, of which only the answers to the first three questions are kept
+ * \return A boolean value that states whether the file was created or not.
+ * \note Names are written as they are given, so duplicates that a later version would reject can be created.
+ */
+bool SurveyFixtures::createVersion0Database(const QString &path, const QStringList &names, const QList<Survey> &surveys)
+{
+    RawConnection raw(path);
+
+    if (!raw.isOpen() ||
+            !raw.exec("CREATE TABLE Employee ("
+                      "emp_id INTEGER UNIQUE NOT NULL PRIMARY KEY AUTOINCREMENT,"
+                      "name TEXT NOT NULL COLLATE NOCASE);") ||
+            !raw.exec("CREATE TABLE Survey ("
+                      "survey_date INTEGER NOT NULL,"
+                      "emp_id INTEGER NOT NULL,"
+                      "q_one INTEGER,"
+                      "q_two INTEGER,"
+                      "q_three INTEGER,"
+                      "temperature REAL,"
+                      "PRIMARY KEY(survey_date, emp_id),"
+                      "FOREIGN KEY(emp_id) REFERENCES Employee(emp_id)"
+                      ");"))
+        return false;
+
+    for (const QString &name : names) {
+        QString quoted(name);
+
+        if (!raw.exec("INSERT INTO Employee (name) VALUES ('" + quoted.replace('\'', "''") + "');"))
+            return false;
+    }
+
+    for (const Survey &survey : surveys) {
+        QStringList values({QString::number(toUnixTime(survey.getSurveyDate())),
+                            QString::number(survey.getEmployeeId()),
+                            survey.getAnswer(0) ? "1" : "0",
+                            survey.getAnswer(1) ? "1" : "0",
+                            survey.getAnswer(2) ? "1" : "0",
+                            QString::number(survey.getTemperature(), 'f', 2)});
+
+        if (!raw.exec("INSERT INTO Survey (survey_date, emp_id, q_one, q_two, q_three, temperature) "
+                      "VALUES (" + values.join(", ") + ");"))
+            return false;
+    }
+
+    return raw.value("PRAGMA user_version;").toInt() == 0;
+}
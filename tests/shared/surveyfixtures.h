@@ -0,0 +1,49 @@
+#ifndef SURVEYFIXTURES_H
+#define SURVEYFIXTURES_H
+
+#include "surveydatabase.h"
+
+#include <QSqlDatabase>
+#include <QStringList>
+#include <QVariant>
+
+/*!
+ * \brief A plain SQLite connection to a database file, separate from the SurveyDatabase under test.
+ *
+ * Builds legacy files, changes a file behind the back of a SurveyDatabase or holds its write lock,
+ * like another workstation would.
+ */
+class RawConnection
+{
+public:
+    explicit RawConnection(const QString &path);
+    ~RawConnection();
+
+    bool isOpen() const;
+    bool exec(const QString &sql);
+    QVariant value(const QString &sql);
+
+private:
+    QString connectionName; ///< The name of the connection, unique for every RawConnection.
+    QSqlDatabase db;        ///< The open connection.
+};
+
+/*!
+ * \brief Builders for the employees, surveys and questions the tests start from.
+ */
+namespace SurveyFixtures
+{
+qint64 toUnixTime(const QDate &date);
+QList<double> steady(const double &temperature, const int &days);
+
+QList<int> createEmployees(SurveyDatabase &db, const QStringList &names);
+QList<Survey> makeDailySurveys(const int &empId, const QDate &first, const QList<double> &temperatures,
+                               const quint32 &answers = 0);
+int addDailySurveys(SurveyDatabase &db, const int &empId, const QDate &first, const QList<double> &temperatures,
+                    const quint32 &answers = 0);
+bool addQuestions(SurveyDatabase &db, const QStringList &texts);
+
+bool createVersion0Database(const QString &path, const QStringList &names, const QList<Survey> &surveys);
+}
+
+#endif // SURVEYFIXTURES_H
@@ -0,0 +1,7 @@
+# The unit tests, build and run them with: qmake tests.pro && make && make check
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    tst_ingestionserver \
+    tst_surveydaemon \
+    tst_surveydatabase
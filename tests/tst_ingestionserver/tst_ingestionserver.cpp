@@ -0,0 +1,545 @@
+#include "ingestionserver.h"
+#include "surveydatabase.h"
+#include "surveyfixtures.h"
+
+#include <QtTest>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QSignalSpy>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+using namespace SurveyFixtures;
+
+namespace {
+const QDate FirstDay(2024, 3, 4);   ///< The first survey date of every test.
+const int ResponseTimeout(5000);    ///< The time (in milliseconds) a client waits for a response.
+
+/*!
+ * \brief A response of the server, as received by a tablet.
+ */
+struct HttpResponse
+{
+    int status = 0;         ///< The status code, or 0 if no complete response arrived.
+    QByteArray headers;     ///< The status line and the headers.
+    QByteArray body;        ///< The body.
+
+    QJsonObject json() const { return QJsonDocument::fromJson(body).object(); }
+};
+
+/*!
+ * \brief A tablet connected to the server over the loopback interface.
+ *
+ * The server runs on the same thread, so the client never blocks: it keeps the event loop running while it waits.
+ */
+class TabletClient
+{
+public:
+    explicit TabletClient(const quint16 &port)
+    {
+        socket.connectToHost(QHostAddress::LocalHost, port);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        while (socket.state() != QAbstractSocket::ConnectedState && timer.elapsed() < ResponseTimeout)
+            QTest::qWait(5);
+    }
+
+    bool isConnected() const
+    {
+        return socket.state() == QAbstractSocket::ConnectedState;
+    }
+
+    void send(const QByteArray &data)
+    {
+        socket.write(data);
+        socket.flush();
+    }
+
+    HttpResponse request(const QByteArray &method, const QByteArray &path, const QByteArray &body = QByteArray(),
+                         const QByteArray &token = QByteArray())
+    {
+        QByteArray data(method + " " + path + " HTTP/1.1\r\n"
+                        "Host: localhost\r\n"
+                        "Content-Type: application/json\r\n"
+                        "Content-Length: " + QByteArray::number(body.size()) + "\r\n");
+
+        if (!token.isEmpty())
+            data += "X-CCQ-Token: " + token + "\r\n";
+
+        send(data + "\r\n" + body);
+        return readResponse();
+    }
+
+    HttpResponse post(const QJsonArray &surveys, const QByteArray &token = QByteArray())
+    {
+        return request("POST", "/surveys", QJsonDocument(surveys).toJson(QJsonDocument::Compact), token);
+    }
+
+    HttpResponse readResponse()
+    {
+        HttpResponse response;
+        QElapsedTimer timer;
+
+        timer.start();
+
+        while (timer.elapsed() < ResponseTimeout) {
+            buffer.append(socket.readAll());
+
+            int headerEnd(buffer.indexOf("\r\n\r\n"));
+
+            if (headerEnd >= 0) {
+                QByteArray headers(buffer.left(headerEnd));
+                int length(0);
+
+                for (const QByteArray &line : headers.split('\n')) {
+                    if (line.toLower().startsWith("content-length:"))
+                        length = line.mid(15).trimmed().toInt();
+                }
+
+                if (buffer.size() >= headerEnd + 4 + length) {
+                    response.status = headers.mid(9, 3).toInt();
+                    response.headers = headers;
+                    response.body = buffer.mid(headerEnd + 4, length);
+                    buffer.remove(0, headerEnd + 4 + length);
+                    return response;
+                }
+            }
+
+            QTest::qWait(5);
+        }
+
+        return response;
+    }
+
+    QTcpSocket socket;  ///< The connection to the server.
+    QByteArray buffer;  ///< The bytes received but not yet read as a response.
+};
+
+/*!
+ * \brief Creates a survey as a tablet submits it.
+ * \param date = The survey date
+ * \param empId = The ID of the employee
+ * \param answers = The answers, as an array of booleans or as a bitmask
+ * \param temperature = The temperature in degrees Celsius
+ * \return The survey as a JSON object.
+ */
+QJsonObject surveyJson(const QDate &date, const int &empId, const QJsonValue &answers, const double &temperature)
+{
+    return QJsonObject({{"survey_date", date.toString(Qt::ISODate)},
+                        {"emp_id", empId},
+                        {"answers", answers},
+                        {"temperature", temperature}});
+}
+}
+
+/*!
+ * \brief The tests of the IngestionServer, with tablets connected over the loopback interface.
+ */
+class TestIngestionServer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void startOnLoopback();
+    void refuseNetworkWithoutToken();
+    void acceptSurveys();
+    void rejectInvalidSurveys();
+    void writeFullBatchAtOnce();
+    void dropUnwritableSurveys();
+    void retryWhileLocked();
+    void requireToken();
+    void unknownResource();
+    void malformedRequests();
+    void keepAlive();
+    void stopWritesPending();
+
+private:
+    QTemporaryDir tempDir;              ///< Holds the database file of the tests that need one.
+    SurveyDatabase *surveyDb = nullptr; ///< The database of the current test, in memory.
+    IngestionServer *server = nullptr;  ///< The server of the current test, not started yet.
+    QList<int> ids;                     ///< The employees Ann and Ben.
+
+    int pendingSurveys(TabletClient &client);
+};
+
+void TestIngestionServer::init()
+{
+    surveyDb = new SurveyDatabase();
+
+    QVERIFY(surveyDb->createDatabase(SurveyDatabase::InMemoryLocation));
+
+    ids = createEmployees(*surveyDb, {"Ann", "Ben"});
+    QCOMPARE(ids.size(), 2);
+
+    server = new IngestionServer(surveyDb);
+}
+
+void TestIngestionServer::cleanup()
+{
+    delete server;
+    delete surveyDb;
+    server = nullptr;
+    surveyDb = nullptr;
+}
+
+/*!
+ * \brief Asks the server how many surveys are waiting to be written.
+ * \param client = The tablet to ask with
+ * \return The amount of pending surveys, or -1 if the server did not answer.
+ */
+int TestIngestionServer::pendingSurveys(TabletClient &client)
+{
+    HttpResponse response(client.request("GET", "/health"));
+
+    return response.status == 200 ? response.json().value("pending").toInt(-1) : -1;
+}
+
+void TestIngestionServer::startOnLoopback()
+{
+    QVERIFY(server->start(0));
+    QVERIFY(server->isListening());
+    QVERIFY(server->getPort() > 0);
+    QVERIFY(server->getLastError().isEmpty());
+
+    // Starting a running server changes nothing.
+    quint16 port(server->getPort());
+
+    QVERIFY(server->start(0));
+    QCOMPARE(server->getPort(), port);
+
+    TabletClient client(port);
+
+    QVERIFY(client.isConnected());
+    QCOMPARE(pendingSurveys(client), 0);
+
+    server->stop();
+    QVERIFY(!server->isListening());
+}
+
+void TestIngestionServer::refuseNetworkWithoutToken()
+{
+    QVERIFY(!server->start(0, QHostAddress::Any));
+    QVERIFY(!server->isListening());
+    QVERIFY(!server->getLastError().isEmpty());
+
+    server->setAccessToken("secret");
+    QVERIFY(server->start(0, QHostAddress::Any));
+    QVERIFY(server->getLastError().isEmpty());
+}
+
+void TestIngestionServer::acceptSurveys()
+{
+    QSignalSpy ingested(server, &IngestionServer::surveysIngested);
+
+    QVERIFY(server->start(0));
+
+    TabletClient client(server->getPort());
+    QJsonArray surveys({surveyJson(FirstDay, ids[0], QJsonArray({true, false, true}), 36.6),
+                        surveyJson(FirstDay, ids[1], 2, 36.8),
+                        surveyJson(FirstDay.addDays(1), ids[0], QJsonArray(), 36.5)});
+    HttpResponse response(client.post(surveys));
+
+    QCOMPARE(response.status, 202);
+    QCOMPARE(response.json().value("accepted").toInt(), 3);
+    QCOMPARE(response.json().value("rejected").toInt(), 0);
+
+    // The surveys are written together once the flush timer fires.
+    QVERIFY(ingested.wait(ResponseTimeout));
+    QCOMPARE(ingested.count(), 1);
+    QCOMPARE(ingested.first().first().toInt(), 3);
+    QCOMPARE(pendingSurveys(client), 0);
+
+    QList<DailyStatus> statuses(surveyDb->getDailyStatus(FirstDay));
+
+    QCOMPARE(statuses.size(), 2);
+    QCOMPARE(statuses[0].answers, 0x5u);
+    QCOMPARE(statuses[0].temperature, 36.6);
+    QCOMPARE(statuses[1].answers, 0x2u);
+    QVERIFY(surveyDb->getDailyStatus(FirstDay.addDays(1))[0].surveyed);
+
+    // A single object is accepted as well.
+    response = client.request("POST", "/surveys",
+                              QJsonDocument(surveyJson(FirstDay.addDays(1), ids[1], 0, 36.7)).toJson(QJsonDocument::Compact));
+    QCOMPARE(response.status, 202);
+    QCOMPARE(response.json().value("accepted").toInt(), 1);
+    QVERIFY(ingested.wait(ResponseTimeout));
+    QCOMPARE(surveyDb->getDailyStatus(FirstDay.addDays(1)).size(), 2);
+}
+
+void TestIngestionServer::rejectInvalidSurveys()
+{
+    QSignalSpy ingested(server, &IngestionServer::surveysIngested);
+    QSignalSpy dropped(server, &IngestionServer::surveysDropped);
+
+    QVERIFY(server->start(0));
+
+    TabletClient client(server->getPort());
+    QJsonArray tooManyAnswers;
+
+    for (int bit = 0; bit <= QuestionSet::MaxQuestions; ++bit)
+        tooManyAnswers.append(false);
+
+    QJsonObject noTemperature(surveyJson(FirstDay, ids[1], 0, 36.5));
+    noTemperature.remove("temperature");
+
+    QJsonArray surveys({surveyJson(FirstDay, ids[0], 0, 36.5),
+                        surveyJson(FirstDay, ids[1] + 100, 0, 36.5),
+                        surveyJson(FirstDay, ids[1], 0, 50.0),
+                        surveyJson(FirstDay, ids[1], 0, 20.0),
+                        noTemperature,
+                        surveyJson(FirstDay, ids[1], "no", 36.5),
+                        surveyJson(FirstDay, ids[1], tooManyAnswers, 36.5),
+                        surveyJson(FirstDay, ids[1], -1, 36.5),
+                        surveyJson(QDate(), ids[1], 0, 36.5),
+                        surveyJson(FirstDay, -1, 0, 36.5)});
+    HttpResponse response(client.post(surveys));
+
+    QCOMPARE(response.status, 202);
+    QCOMPARE(response.json().value("accepted").toInt(), 1);
+    QCOMPARE(response.json().value("rejected").toInt(), 9);
+
+    // When nothing is accepted, the request fails.
+    response = client.post(QJsonArray({surveyJson(FirstDay, ids[1] + 100, 0, 36.5)}));
+    QCOMPARE(response.status, 422);
+    QCOMPARE(response.json().value("accepted").toInt(), 0);
+    QCOMPARE(response.json().value("rejected").toInt(), 1);
+
+    response = client.request("POST", "/surveys", "{not json");
+    QCOMPARE(response.status, 422);
+    QCOMPARE(response.json().value("rejected").toInt(), 1);
+
+    // The unknown employee never reached the batch, so the valid survey is written with it.
+    QVERIFY(ingested.wait(ResponseTimeout));
+    QCOMPARE(ingested.first().first().toInt(), 1);
+    QCOMPARE(dropped.count(), 0);
+
+    QList<DailyStatus> statuses(surveyDb->getDailyStatus(FirstDay));
+
+    QVERIFY(statuses[0].surveyed);
+    QVERIFY(!statuses[1].surveyed);
+}
+
+void TestIngestionServer::writeFullBatchAtOnce()
+{
+    QSignalSpy ingested(server, &IngestionServer::surveysIngested);
+
+    QVERIFY(server->start(0));
+
+    TabletClient client(server->getPort());
+    QJsonArray surveys;
+
+    for (int day = 0; day < 500; ++day)
+        surveys.append(surveyJson(FirstDay.addDays(day), ids[0], 0, 36.5));
+
+    HttpResponse response(client.post(surveys));
+
+    // A full batch is written before the response is sent.
+    QCOMPARE(response.status, 202);
+    QCOMPARE(response.json().value("accepted").toInt(), 500);
+    QCOMPARE(ingested.count(), 1);
+    QCOMPARE(ingested.first().first().toInt(), 500);
+    QCOMPARE(pendingSurveys(client), 0);
+
+    TemperatureSeries series;
+
+    QVERIFY(surveyDb->loadTemperatureSeries(series, ids[0]));
+    QCOMPARE(series.size(), 500);
+}
+
+void TestIngestionServer::dropUnwritableSurveys()
+{
+    QSignalSpy ingested(server, &IngestionServer::surveysIngested);
+    QSignalSpy dropped(server, &IngestionServer::surveysDropped);
+
+    QVERIFY(server->start(0));
+
+    TabletClient client(server->getPort());
+    HttpResponse response(client.post(QJsonArray({surveyJson(FirstDay, ids[0], 0, 36.5),
+                                                  surveyJson(FirstDay, ids[1], 0, 36.5)})));
+
+    QCOMPARE(response.status, 202);
+    QCOMPARE(response.json().value("accepted").toInt(), 2);
+
+    // Ben is removed before the batch is written, so his survey fails the foreign key.
+    QVERIFY(surveyDb->removeEmployee(ids[1]));
+
+    QVERIFY(dropped.wait(ResponseTimeout));
+    QCOMPARE(dropped.count(), 1);
+    QCOMPARE(dropped.first().first().toInt(), 1);
+    QCOMPARE(ingested.count(), 1);
+    QCOMPARE(ingested.first().first().toInt(), 1);
+
+    // The failed survey is not retried.
+    QCOMPARE(pendingSurveys(client), 0);
+    QTest::qWait(500);
+    QCOMPARE(dropped.count(), 1);
+    QCOMPARE(surveyDb->getDailyStatus(FirstDay).size(), 1);
+    QVERIFY(surveyDb->getDailyStatus(FirstDay)[0].surveyed);
+}
+
+void TestIngestionServer::retryWhileLocked()
+{
+    const QString path(tempDir.filePath("locked.data"));
+    SurveyDatabase fileDb;
+
+    QVERIFY(fileDb.createDatabase(path));
+    QVERIFY(fileDb.addEmployee("Ann"));
+
+    IngestionServer fileServer(&fileDb);
+    QSignalSpy ingested(&fileServer, &IngestionServer::surveysIngested);
+    QSignalSpy dropped(&fileServer, &IngestionServer::surveysDropped);
+
+    QVERIFY(fileServer.start(0));
+
+    TabletClient client(fileServer.getPort());
+    RawConnection otherWorkstation(path);
+
+    QVERIFY(otherWorkstation.exec("BEGIN IMMEDIATE;"));
+
+    HttpResponse response(client.post(QJsonArray({surveyJson(FirstDay, fileDb.getEmployeeId("Ann"), 0, 36.5)})));
+
+    QCOMPARE(response.status, 202);
+
+    // While another workstation holds the write lock, the survey waits instead of being dropped.
+    QTest::qWait(1000);
+    QCOMPARE(ingested.count(), 0);
+    QCOMPARE(dropped.count(), 0);
+    QCOMPARE(pendingSurveys(client), 1);
+
+    QVERIFY(otherWorkstation.exec("ROLLBACK;"));
+    QVERIFY(ingested.count() > 0 || ingested.wait(ResponseTimeout));
+    QCOMPARE(ingested.first().first().toInt(), 1);
+    QCOMPARE(dropped.count(), 0);
+    QCOMPARE(pendingSurveys(client), 0);
+    QVERIFY(fileDb.getDailyStatus(FirstDay)[0].surveyed);
+}
+
+void TestIngestionServer::requireToken()
+{
+    QSignalSpy ingested(server, &IngestionServer::surveysIngested);
+
+    server->setAccessToken("secret");
+    QVERIFY(server->start(0));
+
+    TabletClient client(server->getPort());
+    QJsonArray surveys({surveyJson(FirstDay, ids[0], 0, 36.5)});
+
+    QCOMPARE(client.post(surveys).status, 401);
+    QCOMPARE(client.post(surveys, "wrong").status, 401);
+    QCOMPARE(client.request("GET", "/health").status, 401);
+    QCOMPARE(client.request("GET", "/health", QByteArray(), "secret").status, 200);
+
+    HttpResponse response(client.post(surveys, "secret"));
+
+    QCOMPARE(response.status, 202);
+    QCOMPARE(response.json().value("accepted").toInt(), 1);
+    QVERIFY(ingested.wait(ResponseTimeout));
+    QCOMPARE(ingested.first().first().toInt(), 1);
+}
+
+void TestIngestionServer::unknownResource()
+{
+    QVERIFY(server->start(0));
+
+    TabletClient client(server->getPort());
+    HttpResponse response(client.request("GET", "/surveys"));
+
+    QCOMPARE(response.status, 404);
+    QVERIFY(response.json().contains("error"));
+    QCOMPARE(client.request("POST", "/health").status, 404);
+    QCOMPARE(client.request("POST", "/other", "[]").status, 404);
+
+    // The connection stays usable.
+    QCOMPARE(pendingSurveys(client), 0);
+}
+
+void TestIngestionServer::malformedRequests()
+{
+    QVERIFY(server->start(0));
+
+    // A broken request line closes the connection.
+    TabletClient broken(server->getPort());
+
+    broken.send("GARBAGE\r\n\r\n");
+    QCOMPARE(broken.readResponse().status, 400);
+    QTRY_VERIFY_WITH_TIMEOUT(broken.socket.state() == QAbstractSocket::UnconnectedState, ResponseTimeout);
+
+    TabletClient tooLarge(server->getPort());
+
+    tooLarge.send("POST /surveys HTTP/1.1\r\nContent-Length: " + QByteArray::number(2 * 1024 * 1024) + "\r\n\r\n");
+    QCOMPARE(tooLarge.readResponse().status, 413);
+
+    TabletClient longHeaders(server->getPort());
+
+    longHeaders.send("GET /health HTTP/1.1\r\nX-Filler: " + QByteArray(9 * 1024, 'x'));
+    QCOMPARE(longHeaders.readResponse().status, 431);
+
+    TabletClient badLength(server->getPort());
+
+    badLength.send("POST /surveys HTTP/1.1\r\nContent-Length: -5\r\n\r\n");
+    QCOMPARE(badLength.readResponse().status, 400);
+}
+
+void TestIngestionServer::keepAlive()
+{
+    QVERIFY(server->start(0));
+
+    // Pipelined requests are answered in order on the same connection.
+    TabletClient client(server->getPort());
+
+    client.send("GET /health HTTP/1.1\r\nContent-Length: 0\r\n\r\n"
+                "GET /missing HTTP/1.1\r\nContent-Length: 0\r\n\r\n");
+
+    HttpResponse first(client.readResponse());
+    HttpResponse second(client.readResponse());
+
+    QCOMPARE(first.status, 200);
+    QVERIFY(first.headers.contains("Connection: keep-alive"));
+    QCOMPARE(second.status, 404);
+    QVERIFY(client.isConnected());
+
+    // HTTP/1.0 and "Connection: close" end the connection after the response.
+    TabletClient closing(server->getPort());
+
+    closing.send("GET /health HTTP/1.1\r\nConnection: close\r\nContent-Length: 0\r\n\r\n");
+
+    HttpResponse response(closing.readResponse());
+
+    QCOMPARE(response.status, 200);
+    QVERIFY(response.headers.contains("Connection: close"));
+    QTRY_VERIFY_WITH_TIMEOUT(closing.socket.state() == QAbstractSocket::UnconnectedState, ResponseTimeout);
+
+    TabletClient legacy(server->getPort());
+
+    legacy.send("GET /health HTTP/1.0\r\n\r\n");
+    QCOMPARE(legacy.readResponse().status, 200);
+    QTRY_VERIFY_WITH_TIMEOUT(legacy.socket.state() == QAbstractSocket::UnconnectedState, ResponseTimeout);
+}
+
+void TestIngestionServer::stopWritesPending()
+{
+    QSignalSpy ingested(server, &IngestionServer::surveysIngested);
+
+    QVERIFY(server->start(0));
+
+    TabletClient client(server->getPort());
+
+    QCOMPARE(client.post(QJsonArray({surveyJson(FirstDay, ids[0], 0, 36.5)})).status, 202);
+
+    // Stopping does not wait for the flush timer.
+    server->stop();
+    QCOMPARE(ingested.count(), 1);
+    QVERIFY(surveyDb->getDailyStatus(FirstDay)[0].surveyed);
+    QTRY_VERIFY_WITH_TIMEOUT(client.socket.state() == QAbstractSocket::UnconnectedState, ResponseTimeout);
+}
+
+QTEST_GUILESS_MAIN(TestIngestionServer)
+
+#include "tst_ingestionserver.moc"
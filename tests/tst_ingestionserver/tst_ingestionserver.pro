@@ -0,0 +1,11 @@
+TEMPLATE = app
+TARGET = tst_ingestionserver
+
+include(../objects.pri)
+
+SOURCES += \
+    $$APP_OBJECTS/ingestionserver.cpp \
+    tst_ingestionserver.cpp
+
+HEADERS += \
+    $$APP_OBJECTS/ingestionserver.h
@@ -0,0 +1,274 @@
+#include "surveydaemon.h"
+#include "surveydatabase.h"
+#include "surveyfixtures.h"
+
+#include <QtTest>
+#include <QLocalSocket>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+using namespace SurveyFixtures;
+
+namespace {
+const int ResponseTimeout(5000);    ///< The time (in milliseconds) a client waits for a response.
+const int Pings(1000);              ///< The amount of requests the latency is measured over.
+
+/*!
+ * \brief A tool that queries the daemon over its local socket.
+ *
+ * The daemon accepts clients on the same thread, so the client never blocks: it keeps the event loop running while it waits.
+ */
+class DaemonClient
+{
+public:
+    explicit DaemonClient(const QString &serverName)
+    {
+        socket.connectToServer(serverName);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        while (socket.state() != QLocalSocket::ConnectedState && timer.elapsed() < ResponseTimeout)
+            QTest::qWait(5);
+    }
+
+    bool isConnected() const
+    {
+        return socket.state() == QLocalSocket::ConnectedState;
+    }
+
+    void send(const QByteArray &data)
+    {
+        socket.write(data);
+        socket.flush();
+    }
+
+    QByteArray readLine()
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        while (!socket.canReadLine() && timer.elapsed() < ResponseTimeout)
+            QTest::qWait(1);
+
+        return socket.canReadLine() ? socket.readLine().trimmed() : QByteArray();
+    }
+
+    QJsonObject ask(const QByteArray &request)
+    {
+        send(request + "\n");
+        return QJsonDocument::fromJson(readLine()).object();
+    }
+
+    QLocalSocket socket;    ///< The connection to the daemon.
+};
+}
+
+/*!
+ * \brief The tests of the SurveyDaemon, with clients connected over its local socket.
+ *
+ * The daemon serves a database file with an employee for every clearance reason:
+ * Ann is cleared, Ben has symptoms, Cid has a fever, Dan has no survey and Eve has an abnormally high temperature.
+ */
+class TestSurveyDaemon : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void ping();
+    void cleared();
+    void lookup();
+    void stats();
+    void status();
+    void unknownCommand();
+    void requestTooLong();
+    void followDatabaseChanges();
+    void latency();
+
+private:
+    QTemporaryDir tempDir;      ///< Holds the database file.
+    QDate today;                ///< The day the daemon answers for.
+    SurveyDatabase workstation; ///< Another workstation on the database file, which submits the surveys.
+    SurveyDaemon daemon;        ///< The daemon under test, with two worker threads.
+    QList<int> ids;             ///< The employees Ann, Ben, Cid, Dan and Eve.
+};
+
+void TestSurveyDaemon::initTestCase()
+{
+    QVERIFY(tempDir.isValid());
+
+    const QString path(tempDir.filePath("daemon.data"));
+    today = QDate::currentDate();
+
+    QVERIFY(workstation.createDatabase(path));
+
+    ids = createEmployees(workstation, {"Ann", "Ben", "Cid", "Dan", "Eve"});
+    QCOMPARE(ids.size(), 5);
+
+    QCOMPARE(addDailySurveys(workstation, ids[0], today, {36.5}), 1);
+    QCOMPARE(addDailySurveys(workstation, ids[1], today, {36.5}, 0x1), 1);
+    QCOMPARE(addDailySurveys(workstation, ids[2], today, {38.5}), 1);
+    QCOMPARE(addDailySurveys(workstation, ids[4], today.addDays(-6), steady(36.5, 6) << 37.6), 7);
+
+    QVERIFY(daemon.start("tst_surveydaemon_" + QString::number(QCoreApplication::applicationPid()), path,
+                         DurabilityProfile::balanced(), 2));
+    QVERIFY(!daemon.getServerName().isEmpty());
+}
+
+void TestSurveyDaemon::cleanupTestCase()
+{
+    daemon.stop();
+    QVERIFY(daemon.getServerName().isEmpty());
+}
+
+void TestSurveyDaemon::ping()
+{
+    DaemonClient client(daemon.getServerName());
+
+    QVERIFY(client.isConnected());
+    QCOMPARE(client.ask("ping").value("pong").toBool(), true);
+
+    // Several requests in a single write are answered in order.
+    client.send("ping\nping\n");
+    QCOMPARE(client.readLine(), QByteArray("{\"pong\":true}"));
+    QCOMPARE(client.readLine(), QByteArray("{\"pong\":true}"));
+}
+
+void TestSurveyDaemon::cleared()
+{
+    DaemonClient client(daemon.getServerName());
+    const QStringList reasons({"ok", "symptoms", "fever", "no_survey", "anomaly"});
+
+    for (int i = 0; i < ids.size(); ++i) {
+        QJsonObject response(client.ask("cleared " + QByteArray::number(ids[i])));
+
+        QCOMPARE(response.value("emp_id").toInt(), ids[i]);
+        QCOMPARE(response.value("date").toString(), today.toString(Qt::ISODate));
+        QCOMPARE(response.value("reason").toString(), reasons[i]);
+        QCOMPARE(response.value("cleared").toBool(), i == 0);
+    }
+
+    QJsonObject unknown(client.ask("cleared " + QByteArray::number(ids.last() + 100)));
+
+    QCOMPARE(unknown.value("emp_id").toInt(), ids.last() + 100);
+    QCOMPARE(unknown.value("error").toString(), QString("unknown employee"));
+
+    // The ID is echoed as a number, however the client wrote it.
+    QCOMPARE(client.ask("cleared +" + QByteArray::number(ids[0])).value("emp_id").toInt(), ids[0]);
+    QCOMPARE(client.ask("cleared 00" + QByteArray::number(ids[0])).value("cleared").toBool(), true);
+    QCOMPARE(client.ask("cleared Ann").value("error").toString(), QString("invalid employee id"));
+    QCOMPARE(client.ask("cleared").value("error").toString(), QString("invalid employee id"));
+}
+
+void TestSurveyDaemon::lookup()
+{
+    DaemonClient client(daemon.getServerName());
+    QJsonObject response(client.ask("lookup Cid"));
+
+    QCOMPARE(response.value("emp_id").toInt(), ids[2]);
+    QCOMPARE(response.value("name").toString(), QString("Cid"));
+
+    // Names are looked up case insensitively.
+    QCOMPARE(client.ask("lookup eVE").value("emp_id").toInt(), ids[4]);
+
+    response = client.ask("lookup Zoe");
+    QCOMPARE(response.value("name").toString(), QString("Zoe"));
+    QCOMPARE(response.value("error").toString(), QString("unknown employee"));
+}
+
+void TestSurveyDaemon::stats()
+{
+    DaemonClient client(daemon.getServerName());
+    QJsonObject response(client.ask("stats"));
+
+    QCOMPARE(response.value("date").toString(), today.toString(Qt::ISODate));
+    QCOMPARE(response.value("employees").toInt(), 5);
+    QCOMPARE(response.value("surveyed").toInt(), 4);
+    QCOMPARE(response.value("cleared").toInt(), 1);
+    QCOMPARE(response.value("symptoms").toInt(), 1);
+    QCOMPARE(response.value("fever").toInt(), 1);
+    QCOMPARE(response.value("anomalies").toInt(), 1);
+}
+
+void TestSurveyDaemon::status()
+{
+    DaemonClient client(daemon.getServerName());
+    QJsonObject response(client.ask("status"));
+
+    QVERIFY(response.value("requests").toInteger() > 0);
+    QVERIFY(response.value("p50_us").toDouble() > 0);
+    QVERIFY(response.value("p99_us").toDouble() >= response.value("p50_us").toDouble());
+    QCOMPARE(response.value("threads").toInt(), 2);
+    QVERIFY(response.value("snapshot_age_ms").toInteger() >= 0);
+}
+
+void TestSurveyDaemon::unknownCommand()
+{
+    DaemonClient client(daemon.getServerName());
+
+    QCOMPARE(client.ask("shutdown").value("error").toString(), QString("unknown command"));
+    QCOMPARE(client.ask("").value("error").toString(), QString("unknown command"));
+    QCOMPARE(client.ask("PING").value("error").toString(), QString("unknown command"));
+
+    // The connection stays usable.
+    QCOMPARE(client.ask("ping").value("pong").toBool(), true);
+}
+
+void TestSurveyDaemon::requestTooLong()
+{
+    DaemonClient client(daemon.getServerName());
+
+    client.send(QByteArray(8 * 1024, 'x'));
+    QCOMPARE(client.readLine(), QByteArray("{\"error\":\"request too long\"}"));
+    QTRY_VERIFY_WITH_TIMEOUT(client.socket.state() == QLocalSocket::UnconnectedState, ResponseTimeout);
+}
+
+void TestSurveyDaemon::followDatabaseChanges()
+{
+    DaemonClient client(daemon.getServerName());
+
+    QCOMPARE(client.ask("cleared " + QByteArray::number(ids[3])).value("reason").toString(), QString("no_survey"));
+
+    // Dan submits a survey on another workstation, the daemon picks it up without a restart.
+    QCOMPARE(addDailySurveys(workstation, ids[3], today, {36.6}), 1);
+
+    QTRY_COMPARE_WITH_TIMEOUT(client.ask("cleared " + QByteArray::number(ids[3])).value("reason").toString(),
+                              QString("ok"), ResponseTimeout);
+    QCOMPARE(client.ask("stats").value("cleared").toInt(), 2);
+
+    QVERIFY(workstation.removeSurvey(today, ids[3]));
+    QTRY_COMPARE_WITH_TIMEOUT(client.ask("stats").value("surveyed").toInt(), 4, ResponseTimeout);
+}
+
+void TestSurveyDaemon::latency()
+{
+    DaemonClient client(daemon.getServerName());
+    qint64 before(client.ask("status").value("requests").toInteger());
+
+    QByteArray pings;
+
+    for (int i = 0; i < Pings; ++i)
+        pings += "ping\n";
+
+    client.send(pings);
+
+    for (int i = 0; i < Pings; ++i)
+        QCOMPARE(client.readLine(), QByteArray("{\"pong\":true}"));
+
+    // The client is served by a single worker, so every earlier request on it has been counted.
+    QJsonObject response(client.ask("status"));
+
+    // The latency itself depends on the machine, so it is only reported.
+    QCOMPARE(response.value("requests").toInteger(), before + 1 + Pings);
+    QVERIFY(response.value("p99_us").toDouble() > 0);
+    qDebug() << "(Test) Latency p99 (us): " << response.value("p99_us").toDouble() << Qt::endl;
+}
+
+QTEST_GUILESS_MAIN(TestSurveyDaemon)
+
+#include "tst_surveydaemon.moc"
@@ -0,0 +1,11 @@
+TEMPLATE = app
+TARGET = tst_surveydaemon
+
+include(../objects.pri)
+
+SOURCES += \
+    $$APP_OBJECTS/surveydaemon.cpp \
+    tst_surveydaemon.cpp
+
+HEADERS += \
+    $$APP_OBJECTS/surveydaemon.h
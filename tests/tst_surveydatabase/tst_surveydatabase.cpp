@@ -0,0 +1,1362 @@
+#include "surveydatabase.h"
+#include "surveyfixtures.h"
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QSignalSpy>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace SurveyFixtures;
+
+namespace {
+const QDate FirstDay(2024, 3, 4);   ///< A Monday, the first survey date of every test.
+}
+
+/*!
+ * \brief The tests of every public SurveyDatabase function, on in-memory databases unless a file is needed.
+ */
+class TestSurveyDatabase : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void createInMemory();
+    void createFile();
+    void upgradeFromVersion0();
+    void durabilityProfile();
+    void currentEmployee();
+
+    void addEmployee();
+    void addEmployees();
+    void editEmployee();
+    void renameEmployees();
+    void removeEmployees();
+    void mergeEmployees();
+    void employeeLookup();
+    void normalizeName();
+    void partitions();
+
+    void addSurvey();
+    void addSurveys();
+    void removeSurvey();
+    void editSurvey();
+    void findSurveys();
+    void questions();
+
+    void temperatureAlerts();
+    void rebuildKeepsEarlierAlerts();
+    void compliance();
+    void dailyStatus();
+    void dailyStatusWithoutTemperature();
+    void teamMatrix();
+    void temperatureSeries();
+    void temperatureSketch();
+
+    void surveyModel();
+    void surveyModelAsync();
+    void employeeModel();
+    void pageCache();
+
+    void queryPlans();
+    void createIndex();
+    void purgeSurveys();
+    void incrementalVacuum();
+    void backup();
+    void writeLockContention();
+    void databaseChanged();
+
+private:
+    QTemporaryDir tempDir;  ///< Holds the database files of the tests that need one.
+};
+
+void TestSurveyDatabase::initTestCase()
+{
+    QVERIFY(tempDir.isValid());
+}
+
+void TestSurveyDatabase::createInMemory()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+    QVERIFY(db.isInMemory());
+    QCOMPARE(db.getDatabaseLocation(), QString(SurveyDatabase::InMemoryLocation));
+    QCOMPARE(db.getJournalMode(), QString("memory"));
+    QVERIFY(db.getAuditLogLocation().isEmpty());
+    QVERIFY(!db.getBackup()->start());
+    QVERIFY(db.isIncrementalVacuum());
+    QVERIFY(db.getLastError().isEmpty());
+
+    QCOMPARE(db.getQuestionSet().size(), 3);
+    QCOMPARE(db.getQuestionSet().getActiveMask(), 0x7u);
+    QCOMPARE(db.getSurveyModel()->rowCount(), 0);
+    QCOMPARE(db.getEmployeeModel()->rowCount(), 0);
+    QVERIFY(db.getEmployeeIds().isEmpty());
+}
+
+void TestSurveyDatabase::createFile()
+{
+    const QString path(tempDir.filePath("create.data"));
+    int empId(-1);
+
+    {
+        SurveyDatabase db;
+
+        QVERIFY(db.createDatabase(path));
+        QVERIFY(!db.isInMemory());
+        QCOMPARE(db.getDatabaseLocation(), path);
+        QCOMPARE(db.getJournalMode(), QString("wal"));
+        QCOMPARE(db.getAuditLogLocation(), tempDir.filePath("create.audit"));
+
+        QVERIFY(db.addEmployee("Ann"));
+        empId = db.getEmployeeId("Ann");
+        QCOMPARE(addDailySurveys(db, empId, FirstDay, {36.5, 36.6}), 2);
+
+        // Edits and removals are written to the audit log next to the file.
+        QVERIFY(db.editSurvey(Survey(FirstDay, empId, 0x1, 36.9)));
+        QVERIFY(db.removeSurvey(FirstDay.addDays(1), empId));
+
+        // So are the surveys removed with an employee, and those that clash in a merge.
+        QList<int> ids(createEmployees(db, {"Ben", "Cid"}));
+
+        QCOMPARE(addDailySurveys(db, ids[0], FirstDay, {37.0, 37.1}), 2);
+        QCOMPARE(addDailySurveys(db, ids[1], FirstDay, {36.8}), 1);
+        QVERIFY(db.mergeEmployees(empId, {ids[0]}));
+        QVERIFY(db.removeEmployee(ids[1]));
+    }
+
+    {
+        RawConnection raw(path);
+        QCOMPARE(raw.value("PRAGMA user_version;").toInt(), 7);
+        QCOMPARE(raw.value("SELECT COUNT(*) FROM Survey;").toInt(), 2);
+    }
+
+    AuditLogReader reader(tempDir.filePath("create.audit"));
+    QList<AuditRecord> records;
+
+    QVERIFY(reader.read(AuditFilter(), [&records](const AuditRecord &record) { records.append(record); }));
+    QCOMPARE(records.size(), 4);
+    QCOMPARE(records[0].action, AuditRecord::Edit);
+    QCOMPARE(records[0].oldTemperature, 36.5f);
+    QCOMPARE(records[0].newTemperature, 36.9f);
+    QCOMPARE(records[0].newAnswers, 0x1u);
+    QCOMPARE(records[1].action, AuditRecord::Remove);
+    QCOMPARE(records[1].surveyDate, toUnixTime(FirstDay.addDays(1)));
+    QCOMPARE(records[2].action, AuditRecord::Remove);
+    QCOMPARE(records[2].surveyDate, toUnixTime(FirstDay));
+    QCOMPARE(records[2].oldTemperature, 37.0f);
+    QCOMPARE(records[3].action, AuditRecord::Remove);
+    QCOMPARE(records[3].oldTemperature, 36.8f);
+
+    SurveyDatabase reopened;
+
+    QVERIFY(reopened.createDatabase(path));
+    QCOMPARE(reopened.getEmployeeId("ann"), empId);
+}
+
+void TestSurveyDatabase::upgradeFromVersion0()
+{
+    const QString path(tempDir.filePath("version0.data"));
+    QList<Survey> surveys;
+
+    // Ann has a steady week with a spike on the last day, ALICE is a duplicate of Alice.
+    surveys << makeDailySurveys(1, FirstDay, steady(36.5, 6) << 37.6)
+            << Survey(FirstDay, 2, 0x3, 36.8)
+            << Survey(FirstDay.addDays(1), 2, 0x6, 36.9)
+            << Survey(FirstDay, 3, 0x5, 36.6)
+            << Survey(FirstDay, 4, 0x0, 36.7);
+
+    QVERIFY(createVersion0Database(path, {"Ann", "Bob", "Alice", "ALICE "}, surveys));
+
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(path));
+
+    {
+        RawConnection raw(path);
+        QCOMPARE(raw.value("PRAGMA user_version;").toInt(), 7);
+        QCOMPARE(raw.value("SELECT COUNT(*) FROM Survey;").toInt(), int(surveys.size()));
+    }
+
+    // Version 3: the questions and the packed answers.
+    QCOMPARE(db.getQuestionSet().size(), 3);
+
+    QList<Survey> found(db.findSurveys(FirstDay, FirstDay.addDays(1), 0x2));
+
+    QCOMPARE(found.size(), 2);
+    QCOMPARE(found[0].getEmployeeId(), 2);
+    QCOMPARE(found[0].getAnswers(), 0x3u);
+    QCOMPARE(found[1].getAnswers(), 0x6u);
+    QCOMPARE(db.findSurveys(FirstDay, FirstDay, 0x5, true).size(), 1);
+
+    // Version 2: the trends and alerts were built from the existing surveys.
+    QList<TemperatureAlert> alerts(db.getTemperatureAlerts(FirstDay));
+
+    QCOMPARE(alerts.size(), 1);
+    QCOMPARE(alerts[0].empId, 1);
+    QCOMPARE(alerts[0].surveyDate, FirstDay.addDays(6));
+    QCOMPARE(alerts[0].baseline, 36.5);
+
+    // Version 5: only the oldest of the duplicates gets the name key, the other one is still found by ID.
+    QCOMPARE(db.getEmployeeId("alice"), 3);
+    QVERIFY(db.employeeExist(4));
+    QVERIFY(db.employeeExist("Bob"));
+    QVERIFY(!db.addEmployee("Alice"));
+
+    // Version 4: the summaries of the existing surveys.
+    db.updateEmployeeTableModel();
+
+    EmployeeTableModel *employees(db.getEmployeeModel());
+
+    QCOMPARE(employees->rowCount(), 4);
+
+    for (int row = 0; row < employees->rowCount(); ++row) {
+        if (employees->getEmployeeId(row) == 1) {
+            QCOMPARE(employees->getSurveyCount(row), 7);
+            QCOMPARE(employees->getLastSeen(row), FirstDay.addDays(6));
+        }
+    }
+
+    // Version 6: the temperature bins of the existing surveys.
+    QCOMPARE(db.getTemperatureSketch(FirstDay, FirstDay.addDays(6)).getCount(), qint64(surveys.size()));
+
+    // Version 7: the sites and departments.
+    QVERIFY(db.addSite("Head office") >= 0);
+    QVERIFY(db.addDepartment("Finance") >= 0);
+
+    // Version 1: the surveys are removed with their employee.
+    QVERIFY(db.removeEmployee(3));
+    QCOMPARE(db.findSurveys(FirstDay, FirstDay, 0x5, true).size(), 0);
+    QCOMPARE(db.getDailyStatus(FirstDay).size(), 3);
+
+    // The legacy file was created without incremental vacuum.
+    QVERIFY(!db.isIncrementalVacuum());
+    QVERIFY(db.enableIncrementalVacuum());
+    QVERIFY(db.isIncrementalVacuum());
+
+    // Opening an upgraded file again changes nothing.
+    SurveyDatabase reopened;
+
+    QVERIFY(reopened.createDatabase(path));
+    QCOMPARE(reopened.getTemperatureAlerts(FirstDay).size(), 1);
+    QCOMPARE(reopened.getQuestionSet().size(), 3);
+}
+
+void TestSurveyDatabase::durabilityProfile()
+{
+    SurveyDatabase db;
+
+    QCOMPARE(db.getDurabilityProfile().name, DurabilityProfile::balanced().name);
+
+    db.setDurabilityProfile(DurabilityProfile::archive());
+    QCOMPARE(db.getDurabilityProfile().name, QString("archive"));
+
+    QVERIFY(db.createDatabase(tempDir.filePath("archive.data")));
+    QCOMPARE(db.getJournalMode(), DurabilityProfile::archive().journalMode);
+}
+
+void TestSurveyDatabase::currentEmployee()
+{
+    SurveyDatabase db;
+
+    QCOMPARE(db.getCurrentEmployeeId(), -1);
+
+    db.setCurrentEmployeeId(5);
+    QCOMPARE(db.getCurrentEmployeeId(), 5);
+
+    db.setCurrentEmployeeId(-2);
+    QCOMPARE(db.getCurrentEmployeeId(), 5);
+
+    db.setCurrentEmployeeId(-1);
+    QCOMPARE(db.getCurrentEmployeeId(), -1);
+}
+
+void TestSurveyDatabase::addEmployee()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+    QVERIFY(db.addEmployee("  Jane   Doe "));
+
+    int empId(db.getEmployeeId("jane doe"));
+
+    QVERIFY(empId >= 0);
+    QCOMPARE(db.getEmployeeIds().value("Jane Doe"), empId);
+    QVERIFY(!db.addEmployee("JANE DOE"));
+    QVERIFY(!db.addEmployee("   "));
+    QCOMPARE(db.getEmployeeIds().size(), 1);
+}
+
+void TestSurveyDatabase::addEmployees()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    // Empty names and duplicates, also within the list, are skipped.
+    QCOMPARE(db.addEmployees({"Ann", "Ben", "ann", "", "Cid"}), 3);
+    QCOMPARE(db.addEmployees({"Ben", "Dee"}), 1);
+    QCOMPARE(db.addEmployees({}), 0);
+    QCOMPARE(db.getEmployeeIds().size(), 4);
+    QVERIFY(db.employeeExist("DEE"));
+}
+
+void TestSurveyDatabase::editEmployee()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Ann", "Ben"}));
+
+    QCOMPARE(ids.size(), 2);
+
+    // An employee may change the case of their own name, but not take another employee's name.
+    QVERIFY(db.editEmployee(ids[0], "ANN"));
+    QCOMPARE(db.getEmployeeIds().value("ANN"), ids[0]);
+    QVERIFY(!db.editEmployee(ids[0], "ben"));
+    QVERIFY(!db.editEmployee(ids[1], " "));
+
+    QVERIFY(db.editEmployee("Ann", "Anna"));
+    QCOMPARE(db.getEmployeeId("anna"), ids[0]);
+    QCOMPARE(db.getEmployeeId("ann"), -1);
+    QVERIFY(!db.editEmployee("Nobody", "Somebody"));
+}
+
+void TestSurveyDatabase::renameEmployees()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Ann", "Ben", "Cid"}));
+    QList<QPair<QString, QString>> renames;
+
+    // The first rename clashes with Ben, but Ben has moved on by the third.
+    renames << qMakePair(QString("Ann"), QString("Ben"))
+            << qMakePair(QString("Ben"), QString("Bea"))
+            << qMakePair(QString("Ann"), QString("Ben"))
+            << qMakePair(QString("Nobody"), QString("Dee"));
+
+    QCOMPARE(db.renameEmployees(renames), 2);
+    QCOMPARE(db.getEmployeeId("Bea"), ids[1]);
+    QCOMPARE(db.getEmployeeId("Ben"), ids[0]);
+    QCOMPARE(db.getEmployeeId("Ann"), -1);
+    QCOMPARE(db.getEmployeeId("Cid"), ids[2]);
+    QVERIFY(!db.employeeExist("Dee"));
+    QCOMPARE(db.getEmployeeIds().value("Bea"), ids[1]);
+}
+
+void TestSurveyDatabase::removeEmployees()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Ann", "Ben", "Cid"}));
+
+    for (const int &empId : ids)
+        QCOMPARE(addDailySurveys(db, empId, FirstDay, steady(36.5, 3)), 3);
+
+    QCOMPARE(db.getTemperatureSketch(FirstDay, FirstDay.addDays(2)).getCount(), qint64(9));
+    QVERIFY(db.removeEmployees({ids[0], ids[1]}));
+    QVERIFY(!db.employeeExist("Ann"));
+    QVERIFY(!db.employeeExist(ids[1]));
+
+    // The surveys went with the employees.
+    TemperatureSeries series;
+
+    QVERIFY(db.loadTemperatureSeries(series));
+    QCOMPARE(series.size(), 3);
+    QCOMPARE(db.getTemperatureSketch(FirstDay, FirstDay.addDays(2)).getCount(), qint64(3));
+
+    QVERIFY(db.removeEmployee(ids[2]));
+    QVERIFY(db.getDailyStatus(FirstDay).isEmpty());
+    QCOMPARE(db.getTemperatureSketch(FirstDay, FirstDay.addDays(2)).getCount(), qint64(0));
+}
+
+void TestSurveyDatabase::mergeEmployees()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Ann", "Anne", "Cid"}));
+
+    // Both have a survey on the second day, Ann's is kept.
+    QCOMPARE(addDailySurveys(db, ids[0], FirstDay, {36.5, 36.5}), 2);
+    QCOMPARE(addDailySurveys(db, ids[1], FirstDay.addDays(1), {36.7, 36.7}), 2);
+
+    QVERIFY(db.mergeEmployees(ids[0], {ids[1], ids[0]}));
+    QVERIFY(!db.employeeExist(ids[1]));
+    QVERIFY(!db.employeeExist("Anne"));
+    QVERIFY(db.employeeExist("Cid"));
+
+    TemperatureSeries series;
+
+    QVERIFY(db.loadTemperatureSeries(series, ids[0]));
+    QCOMPARE(series.size(), 3);
+    QCOMPARE(db.getDailyStatus(FirstDay.addDays(1))[0].temperature, 36.5);
+    QCOMPARE(db.getTemperatureSketch(FirstDay, FirstDay.addDays(2)).getCount(), qint64(3));
+
+    // The merged name is free again.
+    QVERIFY(db.addEmployee("Anne"));
+}
+
+void TestSurveyDatabase::employeeLookup()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Ann", "Ben"}));
+    QHash<QString, int> expected({{"Ann", ids[0]}, {"Ben", ids[1]}});
+
+    QCOMPARE(db.getEmployeeIds(), expected);
+    QCOMPARE(db.getEmployeeId(" ANN "), ids[0]);
+    QCOMPARE(db.getEmployeeId("Cid"), -1);
+    QVERIFY(db.employeeExist("ben"));
+    QVERIFY(!db.employeeExist("Cid"));
+    QVERIFY(db.employeeExist(ids[0]));
+    QVERIFY(!db.employeeExist(-1));
+    QVERIFY(!db.employeeExist(ids[1] + 100));
+}
+
+void TestSurveyDatabase::normalizeName()
+{
+    QCOMPARE(SurveyDatabase::normalizeName("  Jane   DOE "), QString("jane doe"));
+    QCOMPARE(SurveyDatabase::normalizeName("   "), QString());
+    // A decomposed accent matches the composed one.
+    QCOMPARE(SurveyDatabase::normalizeName(QString("RENE") + QChar(0x0301)), QString("ren") + QChar(0x00E9));
+}
+
+void TestSurveyDatabase::partitions()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    int north(db.addSite("North"));
+    int south(db.addSite("South"));
+    int lab(db.addDepartment("Lab"));
+
+    QVERIFY(north >= 0 && south >= 0 && lab >= 0);
+    QCOMPARE(db.addSite(" north "), north);
+    QCOMPARE(db.addSite("  "), -1);
+    QCOMPARE(db.getSites(), (QMap<int, QString>({{north, "North"}, {south, "South"}})));
+    QCOMPARE(db.getDepartments(), (QMap<int, QString>({{lab, "Lab"}})));
+
+    QList<int> ids(createEmployees(db, {"Ann", "Ben"}));
+
+    QVERIFY(db.setEmployeePartition({ids[0]}, north, lab));
+
+    // New employees are added to the current partition.
+    db.setPartition(Partition{south, -1});
+    QVERIFY(db.addEmployee("Cid"));
+    ids.append(db.getEmployeeId("Cid"));
+
+    for (const int &empId : ids)
+        QVERIFY(db.addSurvey(Survey(FirstDay, empId, 0, 36.5)));
+
+    db.setPartition(Partition{north, -1});
+    QCOMPARE(db.getPartition().siteId, north);
+    QCOMPARE(db.getPartition().deptId, -1);
+    QCOMPARE(db.getDailyStatus(FirstDay).size(), 1);
+    QCOMPARE(db.getDailyStatus(FirstDay)[0].empId, ids[0]);
+    QCOMPARE(db.getCompliance(FirstDay, FirstDay, WorkdayCalendar()).size(), 1);
+    QCOMPARE(db.getTemperatureSketch(FirstDay, FirstDay).getCount(), qint64(1));
+
+    TemperatureSeries series;
+
+    QVERIFY(db.loadTemperatureSeries(series));
+    QCOMPARE(series.size(), 1);
+
+    db.updateEmployeeTableModel();
+    QCOMPARE(db.getEmployeeModel()->rowCount(), 1);
+
+    db.setPartition(Partition{-1, lab});
+    QCOMPARE(db.getDailyStatus(FirstDay).size(), 1);
+
+    db.setPartition(Partition{south, -1});
+    QCOMPARE(db.getDailyStatus(FirstDay).size(), 1);
+    QCOMPARE(db.getDailyStatus(FirstDay)[0].name, QString("Cid"));
+
+    db.setPartition(Partition());
+    QCOMPARE(db.getDailyStatus(FirstDay).size(), 3);
+    QCOMPARE(db.getTemperatureSketch(FirstDay, FirstDay).getCount(), qint64(3));
+}
+
+void TestSurveyDatabase::addSurvey()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+    QVERIFY(db.addEmployee("Ann"));
+
+    int empId(db.getEmployeeId("Ann"));
+    Survey survey(FirstDay, empId, 0x1, 36.7);
+
+    QVERIFY(db.addSurvey(survey));
+    QVERIFY(!db.addSurvey(survey));
+    QVERIFY(!db.addSurvey(Survey()));
+    QVERIFY(!db.addSurvey(Survey(FirstDay, empId + 100, 0, 36.5)));
+
+    QList<DailyStatus> statuses(db.getDailyStatus(FirstDay));
+
+    QCOMPARE(statuses.size(), 1);
+    QVERIFY(statuses[0].surveyed);
+    QCOMPARE(statuses[0].answers, 0x1u);
+    QCOMPARE(statuses[0].temperature, 36.7);
+}
+
+void TestSurveyDatabase::addSurveys()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+    QVERIFY(db.addEmployee("Ann"));
+
+    int empId(db.getEmployeeId("Ann"));
+    QList<Survey> batch(makeDailySurveys(empId, FirstDay, {36.5, 36.6, 36.7}));
+
+    // Invalid surveys and duplicates are skipped.
+    batch << Survey() << batch.first();
+
+    QCOMPARE(db.addSurveys(batch), 3);
+    QCOMPARE(db.addSurveys(batch), 0);
+
+    // An unknown employee fails the whole batch, which is not a lock failure.
+    QCOMPARE(db.addSurveys({Survey(FirstDay.addDays(5), empId, 0, 36.5), Survey(FirstDay, empId + 100, 0, 36.5)}), -1);
+    QVERIFY(db.getLastError().isEmpty());
+
+    TemperatureSeries series;
+
+    QVERIFY(db.loadTemperatureSeries(series, empId));
+    QCOMPARE(series.size(), 3);
+
+    // Back-filling older surveys in any order re-judges the later spike once the whole batch is in.
+    QVERIFY(db.addEmployee("Ben"));
+
+    int benId(db.getEmployeeId("Ben"));
+    QList<Survey> history(makeDailySurveys(benId, FirstDay, steady(36.5, 6)));
+
+    QVERIFY(db.addSurvey(Survey(FirstDay.addDays(6), benId, 0, 37.6)));
+    QVERIFY(db.getTemperatureAlerts(FirstDay).isEmpty());
+
+    std::reverse(history.begin(), history.end());
+    QCOMPARE(db.addSurveys(history), 6);
+
+    QList<TemperatureAlert> alerts(db.getTemperatureAlerts(FirstDay));
+
+    QCOMPARE(alerts.size(), 1);
+    QCOMPARE(alerts[0].empId, benId);
+    QCOMPARE(alerts[0].surveyDate, FirstDay.addDays(6));
+}
+
+void TestSurveyDatabase::removeSurvey()
+{
+    const QString path(tempDir.filePath("remove.data"));
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(path));
+    QVERIFY(db.addEmployee("Ann"));
+
+    int empId(db.getEmployeeId("Ann"));
+
+    QCOMPARE(addDailySurveys(db, empId, FirstDay, steady(36.5, 6) << 37.6), 7);
+    QCOMPARE(db.getTemperatureAlerts(FirstDay).size(), 1);
+
+    // An earlier survey replays the trend, the last one is removed from it.
+    QVERIFY(db.removeSurvey(FirstDay.addDays(2), empId));
+    QCOMPARE(db.getTemperatureAlerts(FirstDay).size(), 1);
+    QVERIFY(db.removeSurvey(FirstDay.addDays(6), empId));
+    QVERIFY(db.getTemperatureAlerts(FirstDay).isEmpty());
+
+    // The trend remembers the date of the reading before it, so entering the survey again is not a full replay.
+    QCOMPARE(RawConnection(path).value("SELECT last_date FROM TemperatureTrend;").toLongLong(),
+             toUnixTime(FirstDay.addDays(5)));
+
+    QVERIFY(!db.getDailyStatus(FirstDay.addDays(2))[0].surveyed);
+    QVERIFY(!db.getDailyStatus(FirstDay.addDays(6))[0].surveyed);
+    QCOMPARE(db.getTemperatureSketch(FirstDay, FirstDay.addDays(6)).getCount(), qint64(5));
+
+    // Once the spike is back, it is judged against the remaining five readings.
+    QVERIFY(db.addSurvey(Survey(FirstDay.addDays(6), empId, 0, 37.6)));
+    QCOMPARE(db.getTemperatureAlerts(FirstDay).size(), 1);
+}
+
+void TestSurveyDatabase::editSurvey()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+    QVERIFY(db.addEmployee("Ann"));
+
+    int empId(db.getEmployeeId("Ann"));
+
+    QCOMPARE(addDailySurveys(db, empId, FirstDay, steady(36.5, 6) << 36.6), 7);
+    QVERIFY(db.getTemperatureAlerts(FirstDay).isEmpty());
+
+    // Editing the last survey.
+    QVERIFY(db.editSurvey(Survey(FirstDay.addDays(6), empId, 0x2, 37.6)));
+    QCOMPARE(db.getTemperatureAlerts(FirstDay).size(), 1);
+    QCOMPARE(db.getDailyStatus(FirstDay.addDays(6))[0].answers, 0x2u);
+    QVERIFY(db.getDailyStatus(FirstDay.addDays(6))[0].anomaly);
+
+    QVERIFY(db.editSurvey(Survey(FirstDay.addDays(6), empId, 0, 36.6)));
+    QVERIFY(db.getTemperatureAlerts(FirstDay).isEmpty());
+
+    // Editing an earlier survey.
+    QVERIFY(db.editSurvey(Survey(FirstDay.addDays(5), empId, 0, 37.6)));
+
+    QList<TemperatureAlert> alerts(db.getTemperatureAlerts(FirstDay));
+
+    QCOMPARE(alerts.size(), 1);
+    QCOMPARE(alerts[0].surveyDate, FirstDay.addDays(5));
+    QVERIFY(std::abs(db.getTemperatureSketch(FirstDay.addDays(5), FirstDay.addDays(5)).getPercentile(100) - 37.6) <=
+            TemperatureSketch::MaxError);
+
+    QVERIFY(!db.editSurvey(Survey()));
+}
+
+void TestSurveyDatabase::findSurveys()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Ann", "Ben"}));
+
+    QCOMPARE(db.addSurveys({Survey(FirstDay, ids[0], 0x1, 36.5),
+                            Survey(FirstDay.addDays(1), ids[0], 0x3, 36.5),
+                            Survey(FirstDay.addDays(2), ids[0], 0x0, 36.5),
+                            Survey(FirstDay, ids[1], 0x6, 36.5),
+                            Survey(FirstDay.addDays(3), ids[1], 0x2, 36.5)}), 5);
+
+    QList<Survey> any(db.findSurveys(FirstDay, FirstDay.addDays(3), 0x2));
+
+    QCOMPARE(any.size(), 3);
+    QCOMPARE(any[0].getSurveyDate(), FirstDay);
+    QCOMPARE(any[0].getEmployeeId(), ids[1]);
+    QCOMPARE(any[2].getSurveyDate(), FirstDay.addDays(3));
+
+    QList<Survey> all(db.findSurveys(FirstDay, FirstDay.addDays(3), 0x3, true));
+
+    QCOMPARE(all.size(), 1);
+    QCOMPARE(all[0].getEmployeeId(), ids[0]);
+    QCOMPARE(all[0].getAnswers(), 0x3u);
+
+    QCOMPARE(db.findSurveys(FirstDay.addDays(1), FirstDay.addDays(2), 0x7).size(), 1);
+    QCOMPARE(db.findSurveys(FirstDay, FirstDay.addDays(3), 0x8).size(), 0);
+}
+
+void TestSurveyDatabase::questions()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+    QVERIFY(addQuestions(db, {"<p>Have you travelled abroad?</p>"}));
+    QVERIFY(!db.addQuestion("   "));
+
+    QuestionSet questionSet(db.getQuestionSet());
+
+    QCOMPARE(questionSet.size(), 4);
+    QCOMPARE(questionSet.getQuestions().last().bit, 3);
+    QCOMPARE(questionSet.getQuestions().last().text, QString("<p>Have you travelled abroad?</p>"));
+    QCOMPARE(questionSet.getActiveMask(), 0xFu);
+    QCOMPARE(db.getSurveyModel()->columnCount(), 6);
+
+    QVERIFY(db.setQuestionActive(0, false));
+    QCOMPARE(db.getQuestionSet().getActiveMask(), 0xEu);
+    QCOMPARE(db.getQuestionSet().getActiveQuestions().size(), 3);
+    QVERIFY(db.setQuestionActive(0, true));
+    QVERIFY(!db.setQuestionActive(31, true));
+
+    QStringList more;
+
+    for (int bit = 4; bit < QuestionSet::MaxQuestions; ++bit)
+        more.append("Question " + QString::number(bit));
+
+    QVERIFY(addQuestions(db, more));
+    QCOMPARE(db.getQuestionSet().size(), int(QuestionSet::MaxQuestions));
+    QVERIFY(!db.addQuestion("One too many"));
+}
+
+void TestSurveyDatabase::temperatureAlerts()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Ann", "Ben", "Cid"}));
+
+    QCOMPARE(addDailySurveys(db, ids[0], FirstDay, steady(36.5, 6) << 37.6), 7);
+    // A small rise is not an anomaly.
+    QCOMPARE(addDailySurveys(db, ids[1], FirstDay, steady(36.5, 6) << 36.7), 7);
+    // Nothing is flagged while the trend is still warming up.
+    QCOMPARE(addDailySurveys(db, ids[2], FirstDay, steady(36.5, TemperatureTrend::MinSamples - 1) << 38.0), 5);
+
+    QList<TemperatureAlert> alerts(db.getTemperatureAlerts(FirstDay));
+
+    QCOMPARE(alerts.size(), 1);
+    QCOMPARE(alerts[0].empId, ids[0]);
+    QCOMPARE(alerts[0].name, QString("Ann"));
+    QCOMPARE(alerts[0].surveyDate, FirstDay.addDays(6));
+    QCOMPARE(alerts[0].temperature, 37.6);
+    QCOMPARE(alerts[0].baseline, 36.5);
+    QVERIFY(alerts[0].zScore >= TemperatureTrend::ZThreshold);
+
+    QVERIFY(db.getTemperatureAlerts(FirstDay.addDays(7)).isEmpty());
+
+    db.setCurrentEmployeeId(ids[0]);
+    db.updateSurveyTableModel();
+
+    const SurveyPage &page(db.getSurveyModel()->getPage());
+
+    QCOMPARE(page.anomalies.size(), size_t(7));
+    QVERIFY(page.anomalies[6]);
+    QVERIFY(!page.anomalies[5]);
+}
+
+void TestSurveyDatabase::rebuildKeepsEarlierAlerts()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+    QVERIFY(db.addEmployee("Ann"));
+
+    int empId(db.getEmployeeId("Ann"));
+    QList<double> temperatures(steady(36.5, 60));
+
+    // More readings than a rebuild replays come before both spikes and the changed surveys.
+    temperatures[20] = 37.6;
+    temperatures[50] = 37.6;
+
+    QList<Survey> surveys(makeDailySurveys(empId, FirstDay, temperatures));
+    Survey late(surveys.takeAt(30));
+
+    QCOMPARE(db.addSurveys(surveys), 59);
+    QCOMPARE(db.getTemperatureAlerts(FirstDay).size(), 2);
+
+    // A survey that arrives late and a removal in the middle both rebuild the trend from their date.
+    QVERIFY(db.addSurvey(late));
+    QVERIFY(db.removeSurvey(FirstDay.addDays(40), empId));
+
+    QList<TemperatureAlert> alerts(db.getTemperatureAlerts(FirstDay));
+
+    QCOMPARE(alerts.size(), 2);
+    QCOMPARE(alerts[0].surveyDate, FirstDay.addDays(50));
+    QCOMPARE(alerts[1].surveyDate, FirstDay.addDays(20));
+
+    // The replayed spike is judged on the same baseline as a full replay gives.
+    TemperatureTrend expected;
+
+    for (int day = 0; day < 50; ++day) {
+        if (day != 40)
+            expected.addReading(temperatures[day], toUnixTime(FirstDay.addDays(day)));
+    }
+
+    QVERIFY(std::abs(alerts[0].baseline - expected.getMean()) < 1e-9);
+    QVERIFY(std::abs(alerts[0].zScore - expected.getZScore(37.6)) < 1e-9);
+}
+
+void TestSurveyDatabase::compliance()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Ben", "Ann"}));
+    WorkdayCalendar calendar;
+
+    // Monday to Friday for Ann, Monday and Wednesday for Ben.
+    QCOMPARE(addDailySurveys(db, ids[1], FirstDay, steady(36.5, 5)), 5);
+    QVERIFY(db.addSurvey(Survey(FirstDay, ids[0], 0, 36.5)));
+    QVERIFY(db.addSurvey(Survey(FirstDay.addDays(2), ids[0], 0, 36.5)));
+
+    QList<ComplianceRecord> records(db.getCompliance(FirstDay, FirstDay.addDays(6), calendar));
+
+    QCOMPARE(records.size(), 2);
+    QCOMPARE(records[0].name, QString("Ann"));
+    QCOMPARE(records[0].requiredDays, 5);
+    QCOMPARE(records[0].missedDays, 0);
+    QCOMPARE(records[1].empId, ids[0]);
+    QCOMPARE(records[1].missedDays, 3);
+    QCOMPARE(records[1].missedDates, (QList<QDate>({FirstDay.addDays(1), FirstDay.addDays(3), FirstDay.addDays(4)})));
+
+    records = db.getCompliance(FirstDay, FirstDay.addDays(6), calendar, true);
+    QCOMPARE(records.size(), 1);
+    QCOMPARE(records[0].name, QString("Ben"));
+
+    calendar.setHolidays({FirstDay.addDays(1)});
+    records = db.getCompliance(FirstDay, FirstDay.addDays(6), calendar, true);
+    QCOMPARE(records[0].requiredDays, 4);
+    QCOMPARE(records[0].missedDays, 2);
+}
+
+void TestSurveyDatabase::dailyStatus()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Ann", "Ben", "Cid"}));
+    const QDate day(FirstDay.addDays(6));
+
+    QVERIFY(db.addSurvey(Survey(day, ids[0], 0x1, 36.6)));
+    QCOMPARE(addDailySurveys(db, ids[1], FirstDay, steady(36.5, 6) << 37.6), 7);
+
+    QList<DailyStatus> statuses(db.getDailyStatus(day));
+
+    QCOMPARE(statuses.size(), 3);
+    QCOMPARE(statuses[0].empId, ids[0]);
+    QCOMPARE(statuses[0].name, QString("Ann"));
+    QVERIFY(statuses[0].surveyed);
+    QCOMPARE(statuses[0].answers, 0x1u);
+    QCOMPARE(statuses[0].temperature, 36.6);
+    QVERIFY(!statuses[0].anomaly);
+    QVERIFY(statuses[1].surveyed);
+    QVERIFY(statuses[1].anomaly);
+    QVERIFY(!statuses[2].surveyed);
+    QCOMPARE(statuses[2].answers, 0u);
+}
+
+void TestSurveyDatabase::dailyStatusWithoutTemperature()
+{
+    const QString path(tempDir.filePath("notemperature.data"));
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(path));
+    QVERIFY(db.addEmployee("Ann"));
+
+    int empId(db.getEmployeeId("Ann"));
+
+    // Surveys written by other tools may not have a temperature, they still count as submitted.
+    {
+        RawConnection raw(path);
+        QVERIFY(raw.exec("INSERT INTO Survey (survey_date, emp_id, answers, temperature) VALUES (" +
+                         QString::number(toUnixTime(FirstDay)) + ", " + QString::number(empId) + ", 2, NULL);"));
+    }
+
+    QList<DailyStatus> statuses(db.getDailyStatus(FirstDay));
+
+    QCOMPARE(statuses.size(), 1);
+    QVERIFY(statuses[0].surveyed);
+    QCOMPARE(statuses[0].answers, 0x2u);
+    QVERIFY(!statuses[0].anomaly);
+}
+
+void TestSurveyDatabase::teamMatrix()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Cid", "Ann", "Ben"}));
+
+    QCOMPARE(db.addSurveys({Survey(FirstDay, ids[1], 0x1, 36.5),
+                            Survey(FirstDay.addDays(2), ids[1], 0x0, 38.2),
+                            Survey(FirstDay.addDays(1), ids[2], 0x0, 36.6),
+                            Survey(FirstDay.addDays(5), ids[2], 0x0, 36.6)}), 4);
+
+    TeamMatrix matrix;
+
+    QVERIFY(db.loadTeamMatrix(matrix, {ids[2], ids[0], ids[1], ids[2] + 100}, FirstDay, FirstDay.addDays(2)));
+    QCOMPARE(matrix.days, 3);
+    QCOMPARE(matrix.names, QStringList({"Ann", "Ben", "Cid"}));
+    QCOMPARE(matrix.empIds, (QList<int>({ids[1], ids[2], ids[0]})));
+
+    int annDay0(matrix.getCell(0, matrix.columns.value(ids[1])));
+    int annDay1(matrix.getCell(1, matrix.columns.value(ids[1])));
+    int benDay1(matrix.getCell(1, matrix.columns.value(ids[2])));
+
+    QCOMPARE(matrix.temperatures[size_t(annDay0)], 36.5f);
+    QCOMPARE(matrix.answers[size_t(annDay0)], 0x1u);
+    QVERIFY(std::isnan(matrix.temperatures[size_t(annDay1)]));
+    QCOMPARE(matrix.temperatures[size_t(benDay1)], 36.6f);
+
+    TeamMatrixModel model;
+
+    model.load(matrix);
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(model.columnCount(), 3);
+    QCOMPARE(model.data(model.index(2, 0)).toString(), QString("38.2"));
+
+    // The team table is cleared between loads.
+    QVERIFY(db.loadTeamMatrix(matrix, {ids[2]}, FirstDay, FirstDay.addDays(6)));
+    QCOMPARE(matrix.names, QStringList({"Ben"}));
+    QCOMPARE(matrix.days, 7);
+
+    QVERIFY(db.loadTeamMatrix(matrix, {}, FirstDay, FirstDay.addDays(2)));
+    QVERIFY(matrix.empIds.isEmpty());
+}
+
+void TestSurveyDatabase::temperatureSeries()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Ann", "Ben"}));
+
+    QCOMPARE(addDailySurveys(db, ids[0], FirstDay, {36.4, 36.8, 37.2}), 3);
+    QCOMPARE(addDailySurveys(db, ids[1], FirstDay.addDays(1), {36.0, 36.6}), 2);
+
+    TemperatureSeries series;
+
+    QVERIFY(db.loadTemperatureSeries(series));
+    QCOMPARE(series.size(), 5);
+    QCOMPARE(series.getFirstTime(), toUnixTime(FirstDay));
+    QCOMPARE(series.getLastTime(), toUnixTime(FirstDay.addDays(2)));
+    QCOMPARE(series.getMinTemperature(), 36.0f);
+    QCOMPARE(series.getMaxTemperature(), 37.2f);
+
+    QVERIFY(db.loadTemperatureSeries(series, ids[1]));
+    QCOMPARE(series.size(), 2);
+    QCOMPARE(series.getFirstTime(), toUnixTime(FirstDay.addDays(1)));
+
+    QVERIFY(db.loadTemperatureSeries(series, ids[1] + 100));
+    QCOMPARE(series.size(), 0);
+}
+
+void TestSurveyDatabase::temperatureSketch()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Ann", "Ben"}));
+
+    QCOMPARE(addDailySurveys(db, ids[0], FirstDay, steady(36.5, 10)), 10);
+    QVERIFY(db.addSurvey(Survey(FirstDay, ids[1], 0, 39.0)));
+
+    TemperatureSketch sketch(db.getTemperatureSketch(FirstDay, FirstDay.addDays(9)));
+
+    QCOMPARE(sketch.getCount(), qint64(11));
+    QVERIFY(std::abs(sketch.getPercentile(50) - 36.5) <= TemperatureSketch::MaxError);
+    QVERIFY(std::abs(sketch.getPercentile(100) - 39.0) <= TemperatureSketch::MaxError);
+    QCOMPARE(db.getTemperatureSketch(FirstDay.addDays(1), FirstDay.addDays(4)).getCount(), qint64(4));
+
+    // The kept sketches follow the changes.
+    QVERIFY(db.removeSurvey(FirstDay, ids[1]));
+    QVERIFY(db.editSurvey(Survey(FirstDay.addDays(1), ids[0], 0, 37.0)));
+
+    sketch = db.getTemperatureSketch(FirstDay, FirstDay.addDays(9));
+    QCOMPARE(sketch.getCount(), qint64(10));
+    QVERIFY(std::abs(sketch.getPercentile(100) - 37.0) <= TemperatureSketch::MaxError);
+    QCOMPARE(db.getTemperatureSketch(FirstDay.addDays(20), FirstDay.addDays(30)).getCount(), qint64(0));
+}
+
+void TestSurveyDatabase::surveyModel()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Ann", "Ben"}));
+
+    QCOMPARE(addDailySurveys(db, ids[0], FirstDay, {36.5, 36.6, 36.7}, 0x4), 3);
+    QVERIFY(db.addSurvey(Survey(FirstDay, ids[1], 0, 36.9)));
+
+    SurveyTableModel *model(db.getSurveyModel());
+
+    db.setCurrentEmployeeId(ids[0]);
+    db.updateSurveyTableModel();
+    QCOMPARE(model->rowCount(), 3);
+    QCOMPARE(model->columnCount(), 5);
+    QCOMPARE(model->getSurveyDate(0), FirstDay);
+
+    Survey last(model->getSurvey(2, ids[0]));
+
+    QCOMPARE(last.getSurveyDate(), FirstDay.addDays(2));
+    QCOMPARE(last.getAnswers(), 0x4u);
+    QCOMPARE(float(last.getTemperature()), 36.7f);
+
+    db.setCurrentEmployeeId(ids[1]);
+    db.updateSurveyTableModel();
+    QCOMPARE(model->rowCount(), 1);
+
+    // A change shows up the next time the model is updated.
+    QVERIFY(db.addSurvey(Survey(FirstDay.addDays(1), ids[1], 0, 36.9)));
+    db.updateSurveyTableModel();
+    QCOMPARE(model->rowCount(), 2);
+}
+
+void TestSurveyDatabase::surveyModelAsync()
+{
+    SurveyDatabase memoryDb;
+
+    QVERIFY(memoryDb.createDatabase(SurveyDatabase::InMemoryLocation));
+    QVERIFY(memoryDb.addEmployee("Ann"));
+    QCOMPARE(addDailySurveys(memoryDb, memoryDb.getEmployeeId("Ann"), FirstDay, steady(36.5, 3)), 3);
+
+    // Without a file to read from in the background, the surveys are loaded at once.
+    QSignalSpy memoryLoaded(&memoryDb, &SurveyDatabase::surveysLoaded);
+
+    memoryDb.setCurrentEmployeeId(memoryDb.getEmployeeId("Ann"));
+    memoryDb.updateSurveyTableModelAsync();
+    QCOMPARE(memoryLoaded.count(), 1);
+    QVERIFY(!memoryDb.isLoadingSurveys());
+    QCOMPARE(memoryDb.getSurveyModel()->rowCount(), 3);
+
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(tempDir.filePath("async.data")));
+    QVERIFY(db.addEmployee("Ann"));
+
+    int empId(db.getEmployeeId("Ann"));
+
+    QCOMPARE(addDailySurveys(db, empId, FirstDay, steady(36.5, 500)), 500);
+
+    QSignalSpy loaded(&db, &SurveyDatabase::surveysLoaded);
+    QSignalSpy progress(&db, &SurveyDatabase::surveyLoadProgress);
+
+    db.setCurrentEmployeeId(empId);
+    db.updateSurveyTableModelAsync();
+    QVERIFY(loaded.count() == 1 || loaded.wait(5000));
+    QVERIFY(!db.isLoadingSurveys());
+    QVERIFY(progress.count() >= 1);
+    QCOMPARE(db.getSurveyModel()->rowCount(), 500);
+
+    // The complete page was cached, so the next load is immediate.
+    db.updateSurveyTableModelAsync();
+    QCOMPARE(loaded.count(), 2);
+    QCOMPARE(db.getSurveyModel()->rowCount(), 500);
+}
+
+void TestSurveyDatabase::employeeModel()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Ben", "Ann"}));
+
+    QCOMPARE(addDailySurveys(db, ids[1], FirstDay, {36.5, 36.8}), 2);
+
+    EmployeeTableModel *model(db.getEmployeeModel());
+
+    db.updateEmployeeTableModel();
+    QCOMPARE(model->rowCount(), 2);
+    QCOMPARE(model->getName(0), QString("Ann"));
+    QCOMPARE(model->getEmployeeId(0), ids[1]);
+    QCOMPARE(model->getSurveyCount(0), 2);
+    QCOMPARE(model->getLastSeen(0), FirstDay.addDays(1));
+    QCOMPARE(model->getName(1), QString("Ben"));
+    QCOMPARE(model->getSurveyCount(1), 0);
+    QVERIFY(!model->getLastSeen(1).isValid());
+
+    // Removing the last survey moves the last seen date back.
+    QVERIFY(db.removeSurvey(FirstDay.addDays(1), ids[1]));
+    db.updateEmployeeTableModel();
+    QCOMPARE(model->getSurveyCount(0), 1);
+    QCOMPARE(model->getLastSeen(0), FirstDay);
+}
+
+void TestSurveyDatabase::pageCache()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Ann", "Ben"}));
+
+    QVERIFY(db.addSurvey(Survey(FirstDay, ids[0], 0, 36.5)));
+
+    PageCacheStats before(db.getPageCacheStats());
+
+    db.setCurrentEmployeeId(ids[0]);
+    db.updateSurveyTableModel();
+    db.updateSurveyTableModel();
+
+    PageCacheStats stats(db.getPageCacheStats());
+
+    QCOMPARE(stats.misses, before.misses + 1);
+    QCOMPARE(stats.hits, before.hits + 1);
+    QVERIFY(stats.pages >= 1);
+    QVERIFY(stats.bytes > 0);
+    QCOMPARE(stats.maxBytes, qint64(SurveyPageCache::DefaultMaxBytes));
+
+    // A new survey invalidates the page.
+    QVERIFY(db.addSurvey(Survey(FirstDay.addDays(1), ids[0], 0, 36.5)));
+    db.updateSurveyTableModel();
+    QCOMPARE(db.getPageCacheStats().misses, before.misses + 2);
+    QCOMPARE(db.getSurveyModel()->rowCount(), 2);
+
+    // There is no background connection to prefetch with in memory.
+    db.prefetchSurveyPages({ids[1]});
+    QCOMPARE(db.getPageCacheStats().prefetches, before.prefetches);
+
+    db.setPageCacheSize(0);
+    QCOMPARE(db.getPageCacheStats().pages, 0);
+    QCOMPARE(db.getPageCacheStats().maxBytes, qint64(0));
+
+    SurveyDatabase fileDb;
+
+    QVERIFY(fileDb.createDatabase(tempDir.filePath("prefetch.data")));
+
+    QList<int> fileIds(createEmployees(fileDb, {"Ann", "Ben"}));
+
+    QVERIFY(fileDb.addSurvey(Survey(FirstDay, fileIds[1], 0, 36.5)));
+
+    fileDb.prefetchSurveyPages(fileIds);
+    QTRY_COMPARE_WITH_TIMEOUT(fileDb.getPageCacheStats().prefetches, qint64(2), 5000);
+
+    // A prefetched page is a hit.
+    before = fileDb.getPageCacheStats();
+    fileDb.setCurrentEmployeeId(fileIds[1]);
+    fileDb.updateSurveyTableModel();
+    QCOMPARE(fileDb.getPageCacheStats().hits, before.hits + 1);
+    QCOMPARE(fileDb.getSurveyModel()->rowCount(), 1);
+}
+
+void TestSurveyDatabase::queryPlans()
+{
+    const QString path(tempDir.filePath("plans.data"));
+
+    {
+        SurveyDatabase creator;
+        QVERIFY(creator.createDatabase(path));
+    }
+
+    // Like --check-plans, only the statements used on an existing file are explained, not the ones that created it.
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(path));
+    QVERIFY(db.addEmployee("Ann"));
+    QVERIFY(db.addSurvey(Survey(FirstDay, db.getEmployeeId("Ann"), 0, 36.5)));
+    db.getDailyStatus(FirstDay);
+    db.findSurveys(FirstDay, FirstDay, 0x1);
+    db.getTemperatureAlerts(FirstDay);
+    db.getCompliance(FirstDay, FirstDay.addDays(6), WorkdayCalendar());
+
+    QList<QueryPlan> plans(db.inspectQueryPlans());
+    QStringList statements;
+
+    QVERIFY(!plans.isEmpty());
+
+    // Like --check-query-plans, the intended scans (such as loading every question) are not issues.
+    for (const QueryPlan &plan : plans) {
+        QVERIFY2(plan.error.isEmpty(), qPrintable(plan.sql + ": " + plan.error));
+        QVERIFY2(!plan.hasIssues(), qPrintable(plan.sql + ": " + plan.details.join(", ")));
+        statements.append(plan.sql);
+
+        if (plan.sql == "SELECT bit, text, active FROM Question ORDER BY bit;")
+            QVERIFY(plan.expected && plan.fullScan);
+    }
+
+    // Every issued statement is explained once.
+    QCOMPARE(statements.removeDuplicates(), qsizetype(0));
+    QVERIFY(statements.contains("SELECT survey_date, emp_id, answers, temperature FROM Survey "
+                                "WHERE survey_date BETWEEN :from AND :to AND (answers & :mask) != 0 "
+                                "ORDER BY survey_date;"));
+}
+
+void TestSurveyDatabase::createIndex()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QVERIFY(!db.createIndex("DROP TABLE Survey;"));
+    QVERIFY(!db.createIndex("CREATE TABLE Other (id INTEGER);"));
+    QVERIFY(db.createIndex("CREATE INDEX idx_test_temperature ON Survey(temperature);"));
+    QVERIFY(!db.createIndex("CREATE INDEX idx_test_temperature ON Survey(temperature);"));
+    QVERIFY(!db.createIndex("CREATE INDEX idx_test_missing ON Missing(id);"));
+
+    // The survey table still works with the extra index.
+    QVERIFY(db.addEmployee("Ann"));
+    QVERIFY(db.addSurvey(Survey(FirstDay, db.getEmployeeId("Ann"), 0x1, 36.5)));
+    QCOMPARE(db.findSurveys(FirstDay, FirstDay, 0x1).size(), 1);
+}
+
+void TestSurveyDatabase::purgeSurveys()
+{
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(SurveyDatabase::InMemoryLocation));
+
+    QList<int> ids(createEmployees(db, {"Ann", "Ben"}));
+    const QDate cutoff(FirstDay.addDays(10));
+
+    // Ann had a fever for the ten purged days, Ben only has purged surveys.
+    QCOMPARE(addDailySurveys(db, ids[0], FirstDay, steady(39.0, 10) << steady(36.5, 6)), 16);
+    QCOMPARE(addDailySurveys(db, ids[1], FirstDay, steady(36.5, 3)), 3);
+
+    int purged(0);
+    int batch(0);
+
+    do {
+        batch = db.purgeSurveys(cutoff, 4);
+        QVERIFY(batch >= 0 && batch <= 4);
+        purged += batch;
+    } while (batch > 0);
+
+    QCOMPARE(purged, 13);
+
+    TemperatureSeries series;
+
+    QVERIFY(db.loadTemperatureSeries(series));
+    QCOMPARE(series.size(), 6);
+    QCOMPARE(series.getFirstTime(), toUnixTime(cutoff));
+    QCOMPARE(db.getTemperatureSketch(FirstDay, cutoff.addDays(-1)).getCount(), qint64(0));
+
+    // The trend only remembers the remaining readings, so a small rise now stands out.
+    QVERIFY(db.addSurvey(Survey(cutoff.addDays(6), ids[0], 0, 37.2)));
+
+    QList<TemperatureAlert> alerts(db.getTemperatureAlerts(cutoff));
+
+    QCOMPARE(alerts.size(), 1);
+    QCOMPARE(alerts[0].baseline, 36.5);
+
+    // Ben starts over without a trend.
+    QCOMPARE(addDailySurveys(db, ids[1], cutoff, steady(36.5, 4) << 38.0), 5);
+    QCOMPARE(db.getTemperatureAlerts(cutoff).size(), 1);
+}
+
+void TestSurveyDatabase::incrementalVacuum()
+{
+    const QString path(tempDir.filePath("vacuum.data"));
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(path));
+    QVERIFY(db.isIncrementalVacuum());
+    QVERIFY(db.enableIncrementalVacuum());
+    QVERIFY(db.addEmployee("Ann"));
+
+    QCOMPARE(addDailySurveys(db, db.getEmployeeId("Ann"), FirstDay, steady(36.5, 3000)), 3000);
+    QCOMPARE(db.purgeSurveys(FirstDay.addDays(3000), 5000), 3000);
+
+    int freePages(db.getFreePageCount());
+
+    QVERIFY(freePages > 0);
+
+    // Releasing pages is a write like any other, the retention job tries again while another workstation holds the lock.
+    {
+        RawConnection other(path);
+
+        QVERIFY(other.exec("BEGIN IMMEDIATE;"));
+        QCOMPARE(db.reclaimFreePages(1), qint64(-1));
+        QVERIFY(db.isLockBusy());
+        QCOMPARE(db.getFreePageCount(), freePages);
+        QVERIFY(other.exec("ROLLBACK;"));
+    }
+
+    qint64 reclaimed(db.reclaimFreePages(1));
+
+    QVERIFY(reclaimed > 0);
+    QVERIFY(db.getFreePageCount() < freePages);
+    QVERIFY(db.reclaimFreePages(freePages) > 0);
+    QCOMPARE(db.getFreePageCount(), 0);
+    QCOMPARE(db.reclaimFreePages(10), qint64(0));
+}
+
+void TestSurveyDatabase::backup()
+{
+    const QString path(tempDir.filePath("backup.data"));
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(path));
+    QVERIFY(db.addEmployee("Ann"));
+    QCOMPARE(addDailySurveys(db, db.getEmployeeId("Ann"), FirstDay, steady(36.5, 100)), 100);
+
+    BackupSettings settings;
+    settings.directory = tempDir.filePath("backups");
+    settings.compress = false;
+    db.getBackup()->setSettings(settings);
+
+    BackupReport report;
+    bool finished(false);
+
+    connect(db.getBackup(), &SurveyBackup::finished, this, [&report, &finished](const BackupReport &result) {
+        report = result;
+        finished = true;
+    });
+
+    QVERIFY(db.getBackup()->start());
+    QVERIFY(!db.getBackup()->start());
+    QTRY_VERIFY_WITH_TIMEOUT(finished, 10000);
+
+    // The backup works on the handle of Qt's own SQLite driver, which must be the system library.
+    if (report.error.contains("-system-sqlite"))
+        QSKIP("Qt is not built with -system-sqlite.");
+
+    QVERIFY2(report.error.isEmpty(), qPrintable(report.error));
+    QVERIFY(report.pages > 0);
+    QVERIFY(!report.vacuumed);
+    QVERIFY(QFile::exists(report.fileName));
+    QVERIFY(!QFile::exists(report.fileName + ".part"));
+
+    RawConnection copy(report.fileName);
+
+    QCOMPARE(copy.value("SELECT COUNT(*) FROM Survey;").toInt(), 100);
+}
+
+void TestSurveyDatabase::writeLockContention()
+{
+    const QString path(tempDir.filePath("contention.data"));
+    SurveyDatabase db;
+
+    QVERIFY(db.createDatabase(path));
+    QVERIFY(db.addEmployee("Ann"));
+    db.resetContentionStats();
+
+    RawConnection other(path);
+
+    QVERIFY(other.exec("BEGIN IMMEDIATE;"));
+
+    // The main thread tries once and only waits briefly for the lock.
+    QElapsedTimer timer;
+
+    timer.start();
+    QCOMPARE(db.addEmployees({"Ben"}), -1);
+    QVERIFY(timer.elapsed() < 1000);
+    QVERIFY(!db.getLastError().isEmpty());
+    QVERIFY(db.isLockBusy());
+
+    ContentionStats stats(db.getContentionStats());
+
+    QCOMPARE(stats.failedWrites, qint64(1));
+    QCOMPARE(stats.busyRetries, qint64(0));
+    QCOMPARE(stats.writeTransactions, qint64(0));
+    QVERIFY(stats.maxLockWaitMs > 0);
+
+    QVERIFY(other.exec("ROLLBACK;"));
+
+    QCOMPARE(db.addEmployees({"Ben"}), 1);
+    QVERIFY(db.getLastError().isEmpty());
+    QVERIFY(!db.isLockBusy());
+    QCOMPARE(db.getContentionStats().writeTransactions, qint64(1));
+
+    db.resetContentionStats();
+    QCOMPARE(db.getContentionStats().failedWrites, qint64(0));
+    QCOMPARE(db.getContentionStats().writeTransactions, qint64(0));
+}
+
+void TestSurveyDatabase::databaseChanged()
+{
+    const QString path(tempDir.filePath("shared.data"));
+    SurveyDatabase first;
+    SurveyDatabase second;
+
+    QVERIFY(first.createDatabase(path));
+    QVERIFY(second.createDatabase(path));
+
+    QSignalSpy changed(&first, &SurveyDatabase::databaseChanged);
+
+    QVERIFY(second.addEmployee("Ann"));
+    QVERIFY(changed.wait(5000));
+
+    // The other workstation's employee is known without reopening the file.
+    QCOMPARE(first.getEmployeeId("Ann"), second.getEmployeeId("Ann"));
+    QVERIFY(!first.addEmployee("ann"));
+}
+
+QTEST_GUILESS_MAIN(TestSurveyDatabase)
+
+#include "tst_surveydatabase.moc"
@@ -0,0 +1,7 @@
+TEMPLATE = app
+TARGET = tst_surveydatabase
+
+include(../objects.pri)
+
+SOURCES += \
+    tst_surveydatabase.cpp